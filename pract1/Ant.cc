@@ -6,6 +6,7 @@
 
 #include "Ant.h"
 #include "Tape.h"
+#include "SparseTape.h"
 #include <stdexcept>
 #include <iostream>
 
@@ -16,7 +17,7 @@
  * @param orient orientación inicial (LEFT, RIGHT, UP, DOWN)
  */
 Ant::Ant(unsigned x, unsigned y, Orientation orient)
-    : m_x(static_cast<int>(x)), m_y(static_cast<int>(y)), m_orient(orient)
+    : m_x(static_cast<std::int64_t>(x)), m_y(static_cast<std::int64_t>(y)), m_orient(orient)
 {
 }
 
@@ -36,6 +37,22 @@ unsigned Ant::y() const
     return static_cast<unsigned>(m_y);
 }
 
+/**
+ * @brief Obtiene la coordenada X con signo (puede ser negativa en la cinta ilimitada).
+ */
+std::int64_t Ant::posX() const
+{
+    return m_x;
+}
+
+/**
+ * @brief Obtiene la coordenada Y con signo (puede ser negativa en la cinta ilimitada).
+ */
+std::int64_t Ant::posY() const
+{
+    return m_y;
+}
+
 /**
  * @brief Obtiene la orientación actual.
  */
@@ -44,6 +61,16 @@ Ant::Orientation Ant::orient() const
     return m_orient;
 }
 
+/**
+ * @brief Coloca la hormiga en (x,y) con orientación (orient).
+ */
+void Ant::place(std::int64_t x, std::int64_t y, Orientation orient)
+{
+    m_x = x;
+    m_y = y;
+    m_orient = orient;
+}
+
 /**
  * @brief Representación de la hormiga como carácter según orientación: <, >, ^, v.
  * @return char con el símbolo de la hormiga
@@ -94,6 +121,36 @@ void Ant::turnRight()
     }
 }
 
+/**
+ * @brief Gira según el color que tenía la celda antes de pintarla.
+ * @param wasBlack true si la celda era negra (gira dcha), false si era blanca (gira izq)
+ */
+void Ant::turn(bool wasBlack)
+{
+    if (!wasBlack) {
+        // blanca -> negra, gira izq
+        turnLeft();
+    } else {
+        // negra -> blanca, gira dcha
+        turnRight();
+    }
+}
+
+/**
+ * @brief Deshace el giro de turn.
+ * @param wasBlack color que tenía la celda antes del paso que se deshace
+ */
+void Ant::unturn(bool wasBlack)
+{
+    if (!wasBlack) {
+        // giró a la izquierda
+        turnRight();
+    } else {
+        // giró a la derecha
+        turnLeft();
+    }
+}
+
 /**
  * @brief Realiza un paso según las reglas de Langton.
  */
@@ -105,23 +162,16 @@ bool Ant::step(Tape & tape)
         return false;
     }
 
-    // Lee color actual
-    bool isBlack = tape.get(static_cast<unsigned>(m_x), static_cast<unsigned>(m_y));
+    // Lee el color actual y lo invierte (blanca <-> negra) en un solo acceso,
+    // sin volver a comprobar límites porque ya se ha hecho arriba
+    bool wasBlack = tape.flipUnchecked(static_cast<unsigned>(m_x), static_cast<unsigned>(m_y));
 
-    // Aplica reglas, se pinta y gira
-    if (!isBlack) {
-        // blanca -> negra, gira izq
-        tape.set(static_cast<unsigned>(m_x), static_cast<unsigned>(m_y), true);
-        turnLeft();
-    } else {
-        // negra -> blanca, gira dcha
-        tape.set(static_cast<unsigned>(m_x), static_cast<unsigned>(m_y), false);
-        turnRight();
-    }
+    // Aplica reglas y gira
+    turn(wasBlack);
 
     // Calcula la nueva posición sin mover todavía, ya que podría ser inválida
-    int nx = m_x;
-    int ny = m_y;
+    std::int64_t nx = m_x;
+    std::int64_t ny = m_y;
     switch (m_orient) {
     case LEFT:  nx = m_x - 1; break;
     case RIGHT: nx = m_x + 1; break;
@@ -140,3 +190,60 @@ bool Ant::step(Tape & tape)
     m_y = ny;
     return true;
 }
+
+/**
+ * @brief Realiza un paso según las reglas de Langton sobre una cinta ilimitada.
+ */
+void Ant::step(SparseTape & tape)
+{
+    // Invierte la celda actual (reservando su baldosa si es la primera visita) y gira
+    turn(tape.flip(m_x, m_y));
+
+    // Avanza; no hay bordes que comprobar
+    switch (m_orient) {
+    case LEFT:  --m_x; break;
+    case RIGHT: ++m_x; break;
+    case UP:    --m_y; break;
+    case DOWN:  ++m_y; break;
+    }
+}
+
+/**
+ * @brief Deshace un paso según las reglas de Langton.
+ */
+bool Ant::unstep(Tape & tape)
+{
+    // Celda de la que venía: la de detrás según la orientación actual
+    std::int64_t px = m_x;
+    std::int64_t py = m_y;
+    switch (m_orient) {
+    case LEFT:  px = m_x + 1; break;
+    case RIGHT: px = m_x - 1; break;
+    case UP:    py = m_y + 1; break;
+    case DOWN:  py = m_y - 1; break;
+    }
+    if (!tape.isInside(px, py)) {
+        return false;
+    }
+
+    // Al invertirla recupera su color anterior; flipUnchecked devuelve el que tenía después del paso
+    bool wasBlack = !tape.flipUnchecked(static_cast<unsigned>(px), static_cast<unsigned>(py));
+    unturn(wasBlack);
+    m_x = px;
+    m_y = py;
+    return true;
+}
+
+/**
+ * @brief Deshace un paso según las reglas de Langton sobre una cinta ilimitada.
+ */
+void Ant::unstep(SparseTape & tape)
+{
+    switch (m_orient) {
+    case LEFT:  ++m_x; break;
+    case RIGHT: --m_x; break;
+    case UP:    ++m_y; break;
+    case DOWN:  --m_y; break;
+    }
+    unturn(!tape.flip(m_x, m_y));
+}
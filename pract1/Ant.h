@@ -7,10 +7,11 @@
 #ifndef ANT_H
 #define ANT_H
 
+#include "TapeLayout.h" // declara Tape sin incluir Tape.h, que Ant solo necesita en step()
+#include <cstdint>
 #include <iosfwd>
 
-class Tape; // forward declaration 
-// se usa para evitar incluir Tape.h aquí, ya que Ant solo lo necesita en el método step().
+class SparseTape;
 
 /// Representa la hormiga que se mueve sobre Tape
 class Ant {
@@ -18,6 +19,46 @@ public:
     /// Orientacion de la hormiga: Izquierda (0), Derecha (1), Arriba (2), Abajo (3)
     enum Orientation { LEFT = 0, RIGHT = 1, UP = 2, DOWN = 3 };
 
+    /**
+     * @brief Orientación tras el giro de la regla de Langton (a la izquierda si la celda era
+     *        blanca, a la derecha si era negra), sin tablas ni saltos, para los bucles rápidos.
+     *        Un giro siempre cambia entre horizontal y vertical (el bit alto); el bit bajo sale
+     *        del bit alto, del bajo y del color de la celda.
+     * @param orient orientación antes del paso (Orientation)
+     * @param wasBlack 1 si la celda era negra, 0 si era blanca
+     * @return nueva orientación (Orientation)
+     */
+    static constexpr unsigned langtonTurn(unsigned orient, unsigned wasBlack)
+    {
+        return (((orient >> 1) ^ 1u) << 1) | ((orient ^ (orient >> 1) ^ 1u ^ wasBlack) & 1u);
+    }
+
+    /**
+     * @brief Da 'steps' pasos de Langton seguidos sin comprobar bordes: lee e invierte el bit,
+     *        gira y avanza el cursor. Es el bucle de Simulator::runFast, común a cualquier
+     *        disposición de la cinta (Cursor de TapeLayout.h), así que langton_bench compara
+     *        las disposiciones con el mismo código que ejecuta la simulación.
+     * @param words palabras de la cinta (BasicTape::data)
+     * @param cursor posición de la hormiga, que queda tras el último paso
+     * @param orient orientación antes del primer paso
+     * @param steps pasos; el llamador garantiza que ninguno sale de la cinta
+     * @return orientación tras el último paso
+     */
+    template <class Cursor>
+    static unsigned runLangton(std::uint64_t* words, Cursor& cursor, unsigned orient, std::uint64_t steps)
+    {
+        for (std::uint64_t k = 0; k < steps; ++k) {
+            const std::uint64_t bit = cursor.bit();
+            std::uint64_t& word = words[bit >> 6];
+            const unsigned shift = static_cast<unsigned>(bit & 63);
+            const unsigned wasBlack = static_cast<unsigned>(word >> shift) & 1u;
+            word ^= std::uint64_t(1) << shift;
+            orient = langtonTurn(orient, wasBlack);
+            cursor.forward(orient);
+        }
+        return orient;
+    }
+
     /**
      * @brief Construye la hormiga en (x,y) con orientación (orient).
      * @param x coordenada X inicial
@@ -38,6 +79,30 @@ public:
      */
     bool step(Tape & tape);
 
+    /**
+     * @brief Realiza un paso según las reglas de Langton sobre una cinta ilimitada.
+     *        La cinta no tiene bordes, así que el paso siempre se realiza.
+     * @param tape referencia a la cinta dispersa donde está la hormiga
+     */
+    void step(SparseTape & tape);
+
+    /**
+     * @brief Deshace un paso según las reglas de Langton: la hormiga vuelve a la celda de la
+     *        que venía (la de detrás según su orientación), le devuelve su color anterior y
+     *        deshace el giro. La regla es reversible, así que no hace falta ningún historial.
+     *
+     * @param tape referencia a la cinta donde está la hormiga
+     * @return true si el paso se deshizo, false si la celda anterior quedaría fuera de la
+     *         cinta (en ese caso la hormiga no se mueve)
+     */
+    bool unstep(Tape & tape);
+
+    /**
+     * @brief Deshace un paso según las reglas de Langton sobre una cinta ilimitada.
+     * @param tape referencia a la cinta dispersa donde está la hormiga
+     */
+    void unstep(SparseTape & tape);
+
     /**
      * @brief Obtiene la coordenada X actual de la hormiga.
      */
@@ -48,11 +113,30 @@ public:
      */
     unsigned y() const;
 
+    /**
+     * @brief Obtiene la coordenada X con signo (puede ser negativa en la cinta ilimitada).
+     */
+    std::int64_t posX() const;
+
+    /**
+     * @brief Obtiene la coordenada Y con signo (puede ser negativa en la cinta ilimitada).
+     */
+    std::int64_t posY() const;
+
     /**
      * @brief Obtiene la orientación actual.
      */
     Orientation orient() const;
 
+    /**
+     * @brief Coloca la hormiga en (x,y) con orientación (orient).
+     *        Lo usan los bucles de simulación rápidos de Simulator para devolver el estado a la hormiga.
+     * @param x coordenada X
+     * @param y coordenada Y
+     * @param orient orientación
+     */
+    void place(std::int64_t x, std::int64_t y, Orientation orient);
+
     /**
      * @brief Representación de la hormiga como carácter según orientación: <, >, ^, v.
      * @return char con el símbolo de la hormiga
@@ -66,12 +150,15 @@ public:
 
 private:
     // Representación interna de la posición y orientación de la hormiga.
-    int m_x;
-    int m_y;
+    // Con signo y de 64 bits para poder moverse libremente por la cinta ilimitada.
+    std::int64_t m_x;
+    std::int64_t m_y;
     Orientation m_orient;
 
     void turnLeft();
     void turnRight();
+    void turn(bool wasBlack);
+    void unturn(bool wasBlack); // Deshace turn
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,356 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file BitKernels.cc
+ * @brief Implementación de las operaciones sobre palabras de 64 bits y de su elección según
+ *        el procesador.
+ */
+
+#include "BitKernels.h"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BITKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Versiones escalares: las de siempre, palabra a palabra
+
+std::uint64_t popcountScalar(const std::uint64_t* words, std::size_t n)
+{
+    std::uint64_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        count += static_cast<std::uint64_t>(__builtin_popcountll(words[i]));
+    }
+    return count;
+}
+
+std::size_t firstNonZeroScalar(const std::uint64_t* words, std::size_t n)
+{
+    std::size_t i = 0;
+    while (i < n && words[i] == 0) {
+        ++i;
+    }
+    return i;
+}
+
+std::size_t firstDifferenceScalar(const std::uint64_t* a, const std::uint64_t* b, std::size_t n)
+{
+    std::size_t i = 0;
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+void expandScalar(const std::uint64_t* words, std::size_t n, char* out, char zero, char one)
+{
+    const char symbols[2] = { zero, one };
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::uint64_t word = words[i];
+        for (unsigned b = 0; b < 64; ++b) {
+            out[b] = symbols[(word >> b) & 1u];
+        }
+        out += 64;
+    }
+}
+
+#ifdef BITKERNELS_X86
+
+// SSE4.2: POPCNT por palabra y comparaciones de 128 bits
+
+__attribute__((target("sse4.2,popcnt")))
+std::uint64_t popcountSse4(const std::uint64_t* words, std::size_t n)
+{
+    // Cuatro acumuladores para que las instrucciones POPCNT no dependan unas de otras
+    std::uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        c0 += static_cast<std::uint64_t>(__builtin_popcountll(words[i]));
+        c1 += static_cast<std::uint64_t>(__builtin_popcountll(words[i + 1]));
+        c2 += static_cast<std::uint64_t>(__builtin_popcountll(words[i + 2]));
+        c3 += static_cast<std::uint64_t>(__builtin_popcountll(words[i + 3]));
+    }
+    for (; i < n; ++i) {
+        c0 += static_cast<std::uint64_t>(__builtin_popcountll(words[i]));
+    }
+    return c0 + c1 + c2 + c3;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+std::size_t firstNonZeroSse4(const std::uint64_t* words, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(words + i);
+        __m128i any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                   _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        if (!_mm_testz_si128(any, any)) {
+            break;
+        }
+    }
+    while (i < n && words[i] == 0) {
+        ++i;
+    }
+    return i;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+std::size_t firstDifferenceSse4(const std::uint64_t* a, const std::uint64_t* b, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i* pa = reinterpret_cast<const __m128i*>(a + i);
+        const __m128i* pb = reinterpret_cast<const __m128i*>(b + i);
+        __m128i d01 = _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(pa), _mm_loadu_si128(pb)),
+                                   _mm_xor_si128(_mm_loadu_si128(pa + 1), _mm_loadu_si128(pb + 1)));
+        __m128i d23 = _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(pa + 2), _mm_loadu_si128(pb + 2)),
+                                   _mm_xor_si128(_mm_loadu_si128(pa + 3), _mm_loadu_si128(pb + 3)));
+        __m128i any = _mm_or_si128(d01, d23);
+        if (!_mm_testz_si128(any, any)) {
+            break;
+        }
+    }
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+void expandSse4(const std::uint64_t* words, std::size_t n, char* out, char zero, char one)
+{
+    // Cada grupo de 16 bits: el byte k del resultado toma el byte k / 8 de los bits y se
+    // compara con la máscara del bit k % 8
+    const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m128i bitMask = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i zeros = _mm_set1_epi8(zero);
+    const __m128i ones = _mm_set1_epi8(one);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::uint64_t word = words[i];
+        for (unsigned g = 0; g < 4; ++g) {
+            __m128i bits = _mm_shuffle_epi8(_mm_set1_epi16(static_cast<short>(word >> (16 * g))), spread);
+            __m128i set = _mm_cmpeq_epi8(_mm_and_si128(bits, bitMask), bitMask);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * g), _mm_blendv_epi8(zeros, ones, set));
+        }
+        out += 64;
+    }
+}
+
+// AVX2: 256 bits por instrucción; el recuento usa la tabla de 4 bits con VPSHUFB
+
+__attribute__((target("avx2,popcnt")))
+std::uint64_t popcountAvx2(const std::uint64_t* words, std::size_t n)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i total = _mm256_setzero_si256();
+    std::size_t i = 0;
+    while (i + 4 <= n) {
+        // Los contadores de 8 bits suman como mucho 8 por vector y vuelta: 31 vueltas caben
+        __m256i bytes = _mm256_setzero_si256();
+        for (unsigned k = 0; k < 31 && i + 4 <= n; ++k, i += 4) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+            __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+            __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+            bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(lo, hi));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    std::uint64_t count = static_cast<std::uint64_t>(_mm256_extract_epi64(total, 0)) +
+                          static_cast<std::uint64_t>(_mm256_extract_epi64(total, 1)) +
+                          static_cast<std::uint64_t>(_mm256_extract_epi64(total, 2)) +
+                          static_cast<std::uint64_t>(_mm256_extract_epi64(total, 3));
+    for (; i < n; ++i) {
+        count += static_cast<std::uint64_t>(__builtin_popcountll(words[i]));
+    }
+    return count;
+}
+
+__attribute__((target("avx2,popcnt")))
+std::size_t firstNonZeroAvx2(const std::uint64_t* words, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256i* p = reinterpret_cast<const __m256i*>(words + i);
+        __m256i any = _mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1)),
+                                      _mm256_or_si256(_mm256_loadu_si256(p + 2), _mm256_loadu_si256(p + 3)));
+        if (!_mm256_testz_si256(any, any)) {
+            break;
+        }
+    }
+    while (i < n && words[i] == 0) {
+        ++i;
+    }
+    return i;
+}
+
+__attribute__((target("avx2,popcnt")))
+std::size_t firstDifferenceAvx2(const std::uint64_t* a, const std::uint64_t* b, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256i* pa = reinterpret_cast<const __m256i*>(a + i);
+        const __m256i* pb = reinterpret_cast<const __m256i*>(b + i);
+        __m256i d01 = _mm256_or_si256(_mm256_xor_si256(_mm256_loadu_si256(pa), _mm256_loadu_si256(pb)),
+                                      _mm256_xor_si256(_mm256_loadu_si256(pa + 1), _mm256_loadu_si256(pb + 1)));
+        __m256i d23 = _mm256_or_si256(_mm256_xor_si256(_mm256_loadu_si256(pa + 2), _mm256_loadu_si256(pb + 2)),
+                                      _mm256_xor_si256(_mm256_loadu_si256(pa + 3), _mm256_loadu_si256(pb + 3)));
+        __m256i any = _mm256_or_si256(d01, d23);
+        if (!_mm256_testz_si256(any, any)) {
+            break;
+        }
+    }
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+__attribute__((target("avx2,popcnt")))
+void expandAvx2(const std::uint64_t* words, std::size_t n, char* out, char zero, char one)
+{
+    // Como en SSE4.2 pero con 32 bits por vector: VPSHUFB trabaja en cada mitad de 128 bits,
+    // así que la mitad alta toma los bytes 2 y 3
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bitMask = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                             1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i zeros = _mm256_set1_epi8(zero);
+    const __m256i ones = _mm256_set1_epi8(one);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::uint64_t word = words[i];
+        for (unsigned g = 0; g < 2; ++g) {
+            __m256i bits = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(word >> (32 * g))), spread);
+            __m256i set = _mm256_cmpeq_epi8(_mm256_and_si256(bits, bitMask), bitMask);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32 * g), _mm256_blendv_epi8(zeros, ones, set));
+        }
+        out += 64;
+    }
+}
+
+#endif
+
+// Operaciones de una versión
+struct Kernels {
+    std::uint64_t (*popcount)(const std::uint64_t*, std::size_t);
+    std::size_t (*firstNonZero)(const std::uint64_t*, std::size_t);
+    std::size_t (*firstDifference)(const std::uint64_t*, const std::uint64_t*, std::size_t);
+    void (*expand)(const std::uint64_t*, std::size_t, char*, char, char);
+};
+
+const Kernels kKernels[] = {
+    { popcountScalar, firstNonZeroScalar, firstDifferenceScalar, expandScalar },
+#ifdef BITKERNELS_X86
+    { popcountSse4, firstNonZeroSse4, firstDifferenceSse4, expandSse4 },
+    { popcountAvx2, firstNonZeroAvx2, firstDifferenceAvx2, expandAvx2 },
+#endif
+};
+
+BitKernels::Level detect()
+{
+#ifdef BITKERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return BitKernels::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+        return BitKernels::SSE4;
+    }
+#endif
+    return BitKernels::SCALAR;
+}
+
+// Versión en uso; -1 hasta la primera llamada
+std::atomic<int> g_level{ -1 };
+
+const Kernels& kernels()
+{
+    int level = g_level.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = BitKernels::best();
+        g_level.store(level, std::memory_order_relaxed);
+    }
+    return kKernels[level];
+}
+
+} // namespace
+
+/**
+* @brief Versión en uso.
+*/
+BitKernels::Level BitKernels::level()
+{
+    kernels();
+    return static_cast<Level>(g_level.load(std::memory_order_relaxed));
+}
+
+/**
+* @brief Mejor versión que admite el procesador (se comprueba una sola vez).
+*/
+BitKernels::Level BitKernels::best()
+{
+    static const Level detected = detect();
+    return detected;
+}
+
+/**
+* @brief Fuerza una versión.
+* @param level versión
+*/
+void BitKernels::setLevel(Level level)
+{
+    if (level < SCALAR || level > best()) {
+        throw std::invalid_argument(std::string("BitKernels: el procesador no admite la versión ") + name(level));
+    }
+    g_level.store(level, std::memory_order_relaxed);
+}
+
+/**
+* @brief Nombre de una versión.
+*/
+const char* BitKernels::name(Level level)
+{
+    switch (level) {
+    case SCALAR: return "scalar";
+    case SSE4:   return "sse4";
+    case AVX2:   return "avx2";
+    }
+    return "?";
+}
+
+/**
+* @brief Número de bits a 1 de n palabras.
+*/
+std::uint64_t BitKernels::popcount(const std::uint64_t* words, std::size_t n)
+{
+    return kernels().popcount(words, n);
+}
+
+/**
+* @brief Índice de la primera palabra distinta de cero, o n.
+*/
+std::size_t BitKernels::firstNonZero(const std::uint64_t* words, std::size_t n)
+{
+    return kernels().firstNonZero(words, n);
+}
+
+/**
+* @brief Índice de la primera palabra en que a y b difieren, o n.
+*/
+std::size_t BitKernels::firstDifference(const std::uint64_t* a, const std::uint64_t* b, std::size_t n)
+{
+    return kernels().firstDifference(a, b, n);
+}
+
+/**
+* @brief Expande los bits de n palabras a 64 * n caracteres.
+*/
+void BitKernels::expand(const std::uint64_t* words, std::size_t n, char* out, char zero, char one)
+{
+    kernels().expand(words, n, out, zero, one);
+}
@@ -0,0 +1,67 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file BitKernels.h
+ * @brief Operaciones vectorizadas sobre bloques de palabras de 64 bits (las de Tape): contar
+ *        bits, buscar palabras no nulas o distintas y expandir bits a caracteres.
+ *
+ * Hay tres versiones de cada operación: escalar, SSE4.2 (con POPCNT) y AVX2. La primera vez que
+ * se usan se elige la mejor que admite el procesador; setLevel permite forzar otra, p. ej. para
+ * medirlas en el banco de pruebas. Fuera de x86-64 solo existe la escalar.
+ */
+
+#ifndef BITKERNELS_H
+#define BITKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+class BitKernels {
+public:
+    /// Versión de las operaciones
+    enum Level { SCALAR = 0, SSE4 = 1, AVX2 = 2 };
+
+    /**
+     * @brief Versión en uso.
+     */
+    static Level level();
+
+    /**
+     * @brief Mejor versión que admite el procesador.
+     */
+    static Level best();
+
+    /**
+     * @brief Fuerza una versión. No debe llamarse mientras otros hilos usan las operaciones.
+     * @param level versión, como mucho best()
+     * @throw std::invalid_argument si el procesador no la admite
+     */
+    static void setLevel(Level level);
+
+    /**
+     * @brief Nombre de una versión ("scalar", "sse4" o "avx2").
+     */
+    static const char* name(Level level);
+
+    /**
+     * @brief Número de bits a 1 de n palabras.
+     */
+    static std::uint64_t popcount(const std::uint64_t* words, std::size_t n);
+
+    /**
+     * @brief Índice de la primera palabra distinta de cero, o n si no hay ninguna.
+     */
+    static std::size_t firstNonZero(const std::uint64_t* words, std::size_t n);
+
+    /**
+     * @brief Índice de la primera palabra en que a y b difieren, o n si son iguales.
+     */
+    static std::size_t firstDifference(const std::uint64_t* a, const std::uint64_t* b, std::size_t n);
+
+    /**
+     * @brief Escribe un carácter por bit de n palabras (64 * n caracteres, del bit 0 de la
+     *        primera palabra al bit 63 de la última): 'one' para los bits a 1 y 'zero' para el resto.
+     */
+    static void expand(const std::uint64_t* words, std::size_t n, char* out, char zero, char one);
+};
+
+#endif
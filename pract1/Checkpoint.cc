@@ -0,0 +1,105 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Checkpoint.cc
+ * @brief Implementación de Checkpointer, que guarda puntos de control de la simulación desde otro hilo.
+ */
+
+#include "Checkpoint.h"
+#include "Simulator.h"
+
+/**
+* @brief Arranca el hilo escritor.
+* @param filename fichero de los puntos de control
+* @param compress true para comprimir el grid con RLE
+*/
+Checkpointer::Checkpointer(const std::string& filename, bool compress)
+    : m_filename(filename), m_compress(compress), m_pending(-1), m_writing(-1), m_written(0),
+      m_failed(false), m_stop(false)
+{
+    m_thread = std::thread([this]() { run(); });
+}
+
+Checkpointer::~Checkpointer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+/**
+* @brief Copia el estado del simulador y lo encarga al hilo escritor.
+* @param sim simulador
+*/
+void Checkpointer::save(const Simulator& sim)
+{
+    // La copia que no se está escribiendo; si estaba pendiente se retira y se sobrescribe
+    int slot;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_writing != -1) {
+            slot = 1 - m_writing;
+        } else {
+            slot = (m_pending != -1) ? m_pending : 0;
+        }
+        if (m_pending == slot) {
+            m_pending = -1;
+        }
+    }
+    // El hilo escritor solo toca la copia pendiente o la que escribe, así que se copia sin el cerrojo
+    sim.captureSnapshot(m_images[slot]);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = slot;
+    }
+    m_wake.notify_one();
+}
+
+/**
+* @brief Espera a que se hayan escrito todos los puntos de control encargados.
+* @return false si alguna escritura ha fallado
+*/
+bool Checkpointer::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_pending == -1 && m_writing == -1; });
+    return !m_failed;
+}
+
+/**
+* @brief Número de puntos de control escritos.
+*/
+std::uint64_t Checkpointer::written() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_written;
+}
+
+/**
+* @brief Bucle del hilo escritor: escribe la copia pendiente hasta que se le pida parar.
+*/
+void Checkpointer::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_pending != -1 || m_stop; });
+        if (m_pending == -1) {
+            break;
+        }
+        const int slot = m_pending;
+        m_writing = slot;
+        m_pending = -1;
+        lock.unlock();
+        bool ok = Snapshot::write(m_filename, m_images[slot], m_compress);
+        lock.lock();
+        m_writing = -1;
+        if (ok) {
+            ++m_written;
+        } else {
+            m_failed = true;
+        }
+        m_idle.notify_all();
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Checkpoint.h
+ * @brief Definición de Checkpointer, que guarda puntos de control de la simulación desde otro hilo.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "Snapshot.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Simulator;
+
+/**
+ * @brief Guarda instantáneas (ver Snapshot.h) de un simulador en un fichero desde un hilo
+ *        aparte, para que la simulación no espere al disco.
+ *
+ * Usa dos copias en memoria: save copia el estado en la que no se está escribiendo y el hilo
+ * escritor la vuelca al fichero mientras la simulación sigue. Si llega otra copia antes de que
+ * el hilo empiece con la anterior, la sustituye: solo importa el último punto de control.
+ * La copia no es copy-on-write: save copia la cinta entera antes de volver, así que la
+ * simulación se detiene lo que tarda esa copia (unos 6 ms con una cinta de 16384x16384 y 60 ms
+ * con una de 65536x65536), pero no lo que tarda el disco.
+ * Snapshot::write escribe en "<fichero>.tmp" y renombra, así que el fichero siempre contiene
+ * un punto de control completo.
+ */
+class Checkpointer {
+public:
+    /**
+     * @brief Arranca el hilo escritor.
+     * @param filename fichero de los puntos de control
+     * @param compress true para comprimir el grid con RLE
+     */
+    Checkpointer(const std::string& filename, bool compress);
+
+    /**
+     * @brief Espera a que se escriba el último punto de control y detiene el hilo.
+     */
+    ~Checkpointer();
+
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+    /**
+     * @brief Copia el estado del simulador y lo encarga al hilo escritor. Solo lo puede llamar
+     *        un hilo (el que simula); la simulación solo se detiene mientras se copia.
+     * @param sim simulador
+     */
+    void save(const Simulator& sim);
+
+    /**
+     * @brief Espera a que se hayan escrito todos los puntos de control encargados.
+     * @return false si alguna escritura ha fallado
+     */
+    bool flush();
+
+    /**
+     * @brief Número de puntos de control escritos.
+     */
+    std::uint64_t written() const;
+
+private:
+    std::string m_filename;
+    bool m_compress;
+
+    SnapshotImage m_images[2];
+    int m_pending;            // copia lista para escribir (-1 si no hay)
+    int m_writing;            // copia que se está escribiendo (-1 si no hay)
+    std::uint64_t m_written;
+    bool m_failed;
+    bool m_stop;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake; // avisa al hilo escritor
+    std::condition_variable m_idle; // avisa a flush
+    std::thread m_thread;
+
+    void run(); // Bucle del hilo escritor
+};
+
+#endif
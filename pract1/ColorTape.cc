@@ -0,0 +1,103 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file ColorTape.cc
+ * @brief Implementación de la clase ColorTape (cinta bidimensional con varios colores por celda)
+ */
+
+#include "ColorTape.h"
+#include <stdexcept>
+
+/**
+* @brief Construye una cinta sizeX x sizeY, inicialmente todas de color 0.
+* @param sizeX número de columnas (ancho)
+* @param sizeY número de filas (alto)
+*/
+ColorTape::ColorTape(unsigned sizeX, unsigned sizeY)
+    : m_sizeX(sizeX), m_sizeY(sizeY)
+{
+    if (sizeX == 0 || sizeY == 0) {
+        throw std::invalid_argument("El tamaño de la cinta debe ser mayor que 0");
+    }
+    m_cells.assign(static_cast<std::size_t>(sizeX) * sizeY, 0);
+}
+
+/**
+* @brief Cambia el tamaño de la cinta y la deja toda de color 0, reutilizando la memoria si cabe.
+* @param sizeX número de columnas (ancho)
+* @param sizeY número de filas (alto)
+*/
+void ColorTape::reset(unsigned sizeX, unsigned sizeY)
+{
+    if (sizeX == 0 || sizeY == 0) {
+        throw std::invalid_argument("El tamaño de la cinta debe ser mayor que 0");
+    }
+    m_sizeX = sizeX;
+    m_sizeY = sizeY;
+    m_cells.assign(static_cast<std::size_t>(sizeX) * sizeY, 0);
+}
+
+/**
+* @brief Obtiene el color de la celda (x,y).
+*/
+unsigned ColorTape::get(unsigned x, unsigned y) const
+{
+    if (x >= m_sizeX || y >= m_sizeY) {
+        throw std::out_of_range("ColorTape::get: coordenadas fuera de rango");
+    }
+    return m_cells[static_cast<std::size_t>(y) * m_sizeX + x];
+}
+
+/**
+* @brief Fija el color de la celda (x,y).
+*/
+void ColorTape::set(unsigned x, unsigned y, unsigned color)
+{
+    if (x >= m_sizeX || y >= m_sizeY) {
+        throw std::out_of_range("ColorTape::set: coordenadas fuera de rango");
+    }
+    if (color > 255) {
+        throw std::out_of_range("ColorTape::set: color fuera de rango");
+    }
+    m_cells[static_cast<std::size_t>(y) * m_sizeX + x] = static_cast<std::uint8_t>(color);
+}
+
+/**
+* @brief Indica si un par de coordenadas está dentro de la cinta.
+*/
+bool ColorTape::isInside(std::int64_t x, std::int64_t y) const
+{
+    return x >= 0 && y >= 0 && x < static_cast<std::int64_t>(m_sizeX) && y < static_cast<std::int64_t>(m_sizeY);
+}
+
+/**
+* @brief Obtiene el ancho (sizeX)
+*/
+unsigned ColorTape::width() const
+{
+    return m_sizeX;
+}
+
+/**
+* @brief Obtiene la altura (sizeY)
+*/
+unsigned ColorTape::height() const
+{
+    return m_sizeY;
+}
+
+/**
+* @brief Devuelve el carácter para mostrar la celda (x,y).
+*/
+char ColorTape::cellChar(unsigned x, unsigned y) const
+{
+    return colorChar(get(x, y));
+}
+
+/**
+* @brief Carácter con el que se muestra un color.
+*/
+char ColorTape::colorChar(unsigned color)
+{
+    static const char kSymbols[] = " X23456789abcdefghijklmnopqrstuvwxyz";
+    return color < sizeof(kSymbols) - 1 ? kSymbols[color] : '#';
+}
@@ -0,0 +1,109 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file ColorTape.h
+ * @brief Definición de la clase ColorTape (cinta bidimensional con varios colores por celda)
+ */
+
+#ifndef COLORTAPE_H
+#define COLORTAPE_H
+
+#include "TapeMemory.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Cinta bidimensional con bordes donde cada celda guarda un índice de color (0..255)
+// en un byte. La usan las reglas multicolor; la hormiga de dos colores usa Tape.
+class ColorTape {
+public:
+    /**
+     * @brief Construye una cinta sizeX x sizeY, inicialmente todas de color 0.
+     * @param sizeX número de columnas (ancho)
+     * @param sizeY número de filas (alto)
+     */
+    ColorTape(unsigned sizeX, unsigned sizeY);
+
+    /**
+     * @brief Cambia el tamaño de la cinta y la deja toda de color 0, reutilizando la memoria si cabe.
+     * @param sizeX número de columnas (ancho)
+     * @param sizeY número de filas (alto)
+     */
+    void reset(unsigned sizeX, unsigned sizeY);
+
+    /**
+     * @brief Obtiene el color de la celda (x,y).
+     * @param x coordenada X (0..sizeX-1)
+     * @param y coordenada Y (0..sizeY-1)
+     * @return color de la celda
+     */
+    unsigned get(unsigned x, unsigned y) const;
+
+    /**
+     * @brief Fija el color de la celda (x,y).
+     * @param x coordenada X
+     * @param y coordenada Y
+     * @param color nuevo color (0..255)
+     */
+    void set(unsigned x, unsigned y, unsigned color);
+
+    /**
+     * @brief Indica si un par de coordenadas está dentro de la cinta.
+     * @param x coordenada X
+     * @param y coordenada Y
+     * @return true si está dentro
+     */
+    bool isInside(std::int64_t x, std::int64_t y) const;
+
+    /**
+     * @brief Obtiene el ancho (sizeX)
+     * @return ancho
+     */
+    unsigned width() const;
+
+    /**
+     * @brief Obtiene la altura (sizeY)
+     * @return alto
+     */
+    unsigned height() const;
+
+    /**
+     * @brief Devuelve el carácter para mostrar la celda (x,y): ' ' para 0, 'X' para 1,
+     *        y un dígito o letra para los demás colores.
+     * @param x coordenada X
+     * @param y coordenada Y
+     * @return char representación textual
+     */
+    char cellChar(unsigned x, unsigned y) const;
+
+    /**
+     * @brief Carácter con el que se muestra un color (el mismo que usa cellChar).
+     * @param color color de la celda
+     * @return char representación textual
+     */
+    static char colorChar(unsigned color);
+
+    /**
+     * @brief Acceso directo a las celdas, para los bucles de simulación.
+     *        La celda (x,y) es el byte y * width() + x.
+     * @return puntero a la primera celda
+     */
+    std::uint8_t* data();
+    const std::uint8_t* data() const;
+
+private:
+    unsigned m_sizeX;
+    unsigned m_sizeY;
+    std::vector<std::uint8_t, TapeAllocator<std::uint8_t>> m_cells; // las cintas grandes salen de TapeMemory
+};
+
+inline std::uint8_t* ColorTape::data()
+{
+    return m_cells.data();
+}
+
+inline const std::uint8_t* ColorTape::data() const
+{
+    return m_cells.data();
+}
+
+#endif
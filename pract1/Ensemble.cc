@@ -0,0 +1,176 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Ensemble.cc
+ * @brief Implementación de Ensemble, que ejecuta muchas simulaciones independientes repartidas
+ *        entre todos los núcleos y reúne sus estadísticas en una tabla.
+ */
+
+#include "Ensemble.h"
+#include "SeedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+/**
+* @brief Lee una lista de trabajos, uno por línea.
+* @param filename nombre del fichero
+* @return trabajos en el orden del fichero
+*/
+std::vector<EnsembleJob> Ensemble::readJobs(const std::string& filename)
+{
+    std::ifstream ifs(filename);
+    if (!ifs) {
+        throw std::runtime_error("No se pudo abrir el fichero: " + filename);
+    }
+    std::vector<EnsembleJob> jobs;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(ifs, line)) {
+        ++lineNumber;
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue; // línea vacía o comentario
+        }
+        std::istringstream iss(line);
+        EnsembleJob job;
+        int orient;
+        if (!(iss >> job.sizeX >> job.sizeY >> job.antX >> job.antY >> orient >> job.density >> job.seed >> job.maxSteps)) {
+            throw SeedFormatError(lineNumber, "(sizeX sizeY antX antY orient density seed maxSteps [regla])");
+        }
+        if (orient < 0 || orient > 3) {
+            throw SeedFormatError(lineNumber, "(orient debe ser 0 al 3)");
+        }
+        if (!(job.density >= 0.0 && job.density <= 1.0)) {
+            throw SeedFormatError(lineNumber, "(density debe estar entre 0 y 1)");
+        }
+        if (job.sizeX == 0 || job.sizeY == 0 || job.antX >= job.sizeX || job.antY >= job.sizeY) {
+            throw SeedFormatError(lineNumber, "(la hormiga debe estar dentro de la cinta)");
+        }
+        job.orient = static_cast<Ant::Orientation>(orient);
+        // El resto de la línea, si hay algo, es la regla
+        std::string rule;
+        std::getline(iss, rule);
+        std::size_t begin = rule.find_first_not_of(" \t\r");
+        if (begin != std::string::npos) {
+            try {
+                job.rule = Rule::parse(rule.substr(begin, rule.find_last_not_of(" \t\r") + 1 - begin));
+            } catch (std::exception const& e) {
+                throw SeedFormatError(lineNumber, std::string("(regla): ") + e.what());
+            }
+        }
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+/**
+* @brief Crea los hilos.
+* @param threads número de hilos (0 = núcleos de la máquina)
+*/
+Ensemble::Ensemble(unsigned threads)
+    : m_pool(threads), m_trackHighway(true), m_workers(m_pool.size())
+{
+}
+
+/**
+* @brief Activa la detección de la autopista.
+*/
+void Ensemble::setHighwayTracking(bool enabled)
+{
+    m_trackHighway = enabled;
+}
+
+/**
+* @brief Número de hilos.
+*/
+unsigned Ensemble::threads() const
+{
+    return m_pool.size();
+}
+
+/**
+* @brief Ejecuta un trabajo con el simulador del hilo 'worker'.
+*/
+EnsembleResult Ensemble::runJob(unsigned worker, const EnsembleJob& job)
+{
+    EnsembleResult result{ 0, false, 0, 0, 0, 0.0, std::string() };
+    try {
+        std::unique_ptr<Simulator>& sim = m_workers[worker];
+        if (!sim) {
+            sim.reset(new Simulator(job.sizeX, job.sizeY, job.antX, job.antY, job.orient,
+                                    Simulator::BOUNDED, job.rule));
+            sim->setQuiet(true);
+        } else {
+            sim->reset(job.sizeX, job.sizeY, job.antX, job.antY, job.orient, job.rule);
+        }
+        if (job.density > 0.0) {
+            sim->randomize(job.density, job.seed);
+        }
+        sim->setHighwayTracking(m_trackHighway);
+
+        auto start = std::chrono::steady_clock::now();
+        result.steps = sim->runFast(job.maxSteps);
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.edge = sim->borderReached();
+        result.black = sim->blackCount();
+        result.highwayPeriod = sim->highwayPeriod();
+        result.highwayOnset = sim->highwayOnset();
+    } catch (std::exception const& e) {
+        // Los hilos del ThreadPool no pueden lanzar excepciones: el error queda en la tabla
+        result.error = e.what();
+    }
+    return result;
+}
+
+/**
+* @brief Ejecuta todos los trabajos y espera a que terminen.
+* @param jobs trabajos
+* @return estadísticas de cada trabajo, en el mismo orden
+*/
+std::vector<EnsembleResult> Ensemble::run(const std::vector<EnsembleJob>& jobs)
+{
+    std::vector<EnsembleResult> results(jobs.size());
+    std::atomic<std::size_t> next(0);
+    const unsigned workers = static_cast<unsigned>(std::min<std::size_t>(m_pool.size(), jobs.size()));
+    // Una tarea por hilo; cada una va tomando trabajos hasta que no quedan
+    m_pool.parallelFor(workers, [&](unsigned worker) {
+        for (std::size_t i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1)) {
+            results[i] = runJob(worker, jobs[i]);
+        }
+    });
+    return results;
+}
+
+/**
+* @brief Escribe la tabla de resultados en CSV, una fila por trabajo.
+*/
+void Ensemble::writeTable(std::ostream& os, const std::vector<EnsembleJob>& jobs,
+                          const std::vector<EnsembleResult>& results)
+{
+    std::ostringstream out;
+    out << "job,sizeX,sizeY,antX,antY,orient,density,seed,maxSteps,rule,"
+           "steps,edge,black,highway_period,highway_onset,seconds,error\n";
+    for (std::size_t i = 0; i < jobs.size() && i < results.size(); ++i) {
+        const EnsembleJob& job = jobs[i];
+        const EnsembleResult& r = results[i];
+        out << i << ',' << job.sizeX << ',' << job.sizeY << ',' << job.antX << ',' << job.antY << ','
+            << static_cast<int>(job.orient) << ',' << job.density << ',' << job.seed << ',' << job.maxSteps << ','
+            << job.rule.text() << ',' << r.steps << ',' << (r.edge ? 1 : 0) << ',' << r.black << ','
+            << r.highwayPeriod << ',';
+        if (r.highwayPeriod != 0) {
+            out << r.highwayOnset;
+        }
+        out << ',' << r.seconds << ',';
+        if (!r.error.empty()) {
+            std::string error = r.error;
+            std::replace(error.begin(), error.end(), '"', '\'');
+            out << '"' << error << '"';
+        }
+        out << '\n';
+    }
+    os << out.str();
+}
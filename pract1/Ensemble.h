@@ -0,0 +1,109 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Ensemble.h
+ * @brief Definición de Ensemble, que ejecuta muchas simulaciones independientes repartidas
+ *        entre todos los núcleos y reúne sus estadísticas en una tabla.
+ */
+
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "Ant.h"
+#include "Rule.h"
+#include "Simulator.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Configuración inicial de una de las simulaciones (siempre con la cinta con bordes).
+ */
+struct EnsembleJob {
+    unsigned sizeX;
+    unsigned sizeY;
+    unsigned antX;
+    unsigned antY;
+    Ant::Orientation orient;
+    double density;          // proporción de celdas no blancas al empezar (ver Simulator::randomize)
+    std::uint64_t seed;      // semilla de las celdas al azar
+    std::uint64_t maxSteps;  // pasos como mucho (0 = hasta el borde)
+    Rule rule;
+};
+
+/**
+ * @brief Estadísticas de una simulación.
+ */
+struct EnsembleResult {
+    std::uint64_t steps;          // pasos ejecutados
+    bool edge;                    // true si terminó al alcanzar el borde
+    std::uint64_t black;          // celdas no blancas al final
+    unsigned highwayPeriod;       // periodo de la autopista (0 si no se detectó)
+    std::uint64_t highwayOnset;   // paso en que empezó la autopista
+    double seconds;               // tiempo de la simulación (sin crear la cinta)
+    std::string error;            // vacío si la simulación se pudo hacer
+};
+
+/**
+ * @brief Ejecuta una lista de simulaciones independientes en un ThreadPool.
+ *
+ * Cada hilo toma el siguiente trabajo libre de un contador atómico en cuanto termina el anterior,
+ * así que los trabajos largos no dejan hilos parados (el mismo efecto que el robo de tareas,
+ * sin colas por hilo porque los trabajos no generan más trabajo). Cada hilo tiene su propio
+ * Simulator, que se reutiliza con Simulator::reset para no reservar otra cinta en cada trabajo.
+ */
+class Ensemble {
+public:
+    /**
+     * @brief Lee una lista de trabajos. Cada línea es
+     *        "sizeX sizeY antX antY orient density seed maxSteps [regla]"; se ignoran las
+     *        líneas vacías y las que empiezan por '#'.
+     * @param filename nombre del fichero
+     * @return trabajos en el orden del fichero
+     * @throw std::runtime_error si no se puede abrir
+     * @throw SeedFormatError con el número de la primera línea incorrecta
+     */
+    static std::vector<EnsembleJob> readJobs(const std::string& filename);
+
+    /**
+     * @brief Crea los hilos.
+     * @param threads número de hilos (0 = núcleos de la máquina)
+     */
+    explicit Ensemble(unsigned threads = 0);
+
+    /**
+     * @brief Activa la detección de la autopista (por defecto activada). Con ella las simulaciones
+     *        de la regla de Langton avanzan paso a paso registrando el historial (ver
+     *        Simulator::setHighwayTracking); sin ella usan el bucle más rápido.
+     */
+    void setHighwayTracking(bool enabled);
+
+    /**
+     * @brief Número de hilos.
+     */
+    unsigned threads() const;
+
+    /**
+     * @brief Ejecuta todos los trabajos y espera a que terminen.
+     * @param jobs trabajos
+     * @return estadísticas de cada trabajo, en el mismo orden
+     */
+    std::vector<EnsembleResult> run(const std::vector<EnsembleJob>& jobs);
+
+    /**
+     * @brief Escribe la tabla de resultados en CSV, una fila por trabajo.
+     */
+    static void writeTable(std::ostream& os, const std::vector<EnsembleJob>& jobs,
+                           const std::vector<EnsembleResult>& results);
+
+private:
+    ThreadPool m_pool;
+    bool m_trackHighway;
+    std::vector<std::unique_ptr<Simulator>> m_workers; // simulador de cada hilo
+
+    EnsembleResult runJob(unsigned worker, const EnsembleJob& job);
+};
+
+#endif
@@ -0,0 +1,324 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file FrameRecorder.cc
+ * @brief Implementación del dibujo de fotogramas y de su grabación desde otro hilo.
+ */
+
+#include "FrameRecorder.h"
+#include "BitKernels.h"
+#include "Simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Paleta gris de la regla de Langton: el índice es la proporción de celdas negras (0-255)
+std::vector<Rgb> grayPalette()
+{
+    std::vector<Rgb> palette(256);
+    for (unsigned i = 0; i < 256; ++i) {
+        const std::uint8_t level = static_cast<std::uint8_t>(255 - i);
+        palette[i] = Rgb{ level, level, level };
+    }
+    return palette;
+}
+
+// Paleta de las reglas multicolor: blanco, negro y después tonos separados por la razón áurea
+std::vector<Rgb> colorPalette(unsigned colors)
+{
+    std::vector<Rgb> palette{ Rgb{ 255, 255, 255 }, Rgb{ 0, 0, 0 } };
+    double hue = 0.0;
+    while (palette.size() < colors) {
+        // HSV con saturación 0.75 y valor 0.95
+        const double h = hue * 6.0;
+        const double f = h - std::floor(h);
+        const double v = 0.95, p = v * 0.25, q = v * (1 - 0.75 * f), t = v * (1 - 0.75 * (1 - f));
+        double r, g, b;
+        switch (static_cast<int>(h) % 6) {
+        case 0: r = v; g = t; b = p; break;
+        case 1: r = q; g = v; b = p; break;
+        case 2: r = p; g = v; b = t; break;
+        case 3: r = p; g = q; b = v; break;
+        case 4: r = t; g = p; b = v; break;
+        default: r = v; g = p; b = q; break;
+        }
+        palette.push_back(Rgb{ static_cast<std::uint8_t>(r * 255), static_cast<std::uint8_t>(g * 255),
+                               static_cast<std::uint8_t>(b * 255) });
+        hue += 0.618033988749895;
+        hue -= std::floor(hue);
+    }
+    return palette;
+}
+
+// Paleta del mapa de calor: negro sin visitas y de rojo oscuro a blanco pasando por amarillo
+std::vector<Rgb> heatPalette()
+{
+    std::vector<Rgb> palette(256);
+    palette[0] = Rgb{ 0, 0, 0 };
+    for (unsigned i = 1; i < 256; ++i) {
+        const double t = 0.1 + 0.9 * (i - 1) / 254.0;
+        auto channel = [](double x) { return static_cast<std::uint8_t>(std::min(1.0, std::max(0.0, x)) * 255); };
+        palette[i] = Rgb{ channel(3 * t), channel(3 * t - 1), channel(3 * t - 2) };
+    }
+    return palette;
+}
+
+// Celdas negras del tramo [x0, x0+n) de una fila de bits
+unsigned countBits(const std::uint64_t* row, unsigned x0, unsigned n)
+{
+    unsigned count = 0;
+    unsigned x = x0;
+    while (x < x0 + n) {
+        const unsigned bit = x & 63u;
+        const unsigned take = std::min(64u - bit, x0 + n - x);
+        const std::uint64_t mask = (take == 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << take) - 1)) << bit;
+        count += static_cast<unsigned>(__builtin_popcountll(row[x >> 6] & mask));
+        x += take;
+    }
+    return count;
+}
+
+// Tamaño máximo de un fotograma ya ampliado: el lado de un PNG cabe en 31 bits y 2^32 píxeles
+// ya ocupan 4 GB antes de codificarlos
+const std::uint64_t kMaxImageSide = 0x7FFFFFFF;
+const std::uint64_t kMaxImagePixels = std::uint64_t(1) << 32;
+
+} // namespace
+
+/**
+* @brief Arranca los hilos que codifican los fotogramas.
+* @param base prefijo de los ficheros
+* @param format formato de las imágenes
+* @param options opciones de dibujo
+* @param threads hilos codificadores (0 = uno menos que los núcleos)
+*/
+FrameRecorder::FrameRecorder(const std::string& base, ImageWriter::Format format, const FrameOptions& options,
+                             unsigned threads)
+    : m_base(base), m_format(format), m_options(options), m_busy(0), m_written(0), m_failed(false), m_stop(false)
+{
+    if (threads == 0) {
+        // El núcleo que queda es el de la simulación
+        const unsigned cores = std::thread::hardware_concurrency();
+        threads = cores > 1 ? cores - 1 : 1;
+    }
+    // Dos copias más que hilos: la simulación puede copiar mientras todos los hilos trabajan
+    m_sources.resize(threads + 2);
+    for (std::size_t i = 0; i < m_sources.size(); ++i) {
+        m_free.push_back(i);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        m_threads.emplace_back([this]() { run(); });
+    }
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+/**
+* @brief Copia el estado del simulador y lo encarga a los hilos.
+* @param sim simulador
+*/
+void FrameRecorder::record(const Simulator& sim)
+{
+    std::size_t slot;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_released.wait(lock, [this]() { return !m_free.empty(); });
+        slot = m_free.back();
+        m_free.pop_back();
+    }
+    // El hilo solo toca las copias encargadas, así que se copia sin el cerrojo
+    try {
+        sim.captureFrame(m_sources[slot], m_options.heatmap);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(slot);
+        throw;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(slot);
+    }
+    m_wake.notify_one();
+}
+
+/**
+* @brief Espera a que se hayan escrito todos los fotogramas encargados.
+* @return false si alguna escritura ha fallado
+*/
+bool FrameRecorder::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_released.wait(lock, [this]() { return m_pending.empty() && m_busy == 0; });
+    return !m_failed;
+}
+
+/**
+* @brief Número de fotogramas escritos.
+*/
+std::uint64_t FrameRecorder::written() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_written;
+}
+
+/**
+* @brief Bucle de cada hilo: dibuja, codifica y escribe las copias en el orden en que llegan.
+*/
+void FrameRecorder::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return !m_pending.empty() || m_stop; });
+        if (m_pending.empty()) {
+            break;
+        }
+        const std::size_t slot = m_pending.front();
+        m_pending.pop_front();
+        ++m_busy;
+        lock.unlock();
+        bool ok;
+        try {
+            const FrameSource& source = m_sources[slot];
+            IndexedImage image = render(source, m_options);
+            const std::string file = m_base + "." + std::to_string(source.step) + ImageWriter::extension(m_format, image);
+            ok = ImageWriter::write(file, image, m_format);
+        } catch (std::exception const&) {
+            ok = false;
+        }
+        lock.lock();
+        --m_busy;
+        m_free.push_back(slot);
+        if (ok) {
+            ++m_written;
+        } else {
+            m_failed = true;
+        }
+        m_released.notify_all();
+    }
+}
+
+/**
+* @brief Dibuja un fotograma.
+* @param source estado copiado
+* @param options opciones de dibujo
+* @return imagen con paleta
+*/
+IndexedImage FrameRecorder::render(const FrameSource& source, const FrameOptions& options)
+{
+    const unsigned k = std::max(1u, options.cellsPerPixel);
+    const unsigned zoom = std::max(1u, options.pixelsPerCell);
+    const unsigned width = (source.width + k - 1) / k;
+    const unsigned height = (source.height + k - 1) / k;
+    if (std::uint64_t(width) * zoom > kMaxImageSide || std::uint64_t(height) * zoom > kMaxImageSide ||
+        std::uint64_t(width) * height * zoom * zoom > kMaxImagePixels) {
+        throw std::invalid_argument("la imagen de " + std::to_string(std::uint64_t(width) * zoom) + "x" +
+                                    std::to_string(std::uint64_t(height) * zoom) + " píxeles es demasiado grande");
+    }
+    // Celdas del bloque de la columna bx y la fila by (los del borde pueden ser más pequeños)
+    auto blockCells = [&](unsigned bx, unsigned by) {
+        return (std::min(source.width, (bx + 1) * k) - bx * k) * (std::min(source.height, (by + 1) * k) - by * k);
+    };
+
+    IndexedImage image;
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(width) * height);
+    if (options.heatmap) {
+        if (source.visits.size() != static_cast<std::size_t>(source.width) * source.height) {
+            throw std::logic_error("el mapa de calor necesita las visitas por celda (Simulator::setVisitCounting)");
+        }
+        // Máximo de visitas por bloque, en escala logarítmica respecto al máximo de la cinta
+        std::vector<std::uint32_t> peak(pixels.size(), 0);
+        for (unsigned y = 0; y < source.height; ++y) {
+            const std::uint32_t* row = source.visits.data() + static_cast<std::size_t>(y) * source.width;
+            std::uint32_t* out = peak.data() + static_cast<std::size_t>(y / k) * width;
+            for (unsigned x = 0; x < source.width; ++x) {
+                out[x / k] = std::max(out[x / k], row[x]);
+            }
+        }
+        const std::uint32_t top = peak.empty() ? 0 : *std::max_element(peak.begin(), peak.end());
+        const double scale = top > 0 ? 254.0 / std::log1p(static_cast<double>(top)) : 0.0;
+        for (std::size_t i = 0; i < pixels.size(); ++i) {
+            pixels[i] = peak[i] == 0 ? 0 : static_cast<std::uint8_t>(1 + std::log1p(static_cast<double>(peak[i])) * scale);
+        }
+        image.palette = heatPalette();
+    } else if (!source.colors.empty()) {
+        image.palette = colorPalette(source.colorCount);
+        if (k == 1) {
+            pixels.assign(source.colors.begin(), source.colors.end());
+        } else {
+            // El color más frecuente de cada bloque
+            std::vector<unsigned> counts(source.colorCount);
+            for (unsigned by = 0; by < height; ++by) {
+                for (unsigned bx = 0; bx < width; ++bx) {
+                    std::fill(counts.begin(), counts.end(), 0);
+                    for (unsigned y = by * k; y < std::min(source.height, (by + 1) * k); ++y) {
+                        const std::uint8_t* row = source.colors.data() + static_cast<std::size_t>(y) * source.width;
+                        for (unsigned x = bx * k; x < std::min(source.width, (bx + 1) * k); ++x) {
+                            ++counts[row[x]];
+                        }
+                    }
+                    pixels[static_cast<std::size_t>(by) * width + bx] =
+                        static_cast<std::uint8_t>(std::max_element(counts.begin(), counts.end()) - counts.begin());
+                }
+            }
+        }
+    } else {
+        image.palette = grayPalette();
+        if (k == 1) {
+            // Cada fila de bits se expande a 0 / 255 de una vez (BitKernels::expand)
+            std::vector<char> row(source.stride * 64);
+            for (unsigned y = 0; y < source.height; ++y) {
+                BitKernels::expand(source.bits.data() + static_cast<std::size_t>(y) * source.stride, source.stride,
+                                   row.data(), 0, static_cast<char>(255));
+                std::copy(row.begin(), row.begin() + source.width, pixels.begin() + static_cast<std::ptrdiff_t>(y) * width);
+            }
+        } else {
+            // Proporción de celdas negras de cada bloque
+            std::vector<unsigned> counts(width);
+            for (unsigned by = 0; by < height; ++by) {
+                std::fill(counts.begin(), counts.end(), 0);
+                for (unsigned y = by * k; y < std::min(source.height, (by + 1) * k); ++y) {
+                    const std::uint64_t* row = source.bits.data() + static_cast<std::size_t>(y) * source.stride;
+                    for (unsigned bx = 0; bx < width; ++bx) {
+                        counts[bx] += countBits(row, bx * k, std::min(source.width, (bx + 1) * k) - bx * k);
+                    }
+                }
+                for (unsigned bx = 0; bx < width; ++bx) {
+                    const unsigned cells = blockCells(bx, by);
+                    pixels[static_cast<std::size_t>(by) * width + bx] =
+                        static_cast<std::uint8_t>((static_cast<std::uint64_t>(counts[bx]) * 255 + cells / 2) / cells);
+                }
+            }
+        }
+    }
+
+    image.width = width * zoom;
+    image.height = height * zoom;
+    if (zoom == 1) {
+        image.pixels = std::move(pixels);
+        return image;
+    }
+    // Cada píxel se repite zoom veces en su fila y cada fila zoom veces
+    image.pixels.resize(static_cast<std::size_t>(image.width) * image.height);
+    for (unsigned y = 0; y < height; ++y) {
+        std::uint8_t* out = image.pixels.data() + static_cast<std::size_t>(y) * zoom * image.width;
+        for (unsigned x = 0; x < width; ++x) {
+            std::fill(out + static_cast<std::size_t>(x) * zoom, out + static_cast<std::size_t>(x + 1) * zoom,
+                      pixels[static_cast<std::size_t>(y) * width + x]);
+        }
+        for (unsigned r = 1; r < zoom; ++r) {
+            std::copy(out, out + image.width, out + static_cast<std::size_t>(r) * image.width);
+        }
+    }
+    return image;
+}
@@ -0,0 +1,125 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file FrameRecorder.h
+ * @brief Fotogramas de la cinta: copia del estado (FrameSource), opciones de dibujo
+ *        (FrameOptions) y grabación de secuencias desde otro hilo (FrameRecorder).
+ */
+
+#ifndef FRAMERECORDER_H
+#define FRAMERECORDER_H
+
+#include "Image.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Simulator;
+
+/// Cómo se dibuja un fotograma
+struct FrameOptions {
+    unsigned cellsPerPixel = 1; // lado del bloque de celdas que se reduce a un píxel
+    unsigned pixelsPerCell = 1; // lado del cuadrado de píxeles de cada celda (o bloque)
+    bool heatmap = false;       // colorear por visitas (Simulator::setVisitCounting)
+};
+
+/// Copia del estado que hace falta para dibujar un fotograma, tomada tal cual de la cinta
+/// (ver Simulator::captureFrame). Con la regla de Langton se copian las palabras de la cinta
+/// de bits; con las multicolor, un byte por celda.
+struct FrameSource {
+    std::uint64_t step = 0;
+    unsigned width = 0;
+    unsigned height = 0;
+    std::size_t stride = 0;             // palabras por fila de 'bits'
+    std::vector<std::uint64_t> bits;    // regla de Langton (formato de Tape::data)
+    std::vector<std::uint8_t> colors;   // reglas multicolor (vacío con la de Langton)
+    unsigned colorCount = 2;            // colores de la regla
+    std::vector<std::uint32_t> visits;  // visitas por celda (vacío sin mapa de calor)
+};
+
+/**
+ * @brief Graba una secuencia de fotogramas "<base>.<paso><extensión>" desde hilos aparte.
+ *
+ * record copia el estado del simulador en una de las copias libres (solo se detiene la
+ * simulación mientras copia las palabras de la cinta) y los hilos codificadores las dibujan,
+ * las codifican y las escriben; cada fotograma va a su propio fichero, así que pueden
+ * trabajar en varios a la vez. Si todas las copias están esperando a los hilos, record espera
+ * a que quede una libre: ningún fotograma se pierde y la memoria no crece sin límite.
+ */
+class FrameRecorder {
+public:
+    /**
+     * @brief Arranca los hilos que codifican los fotogramas.
+     * @param base prefijo de los ficheros
+     * @param format formato de las imágenes
+     * @param options opciones de dibujo
+     * @param threads hilos codificadores (0 = uno menos que los núcleos de la máquina, al
+     *        menos uno); hay dos copias del estado más que hilos
+     */
+    FrameRecorder(const std::string& base, ImageWriter::Format format, const FrameOptions& options,
+                  unsigned threads = 0);
+
+    /**
+     * @brief Espera a que se escriban los fotogramas pendientes y detiene los hilos.
+     */
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    /**
+     * @brief Copia el estado del simulador y lo encarga a los hilos. Solo lo puede llamar un hilo.
+     * @param sim simulador
+     * @throw std::logic_error si se pide mapa de calor sin contar las visitas
+     */
+    void record(const Simulator& sim);
+
+    /**
+     * @brief Espera a que se hayan escrito todos los fotogramas encargados.
+     * @return false si alguna escritura ha fallado
+     */
+    bool flush();
+
+    /**
+     * @brief Número de fotogramas escritos.
+     */
+    std::uint64_t written() const;
+
+    /**
+     * @brief Dibuja un fotograma: un píxel por bloque de cellsPerPixel x cellsPerPixel celdas
+     *        (gris según la proporción de celdas negras, el color más frecuente o el máximo de
+     *        visitas), ampliado a pixelsPerCell x pixelsPerCell píxeles.
+     * @param source estado copiado
+     * @param options opciones de dibujo
+     * @return imagen con paleta
+     * @throw std::invalid_argument si la imagen ampliada pasa de 2^32 píxeles
+     * @throw std::logic_error si se pide mapa de calor sin visitas
+     */
+    static IndexedImage render(const FrameSource& source, const FrameOptions& options);
+
+private:
+    std::string m_base;
+    ImageWriter::Format m_format;
+    FrameOptions m_options;
+
+    std::vector<FrameSource> m_sources;
+    std::vector<std::size_t> m_free;    // copias libres
+    std::deque<std::size_t> m_pending;  // copias por escribir, en orden
+    unsigned m_busy;                    // copias que se están escribiendo
+    std::uint64_t m_written;
+    bool m_failed;
+    bool m_stop;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;     // avisa a los hilos
+    std::condition_variable m_released; // avisa a record y flush
+    std::vector<std::thread> m_threads;
+
+    void run(); // Bucle de cada hilo
+};
+
+#endif
@@ -0,0 +1,300 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Highway.cc
+ * @brief Implementación de la clase HighwayDetector, que detecta la "autopista" periódica de la hormiga.
+ */
+
+#include "Highway.h"
+#include "SparseTape.h"
+#include <algorithm>
+#include <set>
+
+namespace {
+
+std::int64_t floorDiv(std::int64_t a, std::int64_t b)
+{
+    std::int64_t q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+std::int64_t ceilDiv(std::int64_t a, std::int64_t b)
+{
+    return -floorDiv(-a, b);
+}
+
+// Intervalo [lo, hi] de k que cumple |c - k*d| <= r (vacío si lo > hi)
+void kRange(std::int64_t c, std::int64_t d, std::int64_t r, std::int64_t& lo, std::int64_t& hi)
+{
+    if (d == 0) {
+        bool ok = c >= -r && c <= r;
+        lo = ok ? 0 : 1;
+        hi = ok ? INT64_MAX : 0;
+    } else if (d > 0) {
+        lo = ceilDiv(c - r, d);
+        hi = floorDiv(c + r, d);
+    } else {
+        lo = ceilDiv(c + r, d);
+        hi = floorDiv(c - r, d);
+    }
+}
+
+// Indica si (cx,cy) está en algún cuadrado de radio r centrado en (px,py) + k*(dx,dy), k >= 0
+bool inRay(std::int64_t cx, std::int64_t cy, std::int64_t px, std::int64_t py,
+           std::int64_t dx, std::int64_t dy, std::int64_t r)
+{
+    std::int64_t loX, hiX, loY, hiY;
+    kRange(cx - px, dx, r, loX, hiX);
+    kRange(cy - py, dy, r, loY, hiY);
+    std::int64_t lo = std::max<std::int64_t>(0, std::max(loX, loY));
+    std::int64_t hi = std::min(hiX, hiY);
+    return lo <= hi;
+}
+
+} // namespace
+
+HighwayDetector::HighwayDetector()
+    : m_history(kHistory), m_recorded(0), m_confirmed(false), m_period(0), m_dx(0), m_dy(0),
+      m_summary{ 0, 0, 0, 0, 0, 0 }
+{
+}
+
+/**
+* @brief Vacía el historial y olvida la autopista detectada.
+*/
+void HighwayDetector::reset()
+{
+    m_recorded = 0;
+    m_confirmed = false;
+    m_period = 0;
+    m_dx = m_dy = 0;
+    m_flips.clear();
+}
+
+/**
+* @brief Registra un paso, con el estado de la hormiga antes de darlo.
+*/
+void HighwayDetector::record(std::int64_t x, std::int64_t y, unsigned orient, bool wasBlack)
+{
+    m_history[m_recorded % kHistory] = { x, y, static_cast<std::uint8_t>(orient), wasBlack };
+    ++m_recorded;
+}
+
+/**
+* @brief Entrada de hace 'ago' pasos (1 = el último registrado).
+*/
+const HighwayDetector::Entry& HighwayDetector::back(unsigned ago) const
+{
+    return m_history[(m_recorded - ago) % kHistory];
+}
+
+/**
+* @brief Busca un periodo en el historial y, si lo hay, lo confirma contra la cinta.
+*/
+bool HighwayDetector::check(const SparseTape& tape, std::int64_t x, std::int64_t y, unsigned orient)
+{
+    if (m_confirmed) return true;
+    for (unsigned p = 1; p <= kMaxPeriod && 3ull * p <= m_recorded; ++p) {
+        if (candidate(p, x, y, orient) && confirm(tape, x, y, p)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+* @brief Comprueba en el historial si 'period' se repite en los tres últimos periodos.
+*/
+bool HighwayDetector::candidate(unsigned period, std::int64_t x, std::int64_t y, unsigned orient) const
+{
+    // Filtro rápido: mismo desplazamiento no nulo y misma orientación en tres periodos
+    const Entry& a = back(period);
+    const Entry& b = back(2 * period);
+    const Entry& c = back(3 * period);
+    std::int64_t ddx = x - a.x, ddy = y - a.y;
+    if ((ddx == 0 && ddy == 0) || a.orient != orient || b.orient != orient || c.orient != orient) return false;
+    if (a.x - b.x != ddx || a.y - b.y != ddy || b.x - c.x != ddx || b.y - c.y != ddy) return false;
+
+    // Misma secuencia de giros en los tres últimos periodos
+    return repeats(period, 2 * period);
+}
+
+/**
+* @brief Busca en el historial, sin mirar la cinta, el menor periodo que se repite.
+*/
+unsigned HighwayDetector::findPeriod(std::int64_t x, std::int64_t y, unsigned orient) const
+{
+    for (unsigned p = 1; p <= kMaxPeriod && 3ull * p <= m_recorded; ++p) {
+        if (candidate(p, x, y, orient)) {
+            return p;
+        }
+    }
+    return 0;
+}
+
+/**
+* @brief Indica si los últimos 'steps' colores leídos repiten los de 'period' pasos antes.
+*/
+bool HighwayDetector::repeats(unsigned period, unsigned steps) const
+{
+    if (static_cast<std::uint64_t>(steps) + period > std::min<std::uint64_t>(m_recorded, kHistory)) {
+        return false;
+    }
+    for (unsigned i = 1; i <= steps; ++i) {
+        if (back(i).wasBlack != back(i + period).wasBlack) return false;
+    }
+    return true;
+}
+
+/**
+* @brief Pasos, desde el último hacia atrás, durante los que el recorrido tiene periodo 'period'.
+*/
+std::uint64_t HighwayDetector::periodicSpan(unsigned period) const
+{
+    // Con la misma secuencia de giros, el desplazamiento y el giro total de cada ventana de
+    // 'period' pasos son constantes, así que basta comparar los colores leídos
+    const std::uint64_t available = std::min<std::uint64_t>(m_recorded, kHistory);
+    if (period > available) return 0;
+    unsigned i = 1;
+    while (i + period <= available && back(i).wasBlack == back(i + period).wasBlack) {
+        ++i;
+    }
+    return i - 1 + period;
+}
+
+/**
+* @brief Confirma el periodo comparando la cinta actual con la de hace un periodo en la región
+*        que la hormiga puede leer en el futuro.
+*/
+bool HighwayDetector::confirm(const SparseTape& tape, std::int64_t x, std::int64_t y, unsigned period)
+{
+    const Entry& start = back(period);
+    const std::int64_t dx = x - start.x;
+    const std::int64_t dy = y - start.y;
+    const std::int64_t r = period;
+
+    // Celdas invertidas durante el último periodo: las visitadas un número impar de veces
+    std::set<std::pair<std::int64_t, std::int64_t>> flipped;
+    for (unsigned i = 1; i <= period; ++i) {
+        auto cell = std::make_pair(back(i).x, back(i).y);
+        auto it = flipped.find(cell);
+        if (it == flipped.end()) {
+            flipped.insert(cell);
+        } else {
+            flipped.erase(it);
+        }
+    }
+
+    // Celdas negras ahora dentro de la región de hace un periodo (A0), que contiene a la actual (A1).
+    // Se recorre la banda que barre el rayo por tramos de unas baldosas, hasta salir del
+    // rectángulo de baldosas reservadas: el coste depende de la banda, no de toda la cinta
+    std::set<std::pair<std::int64_t, std::int64_t>> nowA0, nowA1, thenShifted;
+    std::int64_t minX, minY, maxX, maxY;
+    if (tape.bounds(minX, minY, maxX, maxY)) {
+        // Cada tramo avanza al menos 2r celdas, para que tramos consecutivos no relean casi las
+        // mismas celdas cuando el radio es mayor que una baldosa
+        const std::int64_t stride = std::max(dx < 0 ? -dx : dx, dy < 0 ? -dy : dy);
+        const std::int64_t chunk = std::max<std::int64_t>(1, std::max(SparseTape::kTileSize, 2 * r) / stride);
+        for (std::int64_t k = 0;; k += chunk) {
+            // Rectángulo de los cuadrados k .. k+chunk-1 del rayo
+            const std::int64_t ax = start.x + k * dx, bx = ax + (chunk - 1) * dx;
+            const std::int64_t ay = start.y + k * dy, by = ay + (chunk - 1) * dy;
+            const std::int64_t x0 = std::min(ax, bx) - r, x1 = std::max(ax, bx) + r;
+            const std::int64_t y0 = std::min(ay, by) - r, y1 = std::max(ay, by) + r;
+            // El rayo avanza siempre en la dirección d: si el tramo ya ha salido por ese lado,
+            // los siguientes también
+            if ((dx > 0 && x0 > maxX) || (dx < 0 && x1 < minX) || (dy > 0 && y0 > maxY) || (dy < 0 && y1 < minY)) {
+                break;
+            }
+            if (x1 < minX || x0 > maxX || y1 < minY || y0 > maxY) continue;
+            for (auto const& c : tape.blackCells(std::max(x0, minX), std::max(y0, minY),
+                                                 std::min(x1, maxX), std::min(y1, maxY))) {
+                if (inRay(c.first, c.second, start.x, start.y, dx, dy, r)) {
+                    nowA0.insert(c);
+                    if (inRay(c.first, c.second, x, y, dx, dy, r)) {
+                        nowA1.insert(c);
+                    }
+                }
+            }
+        }
+    }
+    // Estado de hace un periodo en A0 = estado actual XOR celdas invertidas, trasladado d
+    for (auto const& c : nowA0) {
+        if (!flipped.count(c)) thenShifted.insert({c.first + dx, c.second + dy});
+    }
+    for (auto const& c : flipped) {
+        if (!nowA0.count(c)) thenShifted.insert({c.first + dx, c.second + dy});
+    }
+    if (thenShifted != nowA1) {
+        return false;
+    }
+
+    m_confirmed = true;
+    m_period = period;
+    m_dx = dx;
+    m_dy = dy;
+    m_flips.clear();
+    for (auto const& c : flipped) {
+        m_flips.emplace_back(c.first - start.x, c.second - start.y);
+    }
+    m_summary = PeriodSummary{ 0, 0, 0, 0, 0, 0 };
+    for (auto const& c : flipped) {
+        m_summary.blackDelta += tape.get(c.first, c.second) ? 1 : -1;
+    }
+    for (unsigned i = 1; i <= period; ++i) {
+        const Entry& e = back(i);
+        m_summary.blackReads += e.wasBlack;
+        m_summary.minX = std::min(m_summary.minX, e.x - start.x);
+        m_summary.minY = std::min(m_summary.minY, e.y - start.y);
+        m_summary.maxX = std::max(m_summary.maxX, e.x - start.x);
+        m_summary.maxY = std::max(m_summary.maxY, e.y - start.y);
+    }
+    return true;
+}
+
+/**
+* @brief Indica si hay una autopista confirmada.
+*/
+bool HighwayDetector::confirmed() const
+{
+    return m_confirmed;
+}
+
+/**
+* @brief Periodo en pasos de la autopista confirmada.
+*/
+unsigned HighwayDetector::period() const
+{
+    return m_period;
+}
+
+/**
+* @brief Desplazamiento de la hormiga en cada periodo (X).
+*/
+std::int64_t HighwayDetector::dx() const
+{
+    return m_dx;
+}
+
+/**
+* @brief Desplazamiento de la hormiga en cada periodo (Y).
+*/
+std::int64_t HighwayDetector::dy() const
+{
+    return m_dy;
+}
+
+/**
+* @brief Resumen de un periodo de la autopista confirmada.
+*/
+const HighwayDetector::PeriodSummary& HighwayDetector::summary() const
+{
+    return m_summary;
+}
+
+/**
+* @brief Celdas que se invierten durante un periodo, relativas a la posición inicial del periodo.
+*/
+const std::vector<std::pair<std::int64_t, std::int64_t>>& HighwayDetector::flips() const
+{
+    return m_flips;
+}
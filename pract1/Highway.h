@@ -0,0 +1,145 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Highway.h
+ * @brief Definición de la clase HighwayDetector, que detecta la "autopista" periódica de la hormiga.
+ */
+
+#ifndef HIGHWAY_H
+#define HIGHWAY_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class SparseTape;
+
+/**
+ * @brief Detecta cuándo la hormiga de Langton sobre la cinta ilimitada entra en un régimen
+ *        periódico (la autopista de periodo 104) y obtiene el patrón que se repite.
+ *
+ * Guarda un historial circular de los últimos pasos (posición, orientación y color leído).
+ * Un candidato de periodo P es válido si las tres últimas ventanas de P pasos tienen el mismo
+ * desplazamiento (no nulo), la misma orientación y la misma secuencia de giros. Después se
+ * confirma comprobando que el contenido de la cinta en la región que la hormiga puede leer en
+ * el futuro (la unión de los cuadrados de radio P alrededor de p + k*d, k >= 0) es el de hace
+ * un periodo trasladado d, lo que garantiza que el periodo se repite indefinidamente. Esa
+ * comparación solo consulta las baldosas que corta la banda del rayo.
+ */
+class HighwayDetector {
+public:
+    /// Número de pasos del historial y periodo máximo que se busca
+    static constexpr unsigned kHistory = 8192;
+    static constexpr unsigned kMaxPeriod = kHistory / 4;
+
+    HighwayDetector();
+
+    /**
+     * @brief Vacía el historial y olvida la autopista detectada.
+     */
+    void reset();
+
+    /**
+     * @brief Registra un paso, con el estado de la hormiga antes de darlo.
+     * @param x posición X
+     * @param y posición Y
+     * @param orient orientación antes del paso
+     * @param wasBlack color de la celda leída
+     */
+    void record(std::int64_t x, std::int64_t y, unsigned orient, bool wasBlack);
+
+    /**
+     * @brief Busca un periodo en el historial y, si lo hay, lo confirma contra la cinta.
+     * @param tape cinta en el momento actual
+     * @param x posición X actual de la hormiga
+     * @param y posición Y actual de la hormiga
+     * @param orient orientación actual de la hormiga
+     * @return true si la hormiga está en una autopista confirmada
+     */
+    bool check(const SparseTape& tape, std::int64_t x, std::int64_t y, unsigned orient);
+
+    /**
+     * @brief Busca solo en el historial, sin mirar la cinta, el menor periodo que se repite en
+     *        los tres últimos periodos (sirve también para la cinta con bordes, donde no se
+     *        puede confirmar que la autopista no vaya a romperse).
+     * @param x posición X actual de la hormiga
+     * @param y posición Y actual de la hormiga
+     * @param orient orientación actual de la hormiga
+     * @return periodo encontrado, o 0 si no hay
+     */
+    unsigned findPeriod(std::int64_t x, std::int64_t y, unsigned orient) const;
+
+    /**
+     * @brief Indica si los colores leídos en los últimos 'steps' pasos repiten los de 'period'
+     *        pasos antes (si no hay historial suficiente devuelve false).
+     */
+    bool repeats(unsigned period, unsigned steps) const;
+
+    /**
+     * @brief Número de pasos registrados, contando hacia atrás desde el último, durante los que
+     *        la hormiga sigue un recorrido de periodo 'period' (como mucho kHistory). Restado
+     *        del paso actual da el paso en que empezó la autopista.
+     */
+    std::uint64_t periodicSpan(unsigned period) const;
+
+    /**
+     * @brief Indica si hay una autopista confirmada.
+     */
+    bool confirmed() const;
+
+    /**
+     * @brief Periodo en pasos de la autopista confirmada.
+     */
+    unsigned period() const;
+
+    /**
+     * @brief Desplazamiento de la hormiga en cada periodo.
+     */
+    std::int64_t dx() const;
+    std::int64_t dy() const;
+
+    /// Resumen del recorrido de un periodo de la autopista confirmada
+    struct PeriodSummary {
+        unsigned blackReads;     // pasos en que se leyó una celda negra (giros a la derecha)
+        int blackDelta;          // variación del número de celdas negras en el periodo
+        std::int64_t minX, minY; // rectángulo de las celdas visitadas, relativo a la
+        std::int64_t maxX, maxY; // posición de la hormiga al empezar el periodo
+    };
+
+    /**
+     * @brief Resumen de un periodo de la autopista confirmada (para las estadísticas de los
+     *        periodos que se saltan).
+     */
+    const PeriodSummary& summary() const;
+
+    /**
+     * @brief Celdas que se invierten durante un periodo, relativas a la posición de la hormiga
+     *        al empezarlo. Como la regla solo invierte celdas, aplicar varios periodos es una
+     *        XOR y el orden no importa.
+     */
+    const std::vector<std::pair<std::int64_t, std::int64_t>>& flips() const;
+
+private:
+    struct Entry {
+        std::int64_t x;
+        std::int64_t y;
+        std::uint8_t orient;
+        bool wasBlack;
+    };
+
+    std::vector<Entry> m_history; // circular, kHistory entradas
+    std::uint64_t m_recorded;     // pasos registrados en total
+
+    bool m_confirmed;
+    unsigned m_period;
+    std::int64_t m_dx;
+    std::int64_t m_dy;
+    std::vector<std::pair<std::int64_t, std::int64_t>> m_flips;
+    PeriodSummary m_summary;
+
+    const Entry& back(unsigned ago) const; // entrada de hace 'ago' pasos (1 = último)
+    // Filtro del historial: mismo desplazamiento, orientación y giros en tres periodos
+    bool candidate(unsigned period, std::int64_t x, std::int64_t y, unsigned orient) const;
+    bool confirm(const SparseTape& tape, std::int64_t x, std::int64_t y, unsigned period);
+};
+
+#endif
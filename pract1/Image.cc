@@ -0,0 +1,414 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Image.cc
+ * @brief Implementación de la escritura de imágenes en PGM/PPM y del codificador PNG.
+ */
+
+#include "Image.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+
+// --- Comprobaciones de PNG y zlib ---
+
+const std::uint32_t* crcTable()
+{
+    static std::uint32_t table[256];
+    static const bool ready = []() {
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return true;
+    }();
+    (void)ready;
+    return table;
+}
+
+std::uint32_t crc32(const std::uint8_t* data, std::size_t n, std::uint32_t crc = 0)
+{
+    const std::uint32_t* table = crcTable();
+    crc = ~crc;
+    for (std::size_t i = 0; i < n; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+std::uint32_t adler32(const std::uint8_t* data, std::size_t n)
+{
+    // 5552 bytes es lo máximo que se puede sumar sin que las sumas de 32 bits se desborden
+    std::uint32_t a = 1, b = 0;
+    while (n > 0) {
+        const std::size_t block = std::min<std::size_t>(n, 5552);
+        for (std::size_t i = 0; i < block; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += block;
+        n -= block;
+    }
+    return (b << 16) | a;
+}
+
+// --- deflate con códigos Huffman fijos (RFC 1951, sección 3.2.6) ---
+
+// Escribe bits empezando por el menos significativo de cada byte, como pide deflate
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<std::uint8_t>& out) : m_out(out), m_bits(0), m_count(0) {}
+
+    void put(std::uint32_t value, unsigned count)
+    {
+        m_bits |= static_cast<std::uint64_t>(value) << m_count;
+        m_count += count;
+        while (m_count >= 8) {
+            m_out.push_back(static_cast<std::uint8_t>(m_bits));
+            m_bits >>= 8;
+            m_count -= 8;
+        }
+    }
+
+    void finish()
+    {
+        if (m_count > 0) {
+            m_out.push_back(static_cast<std::uint8_t>(m_bits));
+        }
+        m_bits = 0;
+        m_count = 0;
+    }
+
+private:
+    std::vector<std::uint8_t>& m_out;
+    std::uint64_t m_bits;
+    unsigned m_count;
+};
+
+const unsigned kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                   35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const unsigned kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const unsigned kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                     257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                     8193, 12289, 16385, 24577 };
+const unsigned kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                      7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+const std::size_t kWindow = 32768;
+const unsigned kMinMatch = 3;
+const unsigned kMaxMatch = 258;
+const unsigned kHashBits = 15;
+// Candidatos que se prueban por posición y repetición más larga tras la que aún se insertan
+// en la tabla todas sus posiciones (las zonas uniformes darían cadenas larguísimas)
+const unsigned kMaxChain = 32;
+const unsigned kMaxInsert = 16;
+
+std::uint32_t reverseBits(std::uint32_t code, unsigned length)
+{
+    std::uint32_t reversed = 0;
+    for (unsigned i = 0; i < length; ++i) {
+        reversed = (reversed << 1) | ((code >> i) & 1u);
+    }
+    return reversed;
+}
+
+// Códigos fijos de los símbolos 0-287, ya invertidos para BitWriter
+struct FixedCodes {
+    std::uint32_t code[288];
+    unsigned length[288];
+    std::uint32_t distance[30];
+    std::uint16_t lengthSymbol[kMaxMatch + 1]; // índice en kLengthBase de cada longitud
+
+    FixedCodes()
+    {
+        for (unsigned s = 0; s < 288; ++s) {
+            unsigned value, bits;
+            if (s < 144) {
+                value = 0x30 + s;
+                bits = 8;
+            } else if (s < 256) {
+                value = 0x190 + (s - 144);
+                bits = 9;
+            } else if (s < 280) {
+                value = s - 256;
+                bits = 7;
+            } else {
+                value = 0xC0 + (s - 280);
+                bits = 8;
+            }
+            code[s] = reverseBits(value, bits);
+            length[s] = bits;
+        }
+        for (unsigned d = 0; d < 30; ++d) {
+            distance[d] = reverseBits(d, 5);
+        }
+        unsigned symbol = 0;
+        for (unsigned len = kMinMatch; len <= kMaxMatch; ++len) {
+            while (symbol + 1 < 29 && kLengthBase[symbol + 1] <= len) {
+                ++symbol;
+            }
+            lengthSymbol[len] = static_cast<std::uint16_t>(symbol);
+        }
+    }
+};
+
+// Comprime 'data' como un único bloque deflate con códigos fijos
+void deflateFixed(const std::vector<std::uint8_t>& data, std::vector<std::uint8_t>& out)
+{
+    static const FixedCodes codes;
+    BitWriter bits(out);
+    bits.put(1, 1); // último bloque
+    bits.put(1, 2); // códigos fijos
+
+    const std::size_t n = data.size();
+    std::vector<std::int64_t> head(std::size_t(1) << kHashBits, -1);
+    std::vector<std::int64_t> prev(kWindow, -1);
+    auto hashAt = [&](std::size_t i) {
+        const std::uint32_t v = static_cast<std::uint32_t>(data[i]) | (static_cast<std::uint32_t>(data[i + 1]) << 8) |
+                                (static_cast<std::uint32_t>(data[i + 2]) << 16);
+        return (v * 2654435761u) >> (32 - kHashBits);
+    };
+    auto insert = [&](std::size_t i) {
+        if (i + kMinMatch <= n) {
+            const std::uint32_t h = hashAt(i);
+            prev[i & (kWindow - 1)] = head[h];
+            head[h] = static_cast<std::int64_t>(i);
+        }
+    };
+    auto literal = [&](unsigned symbol) { bits.put(codes.code[symbol], codes.length[symbol]); };
+
+    std::size_t i = 0;
+    while (i < n) {
+        unsigned bestLength = 0;
+        std::size_t bestDistance = 0;
+        if (i + kMinMatch <= n) {
+            const std::size_t limit = std::min<std::size_t>(kMaxMatch, n - i);
+            std::int64_t candidate = head[hashAt(i)];
+            for (unsigned chain = 0; candidate >= 0 && chain < kMaxChain; ++chain) {
+                const std::size_t c = static_cast<std::size_t>(candidate);
+                if (i - c > kWindow) {
+                    break;
+                }
+                if (data[c + bestLength] == data[i + bestLength]) {
+                    unsigned length = 0;
+                    while (length < limit && data[c + length] == data[i + length]) {
+                        ++length;
+                    }
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = i - c;
+                        if (length == limit) {
+                            break;
+                        }
+                    }
+                }
+                candidate = prev[c & (kWindow - 1)];
+            }
+        }
+        if (bestLength >= kMinMatch) {
+            const unsigned ls = codes.lengthSymbol[bestLength];
+            literal(257 + ls);
+            bits.put(bestLength - kLengthBase[ls], kLengthExtra[ls]);
+            unsigned ds = 0;
+            while (ds + 1 < 30 && kDistanceBase[ds + 1] <= bestDistance) {
+                ++ds;
+            }
+            bits.put(codes.distance[ds], 5);
+            bits.put(static_cast<std::uint32_t>(bestDistance - kDistanceBase[ds]), kDistanceExtra[ds]);
+            insert(i);
+            if (bestLength <= kMaxInsert) {
+                for (unsigned k = 1; k < bestLength; ++k) {
+                    insert(i + k);
+                }
+            }
+            i += bestLength;
+        } else {
+            literal(data[i]);
+            insert(i);
+            ++i;
+        }
+    }
+    literal(256); // fin de bloque
+    bits.finish();
+}
+
+void putBigEndian(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    out.push_back(static_cast<std::uint8_t>(value >> 24));
+    out.push_back(static_cast<std::uint8_t>(value >> 16));
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Escribe un bloque PNG: longitud, tipo, datos y CRC del tipo y los datos
+void writeChunk(std::ostream& os, const char type[4], const std::uint8_t* data, std::size_t size)
+{
+    std::vector<std::uint8_t> header;
+    putBigEndian(header, static_cast<std::uint32_t>(size));
+    header.insert(header.end(), type, type + 4);
+    std::uint32_t crc = crc32(header.data() + 4, 4);
+    crc = crc32(data, size, crc);
+    std::vector<std::uint8_t> trailer;
+    putBigEndian(trailer, crc);
+    os.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    os.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    os.write(reinterpret_cast<const char*>(trailer.data()), static_cast<std::streamsize>(trailer.size()));
+}
+
+bool endsWith(const std::string& text, const char* suffix)
+{
+    const std::size_t n = std::strlen(suffix);
+    return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+} // namespace
+
+/**
+* @brief Indica si todos los colores de la paleta son grises.
+*/
+bool IndexedImage::gray() const
+{
+    return std::all_of(palette.begin(), palette.end(), [](const Rgb& c) { return c.r == c.g && c.g == c.b; });
+}
+
+/**
+* @brief Formato según la extensión del fichero.
+* @param filename nombre del fichero
+*/
+ImageWriter::Format ImageWriter::formatOf(const std::string& filename)
+{
+    if (endsWith(filename, ".png")) {
+        return PNG;
+    }
+    if (endsWith(filename, ".pgm") || endsWith(filename, ".ppm") || endsWith(filename, ".pnm")) {
+        return PNM;
+    }
+    throw std::invalid_argument(filename + ": extensión de imagen desconocida (.png, .pgm, .ppm o .pnm)");
+}
+
+/**
+* @brief Extensión que corresponde a una imagen en un formato.
+*/
+const char* ImageWriter::extension(Format format, const IndexedImage& image)
+{
+    if (format == PNG) {
+        return ".png";
+    }
+    return image.gray() ? ".pgm" : ".ppm";
+}
+
+/**
+* @brief Escribe la imagen en un fichero.
+* @param filename fichero de salida
+* @param image imagen
+* @param format formato
+* @return true si se escribió correctamente
+*/
+bool ImageWriter::write(const std::string& filename, const IndexedImage& image, Format format)
+{
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs) {
+        return false;
+    }
+    return format == PNG ? writePng(ofs, image) : writePnm(ofs, image);
+}
+
+/**
+* @brief Escribe la imagen como PGM (P5) si la paleta es gris y como PPM (P6) si no.
+* @param os flujo binario
+* @param image imagen
+*/
+bool ImageWriter::writePnm(std::ostream& os, const IndexedImage& image)
+{
+    const bool gray = image.gray();
+    os << (gray ? "P5" : "P6") << '\n' << image.width << ' ' << image.height << "\n255\n";
+    // Tabla de bytes por índice y bloques de filas de unos 256 KB: una escritura por bloque
+    const unsigned channels = gray ? 1 : 3;
+    std::uint8_t table[256][3] = {};
+    for (std::size_t i = 0; i < image.palette.size() && i < 256; ++i) {
+        table[i][0] = image.palette[i].r;
+        table[i][1] = image.palette[i].g;
+        table[i][2] = image.palette[i].b;
+    }
+    const std::size_t rowBytes = static_cast<std::size_t>(image.width) * channels;
+    const unsigned rowsPerBlock = static_cast<unsigned>(std::max<std::size_t>(1, (std::size_t(1) << 18) / std::max<std::size_t>(1, rowBytes)));
+    std::vector<std::uint8_t> block(rowBytes * std::min(rowsPerBlock, std::max(1u, image.height)));
+    for (unsigned y0 = 0; y0 < image.height; y0 += rowsPerBlock) {
+        const unsigned rows = std::min(rowsPerBlock, image.height - y0);
+        const std::size_t count = static_cast<std::size_t>(rows) * image.width;
+        const std::uint8_t* in = image.pixels.data() + static_cast<std::size_t>(y0) * image.width;
+        std::uint8_t* out = block.data();
+        if (gray) {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = table[in[i]][0];
+            }
+        } else {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[3 * i] = table[in[i]][0];
+                out[3 * i + 1] = table[in[i]][1];
+                out[3 * i + 2] = table[in[i]][2];
+            }
+        }
+        os.write(reinterpret_cast<const char*>(out), static_cast<std::streamsize>(count * channels));
+    }
+    return static_cast<bool>(os);
+}
+
+/**
+* @brief Escribe la imagen como PNG con paleta de 8 bits.
+* @param os flujo binario
+* @param image imagen
+*/
+bool ImageWriter::writePng(std::ostream& os, const IndexedImage& image)
+{
+    static const std::uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    os.write(reinterpret_cast<const char*>(kSignature), sizeof(kSignature));
+
+    std::vector<std::uint8_t> header;
+    putBigEndian(header, image.width);
+    putBigEndian(header, image.height);
+    header.push_back(8); // bits por índice
+    header.push_back(3); // imagen con paleta
+    header.push_back(0); // deflate
+    header.push_back(0); // filtros estándar
+    header.push_back(0); // sin entrelazado
+    writeChunk(os, "IHDR", header.data(), header.size());
+
+    std::vector<std::uint8_t> palette;
+    for (const Rgb& c : image.palette) {
+        palette.push_back(c.r);
+        palette.push_back(c.g);
+        palette.push_back(c.b);
+    }
+    writeChunk(os, "PLTE", palette.data(), palette.size());
+
+    // Cada fila empieza con su filtro (0, ninguno): las imágenes de la cinta son casi todo zonas
+    // uniformes, que deflate ya reduce a repeticiones
+    std::vector<std::uint8_t> raw;
+    raw.reserve(static_cast<std::size_t>(image.width + 1) * image.height);
+    for (unsigned y = 0; y < image.height; ++y) {
+        raw.push_back(0);
+        const std::uint8_t* in = image.pixels.data() + static_cast<std::size_t>(y) * image.width;
+        raw.insert(raw.end(), in, in + image.width);
+    }
+    std::vector<std::uint8_t> zlib = { 0x78, 0x01 };
+    deflateFixed(raw, zlib);
+    putBigEndian(zlib, adler32(raw.data(), raw.size()));
+
+    // Bloques IDAT de como mucho 1 MB
+    const std::size_t kMaxChunk = std::size_t(1) << 20;
+    for (std::size_t offset = 0; offset < zlib.size(); offset += kMaxChunk) {
+        writeChunk(os, "IDAT", zlib.data() + offset, std::min(kMaxChunk, zlib.size() - offset));
+    }
+    writeChunk(os, "IEND", nullptr, 0);
+    return static_cast<bool>(os);
+}
@@ -0,0 +1,73 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Image.h
+ * @brief Imagen con paleta (IndexedImage) y su escritura en PGM/PPM o PNG (ImageWriter).
+ *
+ * El PNG se codifica aquí mismo, sin bibliotecas externas: imagen con paleta de 8 bits por
+ * píxel, filas sin filtro y comprimidas con deflate (códigos Huffman fijos y repeticiones
+ * buscadas con una tabla hash), así que las zonas uniformes de la cinta ocupan muy poco.
+ */
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// Color de la paleta
+struct Rgb {
+    std::uint8_t r, g, b;
+};
+
+/// Imagen de un byte por píxel (índice en la paleta, de hasta 256 colores), fila a fila
+struct IndexedImage {
+    unsigned width = 0;
+    unsigned height = 0;
+    std::vector<std::uint8_t> pixels;
+    std::vector<Rgb> palette;
+
+    /**
+     * @brief Indica si todos los colores de la paleta son grises (se escribe como PGM).
+     */
+    bool gray() const;
+};
+
+/**
+ * @brief Escribe imágenes con paleta en PGM/PPM (binarios, P5/P6) o PNG.
+ */
+class ImageWriter {
+public:
+    /// Formato del fichero: PNM es PGM si la paleta es gris y PPM si no
+    enum Format { PNM = 0, PNG = 1 };
+
+    /**
+     * @brief Formato según la extensión del fichero (.png, .pgm, .ppm o .pnm).
+     * @throw std::invalid_argument si la extensión no es ninguna de esas
+     */
+    static Format formatOf(const std::string& filename);
+
+    /**
+     * @brief Extensión que corresponde a una imagen en un formato (".png", ".pgm" o ".ppm").
+     */
+    static const char* extension(Format format, const IndexedImage& image);
+
+    /**
+     * @brief Escribe la imagen en un fichero.
+     * @return true si se escribió correctamente
+     */
+    static bool write(const std::string& filename, const IndexedImage& image, Format format);
+
+    /**
+     * @brief Escribe la imagen en un flujo binario como PGM (P5) o PPM (P6).
+     */
+    static bool writePnm(std::ostream& os, const IndexedImage& image);
+
+    /**
+     * @brief Escribe la imagen en un flujo binario como PNG con paleta.
+     */
+    static bool writePng(std::ostream& os, const IndexedImage& image);
+};
+
+#endif
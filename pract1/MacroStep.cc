@@ -0,0 +1,114 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file MacroStep.cc
+ * @brief Cálculo y comprobación de la tabla de macro-pasos.
+ */
+
+#include "MacroStep.h"
+#include "Ant.h"
+#include "Tape.h"
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace {
+
+const int kDx[4] = { -1, 1, 0, 0 };
+const int kDy[4] = { 0, 0, -1, 1 };
+
+// Entrada de la tabla a partir de sus campos (ver MacroStep.h)
+std::uint32_t pack(unsigned patch, unsigned x, unsigned y, unsigned orient, unsigned steps)
+{
+    return patch | (x << 16) | (y << 18) | (orient << 20) | (static_cast<std::uint32_t>(steps) << 22);
+}
+
+std::uint32_t* g_table = nullptr; // no se libera: dura lo que el programa
+std::once_flag g_tableOnce;
+
+} // namespace
+
+/**
+* @brief Tabla de macro-pasos sin calcular (a ceros); la primera llamada la reserva. calloc
+*        pide un bloque tan grande directamente al sistema, que lo entrega ya a ceros, así que no
+*        lo recorre para ponerlo a ceros.
+* @throw std::bad_alloc si no hay memoria
+*/
+std::uint32_t* MacroStep::table()
+{
+    std::call_once(g_tableOnce, [] {
+        g_table = static_cast<std::uint32_t*>(std::calloc(kEntries, sizeof(std::uint32_t)));
+        if (!g_table) {
+            throw std::bad_alloc();
+        }
+    });
+    return g_table;
+}
+
+/**
+* @brief Calcula una entrada: da pasos sobre el bloque hasta que la hormiga sale de él.
+* @param patch bloque
+* @param x columna de la hormiga en el bloque
+* @param y fila de la hormiga en el bloque
+* @param orient orientación
+* @return entrada (ver MacroStep.h)
+*/
+std::uint32_t MacroStep::compute(unsigned patch, unsigned x, unsigned y, unsigned orient)
+{
+    unsigned steps = 0;
+    for (;;) {
+        const unsigned mask = 1u << (y * kSide + x);
+        const unsigned wasBlack = (patch & mask) != 0;
+        patch ^= mask;
+        orient = Ant::langtonTurn(orient, wasBlack);
+        ++steps;
+        const int nx = static_cast<int>(x) + kDx[orient];
+        const int ny = static_cast<int>(y) + kDy[orient];
+        if (nx < 0 || ny < 0 || nx >= static_cast<int>(kSide) || ny >= static_cast<int>(kSide)) {
+            return pack(patch, x, y, orient, steps);
+        }
+        x = static_cast<unsigned>(nx);
+        y = static_cast<unsigned>(ny);
+    }
+}
+
+/**
+* @brief Calcula toda la tabla y la comprueba contra Ant::step.
+* @return número de entradas que no coinciden
+*/
+std::size_t MacroStep::verify()
+{
+    std::uint32_t* entries = table();
+    Tape tape(kSide, kSide);
+    std::size_t wrong = 0;
+    for (unsigned patch = 0; patch < 0x10000u; ++patch) {
+        for (unsigned y = 0; y < kSide; ++y) {
+            for (unsigned x = 0; x < kSide; ++x) {
+                for (unsigned orient = 0; orient < 4; ++orient) {
+                    for (unsigned r = 0; r < kSide; ++r) {
+                        const std::uint64_t row = (patch >> (r * kSide)) & 0xFu;
+                        tape.writeRow(r, &row);
+                    }
+                    Ant ant(x, y, static_cast<Ant::Orientation>(orient));
+                    unsigned steps = 1;
+                    // Ant::step devuelve false en el paso que sacaría a la hormiga de la cinta,
+                    // después de invertir la celda y girar
+                    while (ant.step(tape)) {
+                        ++steps;
+                    }
+                    unsigned after = 0;
+                    for (unsigned r = 0; r < kSide; ++r) {
+                        std::uint64_t row;
+                        tape.readRow(r, &row);
+                        after |= static_cast<unsigned>(row) << (r * kSide);
+                    }
+                    const std::uint32_t expected = pack(after, static_cast<unsigned>(ant.posX()),
+                                                        static_cast<unsigned>(ant.posY()), ant.orient(), steps);
+                    if (lookup(entries, patch, x, y, orient) != expected) {
+                        ++wrong;
+                    }
+                }
+            }
+        }
+    }
+    return wrong;
+}
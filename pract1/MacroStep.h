@@ -0,0 +1,99 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file MacroStep.h
+ * @brief Tabla de macro-pasos de la hormiga de Langton: para cada contenido de un bloque de 4x4
+ *        celdas y cada posición y orientación de la hormiga dentro de él, el bloque, la posición
+ *        y la orientación con que la hormiga sale del bloque y los pasos que ha dado.
+ *
+ * Con la tabla, el bucle de simulación (motor MACRO de Simulator) lee las 16 celdas del bloque
+ * alineado a 4 en que está la hormiga, busca la entrada y escribe las celdas cambiadas de una
+ * vez, en lugar de leer, invertir y girar paso a paso. La hormiga de Langton siempre acaba
+ * saliendo de cualquier región finita, así que todas las entradas terminan.
+ *
+ * La tabla entera ocupa 16 MB y calcularla lleva más que muchas simulaciones, así que empieza
+ * a ceros (sin tocar la memoria: ver table()) y cada entrada se calcula la primera vez que se
+ * busca (ninguna entrada calculada es 0, porque siempre se da al menos un paso).
+ *
+ * No es más rápido que el bucle de runFast: cada búsqueda avanza unos pocos pasos y cuesta una
+ * lectura de una tabla que no cabe en la caché, mientras que runFast solo espera a la lectura
+ * de la celda. Sobre cintas que empiezan vacías va más o menos igual (0,9-1,1 veces runFast en
+ * langton_bench) y sobre cintas aleatorias, donde casi cada búsqueda falla en la caché, unas
+ * 5,5 veces más lento. Queda como motor opcional y como comprobación de la tabla (--verify).
+ */
+
+#ifndef MACROSTEP_H
+#define MACROSTEP_H
+
+#include <cstddef>
+#include <cstdint>
+
+class MacroStep {
+public:
+    /// Lado del bloque: 4x4 celdas, la fila r en los bits 4r..4r+3 y la columna c en el bit c de cada fila
+    static constexpr unsigned kSide = 4;
+    /// Número de entradas: 2^16 bloques x 16 posiciones x 4 orientaciones
+    static constexpr std::size_t kEntries = std::size_t(1) << 22;
+
+    /**
+     * @brief Tabla de macro-pasos, indexada por key(), sin calcular: se lee con lookup. Se
+     *        reserva a ceros la primera vez que se pide, con páginas que el sistema no entrega
+     *        hasta que se escriben, así que solo ocupan memoria las partes que se usan.
+     */
+    static std::uint32_t* table();
+
+    /**
+     * @brief Entrada de la tabla para un bloque y la hormiga en él, calculándola si hace falta.
+     * @param table tabla de table()
+     * @param patch bloque
+     * @param x columna de la hormiga en el bloque
+     * @param y fila de la hormiga en el bloque
+     * @param orient orientación (Ant::Orientation)
+     */
+    static std::uint32_t lookup(std::uint32_t* table, unsigned patch, unsigned x, unsigned y, unsigned orient)
+    {
+        // Accesos atómicos sin orden: varios hilos pueden calcular la misma entrada a la vez,
+        // pero todos escriben el mismo valor
+        std::uint32_t* entry = table + key(patch, x, y, orient);
+        std::uint32_t value = __atomic_load_n(entry, __ATOMIC_RELAXED);
+        if (value == 0) {
+            value = compute(patch, x, y, orient);
+            __atomic_store_n(entry, value, __ATOMIC_RELAXED);
+        }
+        return value;
+    }
+
+    /**
+     * @brief Calcula una entrada dando los pasos uno a uno sobre el bloque.
+     */
+    static std::uint32_t compute(unsigned patch, unsigned x, unsigned y, unsigned orient);
+
+    /**
+     * @brief Índice de la tabla para un bloque con la hormiga en (x,y) dentro de él, mirando en
+     *        la orientación 'orient' (Ant::Orientation).
+     */
+    static std::size_t key(unsigned patch, unsigned x, unsigned y, unsigned orient)
+    {
+        return (std::size_t(patch) << 6) | ((y * kSide + x) << 2) | orient;
+    }
+
+    /// Bloque después de los pasos
+    static unsigned patch(std::uint32_t entry) { return entry & 0xFFFFu; }
+    /// Columna dentro del bloque desde la que la hormiga sale
+    static unsigned lastX(std::uint32_t entry) { return (entry >> 16) & 3u; }
+    /// Fila dentro del bloque desde la que la hormiga sale
+    static unsigned lastY(std::uint32_t entry) { return (entry >> 18) & 3u; }
+    /// Orientación al salir: la hormiga pasa a la celda vecina de (lastX, lastY) en esa dirección
+    static unsigned orient(std::uint32_t entry) { return (entry >> 20) & 3u; }
+    /// Pasos dados, contando el que saca a la hormiga del bloque
+    static unsigned steps(std::uint32_t entry) { return entry >> 22; }
+
+    /**
+     * @brief Calcula toda la tabla y la comprueba contra Ant::step sobre una cinta de 4x4: en
+     *        cada entrada, la hormiga da pasos hasta que Ant::step no puede moverla fuera de la
+     *        cinta, y el bloque, la posición, la orientación y los pasos deben coincidir.
+     * @return número de entradas que no coinciden (0 si la tabla es correcta)
+     */
+    static std::size_t verify();
+};
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file MappedFile.cc
+ * @brief Implementación de MappedFile, fichero completo proyectado en memoria con mmap.
+ */
+
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+* @brief Proyecta el fichero completo en memoria.
+* @param filename nombre del fichero
+* @param copyOnWrite true para poder escribir en la copia en memoria
+*/
+MappedFile::MappedFile(const std::string& filename, bool copyOnWrite)
+    : m_data(nullptr), m_size(0)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("No se pudo abrir " + filename + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("No se pudo leer el tamaño de " + filename + ": " + std::strerror(error));
+    }
+    m_size = static_cast<std::size_t>(info.st_size);
+    if (m_size > 0) {
+        int prot = copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* addr = ::mmap(nullptr, m_size, prot, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error("No se pudo proyectar " + filename + ": " + std::strerror(error));
+        }
+        m_data = static_cast<char*>(addr);
+    }
+    // La proyección sigue siendo válida después de cerrar el descriptor
+    ::close(fd);
+}
+
+/**
+* @brief Libera la proyección.
+*/
+MappedFile::~MappedFile()
+{
+    if (m_data) {
+        ::munmap(m_data, m_size);
+    }
+}
+
+char* MappedFile::data()
+{
+    return m_data;
+}
+
+const char* MappedFile::data() const
+{
+    return m_data;
+}
+
+std::size_t MappedFile::size() const
+{
+    return m_size;
+}
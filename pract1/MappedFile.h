@@ -0,0 +1,48 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file MappedFile.h
+ * @brief Definición de MappedFile, fichero completo proyectado en memoria con mmap.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Proyecta un fichero completo en memoria y lo libera al destruirse.
+ *        Con copyOnWrite las páginas se pueden modificar sin que cambie el fichero
+ *        (MAP_PRIVATE): solo se copian las páginas que se escriben.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Proyecta el fichero.
+     * @param filename nombre del fichero
+     * @param copyOnWrite true para poder escribir en la copia en memoria
+     * @throw std::runtime_error si no se puede abrir o proyectar
+     */
+    explicit MappedFile(const std::string& filename, bool copyOnWrite = false);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Contenido del fichero (nullptr si está vacío).
+     */
+    char* data();
+    const char* data() const;
+
+    /**
+     * @brief Tamaño del fichero en bytes.
+     */
+    std::size_t size() const;
+
+private:
+    char* m_data;
+    std::size_t m_size;
+};
+
+#endif
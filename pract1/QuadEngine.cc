@@ -0,0 +1,505 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file QuadEngine.cc
+ * @brief Implementación de QuadEngine, motor de simulación sobre un quadtree con nodos compartidos
+ *        y resultados memorizados (al estilo de Hashlife para turmites).
+ */
+
+#include "QuadEngine.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Pasos como mucho por cada recorrido desde la raíz; entre recorridos se puede liberar memoria
+const std::uint64_t kChunkSteps = std::uint64_t(1) << 20;
+// Número de nodos a partir del cual se descartan los nodos inalcanzables y la memoria de recorridos
+const std::size_t kMaxNodes = std::size_t(1) << 21;
+
+// Desplazamiento según orientación de Ant: LEFT, RIGHT, UP, DOWN
+const std::int64_t kDx[4] = { -1, 1, 0, 0 };
+const std::int64_t kDy[4] = { 0, 0, -1, 1 };
+
+inline std::uint64_t mix(std::uint64_t h, std::uint64_t v)
+{
+    h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    return h * 0xBF58476D1CE4E5B9ull;
+}
+
+} // namespace
+
+std::size_t QuadEngine::LeafHash::operator()(const Leaf& leaf) const
+{
+    std::uint64_t h = 0;
+    for (std::size_t i = 0; i < leaf.size(); i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, leaf.data() + i, 8);
+        h = mix(h, word);
+    }
+    return static_cast<std::size_t>(h);
+}
+
+bool QuadEngine::InnerKey::operator==(const InnerKey& o) const
+{
+    return level == o.level && child[0] == o.child[0] && child[1] == o.child[1] &&
+           child[2] == o.child[2] && child[3] == o.child[3];
+}
+
+std::size_t QuadEngine::InnerHash::operator()(const InnerKey& key) const
+{
+    std::uint64_t h = key.level;
+    for (std::uint32_t c : key.child) h = mix(h, c);
+    return static_cast<std::size_t>(h);
+}
+
+bool QuadEngine::MemoKey::operator==(const MemoKey& o) const
+{
+    return node == o.node && orient == o.orient && state == o.state && x == o.x && y == o.y;
+}
+
+std::size_t QuadEngine::MemoHash::operator()(const MemoKey& key) const
+{
+    std::uint64_t h = mix(key.node, (static_cast<std::uint64_t>(key.orient) << 8) | key.state);
+    return static_cast<std::size_t>(mix(mix(h, key.x), key.y));
+}
+
+/**
+* @brief Crea el motor vacío, con la raíz rodeada de paredes (cinta con bordes) o centrada en
+*        (centerX, centerY) (cinta ilimitada).
+*/
+QuadEngine::QuadEngine(const Rule& rule, bool bounded, std::int64_t width, std::int64_t height,
+                       std::int64_t centerX, std::int64_t centerY)
+    : m_rule(rule), m_bounded(bounded), m_width(width), m_height(height)
+{
+    if (rule.colors() >= kWall) {
+        throw std::invalid_argument("QuadEngine: la regla no puede tener más de 255 colores");
+    }
+    if (bounded) {
+        // La cinta ocupa las celdas locales [1, width] x [1, height] y queda al menos una
+        // celda de pared alrededor, así que la hormiga nunca sale de la raíz
+        int level = 4;
+        while ((std::int64_t(1) << level) < std::max(width, height) + 2) ++level;
+        m_originX = -1;
+        m_originY = -1;
+        m_root = build(level, 0, 0);
+    } else {
+        m_originX = centerX - 8;
+        m_originY = centerY - 8;
+        m_root = white(4);
+    }
+    m_synced = m_root;
+}
+
+/**
+* @brief Obtiene (o crea) el nodo hoja con esas celdas.
+*/
+std::uint32_t QuadEngine::leaf(const Leaf& cells)
+{
+    auto it = m_leafIndex.find(cells);
+    if (it != m_leafIndex.end()) return it->second;
+    std::uint32_t id = static_cast<std::uint32_t>(m_nodes.size());
+    m_nodes.push_back({ { static_cast<std::uint32_t>(m_leaves.size()), 0, 0, 0 }, kLeafLevel });
+    m_leaves.push_back(cells);
+    m_leafIndex.emplace(cells, id);
+    return id;
+}
+
+/**
+* @brief Obtiene (o crea) el nodo interno con esos hijos.
+*/
+std::uint32_t QuadEngine::inner(int level, const std::uint32_t child[4])
+{
+    InnerKey key{ { child[0], child[1], child[2], child[3] }, static_cast<std::uint8_t>(level) };
+    auto it = m_innerIndex.find(key);
+    if (it != m_innerIndex.end()) return it->second;
+    std::uint32_t id = static_cast<std::uint32_t>(m_nodes.size());
+    m_nodes.push_back({ { child[0], child[1], child[2], child[3] }, static_cast<std::uint8_t>(level) });
+    m_innerIndex.emplace(key, id);
+    return id;
+}
+
+/**
+* @brief Nodo de un solo color para un nivel, guardado en cache.
+*/
+std::uint32_t QuadEngine::uniform(int level, std::uint8_t color, std::vector<std::uint32_t>& cache)
+{
+    if (cache.size() <= static_cast<std::size_t>(level)) {
+        cache.resize(level + 1, UINT32_MAX);
+    }
+    if (cache[level] == UINT32_MAX) {
+        std::uint32_t id;
+        if (level == kLeafLevel) {
+            Leaf cells;
+            cells.fill(color);
+            id = leaf(cells);
+        } else {
+            std::uint32_t c = uniform(level - 1, color, cache);
+            std::uint32_t children[4] = { c, c, c, c };
+            id = inner(level, children);
+        }
+        cache[level] = id;
+    }
+    return cache[level];
+}
+
+std::uint32_t QuadEngine::white(int level)
+{
+    return uniform(level, 0, m_white);
+}
+
+std::uint32_t QuadEngine::wall(int level)
+{
+    return uniform(level, kWall, m_wall);
+}
+
+/**
+* @brief Construye el nodo de la cinta con bordes que empieza en la posición local (x0,y0):
+*        blanco dentro de la cinta y pared fuera.
+*/
+std::uint32_t QuadEngine::build(int level, std::int64_t x0, std::int64_t y0)
+{
+    std::int64_t size = std::int64_t(1) << level;
+    bool inside = x0 >= 1 && y0 >= 1 && x0 + size - 1 <= m_width && y0 + size - 1 <= m_height;
+    bool outside = x0 + size - 1 < 1 || y0 + size - 1 < 1 || x0 > m_width || y0 > m_height;
+    if (inside) return white(level);
+    if (outside) return wall(level);
+    if (level == kLeafLevel) {
+        Leaf cells;
+        for (std::int64_t y = 0; y < kLeafSize; ++y) {
+            for (std::int64_t x = 0; x < kLeafSize; ++x) {
+                std::int64_t gx = x0 + x, gy = y0 + y;
+                bool in = gx >= 1 && gy >= 1 && gx <= m_width && gy <= m_height;
+                cells[y * kLeafSize + x] = in ? 0 : kWall;
+            }
+        }
+        return leaf(cells);
+    }
+    std::int64_t half = size / 2;
+    std::uint32_t children[4] = {
+        build(level - 1, x0, y0), build(level - 1, x0 + half, y0),
+        build(level - 1, x0, y0 + half), build(level - 1, x0 + half, y0 + half)
+    };
+    return inner(level, children);
+}
+
+/**
+* @brief Devuelve una copia del nodo con la celda local (x,y) cambiada.
+*/
+std::uint32_t QuadEngine::setIn(std::uint32_t node, std::uint64_t x, std::uint64_t y, std::uint8_t color)
+{
+    const Node n = m_nodes[node];
+    if (n.level == kLeafLevel) {
+        Leaf cells = m_leaves[n.child[0]];
+        cells[y * kLeafSize + x] = color;
+        return leaf(cells);
+    }
+    std::uint64_t half = std::uint64_t(1) << (n.level - 1);
+    unsigned ci = (y >= half ? 2 : 0) + (x >= half ? 1 : 0);
+    std::uint32_t children[4] = { n.child[0], n.child[1], n.child[2], n.child[3] };
+    children[ci] = setIn(children[ci], x - (ci & 1) * half, y - (ci >> 1) * half, color);
+    return inner(n.level, children);
+}
+
+/**
+* @brief Color de la celda local (x,y) del nodo.
+*/
+unsigned QuadEngine::getIn(std::uint32_t node, std::uint64_t x, std::uint64_t y) const
+{
+    while (m_nodes[node].level != kLeafLevel) {
+        const Node& n = m_nodes[node];
+        std::uint64_t half = std::uint64_t(1) << (n.level - 1);
+        unsigned ci = (y >= half ? 2 : 0) + (x >= half ? 1 : 0);
+        x -= (ci & 1) * half;
+        y -= (ci >> 1) * half;
+        node = n.child[ci];
+    }
+    return m_leaves[m_nodes[node].child[0]][y * kLeafSize + x];
+}
+
+/**
+* @brief Fija el color de una celda.
+*/
+void QuadEngine::setCell(std::int64_t x, std::int64_t y, unsigned color)
+{
+    if (m_bounded && (x < 0 || y < 0 || x >= m_width || y >= m_height)) {
+        throw std::out_of_range("QuadEngine::setCell: coordenadas fuera de rango");
+    }
+    if (color >= m_rule.colors()) {
+        throw std::out_of_range("QuadEngine::setCell: color fuera de rango");
+    }
+    std::int64_t size;
+    while (true) {
+        size = std::int64_t(1) << m_nodes[m_root].level;
+        if (x >= m_originX && y >= m_originY && x < m_originX + size && y < m_originY + size) break;
+        expand();
+    }
+    m_root = setIn(m_root, x - m_originX, y - m_originY, static_cast<std::uint8_t>(color));
+}
+
+/**
+* @brief Obtiene el color de una celda.
+*/
+unsigned QuadEngine::getCell(std::int64_t x, std::int64_t y) const
+{
+    std::int64_t size = std::int64_t(1) << m_nodes[m_root].level;
+    if (x < m_originX || y < m_originY || x >= m_originX + size || y >= m_originY + size) {
+        return m_bounded ? kWall : 0;
+    }
+    return getIn(m_root, x - m_originX, y - m_originY);
+}
+
+/**
+* @brief Nodo del nivel siguiente con el nodo dado en el centro y blanco alrededor.
+*/
+std::uint32_t QuadEngine::expandNode(std::uint32_t node)
+{
+    const Node n = m_nodes[node];
+    std::uint32_t w = white(n.level - 1);
+    std::uint32_t nw[4] = { w, w, w, n.child[0] };
+    std::uint32_t ne[4] = { w, w, n.child[1], w };
+    std::uint32_t sw[4] = { w, n.child[2], w, w };
+    std::uint32_t se[4] = { n.child[3], w, w, w };
+    std::uint32_t children[4] = { inner(n.level, nw), inner(n.level, ne), inner(n.level, sw), inner(n.level, se) };
+    return inner(n.level + 1, children);
+}
+
+/**
+* @brief Duplica el lado de la cinta ilimitada dejando la actual en el centro.
+*/
+void QuadEngine::expand()
+{
+    std::int64_t quarter = std::int64_t(1) << (m_nodes[m_root].level - 1);
+    m_root = expandNode(m_root);
+    m_synced = expandNode(m_synced);
+    m_originX -= quarter;
+    m_originY -= quarter;
+}
+
+/**
+* @brief Simula la hormiga dentro de una hoja de 8x8 celdas.
+*/
+QuadEngine::Result QuadEngine::runLeaf(std::uint32_t node, std::uint64_t x, std::uint64_t y,
+                                       unsigned orient, unsigned state, std::uint64_t maxSteps)
+{
+    Leaf cells = m_leaves[m_nodes[node].child[0]];
+    Result r{ 0, static_cast<std::int64_t>(x), static_cast<std::int64_t>(y), 0, 0, false, false, 0 };
+    while (r.steps < maxSteps) {
+        std::uint8_t& cell = cells[r.y * kLeafSize + r.x];
+        if (cell == kWall) {
+            r.halted = true;
+            break;
+        }
+        const Rule::Transition& t = m_rule.at(state, cell);
+        cell = t.write;
+        orient = Rule::rotate(orient, t.turn);
+        state = t.next;
+        ++r.steps;
+        r.x += kDx[orient];
+        r.y += kDy[orient];
+        if (r.x < 0 || r.y < 0 || r.x >= kLeafSize || r.y >= kLeafSize) {
+            r.exited = true;
+            break;
+        }
+    }
+    r.orient = static_cast<std::uint8_t>(orient);
+    r.state = static_cast<std::uint8_t>(state);
+    r.node = leaf(cells);
+    return r;
+}
+
+/**
+* @brief Simula la hormiga dentro de un nodo hasta que sale de él, pisa una pared o se agotan
+*        los pasos. Los recorridos completos (sale o pisa pared) se memorizan.
+*/
+QuadEngine::Result QuadEngine::runNode(std::uint32_t node, std::uint64_t x, std::uint64_t y,
+                                       unsigned orient, unsigned state, std::uint64_t maxSteps)
+{
+    MemoKey key{ node, static_cast<std::uint8_t>(orient), static_cast<std::uint8_t>(state), x, y };
+    auto it = m_memo.find(key);
+    if (it != m_memo.end() && it->second.steps <= maxSteps) {
+        return it->second;
+    }
+
+    const Node n = m_nodes[node];
+    Result r;
+    if (n.level == kLeafLevel) {
+        r = runLeaf(node, x, y, orient, state, maxSteps);
+    } else {
+        const std::int64_t half = std::int64_t(1) << (n.level - 1);
+        std::uint32_t children[4] = { n.child[0], n.child[1], n.child[2], n.child[3] };
+        std::int64_t cx = static_cast<std::int64_t>(x);
+        std::int64_t cy = static_cast<std::int64_t>(y);
+        r = Result{ 0, 0, 0, 0, 0, false, false, 0 };
+        while (true) {
+            unsigned ci = (cy >= half ? 2 : 0) + (cx >= half ? 1 : 0);
+            std::int64_t ox = (ci & 1) * half;
+            std::int64_t oy = (ci >> 1) * half;
+            Result sub = runNode(children[ci], static_cast<std::uint64_t>(cx - ox),
+                                 static_cast<std::uint64_t>(cy - oy), orient, state, maxSteps - r.steps);
+            children[ci] = sub.node;
+            r.steps += sub.steps;
+            orient = sub.orient;
+            state = sub.state;
+            cx = sub.x + ox;
+            cy = sub.y + oy;
+            if (sub.halted) {
+                r.halted = true;
+                break;
+            }
+            if (!sub.exited) {
+                break; // pasos agotados dentro del hijo
+            }
+            if (cx < 0 || cy < 0 || cx >= 2 * half || cy >= 2 * half) {
+                r.exited = true;
+                break;
+            }
+            if (r.steps >= maxSteps) {
+                break; // pasos agotados justo al pasar a otro hijo
+            }
+        }
+        r.x = cx;
+        r.y = cy;
+        r.orient = static_cast<std::uint8_t>(orient);
+        r.state = static_cast<std::uint8_t>(state);
+        r.node = inner(n.level, children);
+    }
+    if (r.exited || r.halted) {
+        m_memo[key] = r;
+    }
+    return r;
+}
+
+/**
+* @brief Ejecuta como mucho 'steps' pasos.
+*/
+std::uint64_t QuadEngine::run(AntState& ant, std::uint64_t steps, bool& halted)
+{
+    halted = false;
+    std::uint64_t total = 0;
+    while (total < steps) {
+        if (m_nodes.size() > kMaxNodes) {
+            collect();
+        }
+        // En la cinta ilimitada la raíz crece hasta contener a la hormiga
+        std::int64_t size = std::int64_t(1) << m_nodes[m_root].level;
+        if (ant.x < m_originX || ant.y < m_originY || ant.x >= m_originX + size || ant.y >= m_originY + size) {
+            expand();
+            continue;
+        }
+
+        Result r = runNode(m_root, static_cast<std::uint64_t>(ant.x - m_originX),
+                           static_cast<std::uint64_t>(ant.y - m_originY), ant.orient, ant.state,
+                           std::min(steps - total, kChunkSteps));
+        m_root = r.node;
+        total += r.steps;
+        ant.x = m_originX + r.x;
+        ant.y = m_originY + r.y;
+        ant.orient = r.orient;
+        ant.state = r.state;
+        if (r.halted) {
+            break;
+        }
+    }
+    // Si la hormiga ha quedado sobre la pared, el paso que la llevó ahí no se completa:
+    // vuelve a la celda anterior conservando el giro y el estado, como Ant::step
+    if (m_bounded && getCell(ant.x, ant.y) == kWall) {
+        ant.x -= kDx[ant.orient];
+        ant.y -= kDy[ant.orient];
+        halted = true;
+    }
+    return total;
+}
+
+/**
+* @brief Llama a fn por cada celda que ha cambiado entre dos versiones del mismo nodo.
+*        Los subárboles compartidos se saltan, así que el coste es proporcional a los cambios.
+*/
+void QuadEngine::diff(std::uint32_t before, std::uint32_t after, std::int64_t x0, std::int64_t y0,
+                      const std::function<void(std::int64_t, std::int64_t, unsigned)>& fn) const
+{
+    if (before == after) return;
+    const Node& a = m_nodes[before];
+    const Node& b = m_nodes[after];
+    if (b.level == kLeafLevel) {
+        const Leaf& la = m_leaves[a.child[0]];
+        const Leaf& lb = m_leaves[b.child[0]];
+        for (int i = 0; i < kLeafSize * kLeafSize; ++i) {
+            if (la[i] != lb[i] && lb[i] != kWall) {
+                fn(x0 + i % kLeafSize, y0 + i / kLeafSize, lb[i]);
+            }
+        }
+        return;
+    }
+    std::int64_t half = std::int64_t(1) << (b.level - 1);
+    for (unsigned ci = 0; ci < 4; ++ci) {
+        diff(a.child[ci], b.child[ci], x0 + (ci & 1) * half, y0 + (ci >> 1) * half, fn);
+    }
+}
+
+/**
+* @brief Recorre las celdas que han cambiado desde la última llamada.
+*/
+void QuadEngine::forEachChange(const std::function<void(std::int64_t, std::int64_t, unsigned)>& fn)
+{
+    diff(m_synced, m_root, m_originX, m_originY, fn);
+    m_synced = m_root;
+}
+
+/**
+* @brief Copia un subárbol en otro motor, reutilizando los nodos ya copiados.
+*/
+std::uint32_t QuadEngine::copyInto(std::uint32_t node, QuadEngine& target,
+                                   std::unordered_map<std::uint32_t, std::uint32_t>& remap) const
+{
+    auto it = remap.find(node);
+    if (it != remap.end()) return it->second;
+    const Node& n = m_nodes[node];
+    std::uint32_t id;
+    if (n.level == kLeafLevel) {
+        id = target.leaf(m_leaves[n.child[0]]);
+    } else {
+        std::uint32_t children[4];
+        for (unsigned ci = 0; ci < 4; ++ci) {
+            children[ci] = copyInto(n.child[ci], target, remap);
+        }
+        id = target.inner(n.level, children);
+    }
+    remap.emplace(node, id);
+    return id;
+}
+
+/**
+* @brief Descarta los nodos que ya no son alcanzables desde la raíz y la memoria de recorridos.
+*/
+void QuadEngine::collect()
+{
+    QuadEngine fresh(*this);
+    fresh.m_nodes.clear();
+    fresh.m_leaves.clear();
+    fresh.m_leafIndex.clear();
+    fresh.m_innerIndex.clear();
+    fresh.m_memo.clear();
+    fresh.m_white.clear();
+    fresh.m_wall.clear();
+    std::unordered_map<std::uint32_t, std::uint32_t> remap;
+    fresh.m_root = copyInto(m_root, fresh, remap);
+    fresh.m_synced = copyInto(m_synced, fresh, remap);
+    *this = std::move(fresh);
+}
+
+/**
+* @brief Número de nodos distintos.
+*/
+std::size_t QuadEngine::nodeCount() const
+{
+    return m_nodes.size();
+}
+
+/**
+* @brief Número de recorridos memorizados.
+*/
+std::size_t QuadEngine::memoSize() const
+{
+    return m_memo.size();
+}
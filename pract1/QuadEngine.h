@@ -0,0 +1,167 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file QuadEngine.h
+ * @brief Definición de QuadEngine, motor de simulación sobre un quadtree con nodos compartidos
+ *        y resultados memorizados (al estilo de Hashlife para turmites).
+ */
+
+#ifndef QUADENGINE_H
+#define QUADENGINE_H
+
+#include "Rule.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Motor de simulación que guarda la cinta como un quadtree en el que los subárboles
+ *        iguales se comparten (hash-consing) y memoriza, para cada macro-celda, el recorrido
+ *        completo de la hormiga: "entra en este nodo en (x,y) con orientación o y estado s, y
+ *        sale tras t pasos por (x',y') con o', s' y el nodo transformado en este otro".
+ *
+ * Las hojas son bloques de 8x8 celdas con un color por byte; el color 255 se reserva para
+ * las paredes que rodean la cinta con bordes (la hormiga se detiene al pisarlas).
+ */
+class QuadEngine {
+public:
+    /// Estado de la hormiga en coordenadas de la cinta
+    struct AntState {
+        std::int64_t x;
+        std::int64_t y;
+        unsigned orient;
+        unsigned state;
+    };
+
+    /// Color reservado para las paredes de la cinta con bordes
+    static constexpr std::uint8_t kWall = 255;
+
+    /**
+     * @brief Crea el motor vacío.
+     * @param rule regla de la hormiga (como mucho 255 colores)
+     * @param bounded true para una cinta de width x height con bordes; false para ilimitada
+     * @param width ancho (solo cinta con bordes)
+     * @param height alto (solo cinta con bordes)
+     * @param centerX, centerY punto alrededor del que se crea la cinta ilimitada
+     */
+    QuadEngine(const Rule& rule, bool bounded, std::int64_t width, std::int64_t height,
+               std::int64_t centerX = 0, std::int64_t centerY = 0);
+
+    /**
+     * @brief Fija el color de una celda (no modifica el estado memorizado).
+     */
+    void setCell(std::int64_t x, std::int64_t y, unsigned color);
+
+    /**
+     * @brief Obtiene el color de una celda.
+     */
+    unsigned getCell(std::int64_t x, std::int64_t y) const;
+
+    /**
+     * @brief Ejecuta como mucho 'steps' pasos.
+     * @param ant estado de la hormiga, que se actualiza
+     * @param steps número máximo de pasos
+     * @param halted se pone a true si la hormiga intentó salir de la cinta con bordes; en ese
+     *        caso el último paso contado es el que no se pudo completar y la hormiga no se movió
+     * @return número de pasos dados (incluido el que no se pudo completar)
+     */
+    std::uint64_t run(AntState& ant, std::uint64_t steps, bool& halted);
+
+    /**
+     * @brief Recorre las celdas que han cambiado desde la última llamada (o desde la creación).
+     * @param fn función que recibe x, y y el nuevo color
+     */
+    void forEachChange(const std::function<void(std::int64_t, std::int64_t, unsigned)>& fn);
+
+    /**
+     * @brief Número de nodos distintos y de recorridos memorizados.
+     */
+    std::size_t nodeCount() const;
+    std::size_t memoSize() const;
+
+private:
+    static constexpr int kLeafLevel = 3; // hojas de 8x8
+    static constexpr int kLeafSize = 1 << kLeafLevel;
+    using Leaf = std::array<std::uint8_t, kLeafSize * kLeafSize>;
+
+    struct Node {
+        std::uint32_t child[4]; // NW, NE, SW, SE; en las hojas child[0] es el índice de la hoja
+        std::uint8_t level;
+    };
+
+    struct LeafHash {
+        std::size_t operator()(const Leaf& leaf) const;
+    };
+    struct InnerKey {
+        std::uint32_t child[4];
+        std::uint8_t level;
+        bool operator==(const InnerKey& o) const;
+    };
+    struct InnerHash {
+        std::size_t operator()(const InnerKey& key) const;
+    };
+
+    // Recorrido memorizado
+    struct MemoKey {
+        std::uint32_t node;
+        std::uint8_t orient;
+        std::uint8_t state;
+        std::uint64_t x;
+        std::uint64_t y;
+        bool operator==(const MemoKey& o) const;
+    };
+    struct MemoHash {
+        std::size_t operator()(const MemoKey& key) const;
+    };
+    struct Result {
+        std::uint32_t node;  // nodo transformado
+        std::int64_t x;      // posición final relativa al nodo (fuera de él si 'exited')
+        std::int64_t y;
+        std::uint8_t orient;
+        std::uint8_t state;
+        bool exited;         // salió del nodo
+        bool halted;         // pisó una pared
+        std::uint64_t steps;
+    };
+
+    Rule m_rule;
+    bool m_bounded;
+    std::int64_t m_width;
+    std::int64_t m_height;
+
+    std::vector<Node> m_nodes;
+    std::vector<Leaf> m_leaves;
+    std::unordered_map<Leaf, std::uint32_t, LeafHash> m_leafIndex;
+    std::unordered_map<InnerKey, std::uint32_t, InnerHash> m_innerIndex;
+    std::unordered_map<MemoKey, Result, MemoHash> m_memo;
+    std::vector<std::uint32_t> m_white; // nodo blanco de cada nivel
+    std::vector<std::uint32_t> m_wall;  // nodo de pared de cada nivel
+
+    std::uint32_t m_root;
+    std::uint32_t m_synced;   // raíz en la última llamada a forEachChange
+    std::int64_t m_originX;   // coordenadas de la esquina superior izquierda de la raíz
+    std::int64_t m_originY;
+
+    std::uint32_t leaf(const Leaf& cells);
+    std::uint32_t inner(int level, const std::uint32_t child[4]);
+    std::uint32_t white(int level);
+    std::uint32_t wall(int level);
+    std::uint32_t uniform(int level, std::uint8_t color, std::vector<std::uint32_t>& cache);
+    std::uint32_t build(int level, std::int64_t x0, std::int64_t y0); // nodo para la cinta con bordes
+    std::uint32_t setIn(std::uint32_t node, std::uint64_t x, std::uint64_t y, std::uint8_t color);
+    unsigned getIn(std::uint32_t node, std::uint64_t x, std::uint64_t y) const;
+    void expand();
+    std::uint32_t expandNode(std::uint32_t node);
+    Result runNode(std::uint32_t node, std::uint64_t x, std::uint64_t y,
+                   unsigned orient, unsigned state, std::uint64_t maxSteps);
+    Result runLeaf(std::uint32_t node, std::uint64_t x, std::uint64_t y,
+                   unsigned orient, unsigned state, std::uint64_t maxSteps);
+    void diff(std::uint32_t before, std::uint32_t after, std::int64_t x0, std::int64_t y0,
+              const std::function<void(std::int64_t, std::int64_t, unsigned)>& fn) const;
+    void collect();
+    std::uint32_t copyInto(std::uint32_t node, QuadEngine& target,
+                           std::unordered_map<std::uint32_t, std::uint32_t>& remap) const;
+};
+
+#endif
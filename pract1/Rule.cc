@@ -0,0 +1,166 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Rule.cc
+ * @brief Implementación de las reglas de hormigas multicolor (cadenas RL) y turmites.
+ */
+
+#include "Rule.h"
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Convierte una letra de giro en su código; lanza excepción si no es válida
+std::uint8_t parseTurn(char c)
+{
+    switch (std::toupper(static_cast<unsigned char>(c))) {
+    case 'L': return Rule::LEFT;
+    case 'R': return Rule::RIGHT;
+    case 'N': return Rule::NONE;
+    case 'U': return Rule::UTURN;
+    default:
+        throw std::invalid_argument(std::string("Regla: giro desconocido '") + c + "'");
+    }
+}
+
+} // namespace
+
+/**
+* @brief Construye la regla de la hormiga de Langton de esta práctica ("LR"):
+*        blanca (0) gira a la izquierda y pasa a negra, negra (1) gira a la derecha y pasa a blanca.
+*/
+Rule::Rule()
+    : m_states(1), m_colors(2),
+      m_table{ {1, LEFT, 0}, {0, RIGHT, 0} }, m_text("LR")
+{
+}
+
+/**
+* @brief Construye una regla a partir de su texto (cadena de giros o tabla de turmite).
+*/
+Rule Rule::parse(const std::string& text)
+{
+    std::istringstream iss(text);
+    std::string first;
+    if (!(iss >> first)) {
+        throw std::invalid_argument("Regla vacía");
+    }
+
+    Rule rule;
+    rule.m_table.clear();
+
+    if (first == "turmite") {
+        // Tabla completa: turmite S C <S*C entradas color-giro-estado>
+        if (!(iss >> rule.m_states >> rule.m_colors) || rule.m_states == 0 || rule.m_colors < 2) {
+            throw std::invalid_argument("Regla turmite: se esperaba 'turmite S C' con S >= 1 y C >= 2");
+        }
+        if (rule.m_colors > kMaxColors || rule.m_states > 256) {
+            throw std::invalid_argument("Regla turmite: demasiados estados o colores");
+        }
+        for (unsigned i = 0; i < rule.m_states * rule.m_colors; ++i) {
+            std::string entry;
+            if (!(iss >> entry)) {
+                throw std::invalid_argument("Regla turmite: faltan entradas en la tabla");
+            }
+            // Formato <color><giro><estado>, p. ej. 1R0 o 12L3
+            std::size_t pos = 0;
+            while (pos < entry.size() && std::isdigit(static_cast<unsigned char>(entry[pos]))) ++pos;
+            if (pos == 0 || pos + 1 >= entry.size()) {
+                throw std::invalid_argument("Regla turmite: entrada no válida '" + entry + "'");
+            }
+            unsigned write = std::stoul(entry.substr(0, pos));
+            std::uint8_t turn = parseTurn(entry[pos]);
+            std::string nextText = entry.substr(pos + 1);
+            for (char c : nextText) {
+                if (!std::isdigit(static_cast<unsigned char>(c))) {
+                    throw std::invalid_argument("Regla turmite: entrada no válida '" + entry + "'");
+                }
+            }
+            unsigned next = std::stoul(nextText);
+            if (write >= rule.m_colors || next >= rule.m_states) {
+                throw std::invalid_argument("Regla turmite: color o estado fuera de rango en '" + entry + "'");
+            }
+            rule.m_table.push_back({ static_cast<std::uint8_t>(write), turn, static_cast<std::uint8_t>(next) });
+        }
+        std::string extra;
+        if (iss >> extra) {
+            throw std::invalid_argument("Regla turmite: sobran entradas en la tabla");
+        }
+    } else {
+        // Cadena de giros: la letra i indica el giro al pisar el color i, que pasa a i+1
+        std::string extra;
+        if (iss >> extra) {
+            throw std::invalid_argument("Regla: la cadena de giros no puede contener espacios");
+        }
+        if (first.size() < 2 || first.size() > kMaxColors) {
+            throw std::invalid_argument("Regla: la cadena de giros debe tener entre 2 y 256 letras");
+        }
+        rule.m_states = 1;
+        rule.m_colors = static_cast<unsigned>(first.size());
+        for (unsigned c = 0; c < rule.m_colors; ++c) {
+            std::uint8_t write = static_cast<std::uint8_t>((c + 1) % rule.m_colors);
+            rule.m_table.push_back({ write, parseTurn(first[c]), 0 });
+        }
+        for (char& c : first) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    rule.m_text = text;
+    if (first != "turmite") {
+        rule.m_text = first;
+    }
+    return rule;
+}
+
+/**
+* @brief Número de estados de la regla.
+*/
+unsigned Rule::states() const
+{
+    return m_states;
+}
+
+/**
+* @brief Número de colores de la regla.
+*/
+unsigned Rule::colors() const
+{
+    return m_colors;
+}
+
+/**
+* @brief Transición para el estado y color dados.
+*/
+const Rule::Transition& Rule::at(unsigned state, unsigned color) const
+{
+    return m_table[state * m_colors + color];
+}
+
+/**
+* @brief Indica si es una cadena de giros (un estado y el color avanza en uno).
+*/
+bool Rule::isTurnString() const
+{
+    if (m_states != 1) return false;
+    for (unsigned c = 0; c < m_colors; ++c) {
+        if (m_table[c].write != (c + 1) % m_colors) return false;
+    }
+    return true;
+}
+
+/**
+* @brief Indica si es la regla de la hormiga de Langton de esta práctica ("LR").
+*/
+bool Rule::isLangton() const
+{
+    return isTurnString() && m_colors == 2 &&
+           m_table[0].turn == LEFT && m_table[1].turn == RIGHT;
+}
+
+/**
+* @brief Texto de la regla, en el mismo formato que acepta parse().
+*/
+const std::string& Rule::text() const
+{
+    return m_text;
+}
@@ -0,0 +1,220 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Rule.h
+ * @brief Definición de las reglas de hormigas multicolor (cadenas RL) y turmites.
+ */
+
+#ifndef RULE_H
+#define RULE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Regla de un turmite: para cada par (estado, color) indica el color que se escribe,
+ *        el giro relativo y el siguiente estado.
+ *
+ * Se puede construir desde texto:
+ *   - Cadena de giros, p. ej. "LR", "RLR", "LLRR": un solo estado, el color c pasa a c+1
+ *     (módulo el número de colores) y la hormiga gira según la letra c-ésima.
+ *     La hormiga de esta práctica (blanca: izquierda, negra: derecha) es "LR"; "RL" es su imagen especular.
+ *     Letras: L (izquierda), R (derecha), N (sin giro), U (media vuelta).
+ *   - Tabla de turmite: "turmite S C t0 t1 ..." con S estados, C colores y S*C entradas
+ *     ordenadas por estado y luego color. Cada entrada es <color><giro><estado>, p. ej. "1R0".
+ */
+class Rule {
+public:
+    /// Giro relativo, en cuartos de vuelta en sentido horario
+    enum Turn { NONE = 0, RIGHT = 1, UTURN = 2, LEFT = 3 };
+
+    /// Número máximo de colores (el color de una celda cabe en un byte)
+    static constexpr unsigned kMaxColors = 256;
+
+    /// Resultado de aplicar la regla en un estado sobre un color
+    struct Transition {
+        std::uint8_t write; // color que se escribe
+        std::uint8_t turn;  // giro relativo (Turn)
+        std::uint8_t next;  // siguiente estado
+    };
+
+    /**
+     * @brief Construye la regla de la hormiga de Langton de esta práctica ("LR").
+     */
+    Rule();
+
+    /**
+     * @brief Construye una regla a partir de su texto (cadena de giros o tabla de turmite).
+     * @param text texto de la regla
+     * @return regla
+     * @throw std::invalid_argument si el texto no es válido
+     */
+    static Rule parse(const std::string& text);
+
+    /**
+     * @brief Número de estados de la regla.
+     */
+    unsigned states() const;
+
+    /**
+     * @brief Número de colores de la regla.
+     */
+    unsigned colors() const;
+
+    /**
+     * @brief Transición para el estado y color dados.
+     * @param state estado (< states())
+     * @param color color (< colors())
+     */
+    const Transition& at(unsigned state, unsigned color) const;
+
+    /**
+     * @brief Indica si es una cadena de giros (un estado y el color avanza en uno).
+     */
+    bool isTurnString() const;
+
+    /**
+     * @brief Indica si es la regla de la hormiga de Langton de esta práctica ("LR").
+     */
+    bool isLangton() const;
+
+    /**
+     * @brief Texto de la regla, en el mismo formato que acepta parse().
+     */
+    const std::string& text() const;
+
+    /**
+     * @brief Aplica un giro relativo a una orientación de Ant (LEFT, RIGHT, UP, DOWN).
+     * @param orient orientación actual (0..3)
+     * @param turn giro relativo (Turn)
+     * @return nueva orientación (0..3)
+     */
+    static unsigned rotate(unsigned orient, unsigned turn);
+
+private:
+    unsigned m_states;
+    unsigned m_colors;
+    std::vector<Transition> m_table; // m_states * m_colors entradas
+    std::string m_text;
+};
+
+namespace rule_detail {
+
+// Orientación resultante indexada por orientación * 4 + giro relativo.
+// Orientaciones en el orden de Ant: LEFT(0), RIGHT(1), UP(2), DOWN(3).
+constexpr std::uint8_t kRotate[16] = {
+    0, 2, 1, 3, // LEFT:  sin giro, dcha -> UP, media vuelta -> RIGHT, izq -> DOWN
+    1, 3, 0, 2, // RIGHT: sin giro, dcha -> DOWN, media vuelta -> LEFT, izq -> UP
+    2, 1, 3, 0, // UP:    sin giro, dcha -> RIGHT, media vuelta -> DOWN, izq -> LEFT
+    3, 0, 2, 1, // DOWN:  sin giro, dcha -> LEFT, media vuelta -> UP, izq -> RIGHT
+};
+
+// Giro relativo que lleva de una orientación a otra (la inversa de kRotate), indexado por
+// orientación anterior * 4 + orientación nueva.
+constexpr std::uint8_t kTurnBetween[16] = {
+    0, 2, 1, 3, // desde LEFT
+    2, 0, 3, 1, // desde RIGHT
+    3, 1, 0, 2, // desde UP
+    1, 3, 2, 0, // desde DOWN
+};
+
+constexpr std::uint8_t turnCode(char c)
+{
+    return c == 'R' ? Rule::RIGHT : c == 'L' ? Rule::LEFT : c == 'U' ? Rule::UTURN : Rule::NONE;
+}
+
+} // namespace rule_detail
+
+inline unsigned Rule::rotate(unsigned orient, unsigned turn)
+{
+    return rule_detail::kRotate[orient * 4 + turn];
+}
+
+// Objetos regla para el bucle de simulación de Simulator, que los recibe como parámetro
+// de plantilla. Todos ofrecen apply(state, orient, cell), que lee el color de la celda,
+// lo reescribe y actualiza estado y orientación. Las cadenas de giros ofrecen además
+// unapply(orient, cell), que lo deshace: el color anterior es c-1 y el giro, el inverso del
+// de ese color (ver Simulator::runBackwards).
+
+/**
+ * @brief Cadena de giros fijada en tiempo de compilación, p. ej. FixedTurnRule<'R','L','R'>.
+ *        El compilador conoce el número de colores y la tabla de giros.
+ */
+template <char... Turns>
+struct FixedTurnRule {
+    static constexpr unsigned kColors = sizeof...(Turns);
+    static constexpr std::uint8_t kTurns[kColors] = { rule_detail::turnCode(Turns)... };
+
+    void apply(unsigned& /*state*/, unsigned& orient, std::uint8_t& cell) const
+    {
+        unsigned c = cell;
+        cell = static_cast<std::uint8_t>(c + 1 == kColors ? 0 : c + 1);
+        orient = rule_detail::kRotate[orient * 4 + kTurns[c]];
+    }
+
+    void unapply(unsigned& orient, std::uint8_t& cell) const
+    {
+        unsigned c = cell == 0 ? kColors - 1 : cell - 1u;
+        cell = static_cast<std::uint8_t>(c);
+        orient = rule_detail::kRotate[orient * 4 + ((4 - kTurns[c]) & 3)];
+    }
+};
+
+template <char... Turns>
+constexpr std::uint8_t FixedTurnRule<Turns...>::kTurns[];
+
+/**
+ * @brief Cadena de giros leída en tiempo de ejecución (un solo estado).
+ */
+class TurnStringRule {
+public:
+    explicit TurnStringRule(const Rule& rule)
+        : m_colors(rule.colors()), m_turns(rule.colors())
+    {
+        for (unsigned c = 0; c < m_colors; ++c) {
+            m_turns[c] = rule.at(0, c).turn;
+        }
+    }
+
+    void apply(unsigned& /*state*/, unsigned& orient, std::uint8_t& cell) const
+    {
+        unsigned c = cell;
+        cell = static_cast<std::uint8_t>(c + 1 == m_colors ? 0 : c + 1);
+        orient = rule_detail::kRotate[orient * 4 + m_turns[c]];
+    }
+
+    void unapply(unsigned& orient, std::uint8_t& cell) const
+    {
+        unsigned c = cell == 0 ? m_colors - 1 : cell - 1u;
+        cell = static_cast<std::uint8_t>(c);
+        orient = rule_detail::kRotate[orient * 4 + ((4 - m_turns[c]) & 3)];
+    }
+
+private:
+    unsigned m_colors;
+    std::vector<std::uint8_t> m_turns;
+};
+
+/**
+ * @brief Tabla de turmite completa (varios estados) leída en tiempo de ejecución.
+ */
+class TurmiteRule {
+public:
+    explicit TurmiteRule(const Rule& rule)
+        : m_rule(rule)
+    {
+    }
+
+    void apply(unsigned& state, unsigned& orient, std::uint8_t& cell) const
+    {
+        const Rule::Transition& t = m_rule.at(state, cell);
+        cell = t.write;
+        orient = rule_detail::kRotate[orient * 4 + t.turn];
+        state = t.next;
+    }
+
+private:
+    const Rule& m_rule;
+};
+
+#endif
@@ -0,0 +1,327 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file SeedFile.cc
+ * @brief Implementación de SeedFile, lector del fichero de inicialización en texto proyectado en
+ *        memoria y repartido entre hilos.
+ */
+
+#include "SeedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// Tamaño mínimo de cada trozo, para no crear más tareas que las que compensan
+constexpr std::size_t kMinChunkBytes = 1u << 16;
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+}
+
+// Fin de la línea que empieza en p (el '\n' o end)
+inline const char* lineEnd(const char* p, const char* end)
+{
+    const void* eol = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+    return eol ? static_cast<const char*>(eol) : end;
+}
+
+// Lee un número sin signo en p y avanza p; false si no hay o no cabe en unsigned
+inline bool readNumber(const char*& p, const char* end, unsigned& value)
+{
+    std::from_chars_result r = std::from_chars(p, end, value);
+    if (r.ec != std::errc()) return false;
+    p = r.ptr;
+    return true;
+}
+
+// Lee una línea de celda "x y [color]" entre p y eol
+inline bool parseCell(const char* p, const char* eol, unsigned& x, unsigned& y, unsigned& color)
+{
+    if (!readNumber(p, eol, x) || p == eol || !isBlank(*p)) return false;
+    p = skipBlanks(p, eol);
+    if (!readNumber(p, eol, y)) return false;
+    color = 1;
+    const char* q = skipBlanks(p, eol);
+    if (q != eol && q != p) {
+        p = q;
+        if (!readNumber(p, eol, color)) return false;
+        q = skipBlanks(p, eol);
+    }
+    return q == eol;
+}
+
+// Lee una línea "ant x y orient"
+bool parseAnt(const std::string& line, SeedFile::ExtraAnt& ant)
+{
+    std::istringstream iss(line);
+    std::string word;
+    int orient;
+    if (!(iss >> word >> ant.x >> ant.y >> orient) || orient < 0 || orient > 3) {
+        return false;
+    }
+    ant.orient = static_cast<Ant::Orientation>(orient);
+    return true;
+}
+
+} // namespace
+
+/**
+* @brief Crea el error con el texto "Formato incorrecto en la línea N (detalle)".
+*/
+SeedFormatError::SeedFormatError(std::size_t line, const std::string& detail)
+    : std::runtime_error("Formato incorrecto en la línea " + std::to_string(line) + " " + detail),
+      m_line(line)
+{
+}
+
+std::size_t SeedFormatError::line() const
+{
+    return m_line;
+}
+
+/**
+* @brief Proyecta el fichero, lee la cabecera y reparte el resto en trozos.
+* @param filename nombre del fichero
+* @param threads hilos para leer las celdas (0 = núcleos de la máquina)
+*/
+SeedFile::SeedFile(const std::string& filename, unsigned threads)
+    : m_file(filename), m_threads(threads), m_sizeX(0), m_sizeY(0), m_antX(0), m_antY(0),
+      m_orient(Ant::LEFT), m_antState(0), m_ruleRead(false), m_bodyLine(1), m_headerAnts(0)
+{
+    if (m_threads == 0) {
+        m_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const char* p = m_file.data();
+    const char* end = p + m_file.size();
+
+    // Siguiente línea de la cabecera, como texto
+    std::size_t lineNumber = 0;
+    auto nextLine = [&](std::string& line) {
+        if (p >= end) return false;
+        const char* eol = lineEnd(p, end);
+        line.assign(p, eol);
+        p = (eol == end) ? end : eol + 1;
+        ++lineNumber;
+        return true;
+    };
+
+    // Línea 1: sizeX sizeY
+    std::string line;
+    {
+        std::istringstream iss(nextLine(line) ? line : std::string());
+        if (!(iss >> m_sizeX >> m_sizeY)) {
+            throw SeedFormatError(1, "(sizeX sizeY)");
+        }
+    }
+    // Línea 2: antX antY orient [estado]
+    {
+        std::istringstream iss(nextLine(line) ? line : std::string());
+        int orient = 0;
+        if (!(iss >> m_antX >> m_antY >> orient)) {
+            throw SeedFormatError(2, "(antX antY orient)");
+        }
+        if (orient < 0 || orient > 3) {
+            throw SeedFormatError(2, "(orient debe ser 0 al 3)");
+        }
+        m_orient = static_cast<Ant::Orientation>(orient);
+        if (!(iss >> m_antState)) {
+            m_antState = 0;
+        }
+    }
+
+    // Regla, hormigas adicionales y líneas vacías hasta la primera celda
+    while (p < end) {
+        const char* eol = lineEnd(p, end);
+        const char* q = skipBlanks(p, eol);
+        if (q != eol && !std::isalpha(static_cast<unsigned char>(*q))) {
+            break; // primera celda (o línea incorrecta, que se indica al leer las celdas)
+        }
+        nextLine(line);
+        std::istringstream iss(line);
+        std::string first;
+        if (!(iss >> first)) {
+            continue; // línea vacía
+        }
+        if (first == "ant") {
+            ExtraAnt ant;
+            if (!parseAnt(line, ant)) {
+                throw SeedFormatError(lineNumber, "(ant x y orient)");
+            }
+            m_extraAnts.push_back(ant);
+        } else {
+            if (m_ruleRead) {
+                throw SeedFormatError(lineNumber, "(regla): la regla ya estaba definida");
+            }
+            try {
+                m_rule = Rule::parse(line);
+            } catch (std::exception const& e) {
+                throw SeedFormatError(lineNumber, std::string("(regla): ") + e.what());
+            }
+            m_ruleRead = true;
+        }
+    }
+    m_headerAnts = m_extraAnts.size();
+    m_bodyLine = lineNumber + 1;
+
+    // Reparte las celdas en trozos de tamaño parecido que terminan en un salto de línea
+    const std::size_t bytes = static_cast<std::size_t>(end - p);
+    const std::size_t count = std::max<std::size_t>(1, std::min<std::size_t>(m_threads * 4u, bytes / kMinChunkBytes));
+    const char* begin = p;
+    for (std::size_t i = 1; i <= count && begin < end; ++i) {
+        const char* cut = (i == count) ? end : p + bytes / count * i;
+        if (cut <= begin) continue;
+        if (cut < end) {
+            const char* eol = lineEnd(cut - 1, end);
+            cut = (eol == end) ? end : eol + 1;
+        }
+        m_chunks.push_back(Chunk{ begin, cut, 0, 0, std::string(), {}, {} });
+        begin = cut;
+    }
+}
+
+unsigned SeedFile::sizeX() const
+{
+    return m_sizeX;
+}
+
+unsigned SeedFile::sizeY() const
+{
+    return m_sizeY;
+}
+
+unsigned SeedFile::antX() const
+{
+    return m_antX;
+}
+
+unsigned SeedFile::antY() const
+{
+    return m_antY;
+}
+
+Ant::Orientation SeedFile::orient() const
+{
+    return m_orient;
+}
+
+unsigned SeedFile::antState() const
+{
+    return m_antState;
+}
+
+const Rule& SeedFile::rule() const
+{
+    return m_rule;
+}
+
+std::size_t SeedFile::chunkCount() const
+{
+    return m_chunks.size();
+}
+
+const std::vector<SeedFile::ExtraAnt>& SeedFile::extraAnts() const
+{
+    return m_extraAnts;
+}
+
+const std::vector<SeedFile::ColoredCell>& SeedFile::coloredCells() const
+{
+    return m_colored;
+}
+
+/**
+* @brief Lee un trozo: entrega las celdas negras y guarda el resto. Se detiene en la primera
+*        línea incorrecta, que queda anotada en el trozo (no lanza excepciones desde los hilos).
+*/
+void SeedFile::readChunk(Chunk& chunk, std::size_t index,
+                         const std::function<void(std::size_t, unsigned, unsigned)>& black) const
+{
+    chunk.lines = 0;
+    chunk.errorLine = 0;
+    chunk.ants.clear();
+    chunk.colored.clear();
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+    while (p < end) {
+        ++chunk.lines;
+        const char* eol = lineEnd(p, end);
+        const char* q = skipBlanks(p, eol);
+        p = (eol == end) ? end : eol + 1;
+        if (q == eol) {
+            continue; // línea vacía
+        }
+        if (std::isdigit(static_cast<unsigned char>(*q))) {
+            unsigned x, y, color;
+            if (!parseCell(q, eol, x, y, color)) {
+                chunk.errorLine = chunk.lines;
+                chunk.error = "(x y [color])";
+                return;
+            }
+            if (color == 1) {
+                black(index, x, y);
+            } else {
+                chunk.colored.push_back({ x, y, color });
+            }
+        } else if (std::isalpha(static_cast<unsigned char>(*q))) {
+            std::string line(q, eol);
+            ExtraAnt ant;
+            if (line.compare(0, 3, "ant") == 0 && (line.size() == 3 || isBlank(line[3]))) {
+                if (!parseAnt(line, ant)) {
+                    chunk.errorLine = chunk.lines;
+                    chunk.error = "(ant x y orient)";
+                    return;
+                }
+                chunk.ants.push_back(ant);
+            } else {
+                chunk.errorLine = chunk.lines;
+                chunk.error = m_ruleRead ? "(regla): la regla ya estaba definida"
+                                         : "(regla): la regla debe ir antes de las celdas";
+                return;
+            }
+        } else {
+            chunk.errorLine = chunk.lines;
+            chunk.error = "(x y [color])";
+            return;
+        }
+    }
+}
+
+/**
+* @brief Lee las celdas en paralelo y comprueba después los errores en orden de línea.
+* @param black función que recibe el índice del trozo y las coordenadas de cada celda negra
+*/
+void SeedFile::readCells(const std::function<void(std::size_t, unsigned, unsigned)>& black)
+{
+    m_extraAnts.resize(m_headerAnts);
+    m_colored.clear();
+    if (m_chunks.size() == 1) {
+        readChunk(m_chunks[0], 0, black);
+    } else if (!m_chunks.empty()) {
+        ThreadPool pool(static_cast<unsigned>(std::min<std::size_t>(m_threads, m_chunks.size())));
+        pool.parallelFor(static_cast<unsigned>(m_chunks.size()),
+                         [&](unsigned i) { readChunk(m_chunks[i], i, black); });
+    }
+
+    // El número de la primera línea de cada trozo se conoce al sumar las de los anteriores
+    std::size_t line = m_bodyLine;
+    for (auto const& chunk : m_chunks) {
+        if (chunk.errorLine != 0) {
+            throw SeedFormatError(line + chunk.errorLine - 1, chunk.error);
+        }
+        line += chunk.lines;
+        m_extraAnts.insert(m_extraAnts.end(), chunk.ants.begin(), chunk.ants.end());
+        m_colored.insert(m_colored.end(), chunk.colored.begin(), chunk.colored.end());
+    }
+}
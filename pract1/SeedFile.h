@@ -0,0 +1,131 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file SeedFile.h
+ * @brief Definición de SeedFile, lector del fichero de inicialización en texto proyectado en
+ *        memoria y repartido entre hilos.
+ */
+
+#ifndef SEEDFILE_H
+#define SEEDFILE_H
+
+#include "Ant.h"
+#include "MappedFile.h"
+#include "Rule.h"
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Error de formato en una línea del fichero de inicialización.
+ */
+class SeedFormatError : public std::runtime_error {
+public:
+    /**
+     * @param line número de la línea (empezando en 1)
+     * @param detail explicación entre paréntesis, p. ej. "(x y [color])"
+     */
+    SeedFormatError(std::size_t line, const std::string& detail);
+
+    /**
+     * @brief Número de la línea incorrecta (empezando en 1).
+     */
+    std::size_t line() const;
+
+private:
+    std::size_t m_line;
+};
+
+/**
+ * @brief Fichero de inicialización en texto (ver main.cc) proyectado en memoria.
+ *
+ * La cabecera (tamaño, hormiga y regla) se lee al construirlo. Las líneas siguientes se parten
+ * en trozos que terminan en un salto de línea y se leen en paralelo con std::from_chars: cada
+ * celda negra se entrega a una función en el hilo que la lee, sin guardarla en ningún vector.
+ * La regla, si aparece, debe ir antes de la primera celda.
+ */
+class SeedFile {
+public:
+    /// Hormiga adicional de la colonia (líneas "ant x y orient")
+    struct ExtraAnt {
+        unsigned x;
+        unsigned y;
+        Ant::Orientation orient;
+    };
+
+    /// Celda de un color distinto de 1 (líneas "x y color")
+    struct ColoredCell {
+        unsigned x;
+        unsigned y;
+        unsigned color;
+    };
+
+    /**
+     * @brief Proyecta el fichero y lee la cabecera.
+     * @param filename nombre del fichero
+     * @param threads hilos para leer las celdas (0 = núcleos de la máquina)
+     * @throw std::runtime_error si no se puede abrir
+     * @throw SeedFormatError si la cabecera no es válida
+     */
+    explicit SeedFile(const std::string& filename, unsigned threads = 0);
+
+    unsigned sizeX() const;
+    unsigned sizeY() const;
+    unsigned antX() const;
+    unsigned antY() const;
+    Ant::Orientation orient() const;
+    unsigned antState() const;
+    const Rule& rule() const;
+
+    /**
+     * @brief Número de trozos en que se reparten las celdas (ver readCells).
+     */
+    std::size_t chunkCount() const;
+
+    /**
+     * @brief Lee las celdas en paralelo. Para cada celda negra ("x y" o "x y 1") llama a
+     *        black(trozo, x, y) desde el hilo que lee ese trozo, así que black puede llamarse
+     *        desde varios hilos a la vez. Las hormigas adicionales y las celdas de otros colores
+     *        se guardan, en el orden del fichero, en extraAnts y coloredCells.
+     * @param black función que recibe el índice del trozo y las coordenadas
+     * @throw SeedFormatError con la primera línea incorrecta del fichero
+     */
+    void readCells(const std::function<void(std::size_t, unsigned, unsigned)>& black);
+
+    const std::vector<ExtraAnt>& extraAnts() const;
+    const std::vector<ColoredCell>& coloredCells() const;
+
+private:
+    // Resultado de leer un trozo; los números de línea son relativos al trozo
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::size_t lines;      // líneas leídas (todas si no hay error)
+        std::size_t errorLine;  // 0 si no hay error
+        std::string error;      // explicación del error (ver SeedFormatError)
+        std::vector<ExtraAnt> ants;
+        std::vector<ColoredCell> colored;
+    };
+
+    MappedFile m_file;
+    unsigned m_threads;
+    unsigned m_sizeX;
+    unsigned m_sizeY;
+    unsigned m_antX;
+    unsigned m_antY;
+    Ant::Orientation m_orient;
+    unsigned m_antState;
+    Rule m_rule;
+    bool m_ruleRead;
+    std::size_t m_bodyLine;  // número de la primera línea de las celdas
+    std::vector<Chunk> m_chunks;
+    std::vector<ExtraAnt> m_extraAnts;  // primero las de la cabecera
+    std::size_t m_headerAnts;
+    std::vector<ColoredCell> m_colored;
+
+    void readChunk(Chunk& chunk, std::size_t index,
+                   const std::function<void(std::size_t, unsigned, unsigned)>& black) const;
+};
+
+#endif
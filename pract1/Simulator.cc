@@ -5,10 +5,27 @@
  */
 
 #include "Simulator.h"
+#include "FrameRecorder.h"
+#include "MacroStep.h"
+#include "MappedFile.h"
+#include "SeedFile.h"
+#include "Snapshot.h"
+#include "StepTrace.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <random>
 #include <sstream>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 #include <chrono>
 
 /**
@@ -20,80 +37,2072 @@
 * @param orient orientación inicial de la hormiga
 */
 Simulator::Simulator(unsigned sizeX, unsigned sizeY,
-                     unsigned antX, unsigned antY, Ant::Orientation orient)
-    // Inicializa la cinta y la hormiga con los parámetros dados, y el contador de pasos a 0
-    : m_tape(sizeX, sizeY), m_ant(antX, antY, orient), m_stepCount(0)
+                     unsigned antX, unsigned antY, Ant::Orientation orient,
+                     Mode mode, const Rule& rule)
+    // Inicializa la cinta y la hormiga con los parámetros dados, y el contador de pasos a 0.
+    // Solo se reserva a tamaño completo la cinta que se va a usar; las demás ocupan una celda.
+    : m_mode(mode), m_rule(rule), m_multicolor(!rule.isLangton()),
+      m_tape(mode == INFINITE || m_multicolor ? 1 : sizeX, mode == INFINITE || m_multicolor ? 1 : sizeY),
+      m_colors(m_multicolor ? sizeX : 1, m_multicolor ? sizeY : 1),
+      m_ants{Ant(antX, antY, orient)}, m_state(0), m_viewX(sizeX), m_viewY(sizeY), m_viewScale(1),
+      m_viewCrop(false), m_stepCount(0),
+      m_accelerate(false), m_trackHighway(false), m_highwayPhase(0), m_trackedPeriod(0),
+      m_highwayOnset(0), m_stats(), m_startX(antX), m_startY(antY), m_blackStale(true), m_blackBase(0),
+      m_visitWidth(0), m_order(SEQUENTIAL), m_engine(STEPPER),
+      m_quiet(false), m_borderReached(false),
+      m_telemetry(std::make_shared<TelemetryCounters>()), m_publishedAt(0),
+      m_cancel(std::make_shared<std::atomic<bool>>(false)), m_trace(nullptr)
 {
+    resetStatistics();
+    if (sizeX == 0 || sizeY == 0) {
+        throw std::invalid_argument("El tamaño de la cinta debe ser mayor que 0");
+    }
+    if (m_multicolor && m_mode == INFINITE) {
+        throw std::invalid_argument("Error Simulador: las reglas multicolor solo admiten la cinta con bordes.");
+    }
+    if (m_multicolor) {
+        if (!m_colors.isInside(antX, antY)) {
+            throw std::invalid_argument("Error Simulador: Posición inicial de la hormiga fuera de los límites de la cinta.");
+        }
+        return;
+    }
     // Verifica que la posición inicial de la hormiga esté dentro de los límites de la cinta
-    if (!m_tape.isInside(static_cast<int>(antX), static_cast<int>(antY))) {
+    if (m_mode == BOUNDED && !m_tape.isInside(antX, antY)) {
+        throw std::invalid_argument("Error Simulador: Posición inicial de la hormiga fuera de los límites de la cinta.");
+    }
+}
+
+/**
+* @brief Crea un simulador sin hormigas sobre una cinta ya construida (ver loadSnapshot).
+*/
+Simulator::Simulator(Mode mode, const Rule& rule, unsigned viewX, unsigned viewY, Tape&& tape)
+    : m_mode(mode), m_rule(rule), m_multicolor(!rule.isLangton()), m_tape(std::move(tape)),
+      m_colors(1, 1), m_state(0), m_viewX(viewX), m_viewY(viewY), m_viewScale(1),
+      m_viewCrop(false), m_stepCount(0),
+      m_accelerate(false), m_trackHighway(false), m_highwayPhase(0), m_trackedPeriod(0),
+      m_highwayOnset(0), m_stats(), m_startX(0), m_startY(0), m_blackStale(true), m_blackBase(0),
+      m_visitWidth(0), m_order(SEQUENTIAL), m_engine(STEPPER),
+      m_quiet(false), m_borderReached(false),
+      m_telemetry(std::make_shared<TelemetryCounters>()), m_publishedAt(0),
+      m_cancel(std::make_shared<std::atomic<bool>>(false)), m_trace(nullptr)
+{
+    resetStatistics();
+    if (viewX == 0 || viewY == 0) {
+        throw std::invalid_argument("El tamaño de la cinta debe ser mayor que 0");
+    }
+}
+
+/**
+* @brief Vuelve al estado inicial con otro tamaño, hormiga y regla, reutilizando la cinta.
+* @param sizeX ancho
+* @param sizeY alto
+* @param antX pos X inicial de la hormiga
+* @param antY pos Y inicial de la hormiga
+* @param orient orientación inicial de la hormiga
+* @param rule regla de la hormiga
+*/
+void Simulator::reset(unsigned sizeX, unsigned sizeY, unsigned antX, unsigned antY, Ant::Orientation orient,
+                      const Rule& rule)
+{
+    const bool multicolor = !rule.isLangton();
+    if (sizeX == 0 || sizeY == 0) {
+        throw std::invalid_argument("El tamaño de la cinta debe ser mayor que 0");
+    }
+    if (multicolor && m_mode == INFINITE) {
+        throw std::invalid_argument("Error Simulador: las reglas multicolor solo admiten la cinta con bordes.");
+    }
+    if ((multicolor || m_mode == BOUNDED) && (antX >= sizeX || antY >= sizeY)) {
+        throw std::invalid_argument("Error Simulador: Posición inicial de la hormiga fuera de los límites de la cinta.");
+    }
+    m_rule = rule;
+    m_multicolor = multicolor;
+    // Solo se cambia la cinta que se va a usar; las demás conservan su memoria
+    if (m_multicolor) {
+        m_colors.reset(sizeX, sizeY);
+    } else if (m_mode == INFINITE) {
+        m_sparse.clear();
+    } else {
+        m_tape.reset(sizeX, sizeY);
+    }
+    m_trails.clear();
+    m_ants.assign(1, Ant(antX, antY, orient));
+    m_state = 0;
+    if (!m_viewCrop) {
+        m_viewX = sizeX;
+        m_viewY = sizeY;
+    }
+    m_stepCount = 0;
+    m_highway.reset();
+    m_highwayPhase = 0;
+    m_trackedPeriod = 0;
+    m_highwayOnset = 0;
+    m_quad.reset();
+    m_pyramid.invalidate();
+    m_borderReached = false;
+    m_telemetry->borderReached.store(false, std::memory_order_relaxed);
+    publishProgress();
+    if (!m_visits.empty()) {
+        m_visitWidth = sizeX;
+        m_visits.resize(static_cast<std::size_t>(sizeX) * sizeY);
+    }
+    resetStatistics();
+}
+
+/**
+* @brief Vuelve a empezar las estadísticas desde la posición actual de la hormiga principal.
+*        Las celdas no blancas se vuelven a contar en la siguiente lectura.
+*/
+void Simulator::resetStatistics()
+{
+    m_stats = StatCounters{ 0, { 0, 0, 0, 0 }, INT64_MAX, INT64_MAX, INT64_MIN, INT64_MIN };
+    m_startX = m_ants.empty() ? 0 : m_ants[0].posX();
+    m_startY = m_ants.empty() ? 0 : m_ants[0].posY();
+    m_blackStale = true;
+    std::fill(m_visits.begin(), m_visits.end(), 0);
+}
+
+/**
+* @brief Anota en las estadísticas un paso dado desde (x,y).
+* @param turn giro (Rule::Turn)
+* @param blackDelta variación del número de celdas no blancas (-1, 0 o 1)
+*/
+inline void Simulator::countStep(std::int64_t x, std::int64_t y, unsigned turn, int blackDelta)
+{
+    m_stats.blackDelta += blackDelta;
+    ++m_stats.turns[turn];
+    m_stats.touch(x, y);
+    if (!m_visits.empty()) {
+        ++m_visits[static_cast<std::size_t>(y) * m_visitWidth + static_cast<std::size_t>(x)];
+    }
+}
+
+/**
+* @brief Anota un paso de la regla de Langton: blanca gira a la izquierda y se vuelve negra;
+*        negra gira a la derecha y se vuelve blanca.
+*/
+inline void Simulator::countLangtonStep(std::int64_t x, std::int64_t y, bool wasBlack)
+{
+    countStep(x, y, wasBlack ? Rule::RIGHT : Rule::LEFT, wasBlack ? -1 : 1);
+}
+
+/**
+* @brief Estadísticas de la hormiga principal, mantenidas paso a paso.
+*/
+Simulator::Statistics Simulator::statistics() const
+{
+    if (!kStatistics) {
+        throw std::logic_error("Error Simulador: las estadísticas requieren compilar con LANGTON_STATS (make STATS=1)");
+    }
+    if (m_blackStale) {
+        m_blackBase = static_cast<std::int64_t>(blackCount()) - m_stats.blackDelta;
+        m_blackStale = false;
+    }
+    Statistics s;
+    s.blackCells = static_cast<std::uint64_t>(m_blackBase + m_stats.blackDelta);
+    std::copy(m_stats.turns, m_stats.turns + 4, s.turns);
+    s.touched = m_stats.minX <= m_stats.maxX;
+    s.minX = s.touched ? m_stats.minX : 0;
+    s.minY = s.touched ? m_stats.minY : 0;
+    s.maxX = s.touched ? m_stats.maxX : 0;
+    s.maxY = s.touched ? m_stats.maxY : 0;
+    s.dx = m_ants[0].posX() - m_startX;
+    s.dy = m_ants[0].posY() - m_startY;
+    s.distance = std::sqrt(static_cast<double>(s.dx) * s.dx + static_cast<double>(s.dy) * s.dy);
+    return s;
+}
+
+/**
+* @brief Activa el recuento de visitas por celda de la cinta con bordes.
+* @param enabled true para activarlo
+*/
+void Simulator::setVisitCounting(bool enabled)
+{
+    if (!kStatistics) {
+        throw std::logic_error("Error Simulador: las estadísticas requieren compilar con LANGTON_STATS (make STATS=1)");
+    }
+    if (!enabled) {
+        m_visits = std::vector<std::uint32_t>();
+        m_visitWidth = 0;
+        return;
+    }
+    if (m_mode == INFINITE) {
+        throw std::logic_error("Error Simulador: las visitas por celda solo se cuentan en la cinta con bordes");
+    }
+    m_visitWidth = m_multicolor ? m_colors.width() : m_tape.width();
+    const unsigned height = m_multicolor ? m_colors.height() : m_tape.height();
+    m_visits.assign(static_cast<std::size_t>(m_visitWidth) * height, 0);
+}
+
+/**
+* @brief Número de pasos dados desde la celda (x,y) (0 si no se cuentan las visitas).
+*/
+std::uint32_t Simulator::visits(unsigned x, unsigned y) const
+{
+    const std::size_t i = static_cast<std::size_t>(y) * m_visitWidth + x;
+    return (x < m_visitWidth && i < m_visits.size()) ? m_visits[i] : 0;
+}
+
+/**
+* @brief Rellena la cinta al azar: cada celda es no blanca con probabilidad 'density'.
+* @param density proporción de celdas no blancas (0 a 1)
+* @param seed semilla del generador
+*/
+void Simulator::randomize(double density, std::uint64_t seed)
+{
+    if (!(density >= 0.0 && density <= 1.0)) {
+        throw std::invalid_argument("Error Simulador: la densidad debe estar entre 0 y 1");
+    }
+    materializeTrails();
+    m_highway.reset();
+    m_trackedPeriod = 0;
+    m_quad.reset();
+    m_pyramid.invalidate();
+    m_blackStale = true;
+    std::mt19937_64 rng(seed);
+    // Una celda es no blanca si rng() < threshold (2^64 * density)
+    const std::uint64_t threshold = density >= 1.0 ? UINT64_MAX
+                                                   : static_cast<std::uint64_t>(density * 18446744073709551616.0);
+    if (m_multicolor) {
+        const unsigned colors = m_rule.colors();
+        std::uint8_t* cells = m_colors.data();
+        const std::size_t count = static_cast<std::size_t>(m_colors.width()) * m_colors.height();
+        for (std::size_t i = 0; i < count; ++i) {
+            cells[i] = rng() < threshold ? static_cast<std::uint8_t>(1 + rng() % (colors - 1)) : 0;
+        }
+    } else if (m_mode == INFINITE) {
+        m_sparse.clear();
+        for (unsigned y = 0; y < m_viewY; ++y) {
+            for (unsigned x = 0; x < m_viewX; ++x) {
+                if (rng() < threshold) m_sparse.set(x, y, true);
+            }
+        }
+    } else {
+        // Palabra a palabra: los bits que sobran al final de cada fila quedan a 0
+        const unsigned width = m_tape.width();
+        const std::size_t stride = m_tape.stride();
+        std::vector<std::uint64_t> row(stride);
+        for (unsigned y = 0; y < m_tape.height(); ++y) {
+            for (std::size_t w = 0; w < stride; ++w) {
+                const unsigned bits = std::min(64u, width - static_cast<unsigned>(w * 64));
+                std::uint64_t word = 0;
+                for (unsigned b = 0; b < bits; ++b) {
+                    word |= static_cast<std::uint64_t>(rng() < threshold) << b;
+                }
+                row[w] = word;
+            }
+            m_tape.writeRow(y, row.data());
+        }
+    }
+}
+
+/**
+* @brief Número de celdas no blancas de la cinta.
+*/
+std::uint64_t Simulator::blackCount() const
+{
+    if (m_multicolor) {
+        const std::uint8_t* cells = m_colors.data();
+        const std::size_t count = static_cast<std::size_t>(m_colors.width()) * m_colors.height();
+        return count - static_cast<std::uint64_t>(std::count(cells, cells + count, 0));
+    }
+    if (m_mode == INFINITE) {
+        materializeTrails();
+        return m_sparse.blackCells().size();
+    }
+    return m_tape.countBlack(0, 0, m_tape.width(), m_tape.height());
+}
+
+/**
+* @brief Inicializa celdas negras desde una lista de coordenadas.
+* @param blacks vector de pares (x,y)
+*/
+void Simulator::initializeBlacks(const std::vector<std::pair<unsigned, unsigned>>& blacks)
+{
+    // Cambiar la cinta invalida la autopista detectada
+    materializeTrails();
+    m_highway.reset();
+    m_trackedPeriod = 0;
+    m_quad.reset();
+    m_pyramid.invalidate();
+    m_blackStale = true;
+    // Inicializa las celdas negras en la cinta según las coordenadas dadas
+    for (auto const & p : blacks) {
+        unsigned x = p.first;
+        unsigned y = p.second;
+        if (m_multicolor) {
+            if (m_colors.isInside(x, y)) {
+                m_colors.set(x, y, 1);
+            }
+        } else if (m_mode == INFINITE) {
+            m_sparse.set(x, y, true);
+        // Verifica que la coordenada esté dentro de la cinta antes de ponerla negra
+        } else if (m_tape.isInside(x, y)) {
+            m_tape.set(x, y, true);
+        }
+    }
+}
+
+/**
+* @brief Fija el color de una celda.
+* @param x coordenada X
+* @param y coordenada Y
+* @param color color (menor que el número de colores de la regla)
+*/
+void Simulator::setCell(unsigned x, unsigned y, unsigned color)
+{
+    if (color >= m_rule.colors()) {
+        throw std::invalid_argument("Error Simulador: color " + std::to_string(color) +
+                                    " no válido para la regla " + m_rule.text());
+    }
+    materializeTrails();
+    m_highway.reset();
+    m_trackedPeriod = 0;
+    m_quad.reset();
+    m_pyramid.invalidate();
+    m_blackStale = true;
+    if (m_multicolor) {
+        m_colors.set(x, y, color);
+    } else if (m_mode == INFINITE) {
+        m_sparse.set(x, y, color != 0);
+    } else {
+        m_tape.set(x, y, color != 0);
+    }
+}
+
+/**
+* @brief Fija el estado interno del turmite.
+* @param state estado (menor que el número de estados de la regla)
+*/
+void Simulator::setTurmiteState(unsigned state)
+{
+    if (state >= m_rule.states()) {
+        throw std::invalid_argument("Error Simulador: estado de turmite no válido");
+    }
+    m_state = state;
+}
+
+/**
+* @brief Regla que sigue la hormiga.
+*/
+const Rule& Simulator::rule() const
+{
+    return m_rule;
+}
+
+namespace {
+
+// Carácter de un bloque con 'black' celdas negras de 'total' al mostrar la cinta reducida
+inline char densityChar(std::uint64_t black, std::uint64_t total)
+{
+    static const char kRamp[] = " .:oX";
+    if (black == 0) return ' ';
+    if (black >= total) return 'X';
+    return kRamp[1 + black * 3 / total];
+}
+
+} // namespace
+
+/**
+* @brief Muestra solo una ventana centrada en la hormiga principal, opcionalmente reducida.
+* @param width ancho de la ventana en caracteres (0 = cinta completa)
+* @param height alto de la ventana en caracteres (0 = cinta completa)
+* @param scale lado del bloque de celdas que representa cada carácter
+*/
+void Simulator::setViewport(unsigned width, unsigned height, unsigned scale)
+{
+    if (scale == 0) {
+        throw std::invalid_argument("Error Simulador: la escala de la ventana debe ser mayor que 0");
+    }
+    m_viewScale = scale;
+    m_viewCrop = width != 0 && height != 0;
+    if (m_viewCrop) {
+        m_viewX = width;
+        m_viewY = height;
+    }
+}
+
+/**
+* @brief Escribe en out los caracteres de una fila de la ventana: 'cols' bloques de
+*        m_viewScale x m_viewScale celdas a partir de (x0,y). En modo BOUNDED los bloques del
+*        final se recortan al borde de la cinta.
+*/
+void Simulator::renderLine(std::int64_t x0, std::int64_t y, std::int64_t cols, char* out) const
+{
+    const std::int64_t k = m_viewScale;
+    if (k == 1) {
+        if (m_mode == INFINITE) {
+            m_sparse.renderRow(y, x0, static_cast<std::size_t>(cols), out);
+        } else if (m_multicolor) {
+            const std::uint8_t* row = m_colors.data() + y * m_colors.width() + x0;
+            for (std::int64_t i = 0; i < cols; ++i) {
+                out[i] = ColorTape::colorChar(row[i]);
+            }
+        } else {
+            m_tape.renderRow(static_cast<unsigned>(y), static_cast<unsigned>(x0), static_cast<unsigned>(cols), out);
+        }
+        return;
+    }
+
+    const std::int64_t tapeW = m_multicolor ? m_colors.width() : m_tape.width();
+    const std::int64_t tapeH = m_multicolor ? m_colors.height() : m_tape.height();
+    std::vector<std::uint32_t> histogram(m_multicolor ? m_rule.colors() : 0);
+    for (std::int64_t c = 0; c < cols; ++c) {
+        std::int64_t bx = x0 + c * k;
+        if (m_mode == INFINITE) {
+            out[c] = densityChar(m_sparse.countBlack(bx, y, k, k), static_cast<std::uint64_t>(k * k));
+            continue;
+        }
+        std::int64_t bw = std::min(k, tapeW - bx);
+        std::int64_t bh = std::min(k, tapeH - y);
+        if (!m_multicolor) {
+            // Los bloques de 64x64 o más salen de la pirámide de recuentos
+            out[c] = densityChar(regionCount(bx, y, bw, bh), static_cast<std::uint64_t>(bw * bh));
+            continue;
+        }
+        // Multicolor: el color más frecuente del bloque
+        std::fill(histogram.begin(), histogram.end(), 0);
+        for (std::int64_t yy = y; yy < y + bh; ++yy) {
+            const std::uint8_t* row = m_colors.data() + yy * tapeW + bx;
+            for (std::int64_t i = 0; i < bw; ++i) {
+                ++histogram[row[i]];
+            }
+        }
+        auto best = std::max_element(histogram.begin(), histogram.end());
+        out[c] = ColorTape::colorChar(static_cast<unsigned>(best - histogram.begin()));
+    }
+}
+
+namespace {
+
+// Recorta el rectángulo [x0, x0+w) x [y0, y0+h) a una cinta width x height; false si queda vacío
+bool clipRegion(std::int64_t& x0, std::int64_t& y0, std::int64_t& w, std::int64_t& h, std::int64_t width,
+                std::int64_t height)
+{
+    const std::int64_t x1 = std::min(x0 + w, width);
+    const std::int64_t y1 = std::min(y0 + h, height);
+    x0 = std::max<std::int64_t>(x0, 0);
+    y0 = std::max<std::int64_t>(y0, 0);
+    w = x1 - x0;
+    h = y1 - y0;
+    return w > 0 && h > 0;
+}
+
+} // namespace
+
+/**
+* @brief Número de celdas no blancas de un rectángulo.
+* @param x0 primera columna
+* @param y0 primera fila
+* @param w ancho
+* @param h alto
+* @return número de celdas no blancas
+*/
+std::uint64_t Simulator::regionCount(std::int64_t x0, std::int64_t y0, std::int64_t w, std::int64_t h) const
+{
+    if (w <= 0 || h <= 0) {
+        return 0;
+    }
+    if (m_mode == INFINITE) {
+        materializeTrails();
+        return m_sparse.countBlack(x0, y0, w, h);
+    }
+    if (m_multicolor) {
+        if (!clipRegion(x0, y0, w, h, m_colors.width(), m_colors.height())) {
+            return 0;
+        }
+        std::uint64_t count = 0;
+        for (std::int64_t y = y0; y < y0 + h; ++y) {
+            const std::uint8_t* row = m_colors.data() + y * m_colors.width() + x0;
+            count += static_cast<std::uint64_t>(w - std::count(row, row + w, 0));
+        }
+        return count;
+    }
+    if (!clipRegion(x0, y0, w, h, m_tape.width(), m_tape.height())) {
+        return 0;
+    }
+    // Sin ninguna baldosa entera la pirámide no ahorra nada: se cuenta en la cinta
+    if (w < TilePyramid::kTileSize || h < TilePyramid::kTileSize) {
+        return m_tape.countBlack(static_cast<unsigned>(x0), static_cast<unsigned>(y0), static_cast<unsigned>(w),
+                                 static_cast<unsigned>(h));
+    }
+    m_pyramid.refresh(m_tape);
+    return m_pyramid.count(m_tape, static_cast<unsigned>(x0), static_cast<unsigned>(y0), static_cast<unsigned>(w),
+                           static_cast<unsigned>(h));
+}
+
+/**
+* @brief Celdas no blancas de un rectángulo, por filas.
+* @param x0 primera columna
+* @param y0 primera fila
+* @param w ancho
+* @param h alto
+* @return celdas con su color
+*/
+std::vector<Simulator::RegionCell> Simulator::regionCells(std::int64_t x0, std::int64_t y0, std::int64_t w,
+                                                          std::int64_t h) const
+{
+    std::vector<RegionCell> cells;
+    if (w <= 0 || h <= 0) {
+        return cells;
+    }
+    if (m_mode == INFINITE) {
+        materializeTrails();
+    } else if (!clipRegion(x0, y0, w, h, m_multicolor ? m_colors.width() : m_tape.width(),
+                           m_multicolor ? m_colors.height() : m_tape.height())) {
+        return cells;
+    }
+    // Por franjas de baldosas: en cada una se buscan los trozos de baldosa con alguna celda no
+    // blanca y solo esos se recorren, fila a fila
+    const std::int64_t tile = TilePyramid::kTileSize;
+    std::vector<std::pair<std::int64_t, std::int64_t>> spans; // columnas [desde, hasta) ocupadas
+    for (std::int64_t ty = y0 & ~(tile - 1); ty < y0 + h; ty += tile) {
+        const std::int64_t rowFrom = std::max(ty, y0);
+        const std::int64_t rowTo = std::min(ty + tile, y0 + h);
+        spans.clear();
+        for (std::int64_t tx = x0 & ~(tile - 1); tx < x0 + w; tx += tile) {
+            const std::int64_t colFrom = std::max(tx, x0);
+            const std::int64_t colTo = std::min(tx + tile, x0 + w);
+            if (regionCount(colFrom, rowFrom, colTo - colFrom, rowTo - rowFrom) == 0) continue;
+            if (!spans.empty() && spans.back().second == colFrom) {
+                spans.back().second = colTo;
+            } else {
+                spans.emplace_back(colFrom, colTo);
+            }
+        }
+        for (std::int64_t y = rowFrom; y < rowTo; ++y) {
+            for (auto const& span : spans) {
+                for (std::int64_t x = span.first; x < span.second; ++x) {
+                    const unsigned color = colorAt(x, y);
+                    if (color != 0) cells.push_back(RegionCell{ x, y, color });
+                }
+            }
+        }
+    }
+    return cells;
+}
+
+/**
+* @brief Mapa de densidad de bloques de zoom x zoom celdas.
+* @param x0 primera columna del primer bloque
+* @param y0 primera fila del primer bloque
+* @param cols bloques por fila
+* @param rows filas de bloques
+* @param zoom lado de cada bloque en celdas
+* @return celdas no blancas de cada bloque, fila a fila
+*/
+std::vector<std::uint64_t> Simulator::densityMap(std::int64_t x0, std::int64_t y0, unsigned cols, unsigned rows,
+                                                 unsigned zoom) const
+{
+    if (zoom == 0) {
+        throw std::invalid_argument("Error Simulador: el zoom del mapa de densidad debe ser mayor que 0");
+    }
+    std::vector<std::uint64_t> map(static_cast<std::size_t>(cols) * rows, 0);
+    const std::int64_t k = zoom;
+    // Nivel de la pirámide cuyos bloques son justo los del mapa (si lo hay)
+    unsigned level = 0;
+    while ((TilePyramid::kTileSize << level) < zoom && level < 31) ++level;
+    const bool aligned = m_mode == BOUNDED && !m_multicolor && (TilePyramid::kTileSize << level) == zoom &&
+                         x0 % k == 0 && y0 % k == 0;
+    if (aligned) {
+        m_pyramid.refresh(m_tape);
+    }
+    if (aligned && level < m_pyramid.levels()) {
+        const std::int64_t bx0 = x0 / k;
+        const std::int64_t by0 = y0 / k;
+        const std::int64_t levelW = m_pyramid.levelWidth(level);
+        const std::int64_t levelH = m_pyramid.levelHeight(level);
+        for (unsigned r = 0; r < rows; ++r) {
+            const std::int64_t by = by0 + r;
+            if (by < 0 || by >= levelH) continue;
+            for (unsigned c = 0; c < cols; ++c) {
+                const std::int64_t bx = bx0 + c;
+                if (bx < 0 || bx >= levelW) continue;
+                map[static_cast<std::size_t>(r) * cols + c] = m_pyramid.at(level, static_cast<unsigned>(bx),
+                                                                            static_cast<unsigned>(by));
+            }
+        }
+        return map;
+    }
+    for (unsigned r = 0; r < rows; ++r) {
+        for (unsigned c = 0; c < cols; ++c) {
+            map[static_cast<std::size_t>(r) * cols + c] = regionCount(x0 + c * k, y0 + r * k, k, k);
+        }
+    }
+    return map;
+}
+
+/**
+* @brief Colores de las celdas alrededor de la hormiga principal.
+* @param radius distancia en celdas desde la hormiga
+* @return (2 * radius + 1)^2 colores, fila a fila
+*/
+std::vector<std::uint8_t> Simulator::neighbourhood(unsigned radius) const
+{
+    if (m_mode == INFINITE) {
+        materializeTrails();
+    }
+    const std::int64_t r = radius;
+    const std::int64_t side = 2 * r + 1;
+    const std::int64_t ax = m_ants[0].posX();
+    const std::int64_t ay = m_ants[0].posY();
+    std::vector<std::uint8_t> cells(static_cast<std::size_t>(side * side));
+    for (std::int64_t dy = -r; dy <= r; ++dy) {
+        for (std::int64_t dx = -r; dx <= r; ++dx) {
+            cells[static_cast<std::size_t>((dy + r) * side + dx + r)] = static_cast<std::uint8_t>(colorAt(ax + dx, ay + dy));
+        }
+    }
+    return cells;
+}
+
+/**
+* @brief Color de la celda (x,y), 0 fuera de la cinta con bordes.
+*/
+unsigned Simulator::colorAt(std::int64_t x, std::int64_t y) const
+{
+    if (m_mode == INFINITE) {
+        return m_sparse.get(x, y) ? 1 : 0;
+    }
+    if (m_multicolor) {
+        return m_colors.isInside(x, y) ? m_colors.get(static_cast<unsigned>(x), static_cast<unsigned>(y)) : 0;
+    }
+    return m_tape.isInside(x, y) ? m_tape.getUnchecked(static_cast<unsigned>(x), static_cast<unsigned>(y)) : 0;
+}
+
+/**
+* @brief Muestra la cinta con la hormiga en su posición actual.
+*/
+void Simulator::display() const
+{
+    render(std::cout);
+}
+
+/**
+* @brief Escribe en un flujo el fotograma que muestra display.
+*        El fotograma se compone en un buffer reutilizado y se escribe de una sola vez.
+* @param os flujo de salida
+*/
+void Simulator::render(std::ostream& os) const
+{
+    materializeTrails();
+    const std::int64_t k = m_viewScale;
+    const std::int64_t tapeW = m_multicolor ? m_colors.width() : m_tape.width();
+    const std::int64_t tapeH = m_multicolor ? m_colors.height() : m_tape.height();
+
+    // Ventana a mostrar, en caracteres (cols x rows) y en celdas (desde x0,y0): la cinta
+    // completa, o una ventana centrada en la hormiga principal (siempre en modo INFINITE)
+    std::int64_t cols = (tapeW + k - 1) / k;
+    std::int64_t rows = (tapeH + k - 1) / k;
+    std::int64_t x0 = 0, y0 = 0;
+    if (m_mode == INFINITE || m_viewCrop) {
+        x0 = m_ants[0].posX() - static_cast<std::int64_t>(m_viewX) * k / 2;
+        y0 = m_ants[0].posY() - static_cast<std::int64_t>(m_viewY) * k / 2;
+        if (m_mode == INFINITE) {
+            cols = m_viewX;
+            rows = m_viewY;
+        } else {
+            // Dentro de la cinta con bordes la ventana no sobresale de ella
+            cols = std::min<std::int64_t>(cols, m_viewX);
+            rows = std::min<std::int64_t>(rows, m_viewY);
+            x0 = std::max<std::int64_t>(0, std::min(x0, tapeW - cols * k));
+            y0 = std::max<std::int64_t>(0, std::min(y0, tapeH - rows * k));
+        }
+    }
+
+    // Compone las filas directamente desde la cinta
+    const std::size_t lineLength = static_cast<std::size_t>(cols) + 1;
+    m_frame.resize(lineLength * static_cast<std::size_t>(rows));
+    for (std::int64_t r = 0; r < rows; ++r) {
+        char* out = &m_frame[static_cast<std::size_t>(r) * lineLength];
+        renderLine(x0, y0 + r * k, cols, out);
+        out[cols] = '\n';
+    }
+
+    // Sobreescribe las celdas donde hay hormigas (si varias coinciden se ve la última)
+    for (auto const& ant : m_ants) {
+        std::int64_t ax = (ant.posX() - x0);
+        std::int64_t ay = (ant.posY() - y0);
+        if (ax >= 0 && ay >= 0 && ax < cols * k && ay < rows * k) {
+            m_frame[static_cast<std::size_t>(ay / k) * lineLength + static_cast<std::size_t>(ax / k)] = ant.symbol();
+        }
+    }
+    os.write(m_frame.data(), static_cast<std::streamsize>(m_frame.size()));
+
+    // Muestra el número de paso actual
+    if (m_mode == INFINITE) {
+        os << "Step: " << m_stepCount << "  Ant: (" << m_ants[0].posX() << ", " << m_ants[0].posY()
+           << ")  Tiles: " << m_sparse.tileCount() << '\n';
+    } else {
+        os << "Step: " << m_stepCount << '\n';
+    }
+}
+
+namespace {
+
+// Pasos entre dos publicaciones del progreso para Telemetry
+constexpr unsigned kPublishInterval = 1u << 16;
+
+} // namespace
+
+/**
+* @brief Contadores de progreso para Telemetry.
+*/
+std::shared_ptr<const TelemetryCounters> Simulator::telemetry() const
+{
+    return m_telemetry;
+}
+
+/**
+* @brief Copia el progreso actual a los contadores que lee Telemetry.
+*/
+void Simulator::publishProgress()
+{
+    m_publishedAt = m_stepCount;
+    m_telemetry->steps.store(m_stepCount, std::memory_order_relaxed);
+    m_telemetry->tapeBytes.store(tapeBytes(), std::memory_order_relaxed);
+    m_telemetry->tiles.store(m_sparse.tileCount(), std::memory_order_relaxed);
+    m_telemetry->tileSwitches.store(m_sparse.tileSwitches(), std::memory_order_relaxed);
+}
+
+/**
+* @brief Publica el progreso si han pasado al menos kPublishInterval pasos desde la última vez
+*        y, solo entonces, mira si se ha pedido cancel. Los bucles lo llaman entre tramos de
+*        pasos: casi siempre es una resta y una comparación.
+* @return false si el bucle debe terminar
+*/
+inline bool Simulator::keepRunning()
+{
+    if (m_stepCount - m_publishedAt >= kPublishInterval) {
+        publishProgress();
+        return !m_cancel->load(std::memory_order_relaxed);
+    }
+    return true;
+}
+
+/**
+* @brief Pide que la ejecución en curso termine cuanto antes (desde cualquier hilo).
+*/
+void Simulator::cancel()
+{
+    m_cancel->store(true, std::memory_order_relaxed);
+}
+
+/**
+* @brief Indica si se ha pedido terminar con cancel.
+*/
+bool Simulator::cancelled() const
+{
+    return m_cancel->load(std::memory_order_relaxed);
+}
+
+/**
+* @brief Olvida la petición de cancel.
+*/
+void Simulator::resetCancel()
+{
+    m_cancel->store(false, std::memory_order_relaxed);
+}
+
+/**
+* @brief Bandera que activa cancel, para otro hilo o un manejador de señal.
+*/
+std::shared_ptr<std::atomic<bool>> Simulator::cancelFlag() const
+{
+    return m_cancel;
+}
+
+/**
+* @brief Memoria reservada por las cintas, en bytes.
+*/
+std::uint64_t Simulator::tapeBytes() const
+{
+    return static_cast<std::uint64_t>(m_tape.wordCount()) * sizeof(std::uint64_t) +
+           static_cast<std::uint64_t>(m_colors.width()) * m_colors.height() + m_sparse.memoryBytes();
+}
+
+/**
+* @brief Ejecuta N pasos (si N==0 se ejecuta hasta que la hormiga salga o se termine).
+* @param steps número de pasos a ejecutar (0 = hasta final)
+* @return número de pasos efectivamente ejecutados
+*/
+std::uint64_t Simulator::runSteps(std::uint64_t steps)
+{
+    if (m_cancel->load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    if (m_trace) {
+        checkTraceable();
+    }
+    if (m_ants.size() > 1) {
+        return runColony(steps);
+    }
+    if (m_engine == QUADTREE) {
+        return runQuad(steps);
+    }
+    if (m_multicolor) {
+        return runColor(steps);
+    }
+    if (m_mode == INFINITE && (m_accelerate || m_trackHighway)) {
+        return runHighway(steps);
+    }
+    if (m_trackHighway) {
+        return runTracked(steps);
+    }
+    if (m_engine == MACRO && m_mode == BOUNDED && !kStatistics) {
+        return runMacro(steps);
+    }
+    std::uint64_t executed = 0;
+    // Por tramos de kPublishInterval pasos como mucho; entre tramos se publica el progreso y
+    // se mira si se ha pedido cancel, así que el bucle interno no comprueba nada más
+    while (steps == 0 || executed < steps) {
+        std::uint64_t chunk = (steps == 0) ? kPublishInterval : std::min<std::uint64_t>(steps - executed, kPublishInterval);
+        if (m_mode == INFINITE) {
+            // Sin bordes: cada paso siempre se realiza
+            for (std::uint64_t k = 0; k < chunk; ++k) {
+                if (kStatistics) {
+                    const Ant& ant = m_ants[0];
+                    countLangtonStep(ant.posX(), ant.posY(), m_sparse.get(ant.posX(), ant.posY()));
+                }
+                m_ants[0].step(m_sparse);
+                if (m_trace) m_trace->record(m_ants[0].orient());
+            }
+            m_stepCount += chunk;
+            executed += chunk;
+        } else {
+            if (m_pyramid.active()) {
+                // Tramos cortos, para marcar solo las baldosas que la hormiga puede pisar
+                chunk = std::min(chunk, TilePyramid::kTrackSteps);
+                m_pyramid.touch(m_ants[0].posX(), m_ants[0].posY(), chunk);
+            }
+            // Ejecuta pasos hasta completar el tramo o que la hormiga no pueda avanzar
+            for (std::uint64_t k = 0; k < chunk; ++k) {
+                if (kStatistics) {
+                    const Ant& ant = m_ants[0];
+                    countLangtonStep(ant.posX(), ant.posY(), m_tape.getUnchecked(ant.x(), ant.y()));
+                }
+                // Ejecuta un paso de la hormiga y actualiza el contador de pasos
+                bool ok = m_ants[0].step(m_tape);
+                if (m_trace) m_trace->record(m_ants[0].orient());
+                ++m_stepCount;
+                if (!ok) {
+                    // Si step devuelve false la simulación termina por haber alcanzado el borde
+                    reportBorder("La hormiga no puede avanzar (borde alcanzado). Simulación terminada.");
+                    return executed;
+                }
+                // Incrementa el contador de pasos ejecutados
+                ++executed;
+            }
+        }
+        if (!keepRunning()) {
+            break;
+        }
+    }
+    // Si se ejecutaron todos los pasos pedidos, devuelve el número de pasos ejecutados
+    return executed;
+}
+
+namespace {
+
+// Orientación antes del paso, indexada por orientación después del paso * 2 + (celda era
+// negra): deshace Ant::langtonTurn.
+const unsigned char kUnturn[8] = {
+    Ant::UP,    Ant::DOWN,  // LEFT
+    Ant::DOWN,  Ant::UP,    // RIGHT
+    Ant::RIGHT, Ant::LEFT,  // UP
+    Ant::LEFT,  Ant::RIGHT, // DOWN
+};
+
+} // namespace
+
+/**
+* @brief Ejecuta N pasos con el bucle optimizado (resultado idéntico a runSteps).
+* @param steps número de pasos a ejecutar (0 = hasta final)
+* @return número de pasos efectivamente ejecutados
+*/
+std::uint64_t Simulator::runFast(std::uint64_t steps)
+{
+    if (m_cancel->load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    if (m_trace) {
+        checkTraceable();
+    }
+    if (m_ants.size() > 1) {
+        return runColony(steps);
+    }
+    if (m_engine == QUADTREE) {
+        return runQuad(steps);
+    }
+    if (m_multicolor) {
+        return runColor(steps);
+    }
+    if (m_mode == INFINITE) {
+        // La cinta ilimitada no tiene índice lineal; usa el bucle normal
+        return runSteps(steps);
+    }
+    if (m_trackHighway) {
+        return runTracked(steps);
+    }
+    if (m_engine == MACRO && !kStatistics) {
+        return runMacro(steps);
+    }
+
+    const std::int64_t width = m_tape.width();
+    const std::int64_t height = m_tape.height();
+    std::uint64_t* words = m_tape.data();
+
+    std::uint64_t executed = 0;
+    while ((steps == 0 || executed < steps) && keepRunning()) {
+        std::int64_t x = m_ants[0].posX();
+        std::int64_t y = m_ants[0].posY();
+        // Pasos que se pueden dar sin llegar a ningún borde: la hormiga avanza una celda por paso
+        std::int64_t margin = std::min(std::min(x, width - 1 - x), std::min(y, height - 1 - y));
+
+        if (margin <= 0) {
+            // Junto al borde: paso normal con comprobación de límites
+            if (kStatistics) {
+                countLangtonStep(x, y, m_tape.getUnchecked(static_cast<unsigned>(x), static_cast<unsigned>(y)));
+            }
+            m_pyramid.touch(x, y, 0);
+            bool ok = m_ants[0].step(m_tape);
+            if (m_trace) m_trace->record(m_ants[0].orient());
+            ++m_stepCount;
+            if (!ok) {
+                reportBorder("La hormiga no puede avanzar (borde alcanzado). Simulación terminada.");
+                return executed;
+            }
+            ++executed;
+            continue;
+        }
+
+        std::uint64_t burst = static_cast<std::uint64_t>(margin);
+        if (steps != 0) {
+            burst = std::min(burst, steps - executed);
+        }
+        if (m_pyramid.active()) {
+            // Tramos cortos, para marcar solo las baldosas que la hormiga puede pisar
+            burst = std::min(burst, TilePyramid::kTrackSteps);
+            m_pyramid.touch(x, y, burst);
+        }
+
+        // Bucle sin ramas ni comprobaciones: lee e invierte el bit, gira y avanza (el cursor
+        // mueve el índice de bit según la disposición de la cinta). Cada paso depende del
+        // anterior, así que lo que cuenta es la cadena lectura de la celda -> giro -> siguiente
+        // índice: el giro y el desplazamiento se calculan con operaciones de bits en lugar de
+        // leer tablas, para que la lectura de la celda sea la única espera de memoria.
+        Tape::Cursor cursor = m_tape.cursor(x, y);
+        unsigned orient = m_ants[0].orient();
+        if (kStatistics) {
+            // El mismo bucle anotando también las estadísticas, en variables locales para que
+            // las escrituras en la cinta no obliguen a releerlas
+            const std::int64_t dx[4] = { -1, 1, 0, 0 };
+            const std::int64_t dy[4] = { 0, 0, -1, 1 };
+            StatCounters stats = m_stats;
+            std::uint32_t* visits = m_visits.empty() ? nullptr : m_visits.data();
+            for (std::uint64_t k = 0; k < burst; ++k) {
+                const std::uint64_t bit = cursor.bit();
+                std::uint64_t& word = words[bit >> 6];
+                std::uint64_t mask = std::uint64_t(1) << (bit & 63);
+                unsigned wasBlack = (word & mask) != 0;
+                word ^= mask;
+                stats.blackDelta += wasBlack ? -1 : 1;
+                ++stats.turns[wasBlack ? Rule::RIGHT : Rule::LEFT];
+                stats.touch(x, y);
+                if (visits) ++visits[y * width + x];
+                orient = Ant::langtonTurn(orient, wasBlack);
+                if (m_trace) m_trace->record(orient);
+                cursor.forward(orient);
+                x += dx[orient];
+                y += dy[orient];
+            }
+            m_stats = stats;
+        } else if (m_trace) {
+            // El mismo bucle anotando la dirección de cada paso; la palabra incompleta del
+            // registro se lleva en variables locales
+            TraceWriter::Pending pending = m_trace->pending();
+            for (std::uint64_t k = 0; k < burst; ++k) {
+                const std::uint64_t bit = cursor.bit();
+                std::uint64_t& word = words[bit >> 6];
+                std::uint64_t mask = std::uint64_t(1) << (bit & 63);
+                unsigned wasBlack = (word & mask) != 0;
+                word ^= mask;
+                orient = Ant::langtonTurn(orient, wasBlack);
+                cursor.forward(orient);
+                pending.bits |= std::uint64_t(orient) << (2 * pending.count);
+                if (++pending.count == TraceWriter::kCodesPerWord) {
+                    m_trace->push(pending.bits);
+                    pending = TraceWriter::Pending{ 0, 0 };
+                }
+            }
+            m_trace->pending() = pending;
+        } else {
+            orient = Ant::runLangton(words, cursor, orient, burst);
+        }
+
+        // Devuelve el estado a la hormiga
+        m_ants[0].place(cursor.x(), cursor.y(), static_cast<Ant::Orientation>(orient));
+        m_stepCount += burst;
+        executed += burst;
+    }
+    return executed;
+}
+
+/**
+* @brief Deshace N pasos ejecutando la regla al revés.
+* @param steps número de pasos a deshacer (0 = hasta el paso 0)
+* @return número de pasos deshechos
+*/
+std::uint64_t Simulator::runBackwards(std::uint64_t steps)
+{
+    if (m_ants.size() > 1) {
+        throw std::logic_error("solo se pueden deshacer pasos con una hormiga");
+    }
+    if (!m_rule.isTurnString()) {
+        throw std::logic_error("la regla " + m_rule.text() + " no es reversible");
+    }
+    // La cinta cambia por detrás del detector de autopista y del quadtree
+    materializeTrails();
+    m_highway.reset();
+    m_highwayPhase = 0;
+    m_trackedPeriod = 0;
+    m_quad.reset();
+    m_pyramid.invalidate();
+    m_blackStale = true;
+
+    const std::uint64_t limit = (steps == 0) ? m_stepCount : std::min<std::uint64_t>(steps, m_stepCount);
+    std::uint64_t undone = 0;
+    if (m_borderReached && limit > 0) {
+        // El último paso invirtió la celda y giró, pero no movió la hormiga
+        Ant& ant = m_ants[0];
+        unsigned orient = ant.orient();
+        if (m_multicolor) {
+            TurnStringRule(m_rule).unapply(orient, m_colors.data()[ant.posY() * m_colors.width() + ant.posX()]);
+        } else {
+            orient = kUnturn[orient * 2 + !m_tape.flipUnchecked(ant.x(), ant.y())];
+        }
+        ant.place(ant.posX(), ant.posY(), static_cast<Ant::Orientation>(orient));
+        m_borderReached = false;
+        m_telemetry->borderReached.store(false, std::memory_order_relaxed);
+        --m_stepCount;
+        ++undone;
+    }
+
+    if (m_multicolor) {
+        undone += runColorBackwards(limit - undone);
+    } else if (m_mode == INFINITE) {
+        for (; undone < limit; ++undone) {
+            m_ants[0].unstep(m_sparse);
+            --m_stepCount;
+        }
+    } else {
+        const std::int64_t width = m_tape.width();
+        const std::int64_t height = m_tape.height();
+        std::uint64_t* words = m_tape.data();
+        while (undone < limit) {
+            std::int64_t x = m_ants[0].posX();
+            std::int64_t y = m_ants[0].posY();
+            // Hacia atrás la hormiga también se mueve una celda por paso
+            std::int64_t margin = std::min(std::min(x, width - 1 - x), std::min(y, height - 1 - y));
+            if (margin <= 0) {
+                if (!m_ants[0].unstep(m_tape)) {
+                    break;
+                }
+                --m_stepCount;
+                ++undone;
+                continue;
+            }
+            std::uint64_t burst = std::min<std::uint64_t>(static_cast<std::uint64_t>(margin), limit - undone);
+
+            // El bucle de runFast al revés: retrocede, invierte el bit y deshace el giro
+            Tape::Cursor cursor = m_tape.cursor(x, y);
+            unsigned orient = m_ants[0].orient();
+            for (std::uint64_t k = 0; k < burst; ++k) {
+                cursor.backward(orient);
+                const std::uint64_t bit = cursor.bit();
+                std::uint64_t& word = words[bit >> 6];
+                std::uint64_t mask = std::uint64_t(1) << (bit & 63);
+                unsigned wasBlack = (word & mask) == 0;
+                word ^= mask;
+                orient = kUnturn[orient * 2 + wasBlack];
+            }
+            m_ants[0].place(cursor.x(), cursor.y(), static_cast<Ant::Orientation>(orient));
+            m_stepCount -= burst;
+            undone += burst;
+        }
+    }
+    publishProgress();
+    return undone;
+}
+
+/**
+* @brief Registra la dirección de cada paso en 'trace', o deja de registrar con nullptr.
+* @param trace registro, o nullptr
+*/
+void Simulator::setStepTrace(TraceWriter* trace)
+{
+    m_trace = trace;
+}
+
+/**
+* @brief Comprueba que los pasos se dan uno a uno y se pueden registrar.
+*/
+void Simulator::checkTraceable() const
+{
+    if (m_ants.size() > 1) {
+        throw std::logic_error("el registro de pasos solo está disponible con una hormiga");
+    }
+    if (m_engine == QUADTREE || m_engine == MACRO) {
+        throw std::logic_error(std::string("el registro de pasos no está disponible con el motor ") +
+                               (m_engine == QUADTREE ? "QUADTREE" : "MACRO"));
+    }
+    if (m_mode == INFINITE && (m_accelerate || m_trackHighway)) {
+        throw std::logic_error("el registro de pasos no está disponible con el salto de autopista");
+    }
+}
+
+/**
+* @brief Repite pasos de un registro comprobando que la regla da las mismas direcciones.
+* @param trace registro
+* @param first índice en el registro del primer paso a repetir
+* @param count pasos a repetir
+* @return pasos repetidos
+*/
+std::uint64_t Simulator::replayTrace(const TraceReader& trace, std::uint64_t first, std::uint64_t count)
+{
+    if (m_ants.size() != 1) {
+        throw std::logic_error("el registro de pasos solo está disponible con una hormiga");
+    }
+    if (first + count > trace.steps()) {
+        throw std::out_of_range("el registro solo tiene " + std::to_string(trace.steps()) + " pasos");
+    }
+    materializeTrails();
+    m_highway.reset();
+    m_trackedPeriod = 0;
+    m_quad.reset();
+    m_pyramid.invalidate();
+    m_blackStale = true;
+
+    const std::int64_t dx[4] = { -1, 1, 0, 0 };
+    const std::int64_t dy[4] = { 0, 0, -1, 1 };
+    const TurmiteRule rule(m_rule);
+    Ant& ant = m_ants[0];
+    std::uint64_t done = 0;
+    while (done < count) {
+        if (m_borderReached) {
+            throw std::invalid_argument("el registro sigue después de que la hormiga alcanzara el borde");
+        }
+        const std::int64_t x = ant.posX();
+        const std::int64_t y = ant.posY();
+        unsigned orient = ant.orient();
+        if (m_multicolor) {
+            rule.apply(m_state, orient, m_colors.data()[y * m_colors.width() + x]);
+        } else if (m_mode == INFINITE) {
+            orient = Ant::langtonTurn(orient, m_sparse.flip(x, y));
+        } else {
+            orient = Ant::langtonTurn(orient, m_tape.flipUnchecked(static_cast<unsigned>(x), static_cast<unsigned>(y)));
+        }
+        const unsigned code = trace.code(first + done);
+        if (orient != code) {
+            throw std::invalid_argument("el registro no corresponde a la simulación en el paso " +
+                                        std::to_string(m_stepCount));
+        }
+        ++m_stepCount;
+        ++done;
+        const std::int64_t nx = x + dx[orient];
+        const std::int64_t ny = y + dy[orient];
+        const bool inside = m_mode == INFINITE ||
+                            (m_multicolor ? m_colors.isInside(nx, ny) : m_tape.isInside(nx, ny));
+        if (!inside) {
+            ant.place(x, y, static_cast<Ant::Orientation>(orient));
+            reportBorder("La hormiga no puede avanzar (borde alcanzado). Simulación terminada.");
+            continue;
+        }
+        ant.place(nx, ny, static_cast<Ant::Orientation>(orient));
+    }
+    return done;
+}
+
+/**
+* @brief Activa la detección de la autopista y el salto de periodos completos.
+* @param enabled true para activarla
+*/
+void Simulator::setHighwayAcceleration(bool enabled)
+{
+    materializeTrails();
+    m_accelerate = enabled;
+    m_highway.reset();
+    m_highwayPhase = 0;
+    m_trackedPeriod = 0;
+}
+
+/**
+* @brief Activa el registro del recorrido para detectar la autopista, también con bordes.
+* @param enabled true para activarlo
+*/
+void Simulator::setHighwayTracking(bool enabled)
+{
+    materializeTrails();
+    m_trackHighway = enabled;
+    m_highway.reset();
+    m_highwayPhase = 0;
+    m_trackedPeriod = 0;
+}
+
+/**
+* @brief Periodo de la autopista detectada (0 si no hay).
+*/
+unsigned Simulator::highwayPeriod() const
+{
+    return m_trackedPeriod;
+}
+
+/**
+* @brief Paso en que empezó la autopista detectada.
+*/
+std::uint64_t Simulator::highwayOnset() const
+{
+    return m_highwayOnset;
+}
+
+/**
+* @brief Activa o desactiva los mensajes por la salida estándar durante la ejecución.
+* @param quiet true para no escribir mensajes
+*/
+void Simulator::setQuiet(bool quiet)
+{
+    m_quiet = quiet;
+}
+
+/**
+* @brief Indica si la simulación terminó porque una hormiga alcanzó el borde.
+*/
+bool Simulator::borderReached() const
+{
+    return m_borderReached;
+}
+
+/**
+* @brief Registra que una hormiga alcanzó el borde y lo muestra si no se está en modo silencioso.
+* @param message mensaje a mostrar
+*/
+void Simulator::reportBorder(const char* message)
+{
+    m_borderReached = true;
+    m_telemetry->borderReached.store(true, std::memory_order_relaxed);
+    if (!m_quiet) {
+        std::cout << message << '\n';
+    }
+}
+
+/**
+* @brief Elige el motor de simulación.
+* @param engine motor
+*/
+void Simulator::setEngine(Engine engine)
+{
+    m_engine = engine;
+    m_quad.reset();
+}
+
+/**
+* @brief Ejecuta pasos con el motor QUADTREE y copia las celdas cambiadas a la cinta.
+* @param steps número de pasos a ejecutar (0 = hasta final)
+* @return número de pasos efectivamente ejecutados
+*/
+namespace {
+
+// Pasos que se piden a QuadEngine de una vez (los mismos que él da por tramo): con menos
+// se pierden recorridos memorizados largos, y con más tarda en notar cancel
+const std::uint64_t kQuadChunk = std::uint64_t(1) << 20;
+
+} // namespace
+
+std::uint64_t Simulator::runQuad(std::uint64_t steps)
+{
+    // Las celdas cambiadas se escriben en la cinta sin marcar las baldosas
+    m_pyramid.invalidate();
+    Ant& ant = m_ants[0];
+    if (!m_quad) {
+        // Copia la cinta actual (incluido el rastro pendiente de la autopista) al quadtree
+        materializeTrails();
+        if (m_multicolor) {
+            m_quad.reset(new QuadEngine(m_rule, true, m_colors.width(), m_colors.height()));
+            for (unsigned y = 0; y < m_colors.height(); ++y) {
+                for (unsigned x = 0; x < m_colors.width(); ++x) {
+                    if (m_colors.get(x, y) != 0) m_quad->setCell(x, y, m_colors.get(x, y));
+                }
+            }
+        } else if (m_mode == INFINITE) {
+            m_quad.reset(new QuadEngine(m_rule, false, 0, 0, ant.posX(), ant.posY()));
+            for (auto const& c : m_sparse.blackCells()) {
+                m_quad->setCell(c.first, c.second, 1);
+            }
+        } else {
+            m_quad.reset(new QuadEngine(m_rule, true, m_tape.width(), m_tape.height()));
+            for (auto const& c : m_tape.blackCells()) {
+                m_quad->setCell(c.first, c.second, 1);
+            }
+        }
+        // Las celdas copiadas ya están en la cinta
+        m_quad->forEachChange([](std::int64_t, std::int64_t, unsigned) {});
+    }
+
+    QuadEngine::AntState state{ ant.posX(), ant.posY(), ant.orient(), m_state };
+    std::uint64_t executed = 0;
+    bool halted = false;
+    while (steps == 0 || executed < steps) {
+        // Por tramos, para publicar el progreso y poder cancelar aunque se pidan muchos pasos
+        std::uint64_t chunk = (steps == 0) ? kQuadChunk : std::min(steps - executed, kQuadChunk);
+        std::uint64_t done = m_quad->run(state, chunk, halted);
+        m_stepCount += done;
+        const bool keep = keepRunning();
+        if (halted) {
+            // El último paso contado no se pudo completar
+            executed += done - 1;
+            break;
+        }
+        executed += done;
+        if (!keep) {
+            break;
+        }
+    }
+
+    // Devuelve el estado a la hormiga y a la cinta
+    ant.place(state.x, state.y, static_cast<Ant::Orientation>(state.orient));
+    m_state = state.state;
+    m_quad->forEachChange([this](std::int64_t x, std::int64_t y, unsigned color) {
+        if (kStatistics) {
+            // Solo se conocen las celdas cambiadas: se mantiene el recuento de no blancas
+            const bool before = m_multicolor ? m_colors.get(static_cast<unsigned>(x), static_cast<unsigned>(y)) != 0
+                              : m_mode == INFINITE ? m_sparse.get(x, y)
+                              : m_tape.getUnchecked(static_cast<unsigned>(x), static_cast<unsigned>(y));
+            m_stats.blackDelta += static_cast<int>(color != 0) - static_cast<int>(before);
+        }
+        if (m_multicolor) {
+            m_colors.set(static_cast<unsigned>(x), static_cast<unsigned>(y), color);
+        } else if (m_mode == INFINITE) {
+            m_sparse.set(x, y, color != 0);
+        } else {
+            m_tape.set(static_cast<unsigned>(x), static_cast<unsigned>(y), color != 0);
+        }
+    });
+    if (halted) {
+        reportBorder("La hormiga no puede avanzar (borde alcanzado). Simulación terminada.");
+    }
+    return executed;
+}
+
+/**
+* @brief Ejecuta pasos con el motor MACRO: mientras el bloque de 4x4 alineado en que está la
+*        hormiga y las celdas que lo rodean estén dentro de la cinta, lee el bloque, busca en la
+*        tabla de MacroStep cómo sale de él y escribe las celdas cambiadas de una vez. Junto al
+*        borde, o si el bloque daría más pasos de los que quedan, da un paso normal.
+* @param steps número de pasos a ejecutar (0 = hasta final)
+* @return número de pasos efectivamente ejecutados
+*/
+std::uint64_t Simulator::runMacro(std::uint64_t steps)
+{
+    std::uint32_t* table = MacroStep::table();
+    const std::int64_t dx[4] = { -1, 1, 0, 0 };
+    const std::int64_t dy[4] = { 0, 0, -1, 1 };
+    const std::int64_t width = m_tape.width();
+    const std::int64_t height = m_tape.height();
+    std::uint64_t* words = m_tape.data();
+    Ant& ant = m_ants[0];
+
+    std::uint64_t executed = 0;
+    while ((steps == 0 || executed < steps) && keepRunning()) {
+        // Por tramos de kPublishInterval pasos como mucho, como runSteps
+        std::uint64_t chunk = (steps == 0) ? kPublishInterval : std::min<std::uint64_t>(steps - executed, kPublishInterval);
+        std::int64_t x = ant.posX();
+        std::int64_t y = ant.posY();
+        if (m_pyramid.active()) {
+            chunk = std::min(chunk, TilePyramid::kTrackSteps);
+            m_pyramid.touch(x, y, chunk);
+        }
+        unsigned orient = ant.orient();
+        std::uint64_t done = 0;
+        while (done < chunk) {
+            const std::int64_t x0 = x & ~std::int64_t(3);
+            const std::int64_t y0 = y & ~std::int64_t(3);
+            if (x0 > 0 && y0 > 0 && x0 + 4 < width && y0 + 4 < height) {
+                // Cada fila del bloque son 4 bits seguidos de una palabra en las dos
+                // disposiciones (x0 es múltiplo de 4)
+                std::uint64_t bits[MacroStep::kSide];
+                unsigned patch = 0;
+                for (unsigned r = 0; r < MacroStep::kSide; ++r) {
+                    bits[r] = m_tape.bitIndex(static_cast<unsigned>(x0), static_cast<unsigned>(y0) + r);
+                    patch |= static_cast<unsigned>((words[bits[r] >> 6] >> (bits[r] & 63)) & 0xFu) << (4 * r);
+                }
+                const std::uint32_t entry = MacroStep::lookup(table, patch, static_cast<unsigned>(x - x0),
+                                                              static_cast<unsigned>(y - y0), orient);
+                if (MacroStep::steps(entry) <= chunk - done) {
+                    const unsigned changed = patch ^ MacroStep::patch(entry);
+                    for (unsigned r = 0; r < MacroStep::kSide; ++r) {
+                        words[bits[r] >> 6] ^= static_cast<std::uint64_t>((changed >> (4 * r)) & 0xFu) << (bits[r] & 63);
+                    }
+                    orient = MacroStep::orient(entry);
+                    x = x0 + MacroStep::lastX(entry) + dx[orient];
+                    y = y0 + MacroStep::lastY(entry) + dy[orient];
+                    done += MacroStep::steps(entry);
+                    continue;
+                }
+            }
+            // Junto al borde o al final del tramo: paso normal con comprobación de límites
+            ant.place(x, y, static_cast<Ant::Orientation>(orient));
+            const bool ok = ant.step(m_tape);
+            if (!ok) {
+                m_stepCount += done + 1;
+                executed += done;
+                reportBorder("La hormiga no puede avanzar (borde alcanzado). Simulación terminada.");
+                return executed;
+            }
+            x = ant.posX();
+            y = ant.posY();
+            orient = ant.orient();
+            ++done;
+        }
+
+        // Devuelve el estado a la hormiga
+        ant.place(x, y, static_cast<Ant::Orientation>(orient));
+        m_stepCount += done;
+        executed += done;
+    }
+    return executed;
+}
+
+/**
+* @brief Número de pasos ejecutados desde el inicio.
+*/
+std::uint64_t Simulator::stepCount() const
+{
+    return m_stepCount;
+}
+
+/**
+* @brief Compara el estado con el de otro simulador (hormigas, pasos y cinta).
+* @param other otro simulador
+* @return true si ambos estados son iguales
+*/
+bool Simulator::sameState(const Simulator& other) const
+{
+    if (m_stepCount != other.m_stepCount || m_ants.size() != other.m_ants.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < m_ants.size(); ++i) {
+        if (m_ants[i].posX() != other.m_ants[i].posX() || m_ants[i].posY() != other.m_ants[i].posY() ||
+            m_ants[i].orient() != other.m_ants[i].orient()) {
+            return false;
+        }
+    }
+    // Cintas con bordes de la regla de Langton: se comparan las palabras directamente
+    if (m_mode == BOUNDED && other.m_mode == BOUNDED && !m_multicolor && !other.m_multicolor) {
+        return m_tape.sameCells(other.m_tape);
+    }
+    std::ostringstream mine, theirs;
+    writeState(mine);
+    other.writeState(theirs);
+    return mine.str() == theirs.str();
+}
+
+namespace {
+
+// Pasos entre dos búsquedas de periodo en el historial de la autopista
+const unsigned kHighwayCheckInterval = 1024;
+// Pasos que se saltan como mucho de una vez cuando se ejecuta sin límite
+const std::uint64_t kHighwayJump = std::uint64_t(1) << 40;
+
+} // namespace
+
+/**
+* @brief Ejecuta pasos con detección y salto de autopista (modo INFINITE, una hormiga, Langton).
+*        Antes de confirmar la autopista se avanza paso a paso registrando el historial y se
+*        busca un periodo cada kHighwayCheckInterval pasos. Después, al inicio de cada periodo
+*        se saltan todos los periodos completos que quepan en los pasos pedidos.
+* @param steps número de pasos a ejecutar (0 = sin fin)
+* @return número de pasos ejecutados
+*/
+std::uint64_t Simulator::runHighway(std::uint64_t steps)
+{
+    Ant& ant = m_ants[0];
+    std::uint64_t executed = 0;
+    while ((steps == 0 || executed < steps) && keepRunning()) {
+        // Sin límite se salta como mucho kHighwayJump pasos de una vez, así que el contador
+        // no se desborda y la petición de cancel se sigue mirando
+        std::uint64_t remaining = (steps == 0) ? kHighwayJump : steps - executed;
+
+        if (!m_highway.confirmed()) {
+            const bool wasBlack = m_sparse.get(ant.posX(), ant.posY());
+            m_highway.record(ant.posX(), ant.posY(), ant.orient(), wasBlack);
+            if (kStatistics) countLangtonStep(ant.posX(), ant.posY(), wasBlack);
+            ant.step(m_sparse);
+            ++m_stepCount;
+            ++executed;
+            if (m_stepCount % kHighwayCheckInterval == 0 &&
+                m_highway.check(m_sparse, ant.posX(), ant.posY(), ant.orient())) {
+                m_highwayPhase = 0;
+                m_trackedPeriod = m_highway.period();
+                m_highwayOnset = m_stepCount - m_highway.periodicSpan(m_trackedPeriod);
+            }
+            continue;
+        }
+
+        const unsigned period = m_highway.period();
+        if (m_highwayPhase != 0 || remaining < period) {
+            // Paso normal dentro del periodo: antes se pinta el rastro que pueda leer la hormiga
+            materializeTrailNear();
+            if (kStatistics) countLangtonStep(ant.posX(), ant.posY(), m_sparse.get(ant.posX(), ant.posY()));
+            ant.step(m_sparse);
+            ++m_stepCount;
+            ++executed;
+            m_highwayPhase = (m_highwayPhase + 1) % period;
+            continue;
+        }
+
+        // Salto de k periodos completos: solo se mueve la hormiga y se apunta el rastro
+        std::uint64_t k = remaining / period;
+        std::int64_t x = ant.posX();
+        std::int64_t y = ant.posY();
+        if (!m_trails.empty()) {
+            TrailSegment& last = m_trails.back();
+            std::int64_t n = static_cast<std::int64_t>(last.periods);
+            if (last.x + n * m_highway.dx() == x && last.y + n * m_highway.dy() == y) {
+                last.periods += k;
+            } else {
+                m_trails.push_back({ x, y, k });
+            }
+        } else {
+            m_trails.push_back({ x, y, k });
+        }
+        std::int64_t kk = static_cast<std::int64_t>(k);
+        if (kStatistics) {
+            // Cada periodo repite el resumen trasladado: el rectángulo de los k periodos es el
+            // que cubre el primero y el último
+            const HighwayDetector::PeriodSummary& s = m_highway.summary();
+            m_stats.blackDelta += kk * s.blackDelta;
+            m_stats.turns[Rule::RIGHT] += k * s.blackReads;
+            m_stats.turns[Rule::LEFT] += k * (period - s.blackReads);
+            const std::int64_t lastX = x + (kk - 1) * m_highway.dx();
+            const std::int64_t lastY = y + (kk - 1) * m_highway.dy();
+            m_stats.touch(std::min(x, lastX) + s.minX, std::min(y, lastY) + s.minY);
+            m_stats.touch(std::max(x, lastX) + s.maxX, std::max(y, lastY) + s.maxY);
+        }
+        ant.place(x + kk * m_highway.dx(), y + kk * m_highway.dy(), ant.orient());
+        m_stepCount += k * period;
+        executed += k * period;
+    }
+    return executed;
+}
+
+/**
+* @brief Ejecuta pasos en la cinta con bordes registrando el historial de la hormiga (ver
+*        setHighwayTracking). Cada kHighwayCheckInterval pasos comprueba que la autopista
+*        detectada sigue repitiéndose o, si no hay ninguna, busca un periodo nuevo.
+* @param steps número de pasos a ejecutar (0 = hasta final)
+* @return número de pasos efectivamente ejecutados
+*/
+std::uint64_t Simulator::runTracked(std::uint64_t steps)
+{
+    // Pasos sin marcar las baldosas de la pirámide (ver TilePyramid.h)
+    m_pyramid.invalidate();
+    Ant& ant = m_ants[0];
+    std::uint64_t executed = 0;
+    while (steps == 0 || executed < steps) {
+        const std::int64_t x = ant.posX();
+        const std::int64_t y = ant.posY();
+        const bool wasBlack = m_tape.getUnchecked(static_cast<unsigned>(x), static_cast<unsigned>(y));
+        m_highway.record(x, y, ant.orient(), wasBlack);
+        if (kStatistics) countLangtonStep(x, y, wasBlack);
+        bool ok = ant.step(m_tape);
+        if (m_trace) m_trace->record(ant.orient());
+        ++m_stepCount;
+        if (!ok) {
+            reportBorder("La hormiga no puede avanzar (borde alcanzado). Simulación terminada.");
+            return executed;
+        }
+        ++executed;
+        if (m_stepCount % kHighwayCheckInterval != 0) {
+            continue;
+        }
+        const bool keep = keepRunning();
+        if (m_trackedPeriod != 0 && !m_highway.repeats(m_trackedPeriod, kHighwayCheckInterval)) {
+            m_trackedPeriod = 0; // la autopista se ha roto
+        }
+        if (m_trackedPeriod == 0) {
+            m_trackedPeriod = m_highway.findPeriod(ant.posX(), ant.posY(), ant.orient());
+            if (m_trackedPeriod != 0) {
+                m_highwayOnset = m_stepCount - m_highway.periodicSpan(m_trackedPeriod);
+            }
+        }
+        if (!keep) {
+            break;
+        }
+    }
+    return executed;
+}
+
+/**
+* @brief Aplica a la cinta las inversiones de un periodo de un segmento del rastro.
+* @param segment segmento
+* @param period índice del periodo dentro del segmento
+*/
+void Simulator::stampPeriod(const TrailSegment& segment, std::uint64_t period) const
+{
+    std::int64_t j = static_cast<std::int64_t>(period);
+    std::int64_t x = segment.x + j * m_highway.dx();
+    std::int64_t y = segment.y + j * m_highway.dy();
+    for (auto const& f : m_highway.flips()) {
+        m_sparse.flip(x + f.first, y + f.second);
+    }
+}
+
+/**
+* @brief Pinta todo el rastro pendiente de la autopista.
+*/
+void Simulator::materializeTrails() const
+{
+    for (auto const& segment : m_trails) {
+        for (std::uint64_t j = 0; j < segment.periods; ++j) {
+            stampPeriod(segment, j);
+        }
+    }
+    m_trails.clear();
+}
+
+/**
+* @brief Pinta los periodos pendientes cuyas celdas puede leer la hormiga en el próximo periodo.
+*        Un periodo que empieza en q solo invierte celdas a distancia <= P de q, y la hormiga solo
+*        lee celdas a distancia <= P de su posición, así que basta con los que están a <= 2P.
+*/
+void Simulator::materializeTrailNear() const
+{
+    const std::int64_t reach = 2 * static_cast<std::int64_t>(m_highway.period()) + 1;
+    const Ant& ant = m_ants[0];
+    while (!m_trails.empty()) {
+        TrailSegment& last = m_trails.back();
+        std::int64_t j = static_cast<std::int64_t>(last.periods) - 1;
+        std::int64_t qx = last.x + j * m_highway.dx();
+        std::int64_t qy = last.y + j * m_highway.dy();
+        if (std::max(std::abs(qx - ant.posX()), std::abs(qy - ant.posY())) > reach) {
+            break;
+        }
+        stampPeriod(last, last.periods - 1);
+        if (--last.periods == 0) {
+            m_trails.pop_back();
+        }
+    }
+}
+
+/**
+* @brief Añade otra hormiga a la colonia (solo con la regla de Langton).
+* @param x pos X inicial de la hormiga
+* @param y pos Y inicial de la hormiga
+* @param orient orientación inicial de la hormiga
+*/
+void Simulator::addAnt(unsigned x, unsigned y, Ant::Orientation orient)
+{
+    if (m_multicolor) {
+        throw std::invalid_argument("Error Simulador: las colonias de hormigas solo admiten la regla de Langton.");
+    }
+    if (m_mode == BOUNDED && !m_tape.isInside(x, y)) {
         throw std::invalid_argument("Error Simulador: Posición inicial de la hormiga fuera de los límites de la cinta.");
     }
+    m_ants.emplace_back(x, y, orient);
 }
 
 /**
-* @brief Inicializa celdas negras desde una lista de coordenadas.
-* @param blacks vector de pares (x,y)
+* @brief Número de hormigas en la cinta.
 */
-void Simulator::initializeBlacks(const std::vector<std::pair<unsigned, unsigned>>& blacks)
+std::size_t Simulator::antCount() const
 {
-    // Inicializa las celdas negras en la cinta según las coordenadas dadas
-    for (auto const & p : blacks) {
-        unsigned x = p.first;
-        unsigned y = p.second;
-        // Verifica que la coordenada esté dentro de la cinta antes de ponerla negra
-        if (m_tape.isInside(static_cast<int>(x), static_cast<int>(y))) {
-            m_tape.set(x, y, true);
+    return m_ants.size();
+}
+
+/**
+* @brief Elige el orden de actualización de la colonia.
+* @param order orden de actualización
+* @param threads hilos para el modo SYNCHRONOUS (0 = núcleos de la máquina)
+*/
+void Simulator::setUpdateOrder(UpdateOrder order, unsigned threads)
+{
+    m_order = order;
+    m_pool.reset();
+    if (order == SYNCHRONOUS && m_mode == BOUNDED) {
+        m_pool.reset(new ThreadPool(threads));
+    }
+}
+
+/**
+* @brief Ejecuta generaciones de la colonia (todas las hormigas dan un paso en cada una).
+*        Termina cuando alguna hormiga no puede avanzar; esa generación se completa pero no cuenta.
+* @param steps número de generaciones a ejecutar (0 = hasta final)
+* @return número de generaciones efectivamente ejecutadas
+*/
+std::uint64_t Simulator::runColony(std::uint64_t steps)
+{
+    // Pasos sin marcar las baldosas de la pirámide (ver TilePyramid.h)
+    m_pyramid.invalidate();
+    std::uint64_t executed = 0;
+    while (steps == 0 || executed < steps) {
+        bool ok = (m_order == SYNCHRONOUS) ? colonyStepSynchronous() : colonyStepSequential();
+        ++m_stepCount;
+        if (!ok) {
+            reportBorder("Una hormiga no puede avanzar (borde alcanzado). Simulación terminada.");
+            return executed;
+        }
+        ++executed;
+        if (!keepRunning()) {
+            break;
         }
     }
+    return executed;
 }
 
 /**
-* @brief Muestra la cinta con la hormiga en su posición actual.
+* @brief Una generación en orden secuencial: cada hormiga ve lo que escribieron las anteriores.
+* @return false si alguna hormiga no pudo avanzar
 */
-void Simulator::display() const
+bool Simulator::colonyStepSequential()
+{
+    bool ok = true;
+    for (auto& ant : m_ants) {
+        if (kStatistics) {
+            countLangtonStep(ant.posX(), ant.posY(), m_mode == INFINITE ? m_sparse.get(ant.posX(), ant.posY())
+                                                                        : m_tape.get(ant.x(), ant.y()));
+        }
+        if (m_mode == INFINITE) {
+            ant.step(m_sparse);
+        } else if (!ant.step(m_tape)) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+* @brief Una generación síncrona: primero todas las hormigas leen su celda y calculan su
+*        movimiento, y después se escriben las celdas. Todas las hormigas de una misma celda
+*        leen el mismo color y escriben el mismo valor, así que el resultado es determinista.
+*        En la cinta con bordes las dos fases se reparten entre los hilos de m_pool: la lectura
+*        por trozos de hormigas y la escritura por franjas de filas, que no comparten palabras.
+* @return false si alguna hormiga no pudo avanzar
+*/
+bool Simulator::colonyStepSynchronous()
 {
-    // Muestra la cinta pero sobreescribe la celda con el símbolo de la hormiga
-    for (unsigned y = 0; y < m_tape.height(); ++y) {
-        for (unsigned x = 0; x < m_tape.width(); ++x) {
-            // Muestra el símbolo de la hormiga si está en esta celda
-            if (x == m_ant.x() && y == m_ant.y()) {
-                std::cout << m_ant.symbol();
+    const std::size_t n = m_ants.size();
+    m_moves.resize(n);
+
+    if (m_mode == INFINITE || !m_pool) {
+        // Cinta dispersa: escribir puede reservar baldosas, así que se hace en un solo hilo
+        for (std::size_t i = 0; i < n; ++i) {
+            Ant const& ant = m_ants[i];
+            bool was = (m_mode == INFINITE) ? m_sparse.get(ant.posX(), ant.posY())
+                                            : m_tape.get(ant.x(), ant.y());
+            m_moves[i] = { ant.posX(), ant.posY(), static_cast<std::uint8_t>(Ant::langtonTurn(ant.orient(), was)), was, true };
+        }
+        bool ok = true;
+        for (std::size_t i = 0; i < n; ++i) {
+            ColonyMove const& mv = m_moves[i];
+            std::int64_t nx = mv.x + (mv.orient == Ant::LEFT ? -1 : mv.orient == Ant::RIGHT ? 1 : 0);
+            std::int64_t ny = mv.y + (mv.orient == Ant::UP ? -1 : mv.orient == Ant::DOWN ? 1 : 0);
+            if (kStatistics) {
+                // Si varias hormigas comparten celda solo la primera la cambia
+                const bool before = (m_mode == INFINITE) ? m_sparse.get(mv.x, mv.y)
+                                                         : m_tape.get(static_cast<unsigned>(mv.x), static_cast<unsigned>(mv.y));
+                countStep(mv.x, mv.y, mv.wasBlack ? Rule::RIGHT : Rule::LEFT,
+                          static_cast<int>(!mv.wasBlack) - static_cast<int>(before));
+            }
+            if (m_mode == INFINITE) {
+                m_sparse.set(mv.x, mv.y, !mv.wasBlack);
             } else {
-                // Si no hay hormiga, muestra el carácter de la celda
-                std::cout << m_tape.cellChar(x, y);
+                m_tape.set(static_cast<unsigned>(mv.x), static_cast<unsigned>(mv.y), !mv.wasBlack);
+                if (!m_tape.isInside(nx, ny)) {
+                    nx = mv.x;
+                    ny = mv.y;
+                    ok = false;
+                }
             }
+            m_ants[i].place(nx, ny, static_cast<Ant::Orientation>(mv.orient));
         }
-        std::cout << '\n';
+        return ok;
     }
-    // Muestra el número de paso actual
-    std::cout << "Step: " << m_stepCount << '\n';
+
+    const unsigned parts = m_pool->size();
+    const std::size_t chunk = (n + parts - 1) / parts;
+    const std::int64_t width = m_tape.width();
+    const std::int64_t height = m_tape.height();
+    // Las franjas no pueden compartir palabras de la cinta: con la disposición por bloques,
+    // cada una tiene un número entero de filas de bloques
+    const std::int64_t rowsPerWord = TapeLayout::kWordRows;
+    const std::int64_t bandHeight = ((height + parts - 1) / parts + rowsPerWord - 1) / rowsPerWord * rowsPerWord;
+    m_buckets.resize(static_cast<std::size_t>(parts) * parts);
+
+    // Fase 1: lectura y cálculo del movimiento (la cinta no se modifica)
+    m_pool->parallelFor(parts, [&](unsigned c) {
+        std::size_t end = std::min(n, (c + 1) * chunk);
+        for (std::size_t i = c * chunk; i < end; ++i) {
+            Ant const& ant = m_ants[i];
+            std::int64_t x = ant.posX();
+            std::int64_t y = ant.posY();
+            bool was = m_tape.getUnchecked(static_cast<unsigned>(x), static_cast<unsigned>(y));
+            std::uint8_t orient = static_cast<std::uint8_t>(Ant::langtonTurn(ant.orient(), was));
+            std::int64_t nx = x + (orient == Ant::LEFT ? -1 : orient == Ant::RIGHT ? 1 : 0);
+            std::int64_t ny = y + (orient == Ant::UP ? -1 : orient == Ant::DOWN ? 1 : 0);
+            bool moved = nx >= 0 && ny >= 0 && nx < width && ny < height;
+            m_moves[i] = { x, y, orient, was, moved };
+            m_buckets[c * parts + static_cast<std::size_t>(y / bandHeight)].push_back(static_cast<std::uint32_t>(i));
+        }
+    });
+
+    // Fase 2: escritura por franjas de filas y movimiento de las hormigas de cada trozo
+    std::atomic<bool> ok(true);
+    std::atomic<std::int64_t> blackDelta(0);
+    m_pool->parallelFor(parts, [&](unsigned b) {
+        std::int64_t bandDelta = 0;
+        for (unsigned c = 0; c < parts; ++c) {
+            auto& bucket = m_buckets[c * parts + b];
+            for (std::uint32_t i : bucket) {
+                ColonyMove const& mv = m_moves[i];
+                if (kStatistics) {
+                    bandDelta += static_cast<int>(!mv.wasBlack) -
+                                 static_cast<int>(m_tape.getUnchecked(static_cast<unsigned>(mv.x), static_cast<unsigned>(mv.y)));
+                }
+                m_tape.setUnchecked(static_cast<unsigned>(mv.x), static_cast<unsigned>(mv.y), !mv.wasBlack);
+            }
+            bucket.clear();
+        }
+        if (kStatistics) {
+            blackDelta.fetch_add(bandDelta, std::memory_order_relaxed);
+        }
+        std::size_t end = std::min(n, (b + 1) * chunk);
+        for (std::size_t i = b * chunk; i < end; ++i) {
+            ColonyMove const& mv = m_moves[i];
+            if (!mv.moved) {
+                m_ants[i].place(mv.x, mv.y, static_cast<Ant::Orientation>(mv.orient));
+                ok.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            std::int64_t nx = mv.x + (mv.orient == Ant::LEFT ? -1 : mv.orient == Ant::RIGHT ? 1 : 0);
+            std::int64_t ny = mv.y + (mv.orient == Ant::UP ? -1 : mv.orient == Ant::DOWN ? 1 : 0);
+            m_ants[i].place(nx, ny, static_cast<Ant::Orientation>(mv.orient));
+        }
+    });
+    if (kStatistics) {
+        // Giros, rectángulo y visitas en un solo hilo (las visitas no son atómicas)
+        m_stats.blackDelta += blackDelta.load();
+        for (ColonyMove const& mv : m_moves) {
+            countStep(mv.x, mv.y, mv.wasBlack ? Rule::RIGHT : Rule::LEFT, 0);
+        }
+    }
+    return ok.load();
 }
 
 /**
-* @brief Ejecuta N pasos (si N==0 se ejecuta hasta que la hormiga salga o se termine).
+* @brief Bucle de simulación multicolor, con la misma estructura que runFast: tramos sin
+*        comprobar límites mientras la hormiga está lejos de los bordes.
+* @param rule objeto regla (FixedTurnRule, TurnStringRule o TurmiteRule)
 * @param steps número de pasos a ejecutar (0 = hasta final)
 * @return número de pasos efectivamente ejecutados
 */
-unsigned Simulator::runSteps(unsigned steps)
+template <class RuleT>
+std::uint64_t Simulator::runColorKernel(const RuleT& rule, std::uint64_t steps)
 {
-    unsigned executed = 0;
-    // Ejecuta pasos hasta que se alcance el número dado o la hormiga no pueda avanzar
-    while ( (steps == 0 || executed < steps) ) {
-        // Ejecuta un paso de la hormiga y actualiza el contador de pasos
-        bool ok = m_ant.step(m_tape);
-        ++m_stepCount;
-        if (!ok) {
-            // Si step devuelve false la simulación termina por haber alcanzado el borde
-            std::cout << "La hormiga no puede avanzar (borde alcanzado). Simulación terminada.\n";
-            return executed;
+    const std::int64_t width = m_colors.width();
+    const std::int64_t height = m_colors.height();
+    // Desplazamientos según orientación: LEFT, RIGHT, UP, DOWN
+    const std::int64_t dx[4] = { -1, 1, 0, 0 };
+    const std::int64_t dy[4] = { 0, 0, -1, 1 };
+    const std::int64_t delta[4] = { -1, 1, -width, width };
+    std::uint8_t* cells = m_colors.data();
+
+    std::int64_t x = m_ants[0].posX();
+    std::int64_t y = m_ants[0].posY();
+    unsigned orient = m_ants[0].orient();
+    unsigned state = m_state;
+
+    std::uint64_t executed = 0;
+    while ((steps == 0 || executed < steps) && keepRunning()) {
+        std::int64_t margin = std::min(std::min(x, width - 1 - x), std::min(y, height - 1 - y));
+
+        if (margin <= 0) {
+            // Junto al borde: aplica la regla y comprueba que el movimiento es posible
+            std::uint8_t& cell = cells[y * width + x];
+            const unsigned before = orient;
+            const bool wasColored = cell != 0;
+            rule.apply(state, orient, cell);
+            if (kStatistics) {
+                countStep(x, y, rule_detail::kTurnBetween[before * 4 + orient],
+                          static_cast<int>(cell != 0) - static_cast<int>(wasColored));
+            }
+            if (m_trace) m_trace->record(orient);
+            ++m_stepCount;
+            std::int64_t nx = x + dx[orient];
+            std::int64_t ny = y + dy[orient];
+            if (!m_colors.isInside(nx, ny)) {
+                m_ants[0].place(x, y, static_cast<Ant::Orientation>(orient));
+                m_state = state;
+                reportBorder("La hormiga no puede avanzar (borde alcanzado). Simulación terminada.");
+                return executed;
+            }
+            x = nx;
+            y = ny;
+            ++executed;
+            continue;
         }
-        // Incrementa el contador de pasos ejecutados
-        ++executed;
+
+        std::uint64_t burst = static_cast<std::uint64_t>(margin);
+        if (steps != 0) {
+            burst = std::min(burst, steps - executed);
+        }
+        std::int64_t idx = y * width + x;
+        if (kStatistics) {
+            // El mismo bucle anotando también las estadísticas (ver runFast)
+            StatCounters stats = m_stats;
+            std::uint32_t* visits = m_visits.empty() ? nullptr : m_visits.data();
+            std::int64_t cx = x, cy = y;
+            for (std::uint64_t k = 0; k < burst; ++k) {
+                std::uint8_t& cell = cells[idx];
+                const unsigned before = orient;
+                const bool wasColored = cell != 0;
+                rule.apply(state, orient, cell);
+                stats.blackDelta += static_cast<int>(cell != 0) - static_cast<int>(wasColored);
+                ++stats.turns[rule_detail::kTurnBetween[before * 4 + orient]];
+                stats.touch(cx, cy);
+                if (visits) ++visits[idx];
+                if (m_trace) m_trace->record(orient);
+                idx += delta[orient];
+                cx += dx[orient];
+                cy += dy[orient];
+            }
+            m_stats = stats;
+        } else if (m_trace) {
+            // El mismo bucle anotando la dirección de cada paso (ver runFast)
+            TraceWriter::Pending pending = m_trace->pending();
+            for (std::uint64_t k = 0; k < burst; ++k) {
+                rule.apply(state, orient, cells[idx]);
+                idx += delta[orient];
+                pending.bits |= std::uint64_t(orient) << (2 * pending.count);
+                if (++pending.count == TraceWriter::kCodesPerWord) {
+                    m_trace->push(pending.bits);
+                    pending = TraceWriter::Pending{ 0, 0 };
+                }
+            }
+            m_trace->pending() = pending;
+        } else {
+            for (std::uint64_t k = 0; k < burst; ++k) {
+                rule.apply(state, orient, cells[idx]);
+                idx += delta[orient];
+            }
+        }
+        x = idx % width;
+        y = idx / width;
+        m_stepCount += burst;
+        executed += burst;
     }
-    // Si se ejecutaron todos los pasos pedidos, devuelve el número de pasos ejecutados
+
+    m_ants[0].place(x, y, static_cast<Ant::Orientation>(orient));
+    m_state = state;
     return executed;
 }
 
+/**
+* @brief Ejecuta pasos con una regla multicolor. Las familias de reglas más usadas tienen
+*        su bucle compilado con la regla fija; el resto usa la tabla leída en ejecución.
+* @param steps número de pasos a ejecutar (0 = hasta final)
+* @return número de pasos efectivamente ejecutados
+*/
+std::uint64_t Simulator::runColor(std::uint64_t steps)
+{
+    if (m_rule.isTurnString()) {
+        const std::string& text = m_rule.text();
+        if (text == "RLR") {
+            return runColorKernel(FixedTurnRule<'R', 'L', 'R'>(), steps);
+        }
+        if (text == "LLRR") {
+            return runColorKernel(FixedTurnRule<'L', 'L', 'R', 'R'>(), steps);
+        }
+        if (text == "RRLLLRLLLRRR") {
+            return runColorKernel(FixedTurnRule<'R', 'R', 'L', 'L', 'L', 'R', 'L', 'L', 'L', 'R', 'R', 'R'>(), steps);
+        }
+        return runColorKernel(TurnStringRule(m_rule), steps);
+    }
+    return runColorKernel(TurmiteRule(m_rule), steps);
+}
+
+/**
+* @brief Bucle de runBackwards con una regla multicolor: el de runColorKernel al revés.
+* @param rule objeto regla (FixedTurnRule o TurnStringRule)
+* @param steps número de pasos a deshacer
+* @return número de pasos deshechos
+*/
+template <class RuleT>
+std::uint64_t Simulator::runColorBackKernel(const RuleT& rule, std::uint64_t steps)
+{
+    const std::int64_t width = m_colors.width();
+    const std::int64_t height = m_colors.height();
+    const std::int64_t dx[4] = { -1, 1, 0, 0 };
+    const std::int64_t dy[4] = { 0, 0, -1, 1 };
+    const std::int64_t delta[4] = { -1, 1, -width, width };
+    std::uint8_t* cells = m_colors.data();
+
+    std::int64_t x = m_ants[0].posX();
+    std::int64_t y = m_ants[0].posY();
+    unsigned orient = m_ants[0].orient();
+
+    std::uint64_t undone = 0;
+    while (undone < steps) {
+        std::int64_t margin = std::min(std::min(x, width - 1 - x), std::min(y, height - 1 - y));
+
+        if (margin <= 0) {
+            // Junto al borde: comprueba que la celda anterior está en la cinta
+            std::int64_t px = x - dx[orient];
+            std::int64_t py = y - dy[orient];
+            if (!m_colors.isInside(px, py)) {
+                break;
+            }
+            x = px;
+            y = py;
+            rule.unapply(orient, cells[y * width + x]);
+            --m_stepCount;
+            ++undone;
+            continue;
+        }
+
+        std::uint64_t burst = std::min<std::uint64_t>(static_cast<std::uint64_t>(margin), steps - undone);
+        std::int64_t idx = y * width + x;
+        for (std::uint64_t k = 0; k < burst; ++k) {
+            idx -= delta[orient];
+            rule.unapply(orient, cells[idx]);
+        }
+        x = idx % width;
+        y = idx / width;
+        m_stepCount -= burst;
+        undone += burst;
+    }
+
+    m_ants[0].place(x, y, static_cast<Ant::Orientation>(orient));
+    return undone;
+}
+
+/**
+* @brief Deshace pasos con una regla multicolor, con los bucles especializados de runColor.
+* @param steps número de pasos a deshacer
+* @return número de pasos deshechos
+*/
+std::uint64_t Simulator::runColorBackwards(std::uint64_t steps)
+{
+    const std::string& text = m_rule.text();
+    if (text == "RLR") {
+        return runColorBackKernel(FixedTurnRule<'R', 'L', 'R'>(), steps);
+    }
+    if (text == "LLRR") {
+        return runColorBackKernel(FixedTurnRule<'L', 'L', 'R', 'R'>(), steps);
+    }
+    if (text == "RRLLLRLLLRRR") {
+        return runColorBackKernel(FixedTurnRule<'R', 'R', 'L', 'L', 'L', 'R', 'L', 'L', 'L', 'R', 'R', 'R'>(), steps);
+    }
+    return runColorBackKernel(TurnStringRule(m_rule), steps);
+}
+
 /**
 * @brief Ejecuta la simulación de forma interactiva.
 *        Tiene la opción de pasos uno a uno o ejecutar N pasos.
@@ -102,9 +2111,10 @@ void Simulator::runInteractive()
 {
     std::cout << "Simulación de la Hormiga de Langton\n";
     std::cout << "Opciones:\n";
-    std::cout << "  1) Paso a paso (pulsa ENTER para avanzar, 'q' + ENTER para salir)\n";
+    std::cout << "  1) Paso a paso (pulsa ENTER para avanzar, 'b [N]' + ENTER para retroceder, 'q' + ENTER para salir)\n";
     std::cout << "  2) Ejecutar N pasos (introduce N, si 0 = hasta que termine)\n";
-    std::cout << "Elige el modo (1 o 2): ";
+    std::cout << "  3) Retroceder N pasos (introduce N, si 0 = hasta el paso 0)\n";
+    std::cout << "Elige el modo (1, 2 o 3): ";
 
     int modo = 1;
     // Lee la opción del usuario, si no es válida se queda en modo 1 por defecto
@@ -115,23 +2125,43 @@ void Simulator::runInteractive()
     std::string dummy; // para limpiar el buffer de entrada
     std::getline(std::cin, dummy); // limpia resto de la línea
 
+    // Modo 3: deshace pasos con la regla al revés, sin historial
+    if (modo == 3) {
+        std::cout << "Introduce número de pasos a retroceder (0 = hasta el paso 0): ";
+        std::uint64_t N = 0;
+        if (!(std::cin >> N)) {
+            std::cin.clear();
+            N = 0;
+        }
+        std::getline(std::cin, dummy); // limpia resto de la línea
+        try {
+            std::uint64_t undone = runBackwards(N);
+            display();
+            std::cout << "Pasos retrocedidos: " << undone << '\n';
+        } catch (std::logic_error const& e) {
+            std::cout << "No se puede retroceder: " << e.what() << '\n';
+        }
+        return;
+    }
+
     // Modo 2
     if (modo == 2) {
         std::cout << "Introduce número de pasos a ejecutar (0 = hasta final): ";
-        unsigned N = 0;
+        std::uint64_t N = 0;
         // Lee el número de pasos a ejecutar, si no es válido se ejecuta hasta el final
         if (!(std::cin >> N)) {
+            std::cin.clear();
             N = 0;
         }
         std::getline(std::cin, dummy); // limpia resto de la línea
         // Ejecuta en bloques mostrando cada 100 pasos para no saturar la salida
-        unsigned executed = 0;
+        std::uint64_t executed = 0;
         // Si N==0 se ejecuta hasta que la hormiga alcance el borde o se termine
         while (N == 0 || executed < N) {
             // Ejecuta un bloque de pasos (100 o el resto si N es menor) y muestra el estado después de cada bloque
-            unsigned toRun = (N == 0) ? 100u : std::min<unsigned>(100u, N - executed);
+            std::uint64_t toRun = (N == 0) ? 100u : std::min<std::uint64_t>(100u, N - executed);
             // Ejecuta el bloque de pasos y actualiza el contador de pasos ejecutados
-            unsigned real = runSteps(toRun == 0 ? 0 : toRun);
+            std::uint64_t real = runFast(toRun);
             executed += real;
             // Muestra el estado actual después de cada bloque
             display();
@@ -152,24 +2182,47 @@ void Simulator::runInteractive()
         }
     } else {
         // Modo 1
-        std::cout << "Modo paso a paso. Pulsa ENTER para dar un paso, 'q' + ENTER para salir.\n";
+        std::cout << "Modo paso a paso. Pulsa ENTER para dar un paso, 'b [N]' + ENTER para retroceder N pasos"
+                  << " (1 por defecto), 'q' + ENTER para salir.\n";
         while (true) {
             // Muestra el estado actual de la cinta y la hormiga
             display();
-            std::cout << "Pulsa ENTER para avanzar, 'q' + ENTER para salir: ";
+            std::cout << "Pulsa ENTER para avanzar, 'b [N]' + ENTER para retroceder, 'q' + ENTER para salir: ";
             std::string line;
             std::getline(std::cin, line); // lee la entrada del usuario
             if (!line.empty() && line[0] == 'q') { // Si el usuario introduce q se sale del bucle
                 std::cout << "Simulación parada por el usuario.\n";
                 break;
             }
+            if (!line.empty() && line[0] == 'b') { // Retrocede N pasos (1 si no se indica)
+                std::istringstream iss(line.substr(1));
+                std::uint64_t back = 1;
+                if (!(iss >> back) || back == 0) back = 1;
+                try {
+                    runBackwards(back);
+                } catch (std::logic_error const& e) {
+                    std::cout << "No se puede retroceder: " << e.what() << '\n';
+                }
+                continue;
+            }
             // Ejecuta un paso de la hormiga y actualiza el contador de pasos
-            bool ok = m_ant.step(m_tape);
+            if (m_mode == INFINITE || m_multicolor || m_ants.size() > 1) {
+                if (runSteps(1) == 0) {
+                    display();
+                    break;
+                }
+                continue;
+            }
+            if (kStatistics) {
+                countLangtonStep(m_ants[0].posX(), m_ants[0].posY(), m_tape.get(m_ants[0].x(), m_ants[0].y()));
+            }
+            m_pyramid.touch(m_ants[0].posX(), m_ants[0].posY(), 0);
+            bool ok = m_ants[0].step(m_tape);
             ++m_stepCount;
             // Si step devuelve false la simulación termina por haber alcanzado el borde
             if (!ok) {
                 display();
-                std::cout << "La hormiga no puede avanzar (borde alcanzado). Simulación terminada.\n";
+                reportBorder("La hormiga no puede avanzar (borde alcanzado). Simulación terminada.");
                 break;
             }
         }
@@ -185,6 +2238,391 @@ bool Simulator::saveState(const std::string& filename) const
 {
     std::ofstream ofs(filename);
     if (!ofs) return false;
+    return writeState(ofs);
+}
+
+/**
+* @brief Guarda el estado en el formato binario de instantáneas.
+* @param filename nombre de fichero de salida
+* @param compress true para comprimir el grid con RLE
+* @return true si se salvó correctamente
+*/
+bool Simulator::saveSnapshot(const std::string& filename, bool compress) const
+{
+    SnapshotImage image;
+    captureSnapshot(image);
+    return Snapshot::write(filename, image, compress);
+}
+
+namespace {
+// Tamaño máximo de la imagen de la cinta ilimitada (captureFrame): 2^32 celdas ocupan 512 MB
+// en bits y 4 GB ya dibujadas
+const std::uint64_t kMaxFrameSide = UINT_MAX;
+const std::uint64_t kMaxFrameCells = std::uint64_t(1) << 32;
+
+} // namespace
+
+/**
+* @brief Guarda la cinta como imagen.
+* @param filename fichero de salida (la extensión elige el formato)
+* @param options opciones de dibujo
+* @return true si se guardó correctamente
+*/
+bool Simulator::saveImage(const std::string& filename, const FrameOptions& options) const
+{
+    const ImageWriter::Format format = ImageWriter::formatOf(filename);
+    FrameSource frame;
+    captureFrame(frame, options.heatmap);
+    return ImageWriter::write(filename, FrameRecorder::render(frame, options), format);
+}
+
+/**
+* @brief Copia lo que hace falta para dibujar la cinta, reutilizando la memoria de 'frame'.
+* @param frame copia de destino
+* @param withVisits true para copiar también las visitas por celda
+*/
+void Simulator::captureFrame(FrameSource& frame, bool withVisits) const
+{
+    materializeTrails();
+    frame.step = m_stepCount;
+    if (withVisits) {
+        if (m_visits.empty()) {
+            throw std::logic_error("Error Simulador: el mapa de calor necesita contar las visitas (setVisitCounting)");
+        }
+        frame.visits.assign(m_visits.begin(), m_visits.end());
+    } else {
+        frame.visits.clear();
+    }
+    if (m_multicolor) {
+        frame.width = m_colors.width();
+        frame.height = m_colors.height();
+        frame.stride = 0;
+        frame.bits.clear();
+        frame.colors.assign(m_colors.data(), m_colors.data() + static_cast<std::size_t>(frame.width) * frame.height);
+        frame.colorCount = m_rule.colors();
+        return;
+    }
+    frame.colors.clear();
+    frame.colorCount = 2;
+    if (m_mode == INFINITE) {
+        // El rectángulo mínimo con las celdas negras, como en captureSnapshot
+        auto blacks = m_sparse.blackCells();
+        std::int64_t minX = 0, maxX = 0, minY = 0, maxY = 0;
+        if (!blacks.empty()) {
+            minX = maxX = blacks[0].first;
+            minY = blacks.front().second;
+            maxY = blacks.back().second;
+            for (auto const& c : blacks) {
+                minX = std::min(minX, c.first);
+                maxX = std::max(maxX, c.first);
+            }
+        }
+        const std::uint64_t width = static_cast<std::uint64_t>(maxX - minX + 1);
+        const std::uint64_t height = static_cast<std::uint64_t>(maxY - minY + 1);
+        if (width > kMaxFrameSide || height > kMaxFrameSide || width * height > kMaxFrameCells) {
+            throw std::logic_error("Error Simulador: la cinta ocupa " + std::to_string(width) + "x" +
+                                   std::to_string(height) + " celdas, demasiadas para una imagen");
+        }
+        frame.width = static_cast<unsigned>(width);
+        frame.height = static_cast<unsigned>(height);
+        frame.stride = (frame.width + 63) / 64;
+        frame.bits.assign(frame.stride * frame.height, 0);
+        for (auto const& c : blacks) {
+            const std::uint64_t x = static_cast<std::uint64_t>(c.first - minX);
+            const std::uint64_t y = static_cast<std::uint64_t>(c.second - minY);
+            frame.bits[y * frame.stride + x / 64] |= std::uint64_t(1) << (x % 64);
+        }
+        return;
+    }
+    frame.width = m_tape.width();
+    frame.height = m_tape.height();
+    frame.stride = m_tape.stride();
+    frame.bits.resize(frame.stride * frame.height);
+    m_tape.readRows(frame.bits.data());
+}
+
+/**
+* @brief Copia el estado completo en una instantánea en memoria, reutilizando sus vectores.
+* @param image instantánea de destino
+*/
+void Simulator::captureSnapshot(SnapshotImage& image) const
+{
+    materializeTrails();
+    SnapshotHeader& header = image.header;
+    std::memset(&header, 0, sizeof(header));
+    header.mode = m_mode;
+    header.viewX = m_viewX;
+    header.viewY = m_viewY;
+    header.stepCount = m_stepCount;
+    header.turmiteState = m_state;
+    header.flags = m_borderReached ? std::uint32_t(Snapshot::BORDER_REACHED) : 0u;
+
+    // Grid de celdas: la cinta tal como está en memoria, o el rectángulo mínimo que contiene
+    // las celdas negras en modo INFINITE
+    std::vector<std::uint64_t>& grid = image.grid;
+    if (m_multicolor) {
+        header.cellBits = 8;
+        header.width = m_colors.width();
+        header.height = m_colors.height();
+        std::size_t bytes = static_cast<std::size_t>(header.width * header.height);
+        grid.assign((bytes + 7) / 8, 0);
+        std::memcpy(grid.data(), m_colors.data(), bytes);
+    } else if (m_mode == INFINITE) {
+        header.cellBits = 1;
+        grid.clear();
+        auto blacks = m_sparse.blackCells();
+        if (!blacks.empty()) {
+            std::int64_t minX = blacks[0].first, maxX = minX;
+            std::int64_t minY = blacks.front().second, maxY = blacks.back().second;
+            for (auto const& c : blacks) {
+                minX = std::min(minX, c.first);
+                maxX = std::max(maxX, c.first);
+            }
+            header.originX = minX;
+            header.originY = minY;
+            header.width = static_cast<std::uint64_t>(maxX - minX + 1);
+            header.height = static_cast<std::uint64_t>(maxY - minY + 1);
+            header.stride = (header.width + 63) / 64;
+            grid.assign(header.stride * header.height, 0);
+            for (auto const& c : blacks) {
+                std::uint64_t x = static_cast<std::uint64_t>(c.first - minX);
+                std::uint64_t y = static_cast<std::uint64_t>(c.second - minY);
+                grid[y * header.stride + x / 64] |= std::uint64_t(1) << (x % 64);
+            }
+        }
+    } else {
+        header.cellBits = 1;
+        header.width = m_tape.width();
+        header.height = m_tape.height();
+        header.stride = m_tape.stride();
+        grid.resize(header.stride * header.height);
+        m_tape.readRows(grid.data());
+    }
+
+    image.ants.resize(m_ants.size());
+    for (std::size_t i = 0; i < m_ants.size(); ++i) {
+        image.ants[i] = SnapshotAnt{ m_ants[i].posX(), m_ants[i].posY(), static_cast<std::uint32_t>(m_ants[i].orient()), 0 };
+    }
+    image.rule = m_rule.text();
+}
+
+/**
+* @brief Carga un simulador desde una instantánea binaria.
+* @param filename nombre del fichero
+* @return simulador con el estado guardado
+*/
+Simulator Simulator::loadSnapshot(const std::string& filename)
+{
+    // El fichero se proyecta con copia al escribir: la cinta se puede modificar sin tocarlo
+    auto file = std::make_shared<MappedFile>(filename, true);
+    SnapshotHeader header;
+    if (file->size() < sizeof(header)) {
+        throw std::invalid_argument(filename + ": el fichero no es una instantánea binaria");
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+    Snapshot::check(header);
+
+    // Comprueba que todas las partes caben en el fichero
+    const std::size_t antsBytes = static_cast<std::size_t>(header.antCount) * sizeof(SnapshotAnt);
+    const std::uint64_t prefix = sizeof(header) + antsBytes + header.ruleLength;
+    if (header.antCount == 0 || prefix > file->size() || header.gridOffset < prefix ||
+        header.gridOffset % sizeof(std::uint64_t) != 0 || header.gridOffset > file->size() ||
+        header.gridBytes > file->size() - header.gridOffset || header.gridBytes % sizeof(std::uint64_t) != 0 ||
+        (header.cellBits != 1 && header.cellBits != 8) || header.encoding > Snapshot::RLE) {
+        throw std::invalid_argument(filename + ": instantánea dañada");
+    }
+    std::vector<SnapshotAnt> ants(header.antCount);
+    std::memcpy(ants.data(), file->data() + sizeof(header), antsBytes);
+    const std::string rule(file->data() + sizeof(header) + antsBytes, header.ruleLength);
+
+    // Palabras del grid, ya descomprimidas
+    const std::size_t wordCount = (header.cellBits == 8)
+        ? static_cast<std::size_t>((header.width * header.height + 7) / 8)
+        : static_cast<std::size_t>(header.stride * header.height);
+    std::uint64_t* stored = reinterpret_cast<std::uint64_t*>(file->data() + header.gridOffset);
+    const std::size_t storedWords = static_cast<std::size_t>(header.gridBytes / sizeof(std::uint64_t));
+    if (header.encoding == Snapshot::RLE) {
+        std::vector<std::uint64_t> decoded(wordCount);
+        Snapshot::decompress(stored, storedWords, decoded.data(), wordCount);
+        return fromParts(header, ants, rule, decoded.data(), wordCount, nullptr, filename);
+    }
+    // Sin comprimir, la cinta con bordes puede usar directamente las páginas proyectadas
+    return fromParts(header, ants, rule, stored, storedWords, file, filename);
+}
+
+/**
+* @brief Crea un simulador desde una instantánea en memoria (ver captureSnapshot).
+* @param image instantánea
+* @return simulador con el estado guardado
+*/
+Simulator Simulator::fromSnapshot(const SnapshotImage& image)
+{
+    return fromParts(image.header, image.ants, image.rule, image.grid.data(), image.grid.size(), nullptr,
+                     "instantánea en memoria");
+}
+
+/**
+* @brief Crea un simulador con las partes de una instantánea, comprobando que son coherentes.
+* @param header cabecera
+* @param ants hormigas
+* @param ruleText texto de la regla
+* @param grid celdas sin comprimir
+* @param wordCount palabras de grid
+* @param keepAlive si no es nulo, dueño de grid: la cinta con bordes de la regla de Langton usa
+*        grid directamente en lugar de copiarlo
+* @param name nombre para los mensajes de error
+*/
+Simulator Simulator::fromParts(const SnapshotHeader& header, const std::vector<SnapshotAnt>& ants,
+                               const std::string& ruleText, const std::uint64_t* grid, std::size_t wordCount,
+                               std::shared_ptr<void> keepAlive, const std::string& name)
+{
+    if (ants.empty() || (header.cellBits != 1 && header.cellBits != 8) || header.mode > INFINITE ||
+        header.width > UINT_MAX || header.height > UINT_MAX) {
+        throw std::invalid_argument(name + ": instantánea dañada");
+    }
+    Rule rule = Rule::parse(ruleText);
+    const Mode mode = static_cast<Mode>(header.mode);
+    const bool multicolor = !rule.isLangton();
+    if (multicolor != (header.cellBits == 8) || (header.cellBits == 1 && header.stride != (header.width + 63) / 64)) {
+        throw std::invalid_argument(name + ": instantánea dañada");
+    }
+    const std::size_t expected = (header.cellBits == 8)
+        ? static_cast<std::size_t>((header.width * header.height + 7) / 8)
+        : static_cast<std::size_t>(header.stride * header.height);
+    if (wordCount != expected) {
+        throw std::invalid_argument(name + ": instantánea dañada");
+    }
+
+    Simulator sim = [&]() {
+        if (mode == BOUNDED && !multicolor) {
+            unsigned width = static_cast<unsigned>(header.width), height = static_cast<unsigned>(header.height);
+            if (keepAlive && TapeLayout::kRowMajor) {
+                // Sin copia: la cinta usa directamente las páginas proyectadas (solo si la
+                // cinta guarda las celdas fila a fila, como la instantánea)
+                return Simulator(mode, rule, header.viewX, header.viewY,
+                                 Tape(width, height, const_cast<std::uint64_t*>(grid), std::move(keepAlive)));
+            }
+            Tape tape(width, height);
+            tape.writeRows(grid);
+            return Simulator(mode, rule, header.viewX, header.viewY, std::move(tape));
+        }
+        return Simulator(mode, rule, header.viewX, header.viewY, Tape(1, 1));
+    }();
+    if (multicolor) {
+        if (mode != BOUNDED) {
+            throw std::invalid_argument(name + ": instantánea dañada");
+        }
+        sim.m_colors = ColorTape(static_cast<unsigned>(header.width), static_cast<unsigned>(header.height));
+        std::memcpy(sim.m_colors.data(), grid, static_cast<std::size_t>(header.width * header.height));
+    } else if (mode == INFINITE) {
+        for (std::uint64_t y = 0; y < header.height; ++y) {
+            for (std::uint64_t w = 0; w < header.stride; ++w) {
+                std::uint64_t word = grid[y * header.stride + w];
+                while (word) {
+                    unsigned bit = static_cast<unsigned>(__builtin_ctzll(word));
+                    word &= word - 1;
+                    sim.m_sparse.set(header.originX + static_cast<std::int64_t>(w * 64 + bit),
+                                     header.originY + static_cast<std::int64_t>(y), true);
+                }
+            }
+        }
+    }
+
+    // Hormigas, estado y pasos
+    for (SnapshotAnt const& stored : ants) {
+        bool inside = (mode == INFINITE) ||
+                      (multicolor ? sim.m_colors.isInside(stored.x, stored.y) : sim.m_tape.isInside(stored.x, stored.y));
+        if (stored.orient > Ant::DOWN || !inside) {
+            throw std::invalid_argument(name + ": hormiga no válida en la instantánea");
+        }
+        Ant ant(0, 0, static_cast<Ant::Orientation>(stored.orient));
+        ant.place(stored.x, stored.y, static_cast<Ant::Orientation>(stored.orient));
+        sim.m_ants.push_back(ant);
+    }
+    if (header.turmiteState >= rule.states()) {
+        throw std::invalid_argument(name + ": estado del turmite no válido en la instantánea");
+    }
+    sim.m_state = header.turmiteState;
+    sim.m_stepCount = header.stepCount;
+    sim.m_borderReached = (header.flags & Snapshot::BORDER_REACHED) != 0;
+    sim.m_telemetry->borderReached.store(sim.m_borderReached, std::memory_order_relaxed);
+    sim.resetStatistics();
+    return sim;
+}
+
+/**
+* @brief Crea un simulador desde un fichero de inicialización en texto leído en paralelo.
+* @param filename nombre del fichero
+* @param mode tipo de cinta
+* @param threads hilos para leer el fichero (0 = núcleos de la máquina)
+*/
+Simulator Simulator::loadSeed(const std::string& filename, Mode mode, unsigned threads)
+{
+    SeedFile seed(filename, threads);
+    Simulator sim(seed.sizeX(), seed.sizeY(), seed.antX(), seed.antY(), seed.orient(), mode, seed.rule());
+    sim.setTurmiteState(seed.antState());
+
+    // Varios hilos pueden escribir en la misma palabra (o byte) de la cinta, así que las
+    // escrituras son atómicas; como solo se ponen celdas a 1 el orden no importa.
+    // Las coordenadas fuera de la cinta se ignoran, como en initializeBlacks.
+    if (sim.m_multicolor) {
+        std::uint8_t* cells = sim.m_colors.data();
+        const unsigned width = sim.m_colors.width();
+        const unsigned height = sim.m_colors.height();
+        seed.readCells([=](std::size_t, unsigned x, unsigned y) {
+            if (x < width && y < height) {
+                __atomic_store_n(&cells[static_cast<std::size_t>(y) * width + x], std::uint8_t(1), __ATOMIC_RELAXED);
+            }
+        });
+    } else if (mode == INFINITE) {
+        // SparseTape no admite escrituras concurrentes: cada trozo guarda sus celdas
+        std::vector<std::vector<std::pair<unsigned, unsigned>>> blacks(seed.chunkCount());
+        seed.readCells([&](std::size_t chunk, unsigned x, unsigned y) { blacks[chunk].emplace_back(x, y); });
+        for (auto const& chunk : blacks) {
+            sim.initializeBlacks(chunk);
+        }
+    } else {
+        std::uint64_t* words = sim.m_tape.data();
+        const Tape& tape = sim.m_tape;
+        const unsigned width = tape.width();
+        const unsigned height = tape.height();
+        seed.readCells([=, &tape](std::size_t, unsigned x, unsigned y) {
+            if (x < width && y < height) {
+                const std::uint64_t bit = tape.bitIndex(x, y);
+                __atomic_fetch_or(&words[bit >> 6], std::uint64_t(1) << (bit & 63u), __ATOMIC_RELAXED);
+            }
+        });
+    }
+
+    for (auto const& a : seed.extraAnts()) {
+        sim.addAnt(a.x, a.y, a.orient);
+    }
+    for (auto const& c : seed.coloredCells()) {
+        sim.setCell(c.x, c.y, c.color);
+    }
+    return sim;
+}
+
+namespace {
+
+// Bytes de texto que writeState acumula antes de escribirlos en el flujo
+const std::size_t kStateBufferSize = 1 << 16;
+
+} // namespace
+
+/**
+* @brief Escribe el estado actual con el formato de saveState.
+* @param ofs flujo de salida
+* @return true si se escribió correctamente
+*/
+bool Simulator::writeState(std::ostream& ofs) const
+{
+    if (m_mode == INFINITE) {
+        return saveSparseState(ofs);
+    }
+    if (m_multicolor) {
+        return saveColorState(ofs);
+    }
 
     // Línea 1: Tamaño de la cinta
     // Línea 2: Posición inicial y orientación de la hormiga
@@ -193,18 +2631,100 @@ bool Simulator::saveState(const std::string& filename) const
     // Escribe el tamaño de la cinta
     ofs << m_tape.width() << ' ' << m_tape.height() << '\n';
     // Escribe la posición y orientación de la hormiga
-    ofs << m_ant.x() << ' ' << m_ant.y() << ' ' << static_cast<int>(m_ant.orient()) << '\n';
+    ofs << m_ants[0].x() << ' ' << m_ants[0].y() << ' ' << static_cast<int>(m_ants[0].orient()) << '\n';
+    // Escribe el resto de hormigas de la colonia
+    for (std::size_t i = 1; i < m_ants.size(); ++i) {
+        ofs << "ant " << m_ants[i].x() << ' ' << m_ants[i].y() << ' ' << static_cast<int>(m_ants[i].orient()) << '\n';
+    }
+
+    // Escribe las posiciones de las celdas negras, formateadas en un buffer que se vuelca por
+    // bloques (con << cada número pasa por la configuración regional del flujo)
+    std::string buffer;
+    buffer.reserve(kStateBufferSize + 32);
+    char number[16];
+    for (auto const& c : m_tape.blackCells()) {
+        buffer.append(number, std::to_chars(number, number + sizeof(number), c.first).ptr);
+        buffer.push_back(' ');
+        buffer.append(number, std::to_chars(number, number + sizeof(number), c.second).ptr);
+        buffer.push_back('\n');
+        if (buffer.size() >= kStateBufferSize) {
+            ofs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    ofs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+    return static_cast<bool>(ofs);
+}
+
+/**
+* @brief Guarda el estado de la cinta ilimitada con el mismo formato que saveState,
+*        trasladando las coordenadas al rectángulo mínimo que contiene celdas negras y hormiga.
+* @param ofs flujo de salida ya abierto
+* @return true si se salvó correctamente
+*/
+bool Simulator::saveSparseState(std::ostream& ofs) const
+{
+    materializeTrails();
+    auto blacks = m_sparse.blackCells();
+    std::int64_t minX = m_ants[0].posX(), maxX = m_ants[0].posX();
+    std::int64_t minY = m_ants[0].posY(), maxY = m_ants[0].posY();
+    for (auto const& ant : m_ants) {
+        minX = std::min(minX, ant.posX());
+        maxX = std::max(maxX, ant.posX());
+        minY = std::min(minY, ant.posY());
+        maxY = std::max(maxY, ant.posY());
+    }
+    for (auto const& c : blacks) {
+        minX = std::min(minX, c.first);
+        maxX = std::max(maxX, c.first);
+        minY = std::min(minY, c.second);
+        maxY = std::max(maxY, c.second);
+    }
+
+    ofs << (maxX - minX + 1) << ' ' << (maxY - minY + 1) << '\n';
+    ofs << (m_ants[0].posX() - minX) << ' ' << (m_ants[0].posY() - minY) << ' '
+        << static_cast<int>(m_ants[0].orient()) << '\n';
+    for (std::size_t i = 1; i < m_ants.size(); ++i) {
+        ofs << "ant " << (m_ants[i].posX() - minX) << ' ' << (m_ants[i].posY() - minY) << ' '
+            << static_cast<int>(m_ants[i].orient()) << '\n';
+    }
+    for (auto const& c : blacks) {
+        ofs << (c.first - minX) << ' ' << (c.second - minY) << '\n';
+    }
+    return static_cast<bool>(ofs);
+}
 
-    // Escribe las posiciones de las celdas negras
-    for (unsigned y = 0; y < m_tape.height(); ++y) {
-        for (unsigned x = 0; x < m_tape.width(); ++x) {
-            // Si la celda es negra, escribe su coordenada
-            if (m_tape.get(x, y)) {
-                // Escribe la coordenada de la celda negra
-                ofs << x << ' ' << y << '\n';
+/**
+* @brief Guarda el estado con una regla multicolor. Añade al formato de saveState el estado
+*        del turmite al final de la línea 2 (si la regla tiene varios estados), la regla en la
+*        línea 3 y el color de cada celda no blanca como tercer número.
+* @param ofs flujo de salida ya abierto
+* @return true si se salvó correctamente
+*/
+bool Simulator::saveColorState(std::ostream& ofs) const
+{
+    ofs << m_colors.width() << ' ' << m_colors.height() << '\n';
+    ofs << m_ants[0].x() << ' ' << m_ants[0].y() << ' ' << static_cast<int>(m_ants[0].orient());
+    if (m_rule.states() > 1) {
+        ofs << ' ' << m_state;
+    }
+    ofs << '\n' << m_rule.text() << '\n';
+    for (unsigned y = 0; y < m_colors.height(); ++y) {
+        for (unsigned x = 0; x < m_colors.width(); ++x) {
+            unsigned color = m_colors.get(x, y);
+            if (color != 0) {
+                ofs << x << ' ' << y << ' ' << color << '\n';
             }
         }
     }
+    return static_cast<bool>(ofs);
+}
 
-    return true;
+/**
+* @brief Indica el tipo de cinta que usa el simulador.
+*/
+Simulator::Mode Simulator::mode() const
+{
+    return m_mode;
 }
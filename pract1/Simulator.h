@@ -8,24 +8,114 @@
 #define SIMULATOR_H
 
 #include "Ant.h"
+#include "ColorTape.h"
+#include "Highway.h"
+#include "QuadEngine.h"
+#include "TilePyramid.h"
+#include "Rule.h"
 #include "Tape.h"
+#include "SparseTape.h"
+#include "Telemetry.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
 #include <string>
+#include <vector>
+
+struct FrameOptions;
+struct FrameSource;
+struct SnapshotAnt;
+struct SnapshotHeader;
+struct SnapshotImage;
+class TraceReader;
+class TraceWriter;
 
 /**
- * @brief Gestiona la simulación y contiene una Tape y una Ant, y controla los pasos.
+ * @brief Gestiona la simulación y contiene una Tape y una o varias Ant, y controla los pasos.
+ *        Con varias hormigas cada paso es una generación en la que se mueven todas.
  */
 class Simulator {
 public:
+    /// Tipo de cinta: con bordes (Tape) o ilimitada (SparseTape)
+    enum Mode { BOUNDED = 0, INFINITE = 1 };
+
+    /// Orden de actualización con varias hormigas:
+    /// SEQUENTIAL mueve las hormigas una tras otra en el orden en que se añadieron;
+    /// SYNCHRONOUS hace que todas lean la cinta antes de que ninguna escriba.
+    enum UpdateOrder { SEQUENTIAL = 0, SYNCHRONOUS = 1 };
+
+    /// Motor de simulación con una sola hormiga:
+    /// STEPPER avanza celda a celda sobre la cinta;
+    /// QUADTREE usa QuadEngine, que memoriza los recorridos de la hormiga por cada macro-celda;
+    /// MACRO recorre los bloques de 4x4 de la cinta con bordes de una vez con la tabla de MacroStep.
+    enum Engine { STEPPER = 0, QUADTREE = 1, MACRO = 2 };
+
+    /// true si se compiló con LANGTON_STATS (make STATS=1): solo entonces los bucles de
+    /// simulación actualizan las estadísticas; si no, ese código no llega a compilarse.
+#ifdef LANGTON_STATS
+    static constexpr bool kStatistics = true;
+#else
+    static constexpr bool kStatistics = false;
+#endif
+
+    /// Estadísticas de la simulación (ver statistics)
+    struct Statistics {
+        std::uint64_t blackCells;        // celdas no blancas
+        std::uint64_t turns[4];          // pasos por giro, indexados por Rule::Turn
+        bool touched;                    // false si la hormiga aún no ha dado ningún paso
+        std::int64_t minX, minY;         // rectángulo de las celdas que ha pisado la hormiga
+        std::int64_t maxX, maxY;
+        std::int64_t dx, dy;             // desplazamiento desde la posición inicial
+        double distance;                 // distancia euclídea desde la posición inicial
+    };
+
     /**
      * @brief Crea un simulador dado el tamaño de cinta, posición y orientación de la hormiga.
+     *        En modo INFINITE el tamaño solo indica la ventana que se muestra por pantalla
+     *        y la hormiga nunca alcanza un borde.
      * @param sizeX ancho
      * @param sizeY alto
      * @param antX pos X inicial de la hormiga
      * @param antY pos Y inicial de la hormiga
      * @param orient orientación inicial de la hormiga
+     * @param mode tipo de cinta (BOUNDED por defecto)
+     * @param rule regla de la hormiga (por defecto la de Langton, "LR"). Las reglas
+     *        multicolor o de turmite solo están disponibles en modo BOUNDED.
      */
     Simulator(unsigned sizeX, unsigned sizeY,
-              unsigned antX, unsigned antY, Ant::Orientation orient);
+              unsigned antX, unsigned antY, Ant::Orientation orient,
+              Mode mode = BOUNDED, const Rule& rule = Rule());
+
+    /**
+     * @brief Vuelve al estado inicial con otro tamaño de cinta, otra hormiga y otra regla,
+     *        conservando el tipo de cinta y las opciones (orden, motor, autopista, mensajes).
+     *        Reutiliza la memoria de la cinta, así que sirve para encadenar muchas simulaciones
+     *        sin volver a reservarla.
+     * @param sizeX ancho
+     * @param sizeY alto
+     * @param antX pos X inicial de la hormiga
+     * @param antY pos Y inicial de la hormiga
+     * @param orient orientación inicial de la hormiga
+     * @param rule regla de la hormiga
+     */
+    void reset(unsigned sizeX, unsigned sizeY, unsigned antX, unsigned antY, Ant::Orientation orient,
+               const Rule& rule = Rule());
+
+    /**
+     * @brief Pone cada celda de la cinta con bordes de un color distinto de 0 con probabilidad
+     *        'density' (con reglas multicolor, un color al azar entre 1 y colors()-1), con un
+     *        generador determinista a partir de 'seed'. En modo INFINITE se usa la ventana.
+     * @param density proporción de celdas no blancas (0 a 1)
+     * @param seed semilla
+     */
+    void randomize(double density, std::uint64_t seed);
+
+    /**
+     * @brief Número de celdas no blancas de la cinta.
+     */
+    std::uint64_t blackCount() const;
 
     /**
      * @brief Inicializa celdas negras desde una lista de coordenadas
@@ -33,6 +123,260 @@ public:
      */
     void initializeBlacks(const std::vector<std::pair<unsigned, unsigned>>& blacks);
 
+    /**
+     * @brief Fija el color de una celda (solo con reglas multicolor; con la regla de
+     *        Langton los colores válidos son 0 y 1).
+     * @param x coordenada X
+     * @param y coordenada Y
+     * @param color color (menor que el número de colores de la regla)
+     */
+    void setCell(unsigned x, unsigned y, unsigned color);
+
+    /**
+     * @brief Añade otra hormiga a la colonia (solo con la regla de Langton).
+     * @param x pos X inicial de la hormiga
+     * @param y pos Y inicial de la hormiga
+     * @param orient orientación inicial de la hormiga
+     */
+    void addAnt(unsigned x, unsigned y, Ant::Orientation orient);
+
+    /**
+     * @brief Número de hormigas en la cinta.
+     */
+    std::size_t antCount() const;
+
+    /**
+     * @brief Elige el orden de actualización de la colonia.
+     *        En modo SYNCHRONOUS, si varias hormigas están en la misma celda todas leen el mismo
+     *        color y la celda se invierte una sola vez, así que el resultado no depende del
+     *        orden ni del número de hilos.
+     * @param order orden de actualización
+     * @param threads hilos para el modo SYNCHRONOUS en la cinta con bordes (0 = núcleos de la máquina)
+     */
+    void setUpdateOrder(UpdateOrder order, unsigned threads = 0);
+
+    /**
+     * @brief Activa la detección de la autopista y el salto de periodos completos.
+     *        Solo actúa en modo INFINITE con una hormiga y la regla de Langton: cuando se
+     *        confirma un régimen periódico, runSteps avanza k periodos de golpe moviendo la
+     *        hormiga y guardando el rastro pendiente, que se pinta en la cinta cuando hace falta.
+     * @param enabled true para activarla
+     */
+    void setHighwayAcceleration(bool enabled);
+
+    /**
+     * @brief Registra el recorrido de la hormiga para saber cuándo entra en la autopista, también
+     *        en la cinta con bordes (ahí sin saltar periodos: el historial se registra paso a
+     *        paso y se busca un periodo cada 1024 pasos, así que la simulación es más lenta).
+     *        Si el periodo deja de repetirse se descarta y se vuelve a buscar. Solo con una
+     *        hormiga y la regla de Langton; en modo INFINITE equivale a setHighwayAcceleration.
+     * @param enabled true para activarlo
+     */
+    void setHighwayTracking(bool enabled);
+
+    /**
+     * @brief Periodo de la autopista detectada (con setHighwayTracking o setHighwayAcceleration),
+     *        o 0 si no se ha detectado.
+     */
+    unsigned highwayPeriod() const;
+
+    /**
+     * @brief Paso en que empezó la autopista detectada (primer paso del recorrido periódico;
+     *        solo tiene sentido si highwayPeriod() no es 0).
+     */
+    std::uint64_t highwayOnset() const;
+
+    /**
+     * @brief Estadísticas de la hormiga principal, que los bucles de simulación mantienen paso a
+     *        paso, así que leerlas cuesta O(1) (salvo la primera lectura tras modificar la cinta
+     *        desde fuera, que vuelve a contar las celdas no blancas). Con varias hormigas se
+     *        cuentan los pasos de todas, pero el desplazamiento es el de la principal; con el
+     *        motor QUADTREE solo se mantienen las celdas no blancas y el desplazamiento.
+     * @throw std::logic_error si no se compiló con LANGTON_STATS
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Cuenta también las visitas a cada celda de la cinta con bordes, en un vector aparte
+     *        de contadores de 32 bits (ver visits). Activarlo pone los contadores a 0.
+     * @param enabled true para activarlo
+     * @throw std::logic_error si no se compiló con LANGTON_STATS o la cinta es ilimitada
+     */
+    void setVisitCounting(bool enabled);
+
+    /**
+     * @brief Número de pasos que la hormiga ha dado desde la celda (x,y), si está activado
+     *        setVisitCounting (si no, 0).
+     */
+    std::uint32_t visits(unsigned x, unsigned y) const;
+
+    /// Celda no blanca de regionCells
+    struct RegionCell {
+        std::int64_t x;
+        std::int64_t y;
+        unsigned color;
+    };
+
+    /**
+     * @brief Número de celdas no blancas del rectángulo [x0, x0+w) x [y0, y0+h) (la parte que
+     *        cae fuera de la cinta con bordes cuenta como blanca). En la cinta con bordes y la
+     *        regla de Langton, si el rectángulo cubre alguna baldosa de 64x64 entera se responde
+     *        con la pirámide de recuentos (ver TilePyramid.h), que se construye en la primera
+     *        consulta y desde entonces se mantiene al simular, así que cuesta lo que el perímetro
+     *        del rectángulo. Con reglas multicolor se recorren sus celdas.
+     */
+    std::uint64_t regionCount(std::int64_t x0, std::int64_t y0, std::int64_t w, std::int64_t h) const;
+
+    /**
+     * @brief Celdas no blancas del rectángulo [x0, x0+w) x [y0, y0+h) con su color, por filas.
+     *        Salta las baldosas de 64x64 sin celdas no blancas (contándolas como regionCount),
+     *        así que cuesta lo que las baldosas ocupadas y no lo que el rectángulo.
+     */
+    std::vector<RegionCell> regionCells(std::int64_t x0, std::int64_t y0, std::int64_t w, std::int64_t h) const;
+
+    /**
+     * @brief Mapa de densidad: celdas no blancas de cada bloque de zoom x zoom celdas, 'cols'
+     *        bloques por fila y 'rows' filas a partir de (x0, y0), fila a fila. Con la regla de
+     *        Langton en la cinta con bordes, un zoom de 64 * 2^k celdas con (x0, y0) múltiplos
+     *        del zoom se lee directamente de un nivel de la pirámide, así que cuesta lo que el
+     *        mapa; si no, cada bloque se cuenta con regionCount.
+     * @throw std::invalid_argument si zoom es 0
+     */
+    std::vector<std::uint64_t> densityMap(std::int64_t x0, std::int64_t y0, unsigned cols, unsigned rows,
+                                          unsigned zoom) const;
+
+    /**
+     * @brief Colores de las (2 * radius + 1)^2 celdas centradas en la hormiga principal, fila a
+     *        fila (0 fuera de la cinta con bordes).
+     */
+    std::vector<std::uint8_t> neighbourhood(unsigned radius) const;
+
+    /**
+     * @brief Contadores de progreso para Telemetry, que los lee desde otro hilo. Los bucles de
+     *        simulación los actualizan cada 65536 pasos más o menos, siempre entre tramos de
+     *        pasos y no dentro del bucle interno. Siguen siendo válidos aunque se destruya el
+     *        simulador.
+     */
+    std::shared_ptr<const TelemetryCounters> telemetry() const;
+
+    /**
+     * @brief Actualiza ya los contadores de telemetry() (p. ej. antes de la última muestra).
+     */
+    void publishProgress();
+
+    /**
+     * @brief Memoria reservada por las cintas, en bytes.
+     */
+    std::uint64_t tapeBytes() const;
+
+    /**
+     * @brief Pide que la ejecución en curso termine cuanto antes. Se puede llamar desde otro
+     *        hilo: los bucles de simulación miran la petición entre tramos de pasos, cuando
+     *        publican el progreso (ver telemetry), así que no cuesta nada paso a paso. Mientras
+     *        no se llame a resetCancel, runSteps y runFast vuelven sin dar pasos.
+     */
+    void cancel();
+
+    /**
+     * @brief Indica si se ha pedido terminar con cancel.
+     */
+    bool cancelled() const;
+
+    /**
+     * @brief Olvida la petición de cancel para poder seguir ejecutando pasos.
+     */
+    void resetCancel();
+
+    /**
+     * @brief Bandera que activa cancel, para guardarla en otro hilo o en un manejador de señal
+     *        (guardar true en ella equivale a llamar a cancel). Sigue siendo válida aunque se
+     *        destruya el simulador.
+     */
+    std::shared_ptr<std::atomic<bool>> cancelFlag() const;
+
+    /**
+     * @brief Registra en 'trace' la dirección de cada paso (ver StepTrace.h), o deja de
+     *        registrar con nullptr. El registro no pasa a ser del simulador. Solo con una
+     *        hormiga y sin los motores QUADTREE ni MACRO ni la autopista de la cinta ilimitada, que no dan
+     *        los pasos uno a uno; si no, runSteps y runFast lanzan std::logic_error.
+     * @param trace registro, o nullptr
+     */
+    void setStepTrace(TraceWriter* trace);
+
+    /**
+     * @brief Repite pasos de un registro: aplica la regla a la celda de la hormiga y la mueve
+     *        en la dirección registrada, comprobando que coincide con la que da la regla.
+     * @param trace registro
+     * @param first índice en el registro del primer paso a repetir
+     * @param count pasos a repetir
+     * @return pasos repetidos
+     * @throw std::invalid_argument si el registro no corresponde a esta simulación
+     */
+    std::uint64_t replayTrace(const TraceReader& trace, std::uint64_t first, std::uint64_t count);
+
+    /**
+     * @brief Elige el motor de simulación. Con QUADTREE la cinta se copia al quadtree la primera
+     *        vez que se ejecutan pasos y, tras cada ejecución, las celdas cambiadas se vuelven a
+     *        escribir en la cinta, así que display y saveState no cambian. El resultado es
+     *        idéntico al de STEPPER. Con varias hormigas siempre se usa STEPPER, y QUADTREE
+     *        tiene prioridad sobre el salto de autopista. MACRO solo se usa con la regla de
+     *        Langton en la cinta con bordes, sin setHighwayTracking y sin make STATS=1 (las
+     *        estadísticas necesitan cada paso); en los demás casos se avanza como con STEPPER.
+     * @param engine motor
+     */
+    void setEngine(Engine engine);
+
+    /**
+     * @brief Activa o desactiva los mensajes por la salida estándar durante la ejecución
+     *        (p. ej. el aviso de borde alcanzado). Por defecto se muestran.
+     * @param quiet true para no escribir mensajes
+     */
+    void setQuiet(bool quiet);
+
+    /**
+     * @brief Indica si la simulación terminó porque una hormiga alcanzó el borde.
+     */
+    bool borderReached() const;
+
+    /**
+     * @brief Muestra solo una ventana de width x height caracteres centrada en la hormiga
+     *        principal (sin salirse de la cinta con bordes), con un carácter por cada bloque de
+     *        scale x scale celdas. Los bloques se muestran con ' ', '.', ':', 'o' o 'X' según la
+     *        proporción de celdas negras, o con el color más frecuente en reglas multicolor.
+     *        Con width o height 0 se muestra la cinta completa (en modo INFINITE, la ventana del
+     *        tamaño indicado al crear el simulador).
+     * @param width ancho de la ventana en caracteres
+     * @param height alto de la ventana en caracteres
+     * @param scale lado del bloque (1 = una celda por carácter)
+     */
+    void setViewport(unsigned width, unsigned height, unsigned scale = 1);
+
+    /**
+     * @brief Escribe en un flujo el fotograma que muestra el modo interactivo (cinta, o la
+     *        ventana elegida con setViewport, con las hormigas y el número de paso).
+     * @param os flujo de salida
+     */
+    void render(std::ostream& os) const;
+
+    /**
+     * @brief Número de pasos ejecutados desde el inicio.
+     */
+    std::uint64_t stepCount() const;
+
+    /**
+     * @brief Compara el estado con el de otro simulador (hormigas, pasos y cinta). Sirve para
+     *        verificar el salto de autopista contra la simulación paso a paso.
+     * @param other otro simulador
+     * @return true si ambos estados son iguales
+     */
+    bool sameState(const Simulator& other) const;
+
+    /**
+     * @brief Fija el estado interno del turmite (0 por defecto).
+     * @param state estado (menor que el número de estados de la regla)
+     */
+    void setTurmiteState(unsigned state);
+
     /**
      * @brief Ejecuta la simulación de forma interactiva.
      *        Tiene la opción de pasos uno a uno o ejecutar N pasos.
@@ -41,24 +385,266 @@ public:
 
     /**
      * @brief Ejecuta N pasos (si N==0 se ejecuta hasta que la hormiga salga o se termine).
+     *        En modo INFINITE la hormiga nunca sale, así que N==0 solo termina con cancel.
+     *        Los pasos se dan por tramos de 65536: entre tramos se publica el progreso y se
+     *        mira si se ha pedido cancel.
+     * @param steps número de pasos a ejecutar (0 = hasta final)
+     * @return número de pasos efectivamente ejecutados (menos si la hormiga alcanzó el borde
+     *         o se pidió cancel)
+     */
+    std::uint64_t runSteps(std::uint64_t steps);
+
+    /**
+     * @brief Ejecuta N pasos con el bucle optimizado: orientación codificada 0..3, giros y
+     *        desplazamientos calculados con operaciones de bits (Ant::langtonTurn y el cursor
+     *        de la cinta) y posición como índice de bit en la cinta empaquetada.
+     *        Solo se comprueban los bordes cuando la hormiga está junto a uno.
+     *        El resultado es idéntico al de runSteps, y también se detiene con cancel.
      * @param steps número de pasos a ejecutar (0 = hasta final)
      * @return número de pasos efectivamente ejecutados
      */
-    unsigned runSteps(unsigned steps);
+    std::uint64_t runFast(std::uint64_t steps);
+
+    /**
+     * @brief Deshace N pasos ejecutando la regla al revés, sin historial: la celda de detrás
+     *        de la hormiga es la que acaba de dejar, su color actual dice qué color tenía y
+     *        con él se deshace el giro. Usa los mismos tramos sin comprobar bordes que
+     *        runFast. Si la simulación terminó en el borde, primero deshace ese último paso.
+     *        Solo con una hormiga y cadenas de giros (los turmites no son reversibles en
+     *        general); las estadísticas y las visitas solo cuentan los pasos hacia delante.
+     * @param steps número de pasos a deshacer (0 = hasta el paso 0)
+     * @return número de pasos deshechos (menos si la celda anterior quedaría fuera de la cinta)
+     * @throw std::logic_error con varias hormigas o una regla de turmite
+     */
+    std::uint64_t runBackwards(std::uint64_t steps);
 
     /**
-     * @brief Guarda el estado actual en un fichero
+     * @brief Guarda el estado actual en un fichero.
+     *        En modo INFINITE se guarda el rectángulo mínimo que contiene las celdas
+     *        negras y la hormiga, con coordenadas relativas a su esquina superior izquierda.
      * @param filename nombre de fichero de salida
      * @return true si se salvó correctamente
      */
     bool saveState(const std::string& filename) const;
 
+    /**
+     * @brief Guarda el estado en el formato binario de Snapshot.h: cabecera (tamaños, pasos,
+     *        estado del turmite), hormigas, regla y el grid de celdas tal como está en memoria
+     *        (en modo INFINITE, el rectángulo mínimo con las celdas negras). Las coordenadas se
+     *        guardan sin normalizar. saveState sigue disponible para exportar en texto.
+     * @param filename nombre de fichero de salida
+     * @param compress true para comprimir el grid con RLE
+     * @return true si se salvó correctamente
+     */
+    bool saveSnapshot(const std::string& filename, bool compress = false) const;
+
+    /**
+     * @brief Copia el estado que guarda saveSnapshot en una instantánea en memoria, reutilizando
+     *        la memoria de sus vectores. Sirve para escribirla después en otro hilo (ver
+     *        Checkpointer) sin que la simulación tenga que esperar al disco.
+     * @param image instantánea de destino
+     */
+    void captureSnapshot(SnapshotImage& image) const;
+
+    /**
+     * @brief Guarda la cinta como imagen (ver FrameRecorder::render): PGM/PPM o PNG según la
+     *        extensión. En modo INFINITE se dibuja el rectángulo mínimo con las celdas negras.
+     * @param filename fichero .png, .pgm, .ppm o .pnm
+     * @param options escala, ampliación y mapa de calor
+     * @return true si se guardó correctamente
+     * @throw std::invalid_argument si la extensión no es de imagen
+     * @throw std::logic_error si se pide mapa de calor sin setVisitCounting
+     */
+    bool saveImage(const std::string& filename, const FrameOptions& options) const;
+
+    /**
+     * @brief Copia lo que hace falta para dibujar la cinta (las palabras de la cinta de bits o
+     *        los bytes de la multicolor, y las visitas si se piden), reutilizando la memoria de
+     *        'frame'. El dibujo y la codificación pueden hacerse después en otro hilo.
+     * @param frame copia de destino
+     * @param withVisits true para copiar también las visitas por celda
+     * @throw std::logic_error si se piden las visitas sin setVisitCounting, o si el
+     *        rectángulo de la cinta ilimitada es demasiado grande
+     */
+    void captureFrame(FrameSource& frame, bool withVisits) const;
+
+    /**
+     * @brief Carga un simulador desde una instantánea binaria. Si no está comprimida y es de
+     *        una cinta con bordes con la regla de Langton, la cinta se proyecta con mmap (copia
+     *        al escribir) en lugar de leerse: solo se cargan las páginas que se usan.
+     * @param filename nombre del fichero
+     * @return simulador con el estado guardado
+     * @throw std::invalid_argument si el fichero no es una instantánea válida
+     */
+    static Simulator loadSnapshot(const std::string& filename);
+
+    /**
+     * @brief Crea un simulador desde una instantánea en memoria (ver captureSnapshot).
+     * @param image instantánea
+     * @return simulador con el estado guardado
+     * @throw std::invalid_argument si la instantánea no es válida
+     */
+    static Simulator fromSnapshot(const SnapshotImage& image);
+
+    /**
+     * @brief Crea un simulador desde un fichero de inicialización en texto (ver main.cc) con
+     *        SeedFile: el fichero se proyecta en memoria, sus líneas se leen en paralelo y las
+     *        celdas negras se escriben directamente en la cinta, sin pasar por un vector.
+     * @param filename nombre del fichero
+     * @param mode tipo de cinta
+     * @param threads hilos para leer el fichero (0 = núcleos de la máquina)
+     * @return simulador con el estado inicial del fichero
+     * @throw SeedFormatError con el número de la primera línea incorrecta
+     */
+    static Simulator loadSeed(const std::string& filename, Mode mode = BOUNDED, unsigned threads = 0);
+
+    /**
+     * @brief Indica el tipo de cinta que usa el simulador.
+     */
+    Mode mode() const;
+
+    /**
+     * @brief Regla que sigue la hormiga.
+     */
+    const Rule& rule() const;
+
 private:
-    Tape m_tape;
-    Ant  m_ant;
-    unsigned m_stepCount; // Contador de pasos ejecutados
+    // Simulador sin hormigas sobre una cinta ya construida (ver loadSnapshot)
+    Simulator(Mode mode, const Rule& rule, unsigned viewX, unsigned viewY, Tape&& tape);
+    // Simulador con las partes de una instantánea (ver loadSnapshot y fromSnapshot)
+    static Simulator fromParts(const SnapshotHeader& header, const std::vector<SnapshotAnt>& ants,
+                               const std::string& ruleText, const std::uint64_t* grid, std::size_t wordCount,
+                               std::shared_ptr<void> keepAlive, const std::string& name);
+
+    Mode m_mode;
+    Rule m_rule;
+    bool m_multicolor;   // true si la regla no es la de Langton y se usa m_colors
+    Tape m_tape;         // Cinta con bordes (modo BOUNDED, regla de Langton)
+    // Cinta ilimitada (modo INFINITE). Es mutable porque el rastro pendiente de la autopista
+    // se pinta en ella de forma perezosa, también desde métodos const como display o saveState.
+    mutable SparseTape m_sparse;
+    ColorTape m_colors;  // Cinta multicolor (reglas multicolor o de turmite)
+    std::vector<Ant> m_ants; // m_ants[0] es la hormiga principal
+    unsigned m_state;    // Estado interno del turmite
+    unsigned m_viewX;    // Ancho de la ventana mostrada
+    unsigned m_viewY;    // Alto de la ventana mostrada
+    unsigned m_viewScale; // Lado del bloque de celdas que representa cada carácter
+    bool m_viewCrop;     // true si en modo BOUNDED se muestra solo la ventana
+    mutable std::string m_frame; // Buffer del fotograma, reutilizado entre llamadas a display
+    std::uint64_t m_stepCount; // Contador de pasos ejecutados
 
+    // Autopista: detección y rastro pendiente de pintar. Cada segmento son 'periods' periodos
+    // consecutivos que empiezan con la hormiga en (x,y); sus inversiones se aplican con XOR,
+    // así que se pueden pintar en cualquier orden.
+    struct TrailSegment {
+        std::int64_t x;
+        std::int64_t y;
+        std::uint64_t periods;
+    };
+    bool m_accelerate;
+    bool m_trackHighway;     // setHighwayTracking
+    HighwayDetector m_highway;
+    unsigned m_highwayPhase; // pasos dados desde el último inicio de periodo
+    unsigned m_trackedPeriod;     // periodo de la autopista detectada (0 = ninguna)
+    std::uint64_t m_highwayOnset; // paso en que empezó
+    mutable std::vector<TrailSegment> m_trails;
+
+    // Estadísticas incrementales (solo se actualizan con kStatistics)
+    struct StatCounters {
+        std::int64_t blackDelta;       // variación de celdas no blancas desde el último recuento
+        std::uint64_t turns[4];
+        std::int64_t minX, minY;       // rectángulo pisado (vacío si minX > maxX)
+        std::int64_t maxX, maxY;
+
+        void touch(std::int64_t x, std::int64_t y)
+        {
+            if (x < minX) minX = x;
+            if (x > maxX) maxX = x;
+            if (y < minY) minY = y;
+            if (y > maxY) maxY = y;
+        }
+    };
+    StatCounters m_stats;
+    std::int64_t m_startX;             // posición inicial de la hormiga principal
+    std::int64_t m_startY;
+    mutable bool m_blackStale;         // la cinta cambió fuera de los bucles: hay que recontar
+    mutable std::int64_t m_blackBase;  // celdas no blancas = m_blackBase + m_stats.blackDelta
+    std::vector<std::uint32_t> m_visits; // visitas por celda (vacío si no se cuentan)
+    unsigned m_visitWidth;
+
+    // Colonia en modo SYNCHRONOUS
+    struct ColonyMove {
+        std::int64_t x;      // posición donde estaba la hormiga (celda a escribir)
+        std::int64_t y;
+        std::uint8_t orient; // nueva orientación
+        bool wasBlack;       // color leído
+        bool moved;          // false si el movimiento la sacaba de la cinta
+    };
+    UpdateOrder m_order;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::vector<ColonyMove> m_moves;
+    std::vector<std::vector<std::uint32_t>> m_buckets; // hormigas por (trozo, franja de filas)
+
+    // Motor QUADTREE; se crea al ejecutar pasos y se descarta si se modifica la cinta
+    Engine m_engine;
+    std::unique_ptr<QuadEngine> m_quad;
+
+    // Recuentos por baldosas de m_tape para las consultas de regiones; se activa con la primera
+    // y los bucles de simulación marcan las baldosas que cambian
+    mutable TilePyramid m_pyramid;
+
+    bool m_quiet;         // true para no escribir mensajes durante la ejecución
+    bool m_borderReached; // true si una hormiga alcanzó el borde
+
+    std::shared_ptr<TelemetryCounters> m_telemetry; // ver telemetry()
+    std::uint64_t m_publishedAt; // m_stepCount en la última publicación
+    std::shared_ptr<std::atomic<bool>> m_cancel; // ver cancel()
+
+    TraceWriter* m_trace; // ver setStepTrace (nullptr si no se registra)
+
+    void reportBorder(const char* message); // Registra el borde alcanzado y lo muestra
+    // publishProgress si han pasado kPublishInterval pasos; false si se ha pedido cancel
+    bool keepRunning();
+    void checkTraceable() const; // Lanza std::logic_error si no se pueden registrar los pasos
+    // Vuelve a empezar las estadísticas (desde la posición actual de la hormiga principal)
+    void resetStatistics();
+    // Anota un paso dado desde (x,y) con el giro 'turn' (Rule::Turn)
+    void countStep(std::int64_t x, std::int64_t y, unsigned turn, int blackDelta);
+    // Anota un paso de la regla de Langton dado desde (x,y) sobre una celda del color 'wasBlack'
+    void countLangtonStep(std::int64_t x, std::int64_t y, bool wasBlack);
+    // Compone una fila de la ventana a partir de la celda (x0,y)
+    void renderLine(std::int64_t x0, std::int64_t y, std::int64_t cols, char* out) const;
+    // Color de la celda (x,y), 0 fuera de la cinta con bordes
+    unsigned colorAt(std::int64_t x, std::int64_t y) const;
     void display() const; // Muestra la cinta con la hormiga en su posición actual
+    bool writeState(std::ostream& ofs) const;      // Contenido de saveState
+    bool saveSparseState(std::ostream& ofs) const; // saveState para el modo INFINITE
+    bool saveColorState(std::ostream& ofs) const;  // saveState para reglas multicolor
+
+    // Ejecuta pasos con detección y salto de autopista
+    std::uint64_t runHighway(std::uint64_t steps);
+    // Ejecuta pasos en la cinta con bordes registrando el historial para setHighwayTracking
+    std::uint64_t runTracked(std::uint64_t steps);
+    void stampPeriod(const TrailSegment& segment, std::uint64_t period) const;
+    void materializeTrails() const;    // Pinta todo el rastro pendiente
+    void materializeTrailNear() const; // Pinta los periodos que la hormiga puede leer pronto
+    // Ejecuta generaciones de la colonia; devuelve las completadas sin que ninguna hormiga se saliera
+    std::uint64_t runColony(std::uint64_t steps);
+    bool colonyStepSequential();
+    bool colonyStepSynchronous();
+    // Ejecuta pasos con el motor QUADTREE y copia las celdas cambiadas a la cinta
+    std::uint64_t runQuad(std::uint64_t steps);
+    // Ejecuta pasos con el motor MACRO (regla de Langton en la cinta con bordes)
+    std::uint64_t runMacro(std::uint64_t steps);
+    // Ejecuta pasos con una regla multicolor, eligiendo el bucle especializado para ella
+    std::uint64_t runColor(std::uint64_t steps);
+    // Bucle de simulación multicolor, instanciado para cada tipo de regla (ver Rule.h)
+    template <class RuleT>
+    std::uint64_t runColorKernel(const RuleT& rule, std::uint64_t steps);
+    // runBackwards con una regla multicolor, con los mismos bucles especializados
+    std::uint64_t runColorBackwards(std::uint64_t steps);
+    template <class RuleT>
+    std::uint64_t runColorBackKernel(const RuleT& rule, std::uint64_t steps);
 };
 
 #endif
\ No newline at end of file
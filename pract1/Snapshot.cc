@@ -0,0 +1,206 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Snapshot.cc
+ * @brief Implementación de las utilidades del formato binario de instantáneas.
+ */
+
+#include "Snapshot.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <unistd.h>
+
+static_assert(std::is_trivially_copyable<SnapshotHeader>::value && sizeof(SnapshotHeader) == 112,
+              "SnapshotHeader debe tener un formato fijo");
+static_assert(std::is_trivially_copyable<SnapshotAnt>::value && sizeof(SnapshotAnt) == 24,
+              "SnapshotAnt debe tener un formato fijo");
+
+namespace {
+
+const char kMagic[8] = { 'L', 'A', 'N', 'G', 'S', 'N', 'A', 'P' };
+const std::uint64_t kRunFlag = std::uint64_t(1) << 63;
+// Repeticiones a partir de las que compensa cortar un tramo literal
+const std::size_t kMinRun = 3;
+
+// Escribe todos los bytes (write puede escribir menos de los pedidos)
+bool writeAll(int fd, const void* data, std::size_t size)
+{
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Sincroniza el directorio que contiene 'path', para que un rename hecho en él sobreviva a
+// una caída del sistema (fsync del fichero solo asegura su contenido, no su entrada)
+bool syncDirectory(const std::string& path)
+{
+    const std::size_t slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    return ok;
+}
+
+} // namespace
+
+/**
+* @brief Rellena la firma y la versión de una cabecera.
+*/
+void Snapshot::stamp(SnapshotHeader& header)
+{
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+}
+
+/**
+* @brief Comprueba la firma y la versión de una cabecera.
+*/
+void Snapshot::check(const SnapshotHeader& header)
+{
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::invalid_argument("el fichero no es una instantánea binaria");
+    }
+    if (header.version != kVersion) {
+        throw std::invalid_argument("versión de instantánea no soportada: " + std::to_string(header.version));
+    }
+}
+
+/**
+* @brief Indica si el fichero empieza por la firma de una instantánea.
+*/
+bool Snapshot::isSnapshot(const std::string& filename)
+{
+    std::ifstream ifs(filename, std::ios::binary);
+    char magic[sizeof(kMagic)];
+    return ifs.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+/**
+* @brief Escribe una instantánea en un fichero temporal, lo renombra al terminar y sincroniza
+*        el directorio.
+* @param filename nombre del fichero
+* @param image instantánea
+* @param compress true para comprimir el grid con RLE
+* @return true si se escribió correctamente
+*/
+bool Snapshot::write(const std::string& filename, const SnapshotImage& image, bool compress)
+{
+    SnapshotHeader header = image.header;
+    stamp(header);
+    header.encoding = compress ? RLE : RAW;
+    header.antCount = static_cast<std::uint32_t>(image.ants.size());
+    header.ruleLength = static_cast<std::uint32_t>(image.rule.size());
+
+    const std::uint64_t* words = image.grid.data();
+    std::size_t wordCount = image.grid.size();
+    std::vector<std::uint64_t> compressed;
+    if (compress) {
+        compressed = Snapshot::compress(words, wordCount);
+        words = compressed.data();
+        wordCount = compressed.size();
+    }
+    // Sin comprimir el grid empieza en una página para poder proyectarlo (ver loadSnapshot)
+    const std::size_t prefix = sizeof(header) + image.ants.size() * sizeof(SnapshotAnt) + image.rule.size();
+    const std::size_t align = compress ? sizeof(std::uint64_t) : kPageSize;
+    header.gridOffset = (prefix + align - 1) / align * align;
+    header.gridBytes = wordCount * sizeof(std::uint64_t);
+    const std::vector<char> padding(header.gridOffset - prefix, 0);
+
+    const std::string tmp = filename + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = writeAll(fd, &header, sizeof(header)) &&
+              writeAll(fd, image.ants.data(), image.ants.size() * sizeof(SnapshotAnt)) &&
+              writeAll(fd, image.rule.data(), image.rule.size()) &&
+              writeAll(fd, padding.data(), padding.size()) &&
+              writeAll(fd, words, static_cast<std::size_t>(header.gridBytes)) &&
+              ::fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), filename.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return syncDirectory(filename);
+}
+
+/**
+* @brief Comprime palabras con RLE.
+*/
+std::vector<std::uint64_t> Snapshot::compress(const std::uint64_t* words, std::size_t count)
+{
+    std::vector<std::uint64_t> out;
+    std::size_t i = 0;
+    while (i < count) {
+        // Longitud de la repetición que empieza en i
+        std::size_t run = 1;
+        while (i + run < count && words[i + run] == words[i]) ++run;
+        if (run >= kMinRun) {
+            out.push_back(kRunFlag | run);
+            out.push_back(words[i]);
+            i += run;
+            continue;
+        }
+        // Tramo literal hasta la siguiente repetición suficientemente larga
+        std::size_t start = i;
+        while (i < count) {
+            std::size_t next = 1;
+            while (i + next < count && next < kMinRun && words[i + next] == words[i]) ++next;
+            if (next >= kMinRun) break;
+            i += next;
+        }
+        out.push_back(i - start);
+        out.insert(out.end(), words + start, words + i);
+    }
+    return out;
+}
+
+/**
+* @brief Descomprime exactamente 'count' palabras.
+*/
+void Snapshot::decompress(const std::uint64_t* data, std::size_t dataWords,
+                          std::uint64_t* out, std::size_t count)
+{
+    std::size_t in = 0, written = 0;
+    while (written < count) {
+        if (in >= dataWords) {
+            throw std::invalid_argument("instantánea comprimida incompleta");
+        }
+        std::uint64_t control = data[in++];
+        std::uint64_t n = control & ~kRunFlag;
+        if (n > count - written) {
+            throw std::invalid_argument("instantánea comprimida con más celdas de las indicadas");
+        }
+        if (control & kRunFlag) {
+            if (in >= dataWords) {
+                throw std::invalid_argument("instantánea comprimida incompleta");
+            }
+            std::fill(out + written, out + written + n, data[in++]);
+        } else {
+            if (n > dataWords - in) {
+                throw std::invalid_argument("instantánea comprimida incompleta");
+            }
+            std::copy(data + in, data + in + n, out + written);
+            in += n;
+        }
+        written += n;
+    }
+}
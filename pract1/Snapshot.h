@@ -0,0 +1,132 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Snapshot.h
+ * @brief Formato binario de instantáneas de la simulación (ver Simulator::saveSnapshot).
+ *
+ * Fichero (enteros en el orden de bytes de la máquina, little-endian en x86/ARM):
+ *   SnapshotHeader
+ *   antCount x SnapshotAnt
+ *   ruleLength bytes con el texto de la regla (Rule::text)
+ *   relleno con ceros hasta gridOffset
+ *   gridBytes bytes con las celdas como palabras de 64 bits, sin comprimir o en RLE
+ *
+ * Celdas: con cellBits == 1 cada fila ocupa 'stride' palabras y la celda (x,y) es el bit
+ * (x % 64) de la palabra y * stride + x / 64 (el mismo formato que Tape); con cellBits == 8
+ * hay un byte por celda, la celda (x,y) es el byte y * width + x (el formato de ColorTape),
+ * completado con ceros hasta un múltiplo de 8 bytes. La celda (x,y) del grid es la celda
+ * (originX + x, originY + y) de la cinta.
+ *
+ * Sin comprimir, gridOffset es múltiplo de 4096 para que el grid empiece en una página y
+ * se pueda proyectar con mmap directamente en una Tape.
+ *
+ * Los ficheros se escriben primero en "<nombre>.tmp" y se renombran al terminar, así que nunca
+ * queda uno a medias y un simulador que tenga proyectada la versión anterior no la ve cambiar.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Cabecera de la instantánea
+struct SnapshotHeader {
+    char magic[8];              // "LANGSNAP"
+    std::uint32_t version;      // Snapshot::kVersion
+    std::uint32_t encoding;     // Snapshot::Encoding
+    std::uint32_t mode;         // Simulator::Mode
+    std::uint32_t cellBits;     // 1 = bits empaquetados, 8 = un byte por celda
+    std::uint32_t viewX;        // tamaño indicado al crear el simulador
+    std::uint32_t viewY;
+    std::uint64_t width;        // tamaño del grid de celdas
+    std::uint64_t height;
+    std::int64_t originX;       // coordenadas de la celda (0,0) del grid
+    std::int64_t originY;
+    std::uint64_t stride;       // palabras por fila (cellBits == 1)
+    std::uint64_t stepCount;
+    std::uint32_t turmiteState;
+    std::uint32_t antCount;
+    std::uint32_t ruleLength;
+    std::uint32_t flags;        // Snapshot::Flags
+    std::uint64_t gridOffset;   // posición del grid en el fichero
+    std::uint64_t gridBytes;    // bytes del grid (comprimido o no)
+};
+
+/// Hormiga guardada en la instantánea
+struct SnapshotAnt {
+    std::int64_t x;
+    std::int64_t y;
+    std::uint32_t orient;
+    std::uint32_t reserved;
+};
+
+/// Instantánea completa en memoria (ver Simulator::captureSnapshot y Snapshot::write)
+struct SnapshotImage {
+    SnapshotHeader header;           // encoding, gridOffset y gridBytes los rellena write
+    std::vector<SnapshotAnt> ants;
+    std::string rule;                // texto de la regla
+    std::vector<std::uint64_t> grid; // celdas sin comprimir
+};
+
+/**
+ * @brief Constantes y utilidades del formato de instantáneas.
+ */
+class Snapshot {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::size_t kPageSize = 4096;
+
+    /// Codificación del grid
+    enum Encoding : std::uint32_t { RAW = 0, RLE = 1 };
+
+    /// Bits de SnapshotHeader::flags
+    enum Flags : std::uint32_t { BORDER_REACHED = 1 };
+
+    /**
+     * @brief Rellena la firma y la versión de una cabecera.
+     */
+    static void stamp(SnapshotHeader& header);
+
+    /**
+     * @brief Comprueba la firma y la versión de una cabecera.
+     * @throw std::invalid_argument si no es una instantánea o la versión no está soportada
+     */
+    static void check(const SnapshotHeader& header);
+
+    /**
+     * @brief Indica si el fichero empieza por la firma de una instantánea.
+     */
+    static bool isSnapshot(const std::string& filename);
+
+    /**
+     * @brief Escribe una instantánea en "<filename>.tmp", la lleva al disco (fsync), la
+     *        renombra a filename, que se sustituye de forma atómica, y lleva al disco también el
+     *        directorio, para que el cambio de nombre no se pierda si el sistema se cae.
+     * @param filename nombre del fichero
+     * @param image instantánea
+     * @param compress true para comprimir el grid con RLE
+     * @return true si se escribió correctamente (si falla antes del rename, filename no cambia)
+     */
+    static bool write(const std::string& filename, const SnapshotImage& image, bool compress);
+
+    /**
+     * @brief Comprime palabras con RLE: cada bloque empieza con una palabra de control; si su
+     *        bit 63 vale 1 los 63 bits restantes son el número de repeticiones de la palabra
+     *        siguiente, y si vale 0 son el número de palabras literales que siguen.
+     * @param words palabras a comprimir
+     * @param count número de palabras
+     * @return palabras comprimidas
+     */
+    static std::vector<std::uint64_t> compress(const std::uint64_t* words, std::size_t count);
+
+    /**
+     * @brief Descomprime exactamente 'count' palabras.
+     * @throw std::invalid_argument si los datos no son válidos
+     */
+    static void decompress(const std::uint64_t* data, std::size_t dataWords,
+                           std::uint64_t* out, std::size_t count);
+};
+
+#endif
@@ -0,0 +1,314 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file SparseTape.cc
+ * @brief Implementación de la clase SparseTape (cinta bidimensional ilimitada y dispersa)
+ */
+
+#include "SparseTape.h"
+#include <algorithm>
+#include <new>
+
+namespace {
+
+// Posición de la celda dentro de su baldosa (0..63), válida también para coordenadas negativas
+inline unsigned localIndex(std::int64_t v)
+{
+    return static_cast<unsigned>(v & (SparseTape::kTileSize - 1));
+}
+
+} // namespace
+
+/**
+* @brief Mezcla las coordenadas de la baldosa para la tabla hash.
+*/
+std::size_t SparseTape::TileKeyHash::operator()(TileKey const& key) const
+{
+    std::uint64_t h = static_cast<std::uint64_t>(key.tx) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<std::uint64_t>(key.ty) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+    return static_cast<std::size_t>(h);
+}
+
+/**
+* @brief Construye una cinta vacía (todas las celdas blancas).
+*/
+SparseTape::SparseTape()
+    : m_arena(sizeof(Tile)), m_lastKey{0, 0}, m_lastTile(nullptr), m_tileSwitches(0), m_minKey{0, 0},
+      m_maxKey{0, 0}
+{
+}
+
+/**
+* @brief Mueve las baldosas de other. La última baldosa guardada apunta a las baldosas movidas,
+*        así que other la olvida: si no, sus escrituras irían a parar a esta cinta.
+*/
+SparseTape::SparseTape(SparseTape&& other) noexcept
+    : m_tiles(std::move(other.m_tiles)), m_arena(std::move(other.m_arena)), m_lastKey(other.m_lastKey),
+      m_lastTile(other.m_lastTile), m_tileSwitches(other.m_tileSwitches), m_minKey(other.m_minKey),
+      m_maxKey(other.m_maxKey)
+{
+    other.m_tiles.clear();
+    other.m_lastTile = nullptr;
+    other.m_tileSwitches = 0;
+}
+
+SparseTape& SparseTape::operator=(SparseTape&& other) noexcept
+{
+    if (this != &other) {
+        m_tiles = std::move(other.m_tiles);
+        m_arena = std::move(other.m_arena);
+        m_lastKey = other.m_lastKey;
+        m_lastTile = other.m_lastTile;
+        m_tileSwitches = other.m_tileSwitches;
+        m_minKey = other.m_minKey;
+        m_maxKey = other.m_maxKey;
+        other.m_tiles.clear();
+        other.m_lastTile = nullptr;
+        other.m_tileSwitches = 0;
+    }
+    return *this;
+}
+
+/**
+* @brief Deja toda la cinta en blanco, conservando los bloques de las baldosas.
+*/
+void SparseTape::clear()
+{
+    m_tiles.clear();
+    m_arena.reset();
+    m_lastKey = TileKey{0, 0};
+    m_lastTile = nullptr;
+    m_tileSwitches = 0;
+}
+
+/**
+* @brief Busca la baldosa que contiene (x,y) sin reservarla.
+* @return puntero a la baldosa o nullptr si no existe
+*/
+SparseTape::Tile const* SparseTape::findTile(std::int64_t x, std::int64_t y) const
+{
+    TileKey key{x >> kTileShift, y >> kTileShift};
+    if (m_lastTile && key == m_lastKey) {
+        return m_lastTile;
+    }
+    auto it = m_tiles.find(key);
+    return it == m_tiles.end() ? nullptr : it->second;
+}
+
+/**
+* @brief Obtiene la baldosa que contiene (x,y), reservándola (en blanco) si no existe.
+* @return referencia a la baldosa
+*/
+SparseTape::Tile& SparseTape::tileFor(std::int64_t x, std::int64_t y)
+{
+    TileKey key{x >> kTileShift, y >> kTileShift};
+    if (m_lastTile && key == m_lastKey) {
+        return *m_lastTile;
+    }
+    ++m_tileSwitches;
+    auto inserted = m_tiles.try_emplace(key, nullptr);
+    if (inserted.second) {
+        // Baldosa nueva, en blanco; si no hay memoria no se deja la entrada vacía en la tabla
+        try {
+            inserted.first->second = new (m_arena.allocate()) Tile{};
+        } catch (...) {
+            m_tiles.erase(inserted.first);
+            throw;
+        }
+        if (m_tiles.size() == 1) {
+            m_minKey = m_maxKey = key;
+        } else {
+            m_minKey = TileKey{std::min(m_minKey.tx, key.tx), std::min(m_minKey.ty, key.ty)};
+            m_maxKey = TileKey{std::max(m_maxKey.tx, key.tx), std::max(m_maxKey.ty, key.ty)};
+        }
+    }
+    m_lastKey = key;
+    m_lastTile = inserted.first->second;
+    return *m_lastTile;
+}
+
+/**
+* @brief Obtiene el valor de la celda (x,y), donde true = negra, false = blanca.
+*/
+bool SparseTape::get(std::int64_t x, std::int64_t y) const
+{
+    Tile const* tile = findTile(x, y);
+    if (!tile) {
+        return false;
+    }
+    return (tile->rows[localIndex(y)] >> localIndex(x)) & 1u;
+}
+
+/**
+* @brief Fija el valor de la celda (x,y), reservando su baldosa si hace falta.
+*/
+void SparseTape::set(std::int64_t x, std::int64_t y, bool value)
+{
+    std::uint64_t& row = tileFor(x, y).rows[localIndex(y)];
+    std::uint64_t mask = std::uint64_t(1) << localIndex(x);
+    if (value) {
+        row |= mask;
+    } else {
+        row &= ~mask;
+    }
+}
+
+/**
+* @brief Invierte el valor de la celda (x,y), reservando su baldosa si hace falta.
+*/
+bool SparseTape::flip(std::int64_t x, std::int64_t y)
+{
+    std::uint64_t& row = tileFor(x, y).rows[localIndex(y)];
+    std::uint64_t mask = std::uint64_t(1) << localIndex(x);
+    bool old = (row & mask) != 0;
+    row ^= mask;
+    return old;
+}
+
+/**
+* @brief Devuelve el carácter apropiado para mostrar la celda (x,y), siendo ' ' o 'X'.
+*/
+char SparseTape::cellChar(std::int64_t x, std::int64_t y) const
+{
+    return get(x, y) ? 'X' : ' ';
+}
+
+/**
+* @brief Escribe los caracteres de 'count' celdas de la fila y a partir de x0.
+*/
+void SparseTape::renderRow(std::int64_t y, std::int64_t x0, std::size_t count, char* out) const
+{
+    static const char kSymbols[2] = { ' ', 'X' };
+    const std::int64_t end = x0 + static_cast<std::int64_t>(count);
+    std::int64_t x = x0;
+    while (x < end) {
+        // Tramo de la fila dentro de la misma baldosa
+        unsigned bit = localIndex(x);
+        std::int64_t n = std::min<std::int64_t>(kTileSize - bit, end - x);
+        Tile const* tile = findTile(x, y);
+        std::uint64_t row = tile ? tile->rows[localIndex(y)] : 0;
+        for (std::int64_t i = 0; i < n; ++i) {
+            *out++ = kSymbols[(row >> (bit + i)) & 1u];
+        }
+        x += n;
+    }
+}
+
+/**
+* @brief Cuenta las celdas negras del rectángulo [x0, x0+w) x [y0, y0+h).
+*/
+std::uint64_t SparseTape::countBlack(std::int64_t x0, std::int64_t y0, std::int64_t w, std::int64_t h) const
+{
+    std::uint64_t count = 0;
+    for (std::int64_t y = y0; y < y0 + h; ++y) {
+        std::int64_t x = x0;
+        while (x < x0 + w) {
+            unsigned bit = localIndex(x);
+            std::int64_t n = std::min<std::int64_t>(kTileSize - bit, x0 + w - x);
+            Tile const* tile = findTile(x, y);
+            if (tile) {
+                std::uint64_t mask = (n == kTileSize ? ~std::uint64_t(0) : ((std::uint64_t(1) << n) - 1)) << bit;
+                count += static_cast<std::uint64_t>(__builtin_popcountll(tile->rows[localIndex(y)] & mask));
+            }
+            x += n;
+        }
+    }
+    return count;
+}
+
+/**
+* @brief Número de baldosas reservadas hasta ahora.
+*/
+std::size_t SparseTape::tileCount() const
+{
+    return m_tiles.size();
+}
+
+/**
+* @brief Veces que una escritura ha tenido que buscar su baldosa en la tabla.
+*/
+std::uint64_t SparseTape::tileSwitches() const
+{
+    return m_tileSwitches;
+}
+
+/**
+* @brief Memoria aproximada de las baldosas y la tabla: cada nodo guarda la clave, la baldosa
+*        y un puntero al siguiente, y cada cubeta un puntero.
+*/
+std::size_t SparseTape::memoryBytes() const
+{
+    // Bloques de baldosas reservados (incluidos los que clear dejó libres) y nodos de la tabla
+    return m_arena.reservedBytes() + m_tiles.size() * (sizeof(TileKey) + sizeof(Tile*) + sizeof(void*)) +
+           m_tiles.bucket_count() * sizeof(void*);
+}
+
+/**
+* @brief Obtiene las coordenadas de todas las celdas negras ordenadas por filas (y, luego x).
+*/
+std::vector<std::pair<std::int64_t, std::int64_t>> SparseTape::blackCells() const
+{
+    std::vector<std::pair<std::int64_t, std::int64_t>> cells;
+    // Recorre solo las baldosas reservadas y, dentro de ellas, solo las filas no vacías
+    for (auto const& entry : m_tiles) {
+        std::int64_t baseX = entry.first.tx * kTileSize;
+        std::int64_t baseY = entry.first.ty * kTileSize;
+        for (std::int64_t ly = 0; ly < kTileSize; ++ly) {
+            std::uint64_t row = entry.second->rows[ly];
+            for (unsigned lx = 0; row != 0; ++lx, row >>= 1) {
+                if (row & 1u) {
+                    cells.emplace_back(baseX + lx, baseY + ly);
+                }
+            }
+        }
+    }
+    // Orden por filas, igual que el que produce el recorrido de Tape
+    std::sort(cells.begin(), cells.end(),
+              [](auto const& a, auto const& b) {
+                  return a.second != b.second ? a.second < b.second : a.first < b.first;
+              });
+    return cells;
+}
+
+/**
+* @brief Obtiene las celdas negras del rectángulo [x0, x1] x [y0, y1], recorriendo solo las
+*        baldosas que lo cortan.
+*/
+std::vector<std::pair<std::int64_t, std::int64_t>> SparseTape::blackCells(std::int64_t x0, std::int64_t y0,
+                                                                          std::int64_t x1, std::int64_t y1) const
+{
+    std::vector<std::pair<std::int64_t, std::int64_t>> cells;
+    for (std::int64_t ty = y0 >> kTileShift; ty <= (y1 >> kTileShift); ++ty) {
+        for (std::int64_t tx = x0 >> kTileShift; tx <= (x1 >> kTileShift); ++tx) {
+            auto it = m_tiles.find(TileKey{tx, ty});
+            if (it == m_tiles.end()) continue;
+            // Parte del rectángulo dentro de esta baldosa
+            const std::int64_t baseX = tx * kTileSize, baseY = ty * kTileSize;
+            const std::int64_t fromX = std::max(x0, baseX) - baseX, toX = std::min(x1, baseX + kTileSize - 1) - baseX;
+            const std::int64_t fromY = std::max(y0, baseY) - baseY, toY = std::min(y1, baseY + kTileSize - 1) - baseY;
+            const std::uint64_t mask = (toX - fromX == kTileSize - 1 ? ~std::uint64_t(0)
+                                                                      : ((std::uint64_t(1) << (toX - fromX + 1)) - 1))
+                                       << fromX;
+            for (std::int64_t ly = fromY; ly <= toY; ++ly) {
+                for (std::uint64_t row = it->second->rows[ly] & mask; row != 0; row &= row - 1) {
+                    cells.emplace_back(baseX + __builtin_ctzll(row), baseY + ly);
+                }
+            }
+        }
+    }
+    return cells;
+}
+
+/**
+* @brief Rectángulo que cubre todas las baldosas reservadas.
+*/
+bool SparseTape::bounds(std::int64_t& x0, std::int64_t& y0, std::int64_t& x1, std::int64_t& y1) const
+{
+    if (m_tiles.empty()) {
+        return false;
+    }
+    x0 = m_minKey.tx * kTileSize;
+    y0 = m_minKey.ty * kTileSize;
+    x1 = m_maxKey.tx * kTileSize + kTileSize - 1;
+    y1 = m_maxKey.ty * kTileSize + kTileSize - 1;
+    return true;
+}
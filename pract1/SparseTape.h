@@ -0,0 +1,168 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file SparseTape.h
+ * @brief Definición de la clase SparseTape (cinta bidimensional ilimitada y dispersa)
+ */
+
+#ifndef SPARSETAPE_H
+#define SPARSETAPE_H
+
+#include "TapeMemory.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Representa una cinta bidimensional sin bordes para la hormiga de Langton.
+// La cinta se divide en baldosas (tiles) de 64x64 celdas que solo se reservan la
+// primera vez que se escribe en ellas; las celdas de baldosas no reservadas son blancas.
+// Las baldosas se reparten por bloques de 2 MB (TileArena) que clear conserva para reutilizarlos.
+// Las coordenadas son enteros con signo de 64 bits.
+class SparseTape {
+public:
+    /// Lado de cada baldosa en celdas (potencia de 2)
+    static constexpr int kTileShift = 6;
+    static constexpr std::int64_t kTileSize = std::int64_t(1) << kTileShift;
+
+    /**
+     * @brief Construye una cinta vacía (todas las celdas blancas).
+     */
+    SparseTape();
+
+    // Las baldosas pertenecen a la cinta: se puede mover pero no copiar (una copia escribiría
+    // a través de m_lastTile en las baldosas de la original)
+    SparseTape(const SparseTape&) = delete;
+    SparseTape& operator=(const SparseTape&) = delete;
+
+    /**
+     * @brief Mueve las baldosas de other, que queda vacía y sin baldosa guardada en m_lastTile.
+     */
+    SparseTape(SparseTape&& other) noexcept;
+    SparseTape& operator=(SparseTape&& other) noexcept;
+
+    /**
+     * @brief Deja toda la cinta en blanco; los bloques de las baldosas se conservan para las
+     *        siguientes.
+     */
+    void clear();
+
+    /**
+     * @brief Obtiene el valor de la celda (x,y), donde true = negra, false = blanca.
+     * @param x coordenada X (cualquier valor)
+     * @param y coordenada Y (cualquier valor)
+     * @return bool estado de la celda
+     */
+    bool get(std::int64_t x, std::int64_t y) const;
+
+    /**
+     * @brief Fija el valor de la celda (x,y), reservando su baldosa si hace falta.
+     * @param x coordenada X
+     * @param y coordenada Y
+     * @param value nuevo valor
+     */
+    void set(std::int64_t x, std::int64_t y, bool value);
+
+    /**
+     * @brief Invierte el valor de la celda (x,y), reservando su baldosa si hace falta.
+     * @param x coordenada X
+     * @param y coordenada Y
+     * @return bool valor que tenía la celda antes de invertirla
+     */
+    bool flip(std::int64_t x, std::int64_t y);
+
+    /**
+     * @brief Devuelve el carácter apropiado para mostrar la celda (x,y), siendo ' ' o 'X'.
+     * @param x coordenada X
+     * @param y coordenada Y
+     * @return char representación textual
+     */
+    char cellChar(std::int64_t x, std::int64_t y) const;
+
+    /**
+     * @brief Escribe en out los caracteres (' ' o 'X') de 'count' celdas de la fila y a partir
+     *        de x0, leyendo la fila de cada baldosa una sola vez.
+     * @param y fila
+     * @param x0 primera columna
+     * @param count número de celdas
+     * @param out buffer de al menos count caracteres
+     */
+    void renderRow(std::int64_t y, std::int64_t x0, std::size_t count, char* out) const;
+
+    /**
+     * @brief Cuenta las celdas negras del rectángulo [x0, x0+w) x [y0, y0+h).
+     * @return número de celdas negras
+     */
+    std::uint64_t countBlack(std::int64_t x0, std::int64_t y0, std::int64_t w, std::int64_t h) const;
+
+    /**
+     * @brief Número de baldosas reservadas hasta ahora.
+     * @return número de baldosas
+     */
+    std::size_t tileCount() const;
+
+    /**
+     * @brief Veces que una escritura ha cambiado de baldosa y ha tenido que buscarla en la
+     *        tabla (los accesos que suelen fallar en la caché).
+     */
+    std::uint64_t tileSwitches() const;
+
+    /**
+     * @brief Memoria aproximada que ocupan las baldosas y la tabla, en bytes.
+     */
+    std::size_t memoryBytes() const;
+
+    /**
+     * @brief Obtiene las coordenadas de todas las celdas negras ordenadas por filas (y, luego x).
+     * @return vector de pares (x,y)
+     */
+    std::vector<std::pair<std::int64_t, std::int64_t>> blackCells() const;
+
+    /**
+     * @brief Obtiene las celdas negras del rectángulo [x0, x1] x [y0, y1] (extremos incluidos),
+     *        consultando solo las baldosas que lo cortan. No salen ordenadas.
+     * @return vector de pares (x,y)
+     */
+    std::vector<std::pair<std::int64_t, std::int64_t>> blackCells(std::int64_t x0, std::int64_t y0,
+                                                                  std::int64_t x1, std::int64_t y1) const;
+
+    /**
+     * @brief Rectángulo [x0, x1] x [y0, y1] que cubre todas las baldosas reservadas (fuera de él
+     *        todas las celdas son blancas).
+     * @return false si no hay ninguna baldosa
+     */
+    bool bounds(std::int64_t& x0, std::int64_t& y0, std::int64_t& x1, std::int64_t& y1) const;
+
+private:
+    // Una baldosa guarda una fila de 64 celdas en cada palabra.
+    struct Tile {
+        std::uint64_t rows[kTileSize];
+    };
+
+    // Clave de una baldosa: coordenadas de la baldosa (x >> kTileShift, y >> kTileShift).
+    struct TileKey {
+        std::int64_t tx;
+        std::int64_t ty;
+        bool operator==(TileKey const& other) const { return tx == other.tx && ty == other.ty; }
+    };
+
+    struct TileKeyHash {
+        std::size_t operator()(TileKey const& key) const;
+    };
+
+    std::unordered_map<TileKey, Tile*, TileKeyHash> m_tiles;
+    TileArena m_arena; // memoria de las baldosas
+
+    // Última baldosa accedida para escritura: la hormiga suele quedarse muchos pasos
+    // en la misma baldosa, así se evita buscar en la tabla en cada paso.
+    // Las baldosas no se mueven al insertar otras (ni al mover la cinta).
+    TileKey m_lastKey;
+    Tile* m_lastTile;
+    std::uint64_t m_tileSwitches; // búsquedas en la tabla desde tileFor
+    TileKey m_minKey, m_maxKey;   // esquinas de las baldosas reservadas (válidas si m_tiles no está vacía)
+
+    Tile& tileFor(std::int64_t x, std::int64_t y);
+    Tile const* findTile(std::int64_t x, std::int64_t y) const;
+};
+
+#endif
@@ -0,0 +1,339 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file StepTrace.cc
+ * @brief Implementación del registro compacto de pasos (TraceWriter, TraceReader y TraceReplay).
+ */
+
+#include "StepTrace.h"
+#include "Simulator.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+const char kMagic[8] = { 'L', 'A', 'N', 'G', 'T', 'R', 'C', 'E' };
+const std::uint64_t kCopyFlag = std::uint64_t(1) << 63;
+// Copia más corta que se codifica como tal (las más cortas salen más baratas como literales)
+const std::size_t kMinCopy = 3;
+// Tamaño de la tabla de la última aparición de cada palabra
+const unsigned kHashBits = 12;
+
+// Comprime un bloque con copias hacia atrás (ver StepTrace.h). Cada palabra se busca en una
+// tabla con su última aparición, así que un recorrido periódico se convierte en una sola copia.
+std::vector<std::uint64_t> packRepeats(const std::vector<std::uint64_t>& words)
+{
+    std::vector<std::uint64_t> out;
+    std::vector<std::uint32_t> last(std::size_t(1) << kHashBits, UINT32_MAX);
+    const std::size_t n = words.size();
+    std::size_t literalStart = 0; // primera palabra literal aún sin escribir
+    auto flushLiterals = [&](std::size_t end) {
+        if (end > literalStart) {
+            out.push_back(end - literalStart);
+            out.insert(out.end(), words.begin() + literalStart, words.begin() + end);
+        }
+    };
+    std::size_t i = 0;
+    while (i < n) {
+        const std::size_t h = static_cast<std::size_t>((words[i] * 0x9E3779B97F4A7C15ull) >> (64 - kHashBits));
+        const std::uint32_t candidate = last[h];
+        last[h] = static_cast<std::uint32_t>(i);
+        if (candidate != UINT32_MAX && words[candidate] == words[i]) {
+            const std::size_t distance = i - candidate;
+            std::size_t length = 1;
+            while (i + length < n && words[i + length] == words[i + length - distance]) {
+                ++length;
+            }
+            if (length >= kMinCopy) {
+                flushLiterals(i);
+                out.push_back(kCopyFlag | (static_cast<std::uint64_t>(distance) << 32) | length);
+                i += length;
+                literalStart = i;
+                continue;
+            }
+        }
+        ++i;
+    }
+    flushLiterals(n);
+    return out;
+}
+
+// Descomprime exactamente 'count' palabras
+void unpackRepeats(const std::uint64_t* data, std::size_t dataWords, std::uint64_t* out, std::size_t count)
+{
+    std::size_t in = 0, written = 0;
+    while (written < count) {
+        if (in >= dataWords) {
+            throw std::invalid_argument("registro de pasos comprimido incompleto");
+        }
+        const std::uint64_t control = data[in++];
+        if (control & kCopyFlag) {
+            const std::uint64_t distance = (control & ~kCopyFlag) >> 32;
+            const std::uint64_t length = control & 0xFFFFFFFFu;
+            if (distance == 0 || distance > written || length > count - written) {
+                throw std::invalid_argument("registro de pasos comprimido dañado");
+            }
+            // Las copias pueden solaparse con lo que escriben, así que se copia palabra a palabra
+            for (std::uint64_t k = 0; k < length; ++k) {
+                out[written + k] = out[written + k - distance];
+            }
+            written += length;
+        } else {
+            if (control > count - written || control > dataWords - in) {
+                throw std::invalid_argument("registro de pasos comprimido dañado");
+            }
+            std::copy(data + in, data + in + control, out + written);
+            in += control;
+            written += control;
+        }
+    }
+}
+
+} // namespace
+
+/**
+* @brief Crea el fichero y escribe la cabecera.
+* @param filename fichero de registro
+* @param firstStep número de paso del simulador al empezar
+*/
+TraceWriter::TraceWriter(const std::string& filename, std::uint64_t firstStep)
+    : m_out(filename, std::ios::binary), m_pending{ 0, 0 }, m_written(0), m_closed(false)
+{
+    if (!m_out) {
+        throw std::runtime_error("no se puede crear el registro de pasos " + filename);
+    }
+    m_chunk.reserve(kChunkWords);
+    TraceHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.firstStep = firstStep;
+    m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+TraceWriter::~TraceWriter()
+{
+    close();
+}
+
+/**
+* @brief Pasos registrados.
+*/
+std::uint64_t TraceWriter::steps() const
+{
+    return m_written + m_chunk.size() * kCodesPerWord + m_pending.count;
+}
+
+/**
+* @brief Escribe los pasos pendientes y cierra el fichero.
+* @return false si alguna escritura ha fallado
+*/
+bool TraceWriter::close()
+{
+    if (!m_closed) {
+        m_closed = true;
+        // El último bloque puede acabar en una palabra incompleta
+        const std::uint32_t codes = static_cast<std::uint32_t>(m_chunk.size() * kCodesPerWord + m_pending.count);
+        if (m_pending.count != 0) {
+            m_chunk.push_back(m_pending.bits);
+            m_pending = Pending{ 0, 0 };
+        }
+        if (codes != 0) {
+            writeChunk(codes);
+        }
+        m_out.close();
+    }
+    return static_cast<bool>(m_out);
+}
+
+/**
+* @brief Comprime m_chunk (si así ocupa menos) y lo escribe.
+* @param codes pasos del bloque
+*/
+void TraceWriter::writeChunk(std::uint32_t codes)
+{
+    std::vector<std::uint64_t> packed = packRepeats(m_chunk);
+    const bool repeat = packed.size() < m_chunk.size();
+    const std::vector<std::uint64_t>& data = repeat ? packed : m_chunk;
+    TraceChunkHeader header{ codes, repeat ? REPEAT : RAW, data.size() };
+    m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(std::uint64_t)));
+    m_written += codes;
+    m_chunk.clear();
+}
+
+/**
+* @brief Lee y descomprime el registro.
+* @param filename fichero de registro
+*/
+TraceReader::TraceReader(const std::string& filename)
+    : m_firstStep(0), m_steps(0)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        throw std::invalid_argument(filename + ": no se puede abrir el registro de pasos");
+    }
+    TraceHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::invalid_argument(filename + ": el fichero no es un registro de pasos");
+    }
+    if (header.version != TraceWriter::kVersion) {
+        throw std::invalid_argument(filename + ": versión de registro no soportada: " + std::to_string(header.version));
+    }
+    m_firstStep = header.firstStep;
+
+    const std::uint32_t fullChunk = static_cast<std::uint32_t>(TraceWriter::kChunkWords * TraceWriter::kCodesPerWord);
+    bool complete = true; // solo el último bloque puede tener menos pasos
+    TraceChunkHeader chunk;
+    std::vector<std::uint64_t> stored;
+    while (in.read(reinterpret_cast<char*>(&chunk), sizeof(chunk))) {
+        const std::size_t wordCount = (chunk.codes + TraceWriter::kCodesPerWord - 1) / TraceWriter::kCodesPerWord;
+        if (!complete || chunk.codes == 0 || chunk.codes > fullChunk || chunk.encoding > TraceWriter::REPEAT ||
+            chunk.words > wordCount || (chunk.encoding == TraceWriter::RAW && chunk.words != wordCount)) {
+            throw std::invalid_argument(filename + ": registro de pasos dañado");
+        }
+        stored.resize(static_cast<std::size_t>(chunk.words));
+        if (!in.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(stored.size() * sizeof(std::uint64_t)))) {
+            throw std::invalid_argument(filename + ": registro de pasos incompleto");
+        }
+        const std::size_t base = m_words.size();
+        m_words.resize(base + wordCount);
+        if (chunk.encoding == TraceWriter::RAW) {
+            std::copy(stored.begin(), stored.end(), m_words.begin() + static_cast<std::ptrdiff_t>(base));
+        } else {
+            unpackRepeats(stored.data(), stored.size(), m_words.data() + base, wordCount);
+        }
+        m_steps += chunk.codes;
+        complete = chunk.codes == fullChunk;
+    }
+    if (in.gcount() != 0) {
+        throw std::invalid_argument(filename + ": registro de pasos incompleto");
+    }
+}
+
+/**
+* @brief Número de paso del simulador en que empieza el registro.
+*/
+std::uint64_t TraceReader::firstStep() const
+{
+    return m_firstStep;
+}
+
+/**
+* @brief Pasos registrados.
+*/
+std::uint64_t TraceReader::steps() const
+{
+    return m_steps;
+}
+
+/**
+* @brief Lee la instantánea inicial y el registro.
+* @param startFile instantánea binaria del simulador al empezar el registro
+* @param traceFile fichero de registro
+* @param keyframeInterval pasos entre dos fotogramas clave
+* @param keyframeBytes memoria máxima de los fotogramas clave sin contar el inicial
+*/
+TraceReplay::TraceReplay(const std::string& startFile, const std::string& traceFile, std::uint64_t keyframeInterval,
+                         std::uint64_t keyframeBytes)
+    : m_trace(traceFile), m_interval(keyframeInterval == 0 ? kDefaultKeyframeInterval : keyframeInterval),
+      m_budget(keyframeBytes), m_bytes(0), m_clock(0)
+{
+    Simulator start = Simulator::loadSnapshot(startFile);
+    if (start.stepCount() != m_trace.firstStep()) {
+        throw std::invalid_argument(traceFile + ": el registro empieza en el paso " + std::to_string(m_trace.firstStep()) +
+                                    " y la instantánea " + startFile + " es del paso " + std::to_string(start.stepCount()));
+    }
+    start.captureSnapshot(m_keyframes[m_trace.firstStep()].image);
+}
+
+/**
+* @brief Primer paso que se puede reconstruir.
+*/
+std::uint64_t TraceReplay::firstStep() const
+{
+    return m_trace.firstStep();
+}
+
+/**
+* @brief Último paso que se puede reconstruir.
+*/
+std::uint64_t TraceReplay::lastStep() const
+{
+    return m_trace.firstStep() + m_trace.steps();
+}
+
+/**
+* @brief Reconstruye la simulación en el paso 'step' desde el fotograma clave anterior.
+* @param step número de paso
+* @return simulador en ese paso
+*/
+Simulator TraceReplay::seek(std::uint64_t step)
+{
+    if (step < firstStep() || step > lastStep()) {
+        throw std::out_of_range("el paso " + std::to_string(step) + " no está en el registro (" +
+                                std::to_string(firstStep()) + " - " + std::to_string(lastStep()) + ")");
+    }
+    auto keyframe = std::prev(m_keyframes.upper_bound(step));
+    keyframe->second.lastUse = ++m_clock;
+    Simulator sim = Simulator::fromSnapshot(keyframe->second.image);
+    sim.setQuiet(true);
+    std::uint64_t at = keyframe->first;
+    while (at < step) {
+        // Hasta el paso pedido o hasta el siguiente fotograma clave, que se guarda
+        const std::uint64_t next = std::min(step, (at / m_interval + 1) * m_interval);
+        sim.replayTrace(m_trace, at - firstStep(), next - at);
+        at = next;
+        if (at % m_interval == 0 && m_keyframes.find(at) == m_keyframes.end()) {
+            store(at, sim);
+        }
+    }
+    return sim;
+}
+
+/**
+* @brief Guarda el estado de 'sim' como fotograma clave del paso 'step' y descarta los usados
+*        hace más tiempo hasta volver a caber en la memoria fijada. El inicial no se descarta
+*        nunca; un fotograma que no cabe ni solo no se guarda.
+*/
+void TraceReplay::store(std::uint64_t step, const Simulator& sim)
+{
+    // El tamaño solo se conoce al copiarlo (en modo INFINITE depende de las celdas negras)
+    auto added = m_keyframes.emplace(step, Keyframe{ SnapshotImage(), ++m_clock }).first;
+    sim.captureSnapshot(added->second.image);
+    const std::uint64_t size = added->second.image.grid.size() * sizeof(std::uint64_t);
+    if (size > m_budget) {
+        m_keyframes.erase(added);
+        return;
+    }
+    m_bytes += size;
+    while (m_bytes > m_budget) {
+        auto oldest = m_keyframes.end();
+        for (auto it = std::next(m_keyframes.begin()); it != m_keyframes.end(); ++it) {
+            if (oldest == m_keyframes.end() || it->second.lastUse < oldest->second.lastUse) {
+                oldest = it;
+            }
+        }
+        m_bytes -= oldest->second.image.grid.size() * sizeof(std::uint64_t);
+        m_keyframes.erase(oldest);
+    }
+}
+
+/**
+* @brief Fotogramas clave guardados.
+*/
+std::size_t TraceReplay::keyframes() const
+{
+    return m_keyframes.size();
+}
+
+/**
+* @brief Memoria de los fotogramas clave guardados, sin contar el inicial.
+*/
+std::uint64_t TraceReplay::keyframeBytes() const
+{
+    return m_bytes;
+}
@@ -0,0 +1,240 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file StepTrace.h
+ * @brief Registro compacto de los pasos de la hormiga (TraceWriter), su lectura (TraceReader)
+ *        y la reconstrucción de la cinta en cualquier paso (TraceReplay).
+ *
+ * Cada paso se guarda como un código de 2 bits: la orientación de la hormiga después de girar,
+ * que es la dirección en la que se mueve (Ant::Orientation), así que caben 4 pasos por byte y
+ * 32 por palabra de 64 bits (el paso i es el par de bits 2 * (i % 32) de la palabra i / 32).
+ *
+ * Fichero (enteros en el orden de bytes de la máquina):
+ *   TraceHeader
+ *   bloques: TraceChunkHeader seguido de 'words' palabras, sin comprimir o comprimidas
+ *
+ * Cada bloque tiene hasta TraceWriter::kChunkWords palabras. Los comprimidos son una serie de
+ * palabras de control: con el bit 63 a 1, copia 'longitud' (bits 0-31) palabras desde
+ * 'distancia' (bits 32-62) palabras atrás; con el bit 63 a 0, le siguen tantas palabras
+ * literales como indica. Así el recorrido periódico de la autopista ocupa unas pocas palabras.
+ */
+
+#ifndef STEPTRACE_H
+#define STEPTRACE_H
+
+#include "Snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+class Simulator;
+
+/// Cabecera del fichero de registro
+struct TraceHeader {
+    char magic[8];           // "LANGTRCE"
+    std::uint32_t version;   // TraceWriter::kVersion
+    std::uint32_t reserved;
+    std::uint64_t firstStep; // Simulator::stepCount al empezar a registrar
+};
+
+/// Cabecera de un bloque de pasos
+struct TraceChunkHeader {
+    std::uint32_t codes;     // pasos del bloque
+    std::uint32_t encoding;  // TraceWriter::Encoding
+    std::uint64_t words;     // palabras guardadas a continuación
+};
+
+/**
+ * @brief Escribe el registro de pasos en un fichero por bloques. Simulator lo alimenta desde
+ *        sus bucles (ver Simulator::setStepTrace); cada bloque lleno se comprime y se escribe.
+ */
+class TraceWriter {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr unsigned kCodesPerWord = 32;
+    static constexpr std::size_t kChunkWords = 8192; // 262144 pasos por bloque
+
+    /// Codificación de un bloque
+    enum Encoding : std::uint32_t { RAW = 0, REPEAT = 1 };
+
+    /// Códigos que aún no completan una palabra. Los bucles de Simulator la copian a variables
+    /// locales durante un tramo para que las escrituras en la cinta no obliguen a releerla.
+    struct Pending {
+        std::uint64_t bits;
+        unsigned count;
+    };
+
+    /**
+     * @brief Crea el fichero y escribe la cabecera.
+     * @param filename fichero de registro
+     * @param firstStep número de paso del simulador al empezar
+     * @throw std::runtime_error si no se puede crear el fichero
+     */
+    TraceWriter(const std::string& filename, std::uint64_t firstStep);
+
+    /**
+     * @brief Llama a close.
+     */
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /**
+     * @brief Añade un paso.
+     * @param code dirección del movimiento (Ant::Orientation)
+     */
+    void record(unsigned code)
+    {
+        m_pending.bits |= std::uint64_t(code) << (2 * m_pending.count);
+        if (++m_pending.count == kCodesPerWord) {
+            push(m_pending.bits);
+            m_pending = Pending{ 0, 0 };
+        }
+    }
+
+    /**
+     * @brief Añade una palabra completa de kCodesPerWord pasos (ver Pending).
+     */
+    void push(std::uint64_t word)
+    {
+        m_chunk.push_back(word);
+        if (m_chunk.size() == kChunkWords) {
+            writeChunk(static_cast<std::uint32_t>(kChunkWords * kCodesPerWord));
+        }
+    }
+
+    /**
+     * @brief Códigos de la palabra incompleta.
+     */
+    Pending& pending()
+    {
+        return m_pending;
+    }
+
+    /**
+     * @brief Pasos registrados.
+     */
+    std::uint64_t steps() const;
+
+    /**
+     * @brief Escribe los pasos pendientes y cierra el fichero (solo la primera vez).
+     * @return false si alguna escritura ha fallado
+     */
+    bool close();
+
+private:
+    std::ofstream m_out;
+    std::vector<std::uint64_t> m_chunk;
+    Pending m_pending;
+    std::uint64_t m_written; // pasos ya escritos en el fichero
+    bool m_closed;
+
+    void writeChunk(std::uint32_t codes); // Comprime y escribe m_chunk
+};
+
+/**
+ * @brief Lee un fichero de registro completo en memoria (a 4 pasos por byte).
+ */
+class TraceReader {
+public:
+    /**
+     * @brief Lee y descomprime el registro.
+     * @param filename fichero de registro
+     * @throw std::invalid_argument si el fichero no existe o no es un registro válido
+     */
+    explicit TraceReader(const std::string& filename);
+
+    /**
+     * @brief Número de paso del simulador en que empieza el registro.
+     */
+    std::uint64_t firstStep() const;
+
+    /**
+     * @brief Pasos registrados.
+     */
+    std::uint64_t steps() const;
+
+    /**
+     * @brief Dirección del movimiento en el paso i del registro (0 = el primero).
+     */
+    unsigned code(std::uint64_t i) const
+    {
+        return static_cast<unsigned>(m_words[i / TraceWriter::kCodesPerWord] >> (2 * (i % TraceWriter::kCodesPerWord))) & 3;
+    }
+
+private:
+    std::uint64_t m_firstStep;
+    std::uint64_t m_steps;
+    std::vector<std::uint64_t> m_words;
+};
+
+/**
+ * @brief Reconstruye la simulación en cualquier paso a partir de la instantánea inicial y el
+ *        registro. Guarda en memoria una instantánea (fotograma clave) cada 'keyframeInterval'
+ *        pasos por los que pasa, así que buscar un paso solo repite los pasos desde el
+ *        fotograma clave anterior. Los fotogramas clave, salvo el inicial, no pasan de
+ *        'keyframeBytes': al llenarse se descartan los usados hace más tiempo (LRU).
+ */
+class TraceReplay {
+public:
+    static constexpr std::uint64_t kDefaultKeyframeInterval = std::uint64_t(1) << 20;
+    static constexpr std::uint64_t kDefaultKeyframeBytes = std::uint64_t(256) << 20;
+
+    /**
+     * @brief Lee la instantánea inicial y el registro.
+     * @param startFile instantánea binaria del simulador al empezar el registro
+     * @param traceFile fichero de registro
+     * @param keyframeInterval pasos entre dos fotogramas clave
+     * @param keyframeBytes memoria máxima de los fotogramas clave sin contar el inicial (0 = no
+     *        guardar ninguno más)
+     * @throw std::invalid_argument si los ficheros no son válidos o no corresponden
+     */
+    TraceReplay(const std::string& startFile, const std::string& traceFile,
+                std::uint64_t keyframeInterval = kDefaultKeyframeInterval,
+                std::uint64_t keyframeBytes = kDefaultKeyframeBytes);
+
+    /**
+     * @brief Primer y último paso que se pueden reconstruir.
+     */
+    std::uint64_t firstStep() const;
+    std::uint64_t lastStep() const;
+
+    /**
+     * @brief Reconstruye la simulación en el paso 'step'.
+     * @param step número de paso, entre firstStep y lastStep
+     * @return simulador en ese paso
+     * @throw std::out_of_range si el paso no está en el registro
+     * @throw std::invalid_argument si el registro no corresponde a la instantánea
+     */
+    Simulator seek(std::uint64_t step);
+
+    /**
+     * @brief Fotogramas clave guardados.
+     */
+    std::size_t keyframes() const;
+
+    /**
+     * @brief Memoria de los fotogramas clave guardados, sin contar el inicial, en bytes.
+     */
+    std::uint64_t keyframeBytes() const;
+
+private:
+    struct Keyframe {
+        SnapshotImage image;
+        std::uint64_t lastUse; // valor de m_clock la última vez que se usó
+    };
+
+    TraceReader m_trace;
+    std::uint64_t m_interval;
+    std::uint64_t m_budget;                        // memoria máxima de los fotogramas clave
+    std::uint64_t m_bytes;                         // memoria de los guardados (sin el inicial)
+    std::uint64_t m_clock;                         // contador de usos, para el LRU
+    std::map<std::uint64_t, Keyframe> m_keyframes; // por número de paso
+
+    void store(std::uint64_t step, const Simulator& sim); // Guarda un fotograma clave si cabe
+};
+
+#endif
@@ -1,12 +1,16 @@
 /**
  * @author Daniel Palenzuela Álvarez alu0101140469
  * @file Tape.cc
- * @brief Implementación de la clase Tape (cinta bidimensional)
+ * @brief Implementación de la plantilla BasicTape (cinta bidimensional) para las dos
+ *        disposiciones de TapeLayout.h
  */
 
 #include "Tape.h"
+#include "BitKernels.h"
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <utility>
 #include <iomanip>
 
 /**
@@ -14,13 +18,106 @@
 * @param sizeX número de columnas (ancho)
 * @param sizeY número de filas (alto)
 */
-Tape::Tape(unsigned sizeX, unsigned sizeY)
-    : m_sizeX(sizeX), m_sizeY(sizeY), m_grid(sizeY, std::vector<bool>(sizeX, false))
+template <class Layout>
+BasicTape<Layout>::BasicTape(unsigned sizeX, unsigned sizeY)
+    : m_sizeX(sizeX), m_sizeY(sizeY), m_stride((static_cast<std::size_t>(sizeX) + 63) / 64),
+      m_layout(sizeX, sizeY), m_bits(nullptr)
 {
     if (sizeX == 0 || sizeY == 0) {
         // Lanzar excepción si el tamaño es inválido
         throw std::invalid_argument("El tamaño de la cinta debe ser mayor que 0");
     }
+    // Reserva todas las celdas en un único bloque, inicialmente blancas
+    m_words.assign(m_layout.wordCount(), 0);
+    m_bits = m_words.data();
+}
+
+/**
+* @brief Cambia el tamaño de la cinta y la deja toda blanca, reutilizando la memoria propia.
+* @param sizeX número de columnas (ancho)
+* @param sizeY número de filas (alto)
+*/
+template <class Layout>
+void BasicTape<Layout>::reset(unsigned sizeX, unsigned sizeY)
+{
+    if (sizeX == 0 || sizeY == 0) {
+        throw std::invalid_argument("El tamaño de la cinta debe ser mayor que 0");
+    }
+    m_sizeX = sizeX;
+    m_sizeY = sizeY;
+    m_stride = (static_cast<std::size_t>(sizeX) + 63) / 64;
+    m_layout = Layout(sizeX, sizeY);
+    m_external.reset();
+    // assign no libera la capacidad reservada, así que no se vuelve a pedir memoria si cabe
+    m_words.assign(m_layout.wordCount(), 0);
+    m_bits = m_words.data();
+}
+
+/**
+* @brief Construye una cinta sobre palabras que ya existen fuera de ella, sin copiarlas.
+* @param sizeX número de columnas (ancho)
+* @param sizeY número de filas (alto)
+* @param words palabras de la cinta
+* @param keepAlive propietario de las palabras
+*/
+template <class Layout>
+BasicTape<Layout>::BasicTape(unsigned sizeX, unsigned sizeY, std::uint64_t* words, std::shared_ptr<void> keepAlive)
+    : m_sizeX(sizeX), m_sizeY(sizeY), m_stride((static_cast<std::size_t>(sizeX) + 63) / 64),
+      m_layout(sizeX, sizeY), m_bits(words), m_external(std::move(keepAlive))
+{
+    if (sizeX == 0 || sizeY == 0) {
+        throw std::invalid_argument("El tamaño de la cinta debe ser mayor que 0");
+    }
+    if (!words) {
+        throw std::invalid_argument("Tape: palabras externas nulas");
+    }
+}
+
+/**
+* @brief Copia la cinta; las palabras se copian siempre a memoria propia.
+*/
+template <class Layout>
+BasicTape<Layout>::BasicTape(const BasicTape& other)
+    : m_sizeX(other.m_sizeX), m_sizeY(other.m_sizeY), m_stride(other.m_stride), m_layout(other.m_layout),
+      m_words(other.m_bits, other.m_bits + other.m_layout.wordCount()), m_bits(m_words.data())
+{
+}
+
+/**
+* @brief Mueve la cinta, conservando las palabras externas si las hay.
+*/
+template <class Layout>
+BasicTape<Layout>::BasicTape(BasicTape&& other) noexcept
+    : m_sizeX(other.m_sizeX), m_sizeY(other.m_sizeY), m_stride(other.m_stride), m_layout(other.m_layout),
+      m_words(std::move(other.m_words)), m_bits(other.m_bits), m_external(std::move(other.m_external))
+{
+    if (!m_external) {
+        m_bits = m_words.data();
+    }
+    other.m_bits = nullptr;
+}
+
+template <class Layout>
+BasicTape<Layout>& BasicTape<Layout>::operator=(const BasicTape& other)
+{
+    if (this != &other) {
+        *this = BasicTape(other);
+    }
+    return *this;
+}
+
+template <class Layout>
+BasicTape<Layout>& BasicTape<Layout>::operator=(BasicTape&& other) noexcept
+{
+    m_sizeX = other.m_sizeX;
+    m_sizeY = other.m_sizeY;
+    m_stride = other.m_stride;
+    m_layout = other.m_layout;
+    m_words = std::move(other.m_words);
+    m_external = std::move(other.m_external);
+    m_bits = m_external ? other.m_bits : m_words.data();
+    other.m_bits = nullptr;
+    return *this;
 }
 
 /**
@@ -29,13 +126,14 @@ Tape::Tape(unsigned sizeX, unsigned sizeY)
 * @param y coordenada Y (0..sizeY-1)
 * @return bool estado de la celda
 */
-bool Tape::get(unsigned x, unsigned y) const
+template <class Layout>
+bool BasicTape<Layout>::get(unsigned x, unsigned y) const
 {
     if (x >= m_sizeX || y >= m_sizeY) {
         // Lanzar excepción si las coordenadas están fuera de rango
         throw std::out_of_range("Tape::get: coordenadas fuera de rango");
     }
-    return m_grid[y][x];
+    return getUnchecked(x, y);
 }
 
 /**
@@ -44,13 +142,14 @@ bool Tape::get(unsigned x, unsigned y) const
 * @param y coordenada Y
 * @param value nuevo valor
 */
-void Tape::set(unsigned x, unsigned y, bool value)
+template <class Layout>
+void BasicTape<Layout>::set(unsigned x, unsigned y, bool value)
 {
     if (x >= m_sizeX || y >= m_sizeY) {
         // Lanzar excepción si las coordenadas están fuera de rango
         throw std::out_of_range("Tape::set: coordenadas fuera de rango");
     }
-    m_grid[y][x] = value;
+    setUnchecked(x, y, value);
 }
 
 /**
@@ -59,16 +158,18 @@ void Tape::set(unsigned x, unsigned y, bool value)
 * @param y coordenada Y
 * @return true si está dentro
 */
-bool Tape::isInside(int x, int y) const
+template <class Layout>
+bool BasicTape<Layout>::isInside(std::int64_t x, std::int64_t y) const
 {
-    return x >= 0 && y >= 0 && static_cast<unsigned>(x) < m_sizeX && static_cast<unsigned>(y) < m_sizeY;
+    return x >= 0 && y >= 0 && x < static_cast<std::int64_t>(m_sizeX) && y < static_cast<std::int64_t>(m_sizeY);
 }
 
 /**
 * @brief Obtiene el ancho (sizeX)
 * @return ancho
 */
-unsigned Tape::width() const
+template <class Layout>
+unsigned BasicTape<Layout>::width() const
 {
     return m_sizeX;
 }
@@ -77,7 +178,8 @@ unsigned Tape::width() const
 * @brief Obtiene la altura (sizeY)
 * @return alto
 */
-unsigned Tape::height() const
+template <class Layout>
+unsigned BasicTape<Layout>::height() const
 {
     return m_sizeY;
 }
@@ -88,25 +190,402 @@ unsigned Tape::height() const
 * @param y coordenada Y
 * @return char representación textual
 */
-char Tape::cellChar(unsigned x, unsigned y) const
+template <class Layout>
+char BasicTape<Layout>::cellChar(unsigned x, unsigned y) const
 {
     return get(x, y) ? 'X' : ' ';
 }
 
+namespace {
+
+const char kSymbols[2] = { ' ', 'X' };
+
+// Caracteres de 'count' celdas de una fila en formato fila a fila a partir de x0
+void renderBits(const std::uint64_t* row, unsigned x0, unsigned count, char* out)
+{
+    unsigned i = 0;
+    // Celda a celda hasta el principio de una palabra, las palabras completas de una vez
+    // (BitKernels::expand) y celda a celda el final
+    for (; i < count && ((x0 + i) & 63u) != 0; ++i) {
+        unsigned x = x0 + i;
+        out[i] = kSymbols[(row[x >> 6] >> (x & 63u)) & 1u];
+    }
+    const unsigned full = (count - i) / 64;
+    if (full > 0) {
+        BitKernels::expand(row + ((x0 + i) >> 6), full, out + i, kSymbols[0], kSymbols[1]);
+        i += full * 64;
+    }
+    for (; i < count; ++i) {
+        unsigned x = x0 + i;
+        out[i] = kSymbols[(row[x >> 6] >> (x & 63u)) & 1u];
+    }
+}
+
+// Bits [from, to) de una palabra (0 <= from < to <= 64)
+std::uint64_t bitRange(unsigned from, unsigned to)
+{
+    return (to - from == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << (to - from)) - 1) << from;
+}
+
+} // namespace
+
+/**
+* @brief Escribe los caracteres de 'count' celdas de la fila y a partir de x0.
+* @param y fila
+* @param x0 primera columna
+* @param count número de celdas
+* @param out buffer de salida
+*/
+template <class Layout>
+void BasicTape<Layout>::renderRow(unsigned y, unsigned x0, unsigned count, char* out) const
+{
+    if constexpr (Layout::kRowMajor) {
+        renderBits(m_bits + static_cast<std::size_t>(y) * m_stride, x0, count, out);
+    } else {
+        // La fila está repartida por bloques: se junta primero en formato fila a fila
+        std::vector<std::uint64_t> row(m_stride);
+        readRow(y, row.data());
+        renderBits(row.data(), x0, count, out);
+    }
+}
+
+/**
+* @brief Cuenta las celdas negras de un rectángulo dentro de la cinta.
+* @param x0 primera columna
+* @param y0 primera fila
+* @param w ancho
+* @param h alto
+* @return número de celdas negras
+*/
+template <class Layout>
+std::uint64_t BasicTape<Layout>::countBlack(unsigned x0, unsigned y0, unsigned w, unsigned h) const
+{
+    if (w == 0 || h == 0) {
+        return 0;
+    }
+    if constexpr (!Layout::kRowMajor) {
+        // Toda la cinta: las palabras fuera de ella están siempre a 0
+        if (x0 == 0 && y0 == 0 && w == m_sizeX && h == m_sizeY) {
+            return BitKernels::popcount(m_bits, m_layout.wordCount());
+        }
+        // Bloque a bloque, con una máscara de las columnas y las filas del bloque que caen dentro
+        std::uint64_t count = 0;
+        for (unsigned by = y0 / 8; by <= (y0 + h - 1) / 8; ++by) {
+            const unsigned rowFrom = std::max(y0, by * 8) - by * 8;
+            const unsigned rowTo = std::min(y0 + h, by * 8 + 8) - by * 8;
+            const std::uint64_t rows = bitRange(rowFrom * 8, rowTo * 8);
+            for (unsigned bx = x0 / 8; bx <= (x0 + w - 1) / 8; ++bx) {
+                const unsigned colFrom = std::max(x0, bx * 8) - bx * 8;
+                const unsigned colTo = std::min(x0 + w, bx * 8 + 8) - bx * 8;
+                const std::uint64_t mask = (bitRange(colFrom, colTo) * 0x0101010101010101ull) & rows;
+                count += static_cast<std::uint64_t>(__builtin_popcountll(m_bits[blockWord(bx, by)] & mask));
+            }
+        }
+        return count;
+    } else {
+        // Filas completas de palabras completas: son contiguas, así que se cuentan de una vez
+        if (x0 == 0 && w == m_sizeX && (m_sizeX & 63u) == 0) {
+            return BitKernels::popcount(m_bits + static_cast<std::size_t>(y0) * m_stride, static_cast<std::size_t>(h) * m_stride);
+        }
+        std::uint64_t count = 0;
+        for (unsigned y = y0; y < y0 + h; ++y) {
+            const std::uint64_t* row = m_bits + static_cast<std::size_t>(y) * m_stride;
+            // Recorre el tramo [x0, x0+w) de la fila: las palabras completas con BitKernels::popcount
+            // y los trozos de palabra de los extremos con una máscara
+            unsigned x = x0;
+            while (x < x0 + w) {
+                unsigned bit = x & 63u;
+                if (bit == 0 && x0 + w - x >= 64) {
+                    const unsigned full = (x0 + w - x) / 64;
+                    count += BitKernels::popcount(row + (x >> 6), full);
+                    x += full * 64;
+                    continue;
+                }
+                unsigned n = std::min(64u - bit, x0 + w - x);
+                std::uint64_t mask = (n == 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << n) - 1)) << bit;
+                count += static_cast<std::uint64_t>(__builtin_popcountll(row[x >> 6] & mask));
+                x += n;
+            }
+        }
+        return count;
+    }
+}
+
+/**
+* @brief Bits de la última palabra de cada fila que corresponden a celdas. El resto no se
+*        modifican nunca al simular, pero una instantánea proyectada en memoria podría traerlos.
+*/
+template <class Layout>
+std::uint64_t BasicTape<Layout>::lastWordMask() const
+{
+    const unsigned used = m_sizeX & 63u;
+    return used == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << used) - 1;
+}
+
+/**
+* @brief Palabra del bloque de 8x8 celdas (bx,by): la de su celda de arriba a la izquierda.
+*/
+template <class Layout>
+std::size_t BasicTape<Layout>::blockWord(unsigned bx, unsigned by) const
+{
+    return static_cast<std::size_t>(m_layout.bitIndex(bx * 8, by * 8) >> 6);
+}
+
+/**
+* @brief Celdas negras (other nulo) o distintas de las de other con la disposición por bloques.
+*        Recorre cada franja de 8 filas juntando antes los bloques no vacíos, para devolver las
+*        celdas fila a fila como la disposición por filas.
+* @param other palabras de otra cinta del mismo tamaño, o nullptr
+* @return pares (x, y)
+*/
+template <class Layout>
+std::vector<std::pair<unsigned, unsigned>> BasicTape<Layout>::blockCells(const std::uint64_t* other) const
+{
+    std::vector<std::pair<unsigned, unsigned>> cells;
+    const unsigned blocksX = (m_sizeX + 7) / 8;
+    const unsigned blocksY = (m_sizeY + 7) / 8;
+    const std::uint64_t lastColumns = bitRange(0, m_sizeX - (blocksX - 1) * 8) * 0x0101010101010101ull;
+    std::vector<std::pair<unsigned, std::uint64_t>> band; // bloques no vacíos de la franja
+    for (unsigned by = 0; by < blocksY; ++by) {
+        band.clear();
+        for (unsigned bx = 0; bx < blocksX; ++bx) {
+            const std::size_t i = blockWord(bx, by);
+            std::uint64_t word = other ? m_bits[i] ^ other[i] : m_bits[i];
+            if (bx == blocksX - 1) {
+                word &= lastColumns;
+            }
+            if (word != 0) {
+                band.emplace_back(bx * 8, word);
+            }
+        }
+        const unsigned rows = std::min(8u, m_sizeY - by * 8);
+        for (unsigned r = 0; r < rows && !band.empty(); ++r) {
+            for (const auto& block : band) {
+                unsigned byte = static_cast<unsigned>(block.second >> (r * 8)) & 0xFFu;
+                while (byte != 0) {
+                    cells.emplace_back(block.first + static_cast<unsigned>(__builtin_ctz(byte)), by * 8 + r);
+                    byte &= byte - 1;
+                }
+            }
+        }
+    }
+    return cells;
+}
+
+/**
+* @brief Coordenadas de las celdas negras, fila a fila.
+* @return pares (x, y)
+*/
+template <class Layout>
+std::vector<std::pair<unsigned, unsigned>> BasicTape<Layout>::blackCells() const
+{
+    if constexpr (!Layout::kRowMajor) {
+        return blockCells(nullptr);
+    } else {
+        std::vector<std::pair<unsigned, unsigned>> cells;
+        const std::size_t total = m_stride * m_sizeY;
+        const std::uint64_t lastMask = lastWordMask();
+        std::size_t i = BitKernels::firstNonZero(m_bits, total);
+        while (i < total) {
+            const unsigned y = static_cast<unsigned>(i / m_stride);
+            const std::size_t column = i % m_stride;
+            std::uint64_t word = m_bits[i];
+            if (column == m_stride - 1) {
+                word &= lastMask;
+            }
+            const unsigned xBase = static_cast<unsigned>(column * 64);
+            while (word != 0) {
+                cells.emplace_back(xBase + static_cast<unsigned>(__builtin_ctzll(word)), y);
+                word &= word - 1;
+            }
+            // En las cintas densas la siguiente palabra casi nunca está vacía
+            ++i;
+            if (i < total && m_bits[i] == 0) {
+                i += BitKernels::firstNonZero(m_bits + i, total - i);
+            }
+        }
+        return cells;
+    }
+}
+
+/**
+* @brief Celdas que difieren de las de otra cinta del mismo tamaño.
+* @param other otra cinta
+* @return pares (x, y)
+*/
+template <class Layout>
+std::vector<std::pair<unsigned, unsigned>> BasicTape<Layout>::diff(const BasicTape& other) const
+{
+    if (m_sizeX != other.m_sizeX || m_sizeY != other.m_sizeY) {
+        throw std::invalid_argument("Tape::diff: las cintas tienen tamaños distintos");
+    }
+    if constexpr (!Layout::kRowMajor) {
+        return blockCells(other.m_bits);
+    } else {
+        std::vector<std::pair<unsigned, unsigned>> cells;
+        const std::size_t total = m_stride * m_sizeY;
+        const std::uint64_t lastMask = lastWordMask();
+        std::size_t i = BitKernels::firstDifference(m_bits, other.m_bits, total);
+        while (i < total) {
+            const unsigned y = static_cast<unsigned>(i / m_stride);
+            const std::size_t column = i % m_stride;
+            std::uint64_t word = m_bits[i] ^ other.m_bits[i];
+            if (column == m_stride - 1) {
+                word &= lastMask;
+            }
+            const unsigned xBase = static_cast<unsigned>(column * 64);
+            while (word != 0) {
+                cells.emplace_back(xBase + static_cast<unsigned>(__builtin_ctzll(word)), y);
+                word &= word - 1;
+            }
+            ++i;
+            i += BitKernels::firstDifference(m_bits + i, other.m_bits + i, total - i);
+        }
+        return cells;
+    }
+}
+
+/**
+* @brief Indica si otra cinta tiene el mismo tamaño y las mismas celdas.
+* @param other otra cinta
+* @return true si son iguales
+*/
+template <class Layout>
+bool BasicTape<Layout>::sameCells(const BasicTape& other) const
+{
+    if (m_sizeX != other.m_sizeX || m_sizeY != other.m_sizeY) {
+        return false;
+    }
+    if constexpr (!Layout::kRowMajor) {
+        // Las palabras propias no traen nunca bits fuera de la cinta
+        const std::size_t total = m_layout.wordCount();
+        return BitKernels::firstDifference(m_bits, other.m_bits, total) == total;
+    } else {
+        const std::size_t total = m_stride * m_sizeY;
+        const std::uint64_t lastMask = lastWordMask();
+        std::size_t i = BitKernels::firstDifference(m_bits, other.m_bits, total);
+        while (i < total) {
+            // Solo cuentan las diferencias en bits que son celdas
+            if (i % m_stride != m_stride - 1 || ((m_bits[i] ^ other.m_bits[i]) & lastMask) != 0) {
+                return false;
+            }
+            ++i;
+            i += BitKernels::firstDifference(m_bits + i, other.m_bits + i, total - i);
+        }
+        return true;
+    }
+}
+
+/**
+* @brief Copia la fila y en formato fila a fila.
+* @param y fila
+* @param out stride() palabras
+*/
+template <class Layout>
+void BasicTape<Layout>::readRow(unsigned y, std::uint64_t* out) const
+{
+    if constexpr (Layout::kRowMajor) {
+        const std::uint64_t* row = m_bits + static_cast<std::size_t>(y) * m_stride;
+        std::copy(row, row + m_stride, out);
+        out[m_stride - 1] &= lastWordMask();
+    } else {
+        // Cada palabra de salida junta la misma fila de 8 bloques consecutivos
+        const unsigned blocksX = (m_sizeX + 7) / 8;
+        const unsigned shift = (y & 7u) * 8;
+        std::fill(out, out + m_stride, 0);
+        for (unsigned bx = 0; bx < blocksX; ++bx) {
+            const std::uint64_t byte = (m_bits[blockWord(bx, y / 8)] >> shift) & 0xFFu;
+            out[bx / 8] |= byte << ((bx & 7u) * 8);
+        }
+        out[m_stride - 1] &= lastWordMask();
+    }
+}
+
+/**
+* @brief Escribe la fila y desde el formato fila a fila.
+* @param y fila
+* @param row stride() palabras
+*/
+template <class Layout>
+void BasicTape<Layout>::writeRow(unsigned y, const std::uint64_t* row)
+{
+    if constexpr (Layout::kRowMajor) {
+        std::uint64_t* dest = m_bits + static_cast<std::size_t>(y) * m_stride;
+        std::copy(row, row + m_stride - 1, dest);
+        dest[m_stride - 1] = row[m_stride - 1] & lastWordMask();
+    } else {
+        const unsigned blocksX = (m_sizeX + 7) / 8;
+        const unsigned shift = (y & 7u) * 8;
+        const std::uint64_t keep = ~(std::uint64_t(0xFF) << shift);
+        for (unsigned bx = 0; bx < blocksX; ++bx) {
+            std::uint64_t byte = (row[bx / 8] >> ((bx & 7u) * 8)) & 0xFFu;
+            if (bx == blocksX - 1) {
+                byte &= bitRange(0, m_sizeX - bx * 8);
+            }
+            std::uint64_t& word = m_bits[blockWord(bx, y / 8)];
+            word = (word & keep) | (byte << shift);
+        }
+    }
+}
+
+/**
+* @brief Copia toda la cinta fila a fila.
+* @param out stride() * height() palabras
+*/
+template <class Layout>
+void BasicTape<Layout>::readRows(std::uint64_t* out) const
+{
+    if constexpr (Layout::kRowMajor) {
+        // Ya están en ese formato: se copian de una vez
+        std::copy(m_bits, m_bits + m_stride * m_sizeY, out);
+    } else {
+        for (unsigned y = 0; y < m_sizeY; ++y) {
+            readRow(y, out + static_cast<std::size_t>(y) * m_stride);
+        }
+    }
+}
+
+/**
+* @brief Escribe toda la cinta desde el formato fila a fila.
+* @param rows stride() * height() palabras
+*/
+template <class Layout>
+void BasicTape<Layout>::writeRows(const std::uint64_t* rows)
+{
+    for (unsigned y = 0; y < m_sizeY; ++y) {
+        writeRow(y, rows + static_cast<std::size_t>(y) * m_stride);
+    }
+}
+
+/**
+* @brief Nombre de la disposición en memoria.
+*/
+template <class Layout>
+const char* BasicTape<Layout>::layoutName()
+{
+    return Layout::name();
+}
+
 /**
 * @brief Visualiza la cinta en flujo (sin hormiga).
 * @param os flujo de salida
 * @param tape cinta a mostrar
 * @return flujo
 */
-std::ostream& operator<<(std::ostream& os, Tape const& tape)
+template <class Layout>
+std::ostream& operator<<(std::ostream& os, BasicTape<Layout> const& tape)
 {
-    // Imprime cada fila de la cinta, usando cellChar para cada celda
-    for (unsigned y = 0; y < tape.m_sizeY; ++y) {
-        for (unsigned x = 0; x < tape.m_sizeX; ++x) {
-            os << tape.cellChar(x, y);
-        }
-        os << '\n';
+    // Compone la cinta completa fila a fila en un solo buffer y la escribe de una vez
+    const std::size_t lineLength = static_cast<std::size_t>(tape.width()) + 1;
+    std::string frame(lineLength * tape.height(), '\n');
+    for (unsigned y = 0; y < tape.height(); ++y) {
+        tape.renderRow(y, 0, tape.width(), &frame[y * lineLength]);
     }
+    os.write(frame.data(), static_cast<std::streamsize>(frame.size()));
     return os;
 }
+
+template class BasicTape<RowMajorLayout>;
+template class BasicTape<MortonLayout>;
+template std::ostream& operator<<(std::ostream& os, BasicTape<RowMajorLayout> const& tape);
+template std::ostream& operator<<(std::ostream& os, BasicTape<MortonLayout> const& tape);
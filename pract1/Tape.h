@@ -1,25 +1,64 @@
 /**
  * @author Daniel Palenzuela Álvarez alu0101140469
  * @file Tape.h
- * @brief Definición de la clase Tape (cinta bidimensional)
+ * @brief Definición de la plantilla BasicTape (cinta bidimensional) y de Tape, la cinta con la
+ *        disposición elegida al compilar (ver TapeLayout.h)
  */
 
 #ifndef TAPE_H
 #define TAPE_H
 
+#include "TapeLayout.h"
+#include "TapeMemory.h"
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Representa la cinta bidimensional de la hormiga de Langton.
-class Tape {
+// Las celdas se guardan como bits en un único bloque contiguo de palabras de 64 bits, en el
+// orden que marca Layout (RowMajorLayout o MortonLayout). Hacia fuera (instantáneas, fotogramas)
+// las celdas siempre se leen y escriben fila a fila, con cada fila alineada a palabra
+// (stride = ceil(sizeX / 64) palabras): ver readRow y writeRow.
+template <class Layout>
+class BasicTape {
 public:
+    /// Posición de la hormiga en los bucles rápidos (ver cursor)
+    using Cursor = typename Layout::Cursor;
+
     /**
      * @brief Construye una cinta sizeX x sizeY, inicialmente todas blancas (false).
      * @param sizeX número de columnas (ancho)
      * @param sizeY número de filas (alto)
      */
-    Tape(unsigned sizeX, unsigned sizeY);
+    BasicTape(unsigned sizeX, unsigned sizeY);
+
+    /**
+     * @brief Construye una cinta sobre palabras que ya existen fuera de ella (p. ej. un fichero
+     *        proyectado en memoria), sin copiarlas. Deben seguir el formato de data().
+     * @param sizeX número de columnas (ancho)
+     * @param sizeY número de filas (alto)
+     * @param words wordCount() palabras, modificables
+     * @param keepAlive propietario de las palabras, que se mantiene vivo mientras exista la cinta
+     */
+    BasicTape(unsigned sizeX, unsigned sizeY, std::uint64_t* words, std::shared_ptr<void> keepAlive);
+
+    /**
+     * @brief Cambia el tamaño de la cinta y la deja toda blanca, reutilizando la memoria
+     *        propia si cabe (las palabras externas se dejan de usar).
+     * @param sizeX número de columnas (ancho)
+     * @param sizeY número de filas (alto)
+     */
+    void reset(unsigned sizeX, unsigned sizeY);
+
+    // Al copiar una cinta las palabras siempre se copian a memoria propia
+    BasicTape(const BasicTape& other);
+    BasicTape(BasicTape&& other) noexcept;
+    BasicTape& operator=(const BasicTape& other);
+    BasicTape& operator=(BasicTape&& other) noexcept;
 
     /**
      * @brief Obtiene el valor de la celda (x,y), donde true = negra, false = blanca.
@@ -43,7 +82,7 @@ public:
      * @param y coordenada Y
      * @return true si está dentro
      */
-    bool isInside(int x, int y) const;
+    bool isInside(std::int64_t x, std::int64_t y) const;
 
     /**
      * @brief Obtiene el ancho (sizeX)
@@ -66,19 +105,231 @@ public:
     char cellChar(unsigned x, unsigned y) const;
 
     /**
-     * @brief Visualiza la cinta en flujo (sin hormiga).
-     * @param os flujo de salida
-     * @param tape cinta a mostrar
-     * @return flujo
+     * @brief Escribe en out los caracteres (' ' o 'X') de 'count' celdas de la fila y a partir
+     *        de x0, leyendo directamente las palabras de la cinta y sin comprobar límites.
+     * @param y fila (debe ser < height())
+     * @param x0 primera columna (x0 + count debe ser <= width())
+     * @param count número de celdas
+     * @param out buffer de al menos count caracteres
+     */
+    void renderRow(unsigned y, unsigned x0, unsigned count, char* out) const;
+
+    /**
+     * @brief Cuenta las celdas negras del rectángulo [x0, x0+w) x [y0, y0+h) palabra a palabra.
+     *        El rectángulo debe estar dentro de la cinta.
+     * @return número de celdas negras
+     */
+    std::uint64_t countBlack(unsigned x0, unsigned y0, unsigned w, unsigned h) const;
+
+    /**
+     * @brief Coordenadas de las celdas negras, fila a fila. Salta las palabras vacías por
+     *        bloques (BitKernels::firstNonZero).
+     * @return pares (x, y)
+     */
+    std::vector<std::pair<unsigned, unsigned>> blackCells() const;
+
+    /**
+     * @brief Celdas que difieren de las de otra cinta del mismo tamaño, fila a fila.
+     * @param other otra cinta
+     * @return pares (x, y)
+     * @throw std::invalid_argument si los tamaños no coinciden
+     */
+    std::vector<std::pair<unsigned, unsigned>> diff(const BasicTape& other) const;
+
+    /**
+     * @brief Indica si otra cinta tiene el mismo tamaño y las mismas celdas, sin listarlas.
+     * @param other otra cinta
+     * @return true si son iguales
+     */
+    bool sameCells(const BasicTape& other) const;
+
+    /**
+     * @brief Obtiene el valor de la celda (x,y) sin comprobar los límites.
+     *        Pensado para el bucle de simulación, donde la posición ya es válida.
+     * @param x coordenada X (debe ser < width())
+     * @param y coordenada Y (debe ser < height())
+     * @return bool estado de la celda
+     */
+    bool getUnchecked(unsigned x, unsigned y) const;
+
+    /**
+     * @brief Fija el valor de la celda (x,y) sin comprobar los límites.
+     * @param x coordenada X (debe ser < width())
+     * @param y coordenada Y (debe ser < height())
+     * @param value nuevo valor
+     */
+    void setUnchecked(unsigned x, unsigned y, bool value);
+
+    /**
+     * @brief Invierte el valor de la celda (x,y) sin comprobar los límites.
+     * @param x coordenada X (debe ser < width())
+     * @param y coordenada Y (debe ser < height())
+     * @return bool valor que tenía la celda antes de invertirla
+     */
+    bool flipUnchecked(unsigned x, unsigned y);
+
+    /**
+     * @brief Número de palabras de 64 bits de cada fila en el formato fila a fila (readRow,
+     *        writeRow y las instantáneas), sea cual sea la disposición en memoria.
+     * @return stride en palabras
+     */
+    std::size_t stride() const;
+
+    /**
+     * @brief Número de palabras que ocupa la cinta en memoria (las de data()).
+     */
+    std::size_t wordCount() const;
+
+    /**
+     * @brief Índice de bit de la celda (x,y) en data(): es el bit (índice % 64) de la palabra
+     *        índice / 64.
+     * @param x coordenada X (debe ser < width())
+     * @param y coordenada Y (debe ser < height())
+     */
+    std::uint64_t bitIndex(unsigned x, unsigned y) const;
+
+    /**
+     * @brief Posición (x,y) preparada para los bucles de simulación rápidos: bit() es su índice
+     *        de bit y forward/backward la mueven una celda según la orientación, sin comprobar
+     *        los bordes. Deja de ser válida si la cinta cambia de tamaño.
+     * @param x coordenada X (debe estar en la cinta)
+     * @param y coordenada Y (debe estar en la cinta)
+     */
+    Cursor cursor(std::int64_t x, std::int64_t y) const;
+
+    /**
+     * @brief Acceso directo a las palabras de la cinta, para los bucles de simulación rápidos,
+     *        en el orden de Layout (ver bitIndex). Con RowMajorLayout la celda (x,y) es el bit
+     *        (x % 64) de la palabra y * stride() + x / 64.
+     * @return puntero a la primera palabra
+     */
+    std::uint64_t* data();
+    const std::uint64_t* data() const;
+
+    /**
+     * @brief Copia la fila y en formato fila a fila: stride() palabras, con la celda x en el
+     *        bit (x % 64) de la palabra x / 64 y a 0 los bits que sobran al final.
+     * @param y fila (debe ser < height())
+     * @param out stride() palabras
+     */
+    void readRow(unsigned y, std::uint64_t* out) const;
+
+    /**
+     * @brief Escribe la fila y desde el formato de readRow (los bits que sobran se ignoran).
+     * @param y fila (debe ser < height())
+     * @param row stride() palabras
+     */
+    void writeRow(unsigned y, const std::uint64_t* row);
+
+    /**
+     * @brief Copia toda la cinta fila a fila: stride() * height() palabras.
+     */
+    void readRows(std::uint64_t* out) const;
+
+    /**
+     * @brief Escribe toda la cinta desde stride() * height() palabras fila a fila.
+     */
+    void writeRows(const std::uint64_t* rows);
+
+    /**
+     * @brief Nombre de la disposición en memoria ("filas" o "morton").
      */
-    friend std::ostream& operator<<(std::ostream& os, Tape const& tape);
+    static const char* layoutName();
 
 private:
-    // Representación interna de la cinta con un vector de filas, 
-    // cada una un vector de celdas booleanas.
     unsigned m_sizeX;
     unsigned m_sizeY;
-    std::vector< std::vector<bool> > m_grid;
+    std::size_t m_stride;                // Palabras por fila en el formato fila a fila
+    Layout m_layout;                     // Orden de las celdas en m_bits
+    // Palabras propias (vacío si son externas); las grandes salen de TapeMemory
+    std::vector<std::uint64_t, TapeAllocator<std::uint64_t>> m_words;
+    std::uint64_t* m_bits;               // Palabras en uso: m_words.data() o las externas
+    std::shared_ptr<void> m_external;    // Propietario de las palabras externas
+
+    std::uint64_t lastWordMask() const;  // Bits de la última palabra de cada fila que son celdas
+    // Palabra del bloque de 8x8 celdas (bx,by) (solo MortonLayout)
+    std::size_t blockWord(unsigned bx, unsigned by) const;
+    // Celdas negras (other nulo) o distintas de las de other, en orden de filas (solo MortonLayout)
+    std::vector<std::pair<unsigned, unsigned>> blockCells(const std::uint64_t* other) const;
 };
 
+/**
+ * @brief Visualiza la cinta en flujo (sin hormiga).
+ * @param os flujo de salida
+ * @param tape cinta a mostrar
+ * @return flujo
+ */
+template <class Layout>
+std::ostream& operator<<(std::ostream& os, BasicTape<Layout> const& tape);
+
+// Los accesos sin comprobación se definen aquí para que el compilador pueda expandirlos
+// en línea dentro de Ant::step.
+
+template <class Layout>
+inline bool BasicTape<Layout>::getUnchecked(unsigned x, unsigned y) const
+{
+    const std::uint64_t bit = m_layout.bitIndex(x, y);
+    return (m_bits[bit >> 6] >> (bit & 63u)) & 1u;
+}
+
+template <class Layout>
+inline void BasicTape<Layout>::setUnchecked(unsigned x, unsigned y, bool value)
+{
+    const std::uint64_t bit = m_layout.bitIndex(x, y);
+    std::uint64_t& word = m_bits[bit >> 6];
+    std::uint64_t mask = std::uint64_t(1) << (bit & 63u);
+    word = value ? (word | mask) : (word & ~mask);
+}
+
+template <class Layout>
+inline bool BasicTape<Layout>::flipUnchecked(unsigned x, unsigned y)
+{
+    const std::uint64_t bit = m_layout.bitIndex(x, y);
+    std::uint64_t& word = m_bits[bit >> 6];
+    std::uint64_t mask = std::uint64_t(1) << (bit & 63u);
+    bool old = (word & mask) != 0;
+    word ^= mask;
+    return old;
+}
+
+template <class Layout>
+inline std::size_t BasicTape<Layout>::stride() const
+{
+    return m_stride;
+}
+
+template <class Layout>
+inline std::size_t BasicTape<Layout>::wordCount() const
+{
+    return m_layout.wordCount();
+}
+
+template <class Layout>
+inline std::uint64_t BasicTape<Layout>::bitIndex(unsigned x, unsigned y) const
+{
+    return m_layout.bitIndex(x, y);
+}
+
+template <class Layout>
+inline typename BasicTape<Layout>::Cursor BasicTape<Layout>::cursor(std::int64_t x, std::int64_t y) const
+{
+    return Cursor(m_layout, x, y);
+}
+
+template <class Layout>
+inline std::uint64_t* BasicTape<Layout>::data()
+{
+    return m_bits;
+}
+
+template <class Layout>
+inline const std::uint64_t* BasicTape<Layout>::data() const
+{
+    return m_bits;
+}
+
+// Las dos disposiciones se instancian en Tape.cc
+extern template class BasicTape<RowMajorLayout>;
+extern template class BasicTape<MortonLayout>;
+
 #endif
\ No newline at end of file
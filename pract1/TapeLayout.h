@@ -0,0 +1,248 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file TapeLayout.h
+ * @brief Orden de las celdas de la cinta con bordes en memoria: fila a fila (RowMajorLayout) o
+ *        por bloques de 8x8 en orden de Morton (MortonLayout), y el alias Tape que usa el resto
+ *        del programa, que se elige al compilar (make LAYOUT=morton).
+ *
+ * Las dos disposiciones dan a cada celda un índice de bit: la celda es el bit (índice % 64) de la
+ * palabra índice / 64. Fila a fila, cada paso vertical de la hormiga salta una fila entera de
+ * palabras, y en una cinta ancha eso suele ser otra línea de caché y a menudo otra página. En
+ * orden de Morton las 64 celdas de un bloque de 8x8 comparten palabra y los bloques vecinos en
+ * el plano quedan cerca en memoria, a cambio de un índice algo más caro de calcular.
+ */
+
+#ifndef TAPELAYOUT_H
+#define TAPELAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+template <class Layout>
+class BasicTape;
+
+/// Celdas fila a fila: la celda (x,y) es el bit x % 64 de la palabra y * stride + x / 64, con
+/// stride = ceil(ancho / 64) palabras por fila
+class RowMajorLayout {
+public:
+    static constexpr bool kRowMajor = true;  // las palabras ya están en el formato fila a fila
+    static constexpr unsigned kWordRows = 1; // filas que comparten palabra
+
+    RowMajorLayout(unsigned width, unsigned height)
+        : m_stride((static_cast<std::size_t>(width) + 63) / 64), m_height(height)
+    {
+    }
+
+    static const char* name() { return "filas"; }
+
+    /// Palabras que ocupa la cinta
+    std::size_t wordCount() const { return m_stride * m_height; }
+
+    /// Índice de bit de la celda (x,y)
+    std::uint64_t bitIndex(unsigned x, unsigned y) const
+    {
+        return (static_cast<std::uint64_t>(y) * m_stride << 6) + x;
+    }
+
+    /// Posición de la hormiga en los bucles rápidos: el índice de bit, que cada movimiento
+    /// desplaza una cantidad fija según la orientación
+    class Cursor {
+    public:
+        Cursor(const RowMajorLayout& layout, std::int64_t x, std::int64_t y)
+            : m_rowBits(static_cast<std::int64_t>(layout.m_stride) * 64), m_bit(y * m_rowBits + x)
+        {
+        }
+
+        std::uint64_t bit() const { return static_cast<std::uint64_t>(m_bit); }
+        void forward(unsigned orient) { m_bit += delta(orient); }
+        void backward(unsigned orient) { m_bit -= delta(orient); }
+        std::int64_t x() const { return m_bit % m_rowBits; }
+        std::int64_t y() const { return m_bit / m_rowBits; }
+
+    private:
+        std::int64_t m_rowBits;
+        std::int64_t m_bit;
+
+        // Desplazamiento de LEFT, RIGHT, UP y DOWN (-1, 1, -m_rowBits, m_rowBits) sin leer una
+        // tabla: el bit alto de la orientación elige la distancia y el bajo el signo. Así el
+        // paso solo espera a la lectura de la celda, no a otra lectura de memoria detrás.
+        std::int64_t delta(unsigned orient) const
+        {
+            const std::int64_t distance = (orient & 2u) ? m_rowBits : 1;
+            const std::int64_t negate = static_cast<std::int64_t>(orient & 1u) - 1; // 0 o -1
+            return (distance ^ negate) - negate;
+        }
+    };
+
+private:
+    std::size_t m_stride;
+    std::size_t m_height;
+};
+
+/// Bloques de 8x8 celdas, uno por palabra (la celda (x,y) es el bit (y % 8) * 8 + x % 8 de la
+/// palabra de su bloque), en orden de Morton: el número de bloque intercala los bits de x / 8 (posiciones
+/// pares) y de y / 8 (impares). Si la cinta no es cuadrada, los bits que le sobran a la
+/// coordenada más larga van seguidos encima. Hay 2^(bitsX + bitsY) bloques, con bitsX y bitsY
+/// los bits de la última columna y la última fila de bloques: hasta unas 4 veces las palabras
+/// de RowMajorLayout en el peor caso, aunque las que caen fuera de la cinta no se tocan nunca.
+///
+/// El índice de bit de (x,y) es la suma de x repartido por los bits de maskX y de y repartido
+/// por los de maskY (pdep con BMI2). Los bucles rápidos llevan las dos mitades por separado y
+/// las mueven con aritmética de enteros dilatados: ((v | ~mask) + 1) & mask suma 1 y
+/// (v - 1) & mask resta 1 sin separar los bits.
+class MortonLayout {
+public:
+    static constexpr bool kRowMajor = false;
+    static constexpr unsigned kWordRows = 8;
+
+    MortonLayout(unsigned width, unsigned height)
+    {
+        const unsigned bitsX = bitsFor((static_cast<std::uint64_t>(width) + 7) / 8);
+        const unsigned bitsY = bitsFor((static_cast<std::uint64_t>(height) + 7) / 8);
+        m_shared = bitsX < bitsY ? bitsX : bitsY;
+        m_interleaved = 0x5555555555555555ull & ((std::uint64_t(1) << (2 * m_shared)) - 1);
+        const unsigned top = 6 + 2 * m_shared;
+        m_maskX = 0x07 | (m_interleaved << 6) | (((std::uint64_t(1) << (bitsX - m_shared)) - 1) << top);
+        m_maskY = 0x38 | (m_interleaved << 7) | (((std::uint64_t(1) << (bitsY - m_shared)) - 1) << top);
+        m_words = std::size_t(1) << (bitsX + bitsY);
+    }
+
+    static const char* name() { return "morton"; }
+
+    std::size_t wordCount() const { return m_words; }
+
+    std::uint64_t bitIndex(unsigned x, unsigned y) const { return depositX(x) | depositY(y); }
+
+    /// x repartido por los bits de maskX
+    std::uint64_t depositX(std::uint64_t x) const
+    {
+#ifdef __BMI2__
+        return _pdep_u64(x, m_maskX);
+#else
+        const std::uint64_t block = x >> 3;
+        return (x & 7) | (spread(block & lowBits()) << 6) | ((block >> m_shared) << (6 + 2 * m_shared));
+#endif
+    }
+
+    /// y repartido por los bits de maskY
+    std::uint64_t depositY(std::uint64_t y) const
+    {
+#ifdef __BMI2__
+        return _pdep_u64(y, m_maskY);
+#else
+        const std::uint64_t block = y >> 3;
+        return ((y & 7) << 3) | (spread(block & lowBits()) << 7) | ((block >> m_shared) << (6 + 2 * m_shared));
+#endif
+    }
+
+    /// Inversa de depositX
+    std::uint64_t extractX(std::uint64_t bits) const
+    {
+#ifdef __BMI2__
+        return _pext_u64(bits, m_maskX);
+#else
+        return (bits & 7) | (compact((bits >> 6) & m_interleaved) << 3) |
+               ((bits & m_maskX) >> (6 + 2 * m_shared) << (3 + m_shared));
+#endif
+    }
+
+    /// Inversa de depositY
+    std::uint64_t extractY(std::uint64_t bits) const
+    {
+#ifdef __BMI2__
+        return _pext_u64(bits, m_maskY);
+#else
+        return ((bits >> 3) & 7) | (compact((bits >> 7) & m_interleaved) << 3) |
+               ((bits & m_maskY) >> (6 + 2 * m_shared) << (3 + m_shared));
+#endif
+    }
+
+    /// Posición de la hormiga en los bucles rápidos: las dos mitades del índice de bit, que se
+    /// mueven por tabla según la orientación sin volver a repartir las coordenadas
+    class Cursor {
+    public:
+        Cursor(const MortonLayout& layout, std::int64_t x, std::int64_t y)
+            : m_layout(&layout), m_x(layout.depositX(static_cast<std::uint64_t>(x))),
+              m_y(layout.depositY(static_cast<std::uint64_t>(y))), m_maskX(layout.m_maskX), m_maskY(layout.m_maskY),
+              m_fillX{ 0, ~layout.m_maskX, 0, 0 }, m_fillY{ 0, 0, 0, ~layout.m_maskY },
+              m_addX{ ~std::uint64_t(0), 1, 0, 0 }, m_addY{ 0, 0, ~std::uint64_t(0), 1 }
+        {
+        }
+
+        std::uint64_t bit() const { return m_x | m_y; }
+        void forward(unsigned orient)
+        {
+            m_x = ((m_x | m_fillX[orient]) + m_addX[orient]) & m_maskX;
+            m_y = ((m_y | m_fillY[orient]) + m_addY[orient]) & m_maskY;
+        }
+        // LEFT/RIGHT y UP/DOWN solo se diferencian en el último bit
+        void backward(unsigned orient) { forward(orient ^ 1u); }
+        std::int64_t x() const { return static_cast<std::int64_t>(m_layout->extractX(m_x)); }
+        std::int64_t y() const { return static_cast<std::int64_t>(m_layout->extractY(m_y)); }
+
+    private:
+        const MortonLayout* m_layout;
+        std::uint64_t m_x;
+        std::uint64_t m_y;
+        std::uint64_t m_maskX;
+        std::uint64_t m_maskY;
+        std::uint64_t m_fillX[4]; // bits fuera de la máscara que se ponen a 1 para sumar
+        std::uint64_t m_fillY[4];
+        std::uint64_t m_addX[4];  // +1, -1 (todo unos) o 0 según la orientación
+        std::uint64_t m_addY[4];
+    };
+
+private:
+    std::uint64_t m_maskX;
+    std::uint64_t m_maskY;
+    std::uint64_t m_interleaved; // bits pares de la parte intercalada del número de bloque
+    unsigned m_shared;           // bits de bloque que se intercalan en cada coordenada
+    std::size_t m_words;
+
+    // Bits necesarios para numerar n bloques (0 si solo hay uno)
+    static unsigned bitsFor(std::uint64_t n)
+    {
+        return n <= 1 ? 0u : 64u - static_cast<unsigned>(__builtin_clzll(n - 1));
+    }
+
+    std::uint64_t lowBits() const { return (std::uint64_t(1) << m_shared) - 1; }
+
+    // Separa los 32 bits bajos de v dejando un 0 entre cada dos
+    static std::uint64_t spread(std::uint64_t v)
+    {
+        v &= 0xFFFFFFFFull;
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+        v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+        v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        v = (v | (v << 2)) & 0x3333333333333333ull;
+        v = (v | (v << 1)) & 0x5555555555555555ull;
+        return v;
+    }
+
+    // Inversa de spread: junta los bits de las posiciones pares
+    static std::uint64_t compact(std::uint64_t v)
+    {
+        v &= 0x5555555555555555ull;
+        v = (v | (v >> 1)) & 0x3333333333333333ull;
+        v = (v | (v >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+        v = (v | (v >> 4)) & 0x00FF00FF00FF00FFull;
+        v = (v | (v >> 8)) & 0x0000FFFF0000FFFFull;
+        v = (v | (v >> 16)) & 0x00000000FFFFFFFFull;
+        return v;
+    }
+};
+
+/// Disposición de la cinta que usa Simulator (langton_bench mide las dos con su mismo bucle,
+/// Ant::runLangton)
+#ifdef LANGTON_MORTON
+using TapeLayout = MortonLayout;
+#else
+using TapeLayout = RowMajorLayout;
+#endif
+
+using Tape = BasicTape<TapeLayout>;
+
+#endif
@@ -0,0 +1,362 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file TapeMemory.cc
+ * @brief Implementación de TapeMemory (bloques proyectados con páginas grandes y reutilizados)
+ *        y de TileArena (reparto de trozos por bloques).
+ */
+
+#include "TapeMemory.h"
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+// Alineación de los bloques pedidos con operator new (una línea de caché)
+constexpr std::align_val_t kSmallAlignment{ 64 };
+
+// Estado compartido de TapeMemory, protegido por 'mutex'
+struct Pool {
+    std::mutex mutex;
+    TapeMemory::HugePages hugePages = TapeMemory::OFF;
+    std::size_t cacheLimit = TapeMemory::kDefaultCacheLimit;
+    std::unordered_map<void*, std::size_t> live; // bloque proyectado en uso -> bytes proyectados
+    std::multimap<std::size_t, void*> cached;    // bytes proyectados -> bloque guardado
+    TapeMemory::Stats stats;
+};
+
+Pool& pool()
+{
+    static Pool instance;
+    return instance;
+}
+
+std::size_t pageBytes()
+{
+    static const std::size_t bytes = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return bytes;
+}
+
+std::size_t roundUp(std::size_t bytes, std::size_t unit)
+{
+    return (bytes + unit - 1) / unit * unit;
+}
+
+// Proyecta 'bytes' bytes anónimos con las páginas de 'mode' (nullptr si no hay memoria)
+void* mapBlock(std::size_t bytes, TapeMemory::HugePages mode, TapeMemory::Stats& stats)
+{
+#ifdef MAP_HUGETLB
+    if (mode == TapeMemory::RESERVED) {
+        void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (block != MAP_FAILED) {
+            return block;
+        }
+        // No quedan páginas grandes reservadas (o el sistema no tiene): se piden transparentes
+        ++stats.hugeFallbacks;
+    }
+#else
+    if (mode == TapeMemory::RESERVED) {
+        ++stats.hugeFallbacks;
+    }
+#endif
+    void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) {
+        return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    if (mode != TapeMemory::OFF) {
+        // Solo es un consejo: si el sistema no usa páginas grandes transparentes no pasa nada
+        madvise(block, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return block;
+}
+
+// Devuelve al sistema los bloques guardados hasta dejar como mucho 'limit' bytes (con el cerrojo)
+void shrinkCache(Pool& p, std::size_t limit)
+{
+    // Primero los más grandes, que son los que menos probabilidades tienen de volver a servir
+    while (p.stats.cachedBytes > limit && !p.cached.empty()) {
+        auto largest = std::prev(p.cached.end());
+        munmap(largest->second, largest->first);
+        p.stats.cachedBytes -= largest->first;
+        p.cached.erase(largest);
+    }
+}
+
+} // namespace
+
+/**
+* @brief Elige las páginas de los bloques que se proyecten a partir de ahora. Los bloques
+*        guardados se descartan, porque se proyectaron con las páginas anteriores.
+* @param mode páginas
+*/
+void TapeMemory::setHugePages(HugePages mode)
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    if (mode != p.hugePages) {
+        shrinkCache(p, 0);
+        p.hugePages = mode;
+    }
+}
+
+TapeMemory::HugePages TapeMemory::hugePages()
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    return p.hugePages;
+}
+
+/**
+* @brief Nombre de un modo de páginas.
+*/
+const char* TapeMemory::name(HugePages mode)
+{
+    switch (mode) {
+    case ADVISE:
+        return "thp";
+    case RESERVED:
+        return "hugetlb";
+    default:
+        return "off";
+    }
+}
+
+/**
+* @brief Modo de páginas a partir de su nombre ("off", "thp" o "hugetlb").
+*/
+TapeMemory::HugePages TapeMemory::parse(const char* text)
+{
+    const std::string value(text);
+    if (value == "off") {
+        return OFF;
+    }
+    if (value == "thp") {
+        return ADVISE;
+    }
+    if (value == "hugetlb") {
+        return RESERVED;
+    }
+    throw std::invalid_argument("páginas grandes no válidas: " + value + " (off, thp o hugetlb)");
+}
+
+/**
+* @brief Cambia el máximo de bytes liberados que se guardan para reutilizar.
+* @param bytes límite (0 = no se guarda nada)
+*/
+void TapeMemory::setCacheLimit(std::size_t bytes)
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    p.cacheLimit = bytes;
+    shrinkCache(p, bytes);
+}
+
+std::size_t TapeMemory::cacheLimit()
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    return p.cacheLimit;
+}
+
+/**
+* @brief Devuelve al sistema todos los bloques guardados.
+*/
+void TapeMemory::trim()
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    shrinkCache(p, 0);
+}
+
+/**
+* @brief Reserva un bloque: con operator new si es pequeño; si no, uno guardado de tamaño
+*        parecido o uno nuevo proyectado con mmap.
+* @param bytes tamaño pedido
+* @return bloque sin inicializar
+*/
+void* TapeMemory::allocate(std::size_t bytes)
+{
+    if (bytes < kMinMappedBytes) {
+        return ::operator new(bytes == 0 ? 1 : bytes, kSmallAlignment);
+    }
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    const std::size_t unit = p.hugePages == OFF ? pageBytes() : kHugePageBytes;
+    const std::size_t mapped = roundUp(bytes, unit);
+    // El bloque guardado más pequeño que sirve, si no desperdicia más de la mitad
+    auto it = p.cached.lower_bound(mapped);
+    if (it != p.cached.end() && it->first / 2 <= mapped) {
+        void* block = it->second;
+        p.live.emplace(block, it->first);
+        p.stats.cachedBytes -= it->first;
+        p.stats.mappedBytes += it->first;
+        ++p.stats.reuses;
+        p.cached.erase(it);
+        return block;
+    }
+    void* block = mapBlock(mapped, p.hugePages, p.stats);
+    if (!block) {
+        // Quizá lo guardado es lo que falta: se devuelve y se intenta otra vez
+        shrinkCache(p, 0);
+        block = mapBlock(mapped, p.hugePages, p.stats);
+        if (!block) {
+            throw std::bad_alloc();
+        }
+    }
+    p.live.emplace(block, mapped);
+    p.stats.mappedBytes += mapped;
+    ++p.stats.maps;
+    return block;
+}
+
+/**
+* @brief Libera un bloque: los proyectados se guardan para reutilizarlos si caben en el límite.
+* @param block bloque de allocate
+* @param bytes tamaño con el que se pidió
+*/
+void TapeMemory::deallocate(void* block, std::size_t bytes) noexcept
+{
+    if (!block) {
+        return;
+    }
+    if (bytes < kMinMappedBytes) {
+        ::operator delete(block, kSmallAlignment);
+        return;
+    }
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    auto it = p.live.find(block);
+    if (it == p.live.end()) {
+        return;
+    }
+    const std::size_t mapped = it->second;
+    p.live.erase(it);
+    p.stats.mappedBytes -= mapped;
+    if (mapped <= p.cacheLimit) {
+        p.cached.emplace(mapped, block);
+        p.stats.cachedBytes += mapped;
+        shrinkCache(p, p.cacheLimit);
+    } else {
+        munmap(block, mapped);
+    }
+}
+
+/**
+* @brief Estado de los bloques y fallos de página del proceso.
+*/
+TapeMemory::Stats TapeMemory::stats()
+{
+    Stats s;
+    {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        s = p.stats;
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        s.minorFaults = static_cast<std::uint64_t>(usage.ru_minflt);
+        s.majorFaults = static_cast<std::uint64_t>(usage.ru_majflt);
+    }
+    return s;
+}
+
+/**
+* @brief Prepara el reparto de trozos de pieceBytes bytes.
+* @param pieceBytes tamaño de cada trozo
+*/
+TileArena::TileArena(std::size_t pieceBytes)
+    : m_pieceBytes(pieceBytes), m_piecesPerBlock(0), m_current(0), m_used(0)
+{
+    if (pieceBytes == 0 || pieceBytes % 64 != 0 || pieceBytes > kBlockBytes) {
+        throw std::invalid_argument("TileArena: tamaño de trozo no válido");
+    }
+    m_piecesPerBlock = kBlockBytes / pieceBytes;
+}
+
+TileArena::~TileArena()
+{
+    release();
+}
+
+TileArena::TileArena(TileArena&& other) noexcept
+    : m_pieceBytes(other.m_pieceBytes), m_piecesPerBlock(other.m_piecesPerBlock),
+      m_blocks(std::move(other.m_blocks)), m_current(other.m_current), m_used(other.m_used)
+{
+    other.m_blocks.clear();
+    other.m_current = 0;
+    other.m_used = 0;
+}
+
+TileArena& TileArena::operator=(TileArena&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_pieceBytes = other.m_pieceBytes;
+        m_piecesPerBlock = other.m_piecesPerBlock;
+        m_blocks = std::move(other.m_blocks);
+        m_current = other.m_current;
+        m_used = other.m_used;
+        other.m_blocks.clear();
+        other.m_current = 0;
+        other.m_used = 0;
+    }
+    return *this;
+}
+
+/**
+* @brief Un trozo nuevo: el siguiente del bloque actual, o el primero del siguiente bloque
+*        (reservándolo si hace falta).
+*/
+void* TileArena::allocate()
+{
+    if (m_blocks.empty() || m_used == m_piecesPerBlock) {
+        const std::size_t next = m_blocks.empty() ? 0 : m_current + 1;
+        if (next == m_blocks.size()) {
+            // reserve antes de pedir el bloque, para que push_back no pueda fallar con él
+            m_blocks.reserve(next + 1);
+            m_blocks.push_back(TapeMemory::allocate(kBlockBytes));
+        }
+        m_current = next;
+        m_used = 0;
+    }
+    return static_cast<char*>(m_blocks[m_current]) + m_used++ * m_pieceBytes;
+}
+
+/**
+* @brief Da por libres todos los trozos, conservando los bloques.
+*/
+void TileArena::reset()
+{
+    m_current = 0;
+    m_used = 0;
+}
+
+/**
+* @brief Bytes de los bloques reservados.
+*/
+std::size_t TileArena::reservedBytes() const
+{
+    return m_blocks.size() * kBlockBytes;
+}
+
+/**
+* @brief Devuelve los bloques a TapeMemory.
+*/
+void TileArena::release() noexcept
+{
+    for (void* block : m_blocks) {
+        TapeMemory::deallocate(block, kBlockBytes);
+    }
+    m_blocks.clear();
+    m_current = 0;
+    m_used = 0;
+}
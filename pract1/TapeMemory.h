@@ -0,0 +1,191 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file TapeMemory.h
+ * @brief Memoria de las cintas: bloques grandes proyectados con mmap, con páginas grandes si se
+ *        piden y reutilizados entre simulaciones (TapeMemory), el asignador de los vectores de
+ *        las cintas (TapeAllocator) y el reparto de baldosas por bloques (TileArena).
+ *
+ * Las cintas de varios GB, reservadas con new, usan páginas de 4 KB: la hormiga salta de una a
+ * otra y cada salto puede fallar en la TLB. Con páginas de 2 MB la TLB cubre 512 veces más
+ * cinta. Los bloques que se liberan se guardan (hasta un límite) para la siguiente cinta, así
+ * que los conjuntos de simulaciones y los bancos de pruebas no vuelven a pedir ni a fallar en
+ * las mismas páginas en cada ejecución.
+ */
+
+#ifndef TAPEMEMORY_H
+#define TAPEMEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+/**
+ * @brief Bloques de memoria de las cintas, compartidos por todos los hilos.
+ *
+ * Las peticiones de menos de kMinMappedBytes van a operator new; las demás se proyectan con
+ * mmap en múltiplos de página (de 2 MB si hay páginas grandes) y al liberarlas se guardan para
+ * reutilizarlas mientras no se pase de cacheLimit() bytes guardados.
+ */
+class TapeMemory {
+public:
+    /// Páginas de los bloques proyectados
+    enum HugePages {
+        OFF,      // páginas normales
+        ADVISE,   // páginas grandes transparentes (madvise MADV_HUGEPAGE), si el sistema las usa
+        RESERVED  // páginas grandes reservadas (MAP_HUGETLB); si no quedan, como ADVISE
+    };
+
+    /// Bloques más pequeños que esto se piden con operator new
+    static constexpr std::size_t kMinMappedBytes = std::size_t(256) << 10;
+    /// Tamaño de una página grande
+    static constexpr std::size_t kHugePageBytes = std::size_t(2) << 20;
+    /// Límite inicial de la memoria guardada para reutilizar
+    static constexpr std::size_t kDefaultCacheLimit = std::size_t(256) << 20;
+
+    /// Estado de la memoria y del proceso
+    struct Stats {
+        std::uint64_t mappedBytes = 0;   // bytes proyectados en uso
+        std::uint64_t cachedBytes = 0;   // bytes proyectados guardados para reutilizar
+        std::uint64_t maps = 0;          // bloques proyectados con mmap
+        std::uint64_t reuses = 0;        // peticiones servidas con un bloque guardado
+        std::uint64_t hugeFallbacks = 0; // bloques RESERVED que no encontraron páginas grandes
+        std::uint64_t minorFaults = 0;   // fallos de página del proceso sin lectura de disco
+        std::uint64_t majorFaults = 0;   // fallos de página del proceso con lectura de disco
+    };
+
+    /**
+     * @brief Elige las páginas de los bloques que se proyecten a partir de ahora.
+     */
+    static void setHugePages(HugePages mode);
+    static HugePages hugePages();
+
+    /**
+     * @brief Nombre de un modo de páginas ("off", "thp" o "hugetlb").
+     */
+    static const char* name(HugePages mode);
+
+    /**
+     * @brief Modo de páginas a partir de su nombre.
+     * @throw std::invalid_argument si el nombre no es válido
+     */
+    static HugePages parse(const char* text);
+
+    /**
+     * @brief Cambia el máximo de bytes liberados que se guardan para reutilizar (0 = ninguno) y
+     *        devuelve al sistema lo que sobre.
+     */
+    static void setCacheLimit(std::size_t bytes);
+    static std::size_t cacheLimit();
+
+    /**
+     * @brief Devuelve al sistema todos los bloques guardados.
+     */
+    static void trim();
+
+    /**
+     * @brief Reserva 'bytes' bytes alineados a 64 bytes (sin inicializar).
+     * @throw std::bad_alloc si no hay memoria
+     */
+    static void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Libera un bloque de allocate con el mismo tamaño.
+     */
+    static void deallocate(void* block, std::size_t bytes) noexcept;
+
+    /**
+     * @brief Estado actual de los bloques y fallos de página del proceso (getrusage).
+     */
+    static Stats stats();
+};
+
+/**
+ * @brief Asignador para los vectores de las cintas: los pide a TapeMemory, así que las cintas
+ *        grandes usan bloques proyectados y los reutilizan.
+ */
+template <class T>
+struct TapeAllocator {
+    using value_type = T;
+
+    TapeAllocator() = default;
+    template <class U>
+    TapeAllocator(const TapeAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(TapeMemory::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept { TapeMemory::deallocate(p, n * sizeof(T)); }
+
+    template <class U>
+    bool operator==(const TapeAllocator<U>&) const noexcept
+    {
+        return true;
+    }
+    template <class U>
+    bool operator!=(const TapeAllocator<U>&) const noexcept
+    {
+        return false;
+    }
+};
+
+/**
+ * @brief Reparte trozos del mismo tamaño avanzando un puntero por bloques de TapeMemory, en
+ *        lugar de pedir cada uno por separado. Los trozos no se liberan sueltos: reset los da
+ *        todos por libres y conserva los bloques para volver a repartirlos.
+ */
+class TileArena {
+public:
+    /// Bytes de cada bloque (una página grande)
+    static constexpr std::size_t kBlockBytes = TapeMemory::kHugePageBytes;
+
+    /**
+     * @brief Prepara el reparto de trozos de pieceBytes bytes (múltiplo de 64, como mucho
+     *        kBlockBytes), sin reservar nada todavía.
+     */
+    explicit TileArena(std::size_t pieceBytes);
+
+    /**
+     * @brief Devuelve los bloques a TapeMemory.
+     */
+    ~TileArena();
+
+    TileArena(const TileArena&) = delete;
+    TileArena& operator=(const TileArena&) = delete;
+    TileArena(TileArena&& other) noexcept;
+    TileArena& operator=(TileArena&& other) noexcept;
+
+    /**
+     * @brief Un trozo nuevo, sin inicializar, alineado a 64 bytes.
+     * @throw std::bad_alloc si no hay memoria
+     */
+    void* allocate();
+
+    /**
+     * @brief Da por libres todos los trozos, conservando los bloques.
+     */
+    void reset();
+
+    /**
+     * @brief Bytes de los bloques reservados.
+     */
+    std::size_t reservedBytes() const;
+
+private:
+    std::size_t m_pieceBytes;
+    std::size_t m_piecesPerBlock;
+    std::vector<void*> m_blocks; // bloques reservados
+    std::size_t m_current;       // bloque del que se reparte
+    std::size_t m_used;          // trozos repartidos del bloque actual
+
+    void release() noexcept;
+};
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Telemetry.cc
+ * @brief Implementación de Telemetry, que muestrea el progreso de la simulación desde otro hilo
+ *        y lo escribe en líneas JSON.
+ */
+
+#include "Telemetry.h"
+#include "TapeMemory.h"
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+
+// Memoria residente del proceso en bytes (0 si /proc no está disponible)
+std::uint64_t residentBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    std::uint64_t size = 0, resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+} // namespace
+
+/**
+* @brief Empieza a muestrear en otro hilo.
+* @param counters contadores del simulador
+* @param out flujo de salida
+* @param interval tiempo entre dos muestras
+*/
+Telemetry::Telemetry(std::shared_ptr<const TelemetryCounters> counters, std::ostream& out,
+                     std::chrono::milliseconds interval)
+    : m_counters(std::move(counters)), m_out(out), m_interval(interval),
+      m_start(std::chrono::steady_clock::now()), m_lastTime(m_start),
+      m_lastSteps(m_counters->steps.load(std::memory_order_relaxed)),
+      m_lastSwitches(m_counters->tileSwitches.load(std::memory_order_relaxed)), m_stop(false)
+{
+    m_thread = std::thread([this]() { run(); });
+}
+
+Telemetry::~Telemetry()
+{
+    stop();
+}
+
+/**
+* @brief Detiene el hilo y escribe la última muestra.
+*/
+void Telemetry::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) return;
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    sample(true);
+}
+
+/**
+* @brief Bucle del hilo vigilante: una muestra cada intervalo hasta que se llame a stop.
+*/
+void Telemetry::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto next = m_start + m_interval;
+    while (!m_wake.wait_until(lock, next, [this]() { return m_stop; })) {
+        lock.unlock();
+        sample(false);
+        lock.lock();
+        next += m_interval;
+    }
+}
+
+/**
+* @brief Lee los contadores y escribe una línea JSON.
+* @param last true para la muestra final
+*/
+void Telemetry::sample(bool last)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const std::uint64_t steps = m_counters->steps.load(std::memory_order_relaxed);
+    const std::uint64_t switches = m_counters->tileSwitches.load(std::memory_order_relaxed);
+    const double elapsed = std::chrono::duration<double>(now - m_lastTime).count();
+    const double stepRate = elapsed > 0 ? (steps - m_lastSteps) / elapsed : 0.0;
+    const double switchRate = elapsed > 0 ? (switches - m_lastSwitches) / elapsed : 0.0;
+    m_lastTime = now;
+    m_lastSteps = steps;
+    m_lastSwitches = switches;
+    // Bloques de TapeMemory y fallos de página de todo el proceso
+    const TapeMemory::Stats memory = TapeMemory::stats();
+
+    // La línea se compone aparte y se escribe de una vez
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3)
+         << "{\"t\":" << std::chrono::duration<double>(now - m_start).count()
+         << std::defaultfloat << std::setprecision(6)
+         << ",\"steps\":" << steps
+         << ",\"steps_per_s\":" << stepRate
+         << ",\"tape_bytes\":" << m_counters->tapeBytes.load(std::memory_order_relaxed)
+         << ",\"rss_bytes\":" << residentBytes()
+         << ",\"mapped_bytes\":" << memory.mappedBytes
+         << ",\"minor_faults\":" << memory.minorFaults
+         << ",\"major_faults\":" << memory.majorFaults
+         << ",\"tiles\":" << m_counters->tiles.load(std::memory_order_relaxed)
+         << ",\"tile_switches\":" << switches
+         << ",\"tile_switches_per_s\":" << switchRate
+         << ",\"border\":" << (m_counters->borderReached.load(std::memory_order_relaxed) ? "true" : "false");
+    if (last) {
+        line << ",\"final\":true";
+    }
+    line << "}\n";
+    const std::string text = line.str();
+    m_out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    m_out.flush();
+}
@@ -0,0 +1,83 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file Telemetry.h
+ * @brief Definición de Telemetry, que muestrea el progreso de la simulación desde otro hilo y
+ *        lo escribe en líneas JSON.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Contadores que publica Simulator (ver Simulator::publishProgress). Son atómicos porque
+ *        los lee el hilo de Telemetry mientras el simulador avanza; el simulador solo los
+ *        escribe entre tramos de pasos, nunca dentro del bucle interno.
+ */
+struct TelemetryCounters {
+    std::atomic<std::uint64_t> steps{ 0 };        // pasos ejecutados
+    std::atomic<std::uint64_t> tapeBytes{ 0 };    // memoria reservada por las cintas
+    std::atomic<std::uint64_t> tiles{ 0 };        // baldosas de la cinta ilimitada
+    std::atomic<std::uint64_t> tileSwitches{ 0 }; // cambios de baldosa (búsquedas en la tabla)
+    std::atomic<bool> borderReached{ false };
+};
+
+/**
+ * @brief Hilo vigilante que cada 'interval' lee los contadores y escribe una línea JSON con
+ *        el paso actual, los pasos por segundo, la memoria de la cinta y del proceso, los
+ *        fallos de página (ver TapeMemory::stats) y los cambios de baldosa, p. ej.
+ *        {"t":1.000,"steps":123456789,"steps_per_s":1.2e+08,"tape_bytes":131072,...}
+ *        Al detenerse escribe una última línea con "final":true.
+ */
+class Telemetry {
+public:
+    /**
+     * @brief Empieza a muestrear en otro hilo.
+     * @param counters contadores del simulador (ver Simulator::telemetry)
+     * @param out flujo de salida (p. ej. std::cerr o un fichero); debe existir hasta stop
+     * @param interval tiempo entre dos muestras
+     */
+    Telemetry(std::shared_ptr<const TelemetryCounters> counters, std::ostream& out,
+              std::chrono::milliseconds interval);
+
+    /**
+     * @brief Llama a stop.
+     */
+    ~Telemetry();
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    /**
+     * @brief Detiene el hilo y escribe la última muestra (solo la primera vez que se llama).
+     */
+    void stop();
+
+private:
+    std::shared_ptr<const TelemetryCounters> m_counters;
+    std::ostream& m_out;
+    std::chrono::milliseconds m_interval;
+    std::chrono::steady_clock::time_point m_start;
+    // Muestra anterior, para las tasas
+    std::chrono::steady_clock::time_point m_lastTime;
+    std::uint64_t m_lastSteps;
+    std::uint64_t m_lastSwitches;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop;
+    std::thread m_thread;
+
+    void run();                 // Bucle del hilo vigilante
+    void sample(bool last);     // Escribe una línea
+};
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file ThreadPool.cc
+ * @brief Implementación de la clase ThreadPool (hilos persistentes para repartir trabajo en paralelo)
+ */
+
+#include "ThreadPool.h"
+
+/**
+* @brief Crea el conjunto de hilos.
+* @param threads número total de hilos, contando el llamante (0 = número de núcleos)
+*/
+ThreadPool::ThreadPool(unsigned threads)
+    : m_job(nullptr), m_tasks(0), m_next(0), m_generation(0), m_finished(0), m_stop(false)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+    }
+    // El hilo que llama a parallelFor también trabaja, así que se crea uno menos
+    for (unsigned i = 1; i < threads; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+/**
+* @brief Detiene y espera a todos los hilos.
+*/
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_workers) {
+        t.join();
+    }
+}
+
+/**
+* @brief Número total de hilos que trabajan en cada parallelFor (incluido el llamante).
+*/
+unsigned ThreadPool::size() const
+{
+    return static_cast<unsigned>(m_workers.size()) + 1;
+}
+
+/**
+* @brief Ejecuta tareas mientras queden sin asignar.
+*/
+void ThreadPool::runTasks(const std::function<void(unsigned)>& fn, unsigned tasks)
+{
+    for (unsigned i = m_next.fetch_add(1); i < tasks; i = m_next.fetch_add(1)) {
+        fn(i);
+    }
+}
+
+/**
+* @brief Bucle de cada hilo: espera una generación nueva, ayuda con sus tareas y avisa al terminar.
+*/
+void ThreadPool::workerLoop()
+{
+    std::uint64_t seen = 0;
+    while (true) {
+        const std::function<void(unsigned)>* job;
+        unsigned tasks;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+            job = m_job;
+            tasks = m_tasks;
+        }
+        runTasks(*job, tasks);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (++m_finished == m_workers.size()) {
+                m_done.notify_one();
+            }
+        }
+    }
+}
+
+/**
+* @brief Ejecuta fn(0), ..., fn(tasks-1) repartidas entre los hilos y espera a que terminen.
+*/
+void ThreadPool::parallelFor(unsigned tasks, const std::function<void(unsigned)>& fn)
+{
+    if (m_workers.empty() || tasks <= 1) {
+        for (unsigned i = 0; i < tasks; ++i) fn(i);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &fn;
+        m_tasks = tasks;
+        m_next.store(0);
+        m_finished = 0;
+        ++m_generation;
+    }
+    m_wake.notify_all();
+    runTasks(fn, tasks);
+    // Se espera a que todos los hilos hayan pasado por esta generación, de modo que
+    // ninguno pueda seguir tomando tareas cuando empiece la siguiente
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&] { return m_finished == m_workers.size(); });
+}
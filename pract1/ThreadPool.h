@@ -0,0 +1,69 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file ThreadPool.h
+ * @brief Definición de la clase ThreadPool (hilos persistentes para repartir trabajo en paralelo)
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Conjunto de hilos que se crean una vez y se reutilizan en cada parallelFor,
+ *        para no pagar la creación de hilos en cada paso de la simulación.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Crea el conjunto de hilos.
+     * @param threads número total de hilos que trabajan en cada parallelFor, contando el
+     *        hilo que lo llama (0 = número de núcleos de la máquina)
+     */
+    explicit ThreadPool(unsigned threads = 0);
+
+    /**
+     * @brief Detiene y espera a todos los hilos.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Número total de hilos que trabajan en cada parallelFor (incluido el llamante).
+     */
+    unsigned size() const;
+
+    /**
+     * @brief Ejecuta fn(0), ..., fn(tasks-1) repartidas entre los hilos y espera a que terminen.
+     *        El hilo que llama también ejecuta tareas. No debe llamarse desde varios hilos a la vez.
+     * @param tasks número de tareas
+     * @param fn función que recibe el índice de la tarea
+     */
+    void parallelFor(unsigned tasks, const std::function<void(unsigned)>& fn);
+
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake; // avisa a los hilos de que hay trabajo nuevo
+    std::condition_variable m_done; // avisa al llamante de que todos los hilos han terminado
+
+    const std::function<void(unsigned)>* m_job;
+    unsigned m_tasks;
+    std::atomic<unsigned> m_next;   // siguiente tarea sin asignar
+    std::uint64_t m_generation;     // se incrementa en cada parallelFor
+    unsigned m_finished;            // hilos que han terminado la generación actual
+    bool m_stop;
+
+    void workerLoop();
+    void runTasks(const std::function<void(unsigned)>& fn, unsigned tasks);
+};
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file TilePyramid.cc
+ * @brief Implementación de TilePyramid (recuentos por baldosas de la cinta con bordes).
+ */
+
+#include "TilePyramid.h"
+#include <algorithm>
+
+/**
+* @brief Construye una pirámide inactiva.
+*/
+TilePyramid::TilePyramid()
+    : m_active(false), m_stale(true), m_width(0), m_height(0)
+{
+}
+
+/**
+* @brief Marca las baldosas a menos de 'radius' celdas de (x,y).
+* @param x columna
+* @param y fila
+* @param radius distancia en celdas
+*/
+void TilePyramid::touch(std::int64_t x, std::int64_t y, std::uint64_t radius)
+{
+    if (!m_active || m_stale) {
+        return;
+    }
+    const std::int64_t r = static_cast<std::int64_t>(std::min<std::uint64_t>(radius, UINT32_MAX));
+    const std::int64_t tilesX = m_levelWidth[0];
+    const std::int64_t tilesY = m_levelHeight[0];
+    const std::int64_t tx0 = std::max<std::int64_t>(0, (x - r) >> kTileShift);
+    const std::int64_t ty0 = std::max<std::int64_t>(0, (y - r) >> kTileShift);
+    const std::int64_t tx1 = std::min<std::int64_t>(tilesX - 1, (x + r) >> kTileShift);
+    const std::int64_t ty1 = std::min<std::int64_t>(tilesY - 1, (y + r) >> kTileShift);
+    for (std::int64_t ty = ty0; ty <= ty1; ++ty) {
+        for (std::int64_t tx = tx0; tx <= tx1; ++tx) {
+            const std::size_t i = static_cast<std::size_t>(ty * tilesX + tx);
+            if (!m_dirty[i]) {
+                m_dirty[i] = 1;
+                m_dirtyTiles.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+}
+
+/**
+* @brief Pone la pirámide al día con la cinta.
+* @param tape cinta
+*/
+void TilePyramid::refresh(const Tape& tape)
+{
+    m_active = true;
+    if (m_stale || tape.width() != m_width || tape.height() != m_height) {
+        rebuild(tape);
+        return;
+    }
+    // Cada baldosa marcada se vuelve a contar y la diferencia se suma en todos los niveles
+    const unsigned tilesX = m_levelWidth[0];
+    for (std::uint32_t i : m_dirtyTiles) {
+        const unsigned tx = i % tilesX;
+        const unsigned ty = i / tilesX;
+        const std::uint64_t now = countTile(tape, tx, ty);
+        const std::uint64_t before = m_levels[0][i];
+        if (now != before) {
+            for (unsigned k = 0; k < m_levels.size(); ++k) {
+                std::uint64_t& block = m_levels[k][static_cast<std::size_t>(ty >> k) * m_levelWidth[k] + (tx >> k)];
+                block = block - before + now;
+            }
+        }
+        m_dirty[i] = 0;
+    }
+    m_dirtyTiles.clear();
+}
+
+/**
+* @brief Construye la pirámide entera: cuenta cada baldosa y suma los niveles de abajo arriba.
+* @param tape cinta
+*/
+void TilePyramid::rebuild(const Tape& tape)
+{
+    m_width = tape.width();
+    m_height = tape.height();
+    m_levels.clear();
+    m_levelWidth.clear();
+    m_levelHeight.clear();
+    unsigned w = (m_width + kTileSize - 1) / kTileSize;
+    unsigned h = (m_height + kTileSize - 1) / kTileSize;
+    if (w == 0 || h == 0) {
+        w = h = 1;
+    }
+    m_levelWidth.push_back(w);
+    m_levelHeight.push_back(h);
+    m_levels.emplace_back(static_cast<std::size_t>(w) * h);
+    for (unsigned ty = 0; ty < h; ++ty) {
+        for (unsigned tx = 0; tx < w; ++tx) {
+            m_levels[0][static_cast<std::size_t>(ty) * w + tx] = countTile(tape, tx, ty);
+        }
+    }
+    while (w > 1 || h > 1) {
+        const unsigned pw = (w + 1) / 2;
+        const unsigned ph = (h + 1) / 2;
+        std::vector<std::uint64_t> parent(static_cast<std::size_t>(pw) * ph, 0);
+        const std::vector<std::uint64_t>& child = m_levels.back();
+        for (unsigned y = 0; y < h; ++y) {
+            for (unsigned x = 0; x < w; ++x) {
+                parent[static_cast<std::size_t>(y / 2) * pw + x / 2] += child[static_cast<std::size_t>(y) * w + x];
+            }
+        }
+        m_levels.push_back(std::move(parent));
+        m_levelWidth.push_back(pw);
+        m_levelHeight.push_back(ph);
+        w = pw;
+        h = ph;
+    }
+    m_dirty.assign(static_cast<std::size_t>(m_levelWidth[0]) * m_levelHeight[0], 0);
+    m_dirtyTiles.clear();
+    m_stale = false;
+}
+
+/**
+* @brief Celdas negras de una baldosa, contadas en la cinta (recortada a su borde).
+*/
+std::uint64_t TilePyramid::countTile(const Tape& tape, unsigned tx, unsigned ty) const
+{
+    const unsigned x0 = tx * kTileSize;
+    const unsigned y0 = ty * kTileSize;
+    if (x0 >= m_width || y0 >= m_height) {
+        return 0;
+    }
+    return tape.countBlack(x0, y0, std::min(kTileSize, m_width - x0), std::min(kTileSize, m_height - y0));
+}
+
+/**
+* @brief Celdas negras de un rectángulo dentro de la cinta: las baldosas completas con la
+*        pirámide y las franjas de los bordes con Tape::countBlack.
+* @param tape cinta
+* @param x0 primera columna
+* @param y0 primera fila
+* @param w ancho
+* @param h alto
+* @return número de celdas negras
+*/
+std::uint64_t TilePyramid::count(const Tape& tape, unsigned x0, unsigned y0, unsigned w, unsigned h) const
+{
+    const unsigned x1 = x0 + w;
+    const unsigned y1 = y0 + h;
+    // Baldosas completas del rectángulo; la última de cada eje cuenta como completa si el
+    // rectángulo llega hasta el borde de la cinta
+    const unsigned tx0 = (x0 + kTileSize - 1) / kTileSize;
+    const unsigned ty0 = (y0 + kTileSize - 1) / kTileSize;
+    const unsigned tx1 = x1 == m_width ? m_levelWidth[0] : x1 / kTileSize;
+    const unsigned ty1 = y1 == m_height ? m_levelHeight[0] : y1 / kTileSize;
+    if (tx0 >= tx1 || ty0 >= ty1) {
+        return tape.countBlack(x0, y0, w, h);
+    }
+    const unsigned xa = tx0 * kTileSize;
+    const unsigned ya = ty0 * kTileSize;
+    const unsigned xb = std::min(tx1 * kTileSize, m_width);
+    const unsigned yb = std::min(ty1 * kTileSize, m_height);
+    return sum(0, tx0, ty0, tx1, ty1) + tape.countBlack(x0, y0, w, ya - y0) + tape.countBlack(x0, yb, w, y1 - yb) +
+           tape.countBlack(x0, ya, xa - x0, yb - ya) + tape.countBlack(xb, ya, x1 - xb, yb - ya);
+}
+
+/**
+* @brief Suma de un rango de bloques del nivel k: los bloques de los extremos que no forman un
+*        bloque completo del nivel siguiente se suman aquí y el resto se pide al nivel siguiente.
+*/
+std::uint64_t TilePyramid::sum(unsigned k, unsigned bx0, unsigned by0, unsigned bx1, unsigned by1) const
+{
+    std::uint64_t total = 0;
+    for (; bx0 < bx1 && by0 < by1; ++k) {
+        const std::vector<std::uint64_t>& level = m_levels[k];
+        const std::size_t width = m_levelWidth[k];
+        if (bx0 & 1u) {
+            for (unsigned y = by0; y < by1; ++y) total += level[y * width + bx0];
+            ++bx0;
+        }
+        if ((bx1 & 1u) && bx0 < bx1) {
+            for (unsigned y = by0; y < by1; ++y) total += level[y * width + bx1 - 1];
+            --bx1;
+        }
+        if ((by0 & 1u) && bx0 < bx1) {
+            for (unsigned x = bx0; x < bx1; ++x) total += level[by0 * width + x];
+            ++by0;
+        }
+        if ((by1 & 1u) && by0 < by1 && bx0 < bx1) {
+            for (unsigned x = bx0; x < bx1; ++x) total += level[(by1 - 1) * width + x];
+            --by1;
+        }
+        bx0 /= 2;
+        by0 /= 2;
+        bx1 /= 2;
+        by1 /= 2;
+    }
+    return total;
+}
+
+/**
+* @brief Número de niveles.
+*/
+unsigned TilePyramid::levels() const
+{
+    return static_cast<unsigned>(m_levels.size());
+}
+
+unsigned TilePyramid::levelWidth(unsigned k) const
+{
+    return m_levelWidth[k];
+}
+
+unsigned TilePyramid::levelHeight(unsigned k) const
+{
+    return m_levelHeight[k];
+}
+
+/**
+* @brief Celdas negras del bloque (bx, by) del nivel k.
+*/
+std::uint64_t TilePyramid::at(unsigned k, unsigned bx, unsigned by) const
+{
+    return m_levels[k][static_cast<std::size_t>(by) * m_levelWidth[k] + bx];
+}
+
+/**
+* @brief Memoria de los recuentos y las marcas, en bytes.
+*/
+std::size_t TilePyramid::memoryBytes() const
+{
+    std::size_t bytes = m_dirty.capacity() + m_dirtyTiles.capacity() * sizeof(std::uint32_t);
+    for (auto const& level : m_levels) {
+        bytes += level.capacity() * sizeof(std::uint64_t);
+    }
+    return bytes;
+}
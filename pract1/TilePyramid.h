@@ -0,0 +1,110 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file TilePyramid.h
+ * @brief Pirámide de recuentos de celdas negras de la cinta con bordes por baldosas de 64x64,
+ *        para contar regiones y dibujar vistas reducidas sin recorrer la cinta.
+ *
+ * El nivel 0 guarda las celdas negras de cada baldosa y cada nivel siguiente la suma de cada
+ * bloque de 2x2 del anterior, hasta llegar a una sola cuenta. Un rectángulo se cuenta con los
+ * niveles para las baldosas completas que cubre y con Tape::countBlack para los trozos de los
+ * bordes, así que cuesta lo que su perímetro y no lo que su área.
+ *
+ * Los bucles de simulación no escriben en la pirámide paso a paso: marcan las baldosas que la
+ * hormiga puede haber pisado (ver touch) y refresh vuelve a contar solo esas antes de cada
+ * consulta. Cualquier otro cambio de la cinta la invalida y se vuelve a construir entera.
+ */
+
+#ifndef TILEPYRAMID_H
+#define TILEPYRAMID_H
+
+#include "Tape.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TilePyramid {
+public:
+    /// Lado de cada baldosa en celdas (potencia de 2)
+    static constexpr unsigned kTileShift = 6;
+    static constexpr unsigned kTileSize = 1u << kTileShift;
+    /// Pasos que pueden dar los bucles de simulación entre dos llamadas a touch
+    static constexpr std::uint64_t kTrackSteps = 64;
+
+    /**
+     * @brief Construye una pirámide inactiva (no se mantiene hasta el primer refresh).
+     */
+    TilePyramid();
+
+    /**
+     * @brief Indica si la pirámide está en uso, es decir, si los bucles de simulación deben
+     *        llamar a touch.
+     */
+    bool active() const { return m_active; }
+
+    /**
+     * @brief Da la pirámide por desactualizada: el siguiente refresh la vuelve a construir.
+     */
+    void invalidate() { m_stale = true; }
+
+    /**
+     * @brief Marca como cambiadas las baldosas a menos de 'radius' celdas de (x,y): las que
+     *        puede pisar la hormiga en 'radius' pasos desde allí. No hace nada si la pirámide
+     *        está inactiva o desactualizada.
+     */
+    void touch(std::int64_t x, std::int64_t y, std::uint64_t radius);
+
+    /**
+     * @brief Pone la pirámide al día con la cinta: la construye si está desactualizada o la
+     *        cinta ha cambiado de tamaño y, si no, vuelve a contar las baldosas marcadas. Desde
+     *        la primera llamada la pirámide queda activa.
+     * @param tape cinta
+     */
+    void refresh(const Tape& tape);
+
+    /**
+     * @brief Celdas negras del rectángulo [x0, x0+w) x [y0, y0+h), que debe estar dentro de la
+     *        cinta. La pirámide debe estar al día (refresh).
+     * @param tape cinta de la que se contó la pirámide
+     */
+    std::uint64_t count(const Tape& tape, unsigned x0, unsigned y0, unsigned w, unsigned h) const;
+
+    /**
+     * @brief Número de niveles (el 0 son las baldosas).
+     */
+    unsigned levels() const;
+
+    /**
+     * @brief Ancho y alto del nivel k, en bloques de kTileSize * 2^k celdas.
+     */
+    unsigned levelWidth(unsigned k) const;
+    unsigned levelHeight(unsigned k) const;
+
+    /**
+     * @brief Celdas negras del bloque (bx, by) del nivel k.
+     */
+    std::uint64_t at(unsigned k, unsigned bx, unsigned by) const;
+
+    /**
+     * @brief Memoria que ocupan los recuentos y las marcas, en bytes.
+     */
+    std::size_t memoryBytes() const;
+
+private:
+    bool m_active;
+    bool m_stale;   // hay que volver a construirla
+    unsigned m_width; // tamaño de la cinta con que se construyó
+    unsigned m_height;
+    std::vector<std::vector<std::uint64_t>> m_levels; // recuentos, fila a fila en cada nivel
+    std::vector<unsigned> m_levelWidth;
+    std::vector<unsigned> m_levelHeight;
+    std::vector<std::uint8_t> m_dirty;       // baldosas marcadas por touch
+    std::vector<std::uint32_t> m_dirtyTiles; // sus índices, para no recorrer m_dirty
+
+    void rebuild(const Tape& tape);
+    // Celdas negras de la baldosa (tx, ty) contadas en la cinta
+    std::uint64_t countTile(const Tape& tape, unsigned tx, unsigned ty) const;
+    // Suma de los bloques [bx0, bx1) x [by0, by1) del nivel k
+    std::uint64_t sum(unsigned k, unsigned bx0, unsigned by0, unsigned bx1, unsigned by1) const;
+};
+
+#endif
@@ -0,0 +1,663 @@
+/**
+ * @author Daniel Palenzuela Álvarez alu0101140469
+ * @file bench.cc
+ * @brief Banco de pruebas de rendimiento: pasos por segundo, accesos a la cinta, dibujado e
+ *        instantáneas, carga de ficheros de inicialización, operaciones sobre la cinta completa
+ *        con cada versión de BitKernels, coste de la telemetría y del registro de pasos y
+ *        reserva de la memoria de las cintas y consultas de regiones, con resultados en JSON o
+ *        CSV para comparar entre versiones.
+ *
+ * Ejecutar (o "make bench"):
+ *   ./langton_bench [--format json|csv] [--repeats N] [--quick] [--filter texto]
+ *
+ * Cada prueba se repite N veces (5 por defecto) y se muestra la media, la desviación típica,
+ * el mínimo y el máximo. Tamaños de cinta: "small" (cabe en L1), "l2" (unos cientos de KB) y
+ * "dram" (decenas de MB). Las cintas "random" empiezan con la mitad de las celdas no blancas.
+ */
+
+#include "BitKernels.h"
+#include "Ensemble.h"
+#include "Simulator.h"
+#include "Rule.h"
+#include "StepTrace.h"
+#include "Tape.h"
+#include "TapeMemory.h"
+#include "Telemetry.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Flujo que descarta lo que se escribe, para medir el dibujado sin la terminal
+class NullBuffer : public std::streambuf {
+protected:
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    int overflow(int c) override { return traits_type::not_eof(c); }
+};
+
+// Destino de los resultados de los bucles de prueba, para que el compilador no los elimine
+volatile unsigned g_sink;
+
+struct Options {
+    std::string format = "json";
+    unsigned repeats = 5;
+    bool quick = false;
+    std::string filter;
+};
+
+// Lee un número sin signo de todo 'text' (como parseNumber en main.cc); false si no lo es o no
+// cabe en unsigned
+bool parseNumber(const std::string& text, unsigned& value)
+{
+    unsigned parsed = 0;
+    const char* end = text.data() + text.size();
+    const std::from_chars_result result = std::from_chars(text.data(), end, parsed);
+    if (text.empty() || result.ec != std::errc() || result.ptr != end) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// Resultado de una prueba: una muestra por repetición
+struct Result {
+    std::string name;
+    std::string metric;
+    std::string unit;
+    std::vector<double> samples;
+};
+
+struct GridSize {
+    const char* name;
+    unsigned width;
+    unsigned height;
+};
+
+double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Crea un simulador con la hormiga en el centro y, si random, la mitad de las celdas no blancas
+std::unique_ptr<Simulator> makeSimulator(const GridSize& size, const Rule& rule, bool random)
+{
+    std::unique_ptr<Simulator> sim(new Simulator(size.width, size.height, size.width / 2, size.height / 2,
+                                                 Ant::UP, Simulator::BOUNDED, rule));
+    sim->setQuiet(true);
+    if (random) {
+        std::mt19937_64 rng(12345);
+        const unsigned colors = rule.colors();
+        std::vector<std::pair<unsigned, unsigned>> blacks;
+        for (unsigned y = 0; y < size.height; ++y) {
+            for (unsigned x = 0; x < size.width; ++x) {
+                std::uint64_t r = rng();
+                if ((r & 1) == 0) continue;
+                unsigned color = colors > 2 ? 1 + static_cast<unsigned>((r >> 1) % (colors - 1)) : 1;
+                if (color == 1) {
+                    blacks.emplace_back(x, y);
+                } else {
+                    sim->setCell(x, y, color);
+                }
+            }
+            // Por tramos, para no guardar todas las coordenadas a la vez en las cintas grandes
+            if (blacks.size() > (1u << 20)) {
+                sim->initializeBlacks(blacks);
+                blacks.clear();
+            }
+        }
+        sim->initializeBlacks(blacks);
+    }
+    return sim;
+}
+
+// Mide pasos por segundo: ejecuta 'steps' pasos por repetición con 'run', creando otro
+// simulador cuando la hormiga alcanza el borde (el tiempo de creación no se cuenta)
+Result measureSteps(const std::string& name, const GridSize& size, const Rule& rule, bool random,
+                    std::uint64_t steps, unsigned repeats,
+                    const std::function<std::uint64_t(Simulator&, std::uint64_t)>& run)
+{
+    Result result{ name, "steps_per_second", "steps/s", {} };
+    std::unique_ptr<Simulator> sim = makeSimulator(size, rule, random);
+    for (unsigned r = 0; r < repeats; ++r) {
+        std::uint64_t done = 0;
+        double elapsed = 0;
+        while (done < steps) {
+            if (sim->borderReached()) {
+                sim = makeSimulator(size, rule, random);
+            }
+            auto start = std::chrono::steady_clock::now();
+            std::uint64_t executed = run(*sim, steps - done);
+            elapsed += seconds(start);
+            done += executed;
+            if (executed == 0 && !sim->borderReached()) break;
+        }
+        result.samples.push_back(elapsed > 0 ? static_cast<double>(done) / elapsed : 0.0);
+    }
+    return result;
+}
+
+// Mide pasos por segundo de la regla de Langton sobre una cinta con la disposición Layout
+// (TapeLayout.h), con el bucle de Simulator::runFast (Ant::runLangton): la hormiga sale del centro de
+// una cinta aleatoria y vuelve a él al llegar al borde
+template <class Layout>
+Result measureLayout(const std::string& name, const GridSize& size, std::uint64_t steps, unsigned repeats)
+{
+    BasicTape<Layout> tape(size.width, size.height);
+    std::mt19937_64 rng(13);
+    std::vector<std::uint64_t> row(tape.stride());
+    for (unsigned y = 0; y < size.height; ++y) {
+        for (auto& w : row) w = rng();
+        tape.writeRow(y, row.data());
+    }
+    std::uint64_t* words = tape.data();
+    const std::int64_t width = size.width;
+    const std::int64_t height = size.height;
+    Result result{ name, "steps_per_second", "steps/s", {} };
+    for (unsigned r = 0; r < repeats; ++r) {
+        std::int64_t x = width / 2;
+        std::int64_t y = height / 2;
+        unsigned orient = Ant::UP;
+        std::uint64_t done = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (done < steps) {
+            std::int64_t margin = std::min(std::min(x, width - 1 - x), std::min(y, height - 1 - y));
+            if (margin <= 0) {
+                x = width / 2;
+                y = height / 2;
+                continue;
+            }
+            const std::uint64_t burst = std::min<std::uint64_t>(static_cast<std::uint64_t>(margin), steps - done);
+            typename BasicTape<Layout>::Cursor cursor = tape.cursor(x, y);
+            orient = Ant::runLangton(words, cursor, orient, burst);
+            x = cursor.x();
+            y = cursor.y();
+            done += burst;
+        }
+        result.samples.push_back(steps / seconds(start));
+    }
+    g_sink = static_cast<unsigned>(tape.countBlack(0, 0, size.width, size.height));
+    return result;
+}
+
+// Mide el tiempo medio de 'calls' llamadas a fn
+Result measureCalls(const std::string& name, const std::string& metric, unsigned calls, unsigned repeats,
+                    const std::function<void()>& fn)
+{
+    Result result{ name, metric, "s", {} };
+    for (unsigned r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < calls; ++i) fn();
+        result.samples.push_back(seconds(start) / calls);
+    }
+    return result;
+}
+
+struct Summary {
+    double mean, stddev, min, max;
+};
+
+Summary summarize(const std::vector<double>& samples)
+{
+    Summary s{ 0, 0, 0, 0 };
+    if (samples.empty()) return s;
+    for (double v : samples) s.mean += v;
+    s.mean /= samples.size();
+    for (double v : samples) s.stddev += (v - s.mean) * (v - s.mean);
+    s.stddev = samples.size() > 1 ? std::sqrt(s.stddev / (samples.size() - 1)) : 0.0;
+    s.min = *std::min_element(samples.begin(), samples.end());
+    s.max = *std::max_element(samples.begin(), samples.end());
+    return s;
+}
+
+void printResults(const std::vector<Result>& results, const Options& options)
+{
+    std::ostringstream out;
+    out.precision(6);
+    if (options.format == "csv") {
+        out << "name,metric,unit,repeats,mean,stddev,min,max\n";
+        for (auto const& r : results) {
+            Summary s = summarize(r.samples);
+            out << r.name << ',' << r.metric << ',' << r.unit << ',' << r.samples.size() << ','
+                << s.mean << ',' << s.stddev << ',' << s.min << ',' << s.max << '\n';
+        }
+    } else {
+        out << "{\n  \"repeats\": " << options.repeats << ",\n  \"quick\": " << (options.quick ? "true" : "false")
+            << ",\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            auto const& r = results[i];
+            Summary s = summarize(r.samples);
+            out << "    {\"name\": \"" << r.name << "\", \"metric\": \"" << r.metric << "\", \"unit\": \"" << r.unit
+                << "\", \"repeats\": " << r.samples.size() << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev
+                << ", \"min\": " << s.min << ", \"max\": " << s.max << ", \"samples\": [";
+            for (std::size_t k = 0; k < r.samples.size(); ++k) {
+                out << (k ? ", " : "") << r.samples[k];
+            }
+            out << "]}" << (i + 1 < results.size() ? "," : "") << '\n';
+        }
+        out << "  ]\n}\n";
+    }
+    std::cout << out.str();
+}
+
+} // namespace
+
+/**
+* @brief Ejecuta todas las pruebas y muestra los resultados.
+*/
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            options.format = argv[++i];
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--repeats" && i + 1 < argc && parseNumber(argv[i + 1], options.repeats)) {
+            ++i;
+        } else {
+            std::cerr << "Como ejecutar: " << argv[0] << " [--format json|csv] [--repeats N] [--quick] [--filter texto]\n";
+            return 1;
+        }
+    }
+    if ((options.format != "json" && options.format != "csv") || options.repeats == 0) {
+        std::cerr << "Formato (json o csv) o número de repeticiones no válido\n";
+        return 1;
+    }
+
+    // Tamaños: bits para la regla de Langton (Tape) y bytes para las multicolor (ColorTape)
+    const GridSize bitSizes[] = { { "small", 64, 64 }, { "l2", 1024, 1024 }, { "dram", 16384, 16384 } };
+    const GridSize byteSizes[] = { { "small", 64, 64 }, { "l2", 512, 512 }, { "dram", 8192, 8192 } };
+    const std::uint64_t steps = options.quick ? 200000 : 5000000;
+    const unsigned repeats = options.repeats;
+
+    std::vector<Result> results;
+    auto wanted = [&](const std::string& name) {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    };
+    auto runSteps = [](Simulator& sim, std::uint64_t n) { return sim.runSteps(n); };
+    auto runFast = [](Simulator& sim, std::uint64_t n) { return sim.runFast(n); };
+    auto runMacro = [](Simulator& sim, std::uint64_t n) {
+        sim.setEngine(Simulator::MACRO);
+        return sim.runFast(n);
+    };
+
+    // Hormiga de Langton: runSteps (paso a paso), runFast (bucle optimizado) y runFast con el
+    // motor MACRO (bloques de 4x4 por tabla, que se va calculando según se usa)
+    for (auto const& size : bitSizes) {
+        if (options.quick && std::string(size.name) == "dram") continue;
+        for (bool random : { false, true }) {
+            std::string base = std::string("langton/") + size.name + (random ? "/random" : "/empty");
+            if (wanted(base + "/runSteps")) {
+                results.push_back(measureSteps(base + "/runSteps", size, Rule(), random, steps, repeats, runSteps));
+            }
+            if (wanted(base + "/runFast")) {
+                results.push_back(measureSteps(base + "/runFast", size, Rule(), random, steps, repeats, runFast));
+            }
+            if (wanted(base + "/macro")) {
+                results.push_back(measureSteps(base + "/macro", size, Rule(), random, steps, repeats, runMacro));
+            }
+        }
+    }
+
+    // Reglas multicolor y de turmite
+    const char* rules[] = { "RLR", "LLRR", "RRLLLRLLLRRR", "LRRRRRLLR", "turmite 2 2 1R1 1L0 1N0 0N0" };
+    for (auto const& size : byteSizes) {
+        if (options.quick && std::string(size.name) == "dram") continue;
+        for (const char* text : rules) {
+            Rule rule = Rule::parse(text);
+            std::string label = text;
+            std::replace(label.begin(), label.end(), ' ', '_');
+            for (bool random : { false, true }) {
+                std::string name = "color/" + label + "/" + size.name + (random ? "/random" : "/empty") + "/runFast";
+                if (wanted(name)) {
+                    results.push_back(measureSteps(name, size, rule, random, steps, repeats, runFast));
+                }
+            }
+        }
+    }
+
+    // Accesos aleatorios a Tape::get y Tape::set
+    for (auto const& size : bitSizes) {
+        std::string name = std::string("tape/") + size.name + "/get_set";
+        if (!wanted(name) || (options.quick && std::string(size.name) == "dram")) continue;
+        Tape tape(size.width, size.height);
+        std::mt19937_64 rng(7);
+        const unsigned ops = 1u << 20;
+        std::vector<std::pair<unsigned, unsigned>> coords(ops);
+        for (auto& c : coords) {
+            c.first = static_cast<unsigned>(rng() % size.width);
+            c.second = static_cast<unsigned>(rng() % size.height);
+        }
+        Result result{ name, "ops_per_second", "ops/s", {} };
+        for (unsigned r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            unsigned black = 0;
+            for (auto const& c : coords) {
+                bool value = tape.get(c.first, c.second);
+                black += value;
+                tape.set(c.first, c.second, !value);
+            }
+            double elapsed = seconds(start);
+            g_sink = black;
+            result.samples.push_back(2.0 * ops / elapsed);
+        }
+        results.push_back(result);
+    }
+
+    // Operaciones sobre la cinta completa (BitKernels.h) con cada versión que admite el
+    // procesador, y los bucles celda a celda con Tape::get que usaban antes como referencia
+    for (auto const& size : bitSizes) {
+        if (options.quick && std::string(size.name) == "dram") continue;
+        std::string base = std::string("bits/") + size.name;
+        if (!wanted(base)) continue;
+        Tape tape(size.width, size.height);
+        std::mt19937_64 rng(11);
+        std::vector<std::uint64_t> words(tape.stride());
+        for (unsigned y = 0; y < size.height; ++y) {
+            for (auto& w : words) w = rng();
+            tape.writeRow(y, words.data());
+        }
+        // Otra cinta con unas pocas celdas cambiadas
+        Tape other(tape);
+        for (unsigned k = 0; k < 64; ++k) {
+            unsigned x = static_cast<unsigned>(rng() % size.width), y = static_cast<unsigned>(rng() % size.height);
+            other.set(x, y, !other.get(x, y));
+        }
+        std::vector<char> row(size.width);
+        const unsigned calls = std::string(size.name) == "small" ? 1000 : std::string(size.name) == "l2" ? 20 : 1;
+        const unsigned cellCalls = std::string(size.name) == "small" ? 100 : 1;
+
+        results.push_back(measureCalls(base + "/popcount/cells", "seconds_per_call", cellCalls, repeats, [&]() {
+            unsigned black = 0;
+            for (unsigned y = 0; y < size.height; ++y)
+                for (unsigned x = 0; x < size.width; ++x) black += tape.get(x, y);
+            g_sink = black;
+        }));
+        results.push_back(measureCalls(base + "/render/cells", "seconds_per_call", cellCalls, repeats, [&]() {
+            for (unsigned y = 0; y < size.height; ++y)
+                for (unsigned x = 0; x < size.width; ++x) row[x] = tape.cellChar(x, y);
+            g_sink = static_cast<unsigned>(row[0]);
+        }));
+        results.push_back(measureCalls(base + "/export/cells", "seconds_per_call", cellCalls, repeats, [&]() {
+            std::vector<std::pair<unsigned, unsigned>> cells;
+            for (unsigned y = 0; y < size.height; ++y)
+                for (unsigned x = 0; x < size.width; ++x)
+                    if (tape.get(x, y)) cells.emplace_back(x, y);
+            g_sink = static_cast<unsigned>(cells.size());
+        }));
+        for (int level = BitKernels::SCALAR; level <= BitKernels::best(); ++level) {
+            BitKernels::setLevel(static_cast<BitKernels::Level>(level));
+            const std::string suffix = std::string("/") + BitKernels::name(static_cast<BitKernels::Level>(level));
+            results.push_back(measureCalls(base + "/popcount" + suffix, "seconds_per_call", calls, repeats, [&]() {
+                g_sink = static_cast<unsigned>(tape.countBlack(0, 0, size.width, size.height));
+            }));
+            results.push_back(measureCalls(base + "/diff" + suffix, "seconds_per_call", calls, repeats, [&]() {
+                g_sink = static_cast<unsigned>(tape.diff(other).size());
+            }));
+            results.push_back(measureCalls(base + "/render" + suffix, "seconds_per_call", calls, repeats, [&]() {
+                for (unsigned y = 0; y < size.height; ++y) tape.renderRow(y, 0, size.width, row.data());
+                g_sink = static_cast<unsigned>(row[0]);
+            }));
+            results.push_back(measureCalls(base + "/export" + suffix, "seconds_per_call", cellCalls, repeats, [&]() {
+                g_sink = static_cast<unsigned>(tape.blackCells().size());
+            }));
+        }
+        BitKernels::setLevel(BitKernels::best());
+    }
+
+    // Pasos por segundo con cada disposición de la cinta en memoria. Las dos pasan por el mismo
+    // bucle que Simulator::runFast (Ant::runLangton), así que se comparan en una sola
+    // compilación; la disposición de Simulator se sigue eligiendo al compilar (make LAYOUT=morton)
+    for (auto const& size : bitSizes) {
+        if (options.quick && std::string(size.name) == "dram") continue;
+        const std::string base = std::string("layout/") + size.name + "/random/";
+        if (wanted(base + RowMajorLayout::name())) {
+            results.push_back(measureLayout<RowMajorLayout>(base + RowMajorLayout::name(), size, steps, repeats));
+        }
+        if (wanted(base + MortonLayout::name())) {
+            results.push_back(measureLayout<MortonLayout>(base + MortonLayout::name(), size, steps, repeats));
+        }
+    }
+
+    // Memoria de las cintas (TapeMemory.h): crear una cinta "dram", dar unos pasos y destruirla,
+    // con páginas normales o grandes y pidiendo bloques nuevos cada vez o reutilizando el
+    // anterior. Junto al tiempo se anotan los fallos de página de cada repetición.
+    if (!options.quick) {
+        const GridSize& size = bitSizes[2];
+        const std::size_t oldLimit = TapeMemory::cacheLimit();
+        for (TapeMemory::HugePages pages : { TapeMemory::OFF, TapeMemory::ADVISE }) {
+            for (bool reuse : { false, true }) {
+                const std::string base = std::string("memory/") + size.name + "/" + TapeMemory::name(pages) +
+                                         (reuse ? "/reuse" : "/fresh");
+                if (!wanted(base)) continue;
+                TapeMemory::setHugePages(pages);
+                TapeMemory::setCacheLimit(reuse ? oldLimit : 0);
+                Result time{ base + "/seconds", "seconds_per_run", "s", {} };
+                Result faults{ base + "/faults", "page_faults_per_run", "faults", {} };
+                for (unsigned r = 0; r <= repeats; ++r) {
+                    const TapeMemory::Stats before = TapeMemory::stats();
+                    auto start = std::chrono::steady_clock::now();
+                    {
+                        Simulator sim(size.width, size.height, size.width / 2, size.height / 2, Ant::UP,
+                                      Simulator::BOUNDED, Rule());
+                        sim.setQuiet(true);
+                        g_sink = static_cast<unsigned>(sim.runFast(1000000));
+                    }
+                    const double elapsed = seconds(start);
+                    // La primera vuelta solo prepara el bloque que reutilizan las demás
+                    if (r > 0) {
+                        time.samples.push_back(elapsed);
+                        faults.samples.push_back(static_cast<double>(TapeMemory::stats().minorFaults - before.minorFaults));
+                    }
+                }
+                results.push_back(time);
+                results.push_back(faults);
+            }
+        }
+        TapeMemory::setHugePages(TapeMemory::OFF);
+        TapeMemory::setCacheLimit(oldLimit);
+    }
+
+    // Dibujado de un fotograma completo y reducido
+    NullBuffer nullBuffer;
+    std::ostream nullStream(&nullBuffer);
+    for (auto const& size : bitSizes) {
+        if (options.quick && std::string(size.name) == "dram") continue;
+        std::string base = std::string("render/") + size.name;
+        if (!wanted(base)) continue;
+        std::unique_ptr<Simulator> sim = makeSimulator(size, Rule(), true);
+        if (std::string(size.name) != "dram") {
+            results.push_back(measureCalls(base + "/full", "seconds_per_frame", 3, repeats,
+                                           [&]() { sim->render(nullStream); }));
+        }
+        sim->setViewport(200, 60, 1);
+        results.push_back(measureCalls(base + "/viewport_200x60", "seconds_per_frame", 20, repeats,
+                                       [&]() { sim->render(nullStream); }));
+        sim->setViewport(200, 60, size.width / 200 + 1);
+        results.push_back(measureCalls(base + "/downsampled_200x60", "seconds_per_frame", 3, repeats,
+                                       [&]() { sim->render(nullStream); }));
+    }
+
+    // Consultas de regiones (TilePyramid.h) sobre una simulación que avanza: runFast con la
+    // pirámide en uso, un mapa de densidad de la cinta entera a 64 y a 256 celdas por bloque
+    // tras unos pasos (se vuelven a contar solo las baldosas pisadas) y el mismo mapa cuando
+    // la cinta ha cambiado por otro camino y la pirámide se construye entera
+    for (auto const& size : bitSizes) {
+        if (std::string(size.name) == "small" || (options.quick && std::string(size.name) == "dram")) continue;
+        const std::string base = std::string("region/") + size.name + "/random";
+        if (!wanted(base)) continue;
+        results.push_back(measureSteps(base + "/runFast_tracked", size, Rule(), true, steps, repeats,
+                                       [](Simulator& sim, std::uint64_t n) {
+                                           sim.regionCount(0, 0, 1, 1);
+                                           return sim.runFast(n);
+                                       }));
+        std::unique_ptr<Simulator> sim = makeSimulator(size, Rule(), true);
+        for (unsigned zoom : { 64u, 256u }) {
+            const std::string name = base + "/density_" + std::to_string(zoom);
+            const unsigned cols = size.width / zoom;
+            const unsigned rows = size.height / zoom;
+            results.push_back(measureCalls(name + "/live", "seconds_per_map", 20, repeats, [&]() {
+                sim->runFast(10000);
+                g_sink = static_cast<unsigned>(sim->densityMap(0, 0, cols, rows, zoom)[0]);
+            }));
+            results.push_back(measureCalls(name + "/rebuild", "seconds_per_map", 3, repeats, [&]() {
+                sim->runFast(10000);
+                sim->setCell(0, 0, 0);
+                g_sink = static_cast<unsigned>(sim->densityMap(0, 0, cols, rows, zoom)[0]);
+            }));
+        }
+        results.push_back(measureCalls(base + "/count_center", "seconds_per_query", 20, repeats, [&]() {
+            sim->runFast(10000);
+            g_sink = static_cast<unsigned>(
+                sim->regionCount(size.width / 4 + 3, size.height / 4 + 5, size.width / 2, size.height / 2));
+        }));
+    }
+
+    // Guardado del estado: texto, instantánea binaria y comprimida
+    const std::string tmpFile = "langton_bench.tmp";
+    for (auto const& size : bitSizes) {
+        if (options.quick && std::string(size.name) == "dram") continue;
+        std::string base = std::string("save/") + size.name;
+        if (!wanted(base)) continue;
+        std::unique_ptr<Simulator> sim = makeSimulator(size, Rule(), true);
+        results.push_back(measureCalls(base + "/text", "seconds_per_save", 1, repeats,
+                                       [&]() { sim->saveState(tmpFile); }));
+        results.push_back(measureCalls(base + "/binary", "seconds_per_save", 1, repeats,
+                                       [&]() { sim->saveSnapshot(tmpFile, false); }));
+        results.push_back(measureCalls(base + "/rle", "seconds_per_save", 1, repeats,
+                                       [&]() { sim->saveSnapshot(tmpFile, true); }));
+        sim->saveSnapshot(tmpFile, false);
+        results.push_back(measureCalls(base + "/load_binary", "seconds_per_load", 1, repeats,
+                                       [&]() { Simulator::loadSnapshot(tmpFile).stepCount(); }));
+    }
+
+    // Coste de la telemetría: la cinta ilimitada (no hay borde, así que cada repetición es una
+    // sola llamada) sin y con un hilo vigilante que muestrea cada 10 ms
+    for (bool on : { false, true }) {
+        std::string name = on ? "telemetry/infinite/on_10ms" : "telemetry/infinite/off";
+        if (!wanted(name)) continue;
+        Result result{ name, "steps_per_second", "steps/s", {} };
+        for (unsigned r = 0; r < repeats; ++r) {
+            Simulator sim(64, 64, 0, 0, Ant::UP, Simulator::INFINITE);
+            std::unique_ptr<Telemetry> telemetry;
+            if (on) {
+                telemetry.reset(new Telemetry(sim.telemetry(), nullStream, std::chrono::milliseconds(10)));
+            }
+            auto start = std::chrono::steady_clock::now();
+            sim.runFast(steps);
+            result.samples.push_back(steps / seconds(start));
+        }
+        results.push_back(result);
+    }
+
+    // Coste del registro de pasos (StepTrace.h): runFast sin y con registro, que se escribe en
+    // un fichero temporal
+    const std::string traceFile = "langton_bench.trace";
+    for (auto const& size : bitSizes) {
+        if (options.quick && std::string(size.name) == "dram") continue;
+        for (const char* text : { "LR", "RLR" }) {
+            Rule rule = Rule::parse(text);
+            std::string base = std::string("trace/") + text + "/" + size.name + "/random";
+            if (!wanted(base)) continue;
+            results.push_back(measureSteps(base + "/off", size, rule, true, steps, repeats, runFast));
+            TraceWriter trace(traceFile, 0);
+            results.push_back(measureSteps(base + "/on", size, rule, true, steps, repeats,
+                                           [&](Simulator& sim, std::uint64_t n) {
+                                               sim.setStepTrace(&trace);
+                                               std::uint64_t done = sim.runFast(n);
+                                               sim.setStepTrace(nullptr);
+                                               return done;
+                                           }));
+        }
+    }
+    std::remove(traceFile.c_str());
+
+    // Conjunto de simulaciones independientes: 1 hilo frente a todos los núcleos (la escala
+    // debería ser casi lineal porque los trabajos no comparten nada)
+    if (wanted("ensemble")) {
+        std::vector<EnsembleJob> jobs;
+        const unsigned jobCount = options.quick ? 32 : 256;
+        for (unsigned i = 0; i < jobCount; ++i) {
+            unsigned side = 128u << (i % 3);
+            jobs.push_back({ side, side, side / 2, side / 2, static_cast<Ant::Orientation>(i % 4),
+                             (i % 4) * 0.05, i, 0, Rule() });
+        }
+        for (unsigned threads : { 1u, 0u }) {
+            Ensemble ensemble(threads);
+            std::string name = threads == 1 ? "ensemble/1_thread" : "ensemble/all_threads";
+            for (bool highway : { true, false }) {
+                ensemble.setHighwayTracking(highway);
+                Result result{ name + (highway ? "/highway" : "/no_highway"), "jobs_per_second", "jobs/s", {} };
+                for (unsigned r = 0; r < repeats; ++r) {
+                    auto start = std::chrono::steady_clock::now();
+                    g_sink = static_cast<unsigned>(ensemble.run(jobs).size());
+                    result.samples.push_back(jobs.size() / seconds(start));
+                }
+                results.push_back(result);
+            }
+        }
+    }
+
+    // Carga de un fichero de inicialización en texto: lectura línea a línea con istringstream
+    // a un vector e initializeBlacks (como hacía main.cc) frente a Simulator::loadSeed con
+    // 1 hilo y con todos
+    struct SeedSize {
+        const char* name;
+        unsigned side;
+        unsigned cells;
+    };
+    const SeedSize seedSizes[] = { { "l2", 1024, 200000 }, { "dram", 8192, 10000000 } };
+    for (auto const& size : seedSizes) {
+        if (options.quick && std::string(size.name) == "dram") continue;
+        std::string base = std::string("seed/") + size.name;
+        if (!wanted(base)) continue;
+        {
+            std::ofstream ofs(tmpFile);
+            std::mt19937_64 rng(99);
+            ofs << size.side << ' ' << size.side << '\n' << size.side / 2 << ' ' << size.side / 2 << " 2\n";
+            for (unsigned i = 0; i < size.cells; ++i) {
+                ofs << rng() % size.side << ' ' << rng() % size.side << '\n';
+            }
+        }
+        results.push_back(measureCalls(base + "/getline_istringstream", "seconds_per_load", 1, repeats, [&]() {
+            std::ifstream ifs(tmpFile);
+            unsigned sizeX, sizeY, antX, antY, x, y;
+            int orient;
+            ifs >> sizeX >> sizeY >> antX >> antY >> orient;
+            std::vector<std::pair<unsigned, unsigned>> blacks;
+            std::string line;
+            std::getline(ifs, line);
+            while (std::getline(ifs, line)) {
+                std::istringstream iss(line);
+                if (iss >> x >> y) blacks.emplace_back(x, y);
+            }
+            Simulator sim(sizeX, sizeY, antX, antY, static_cast<Ant::Orientation>(orient));
+            sim.initializeBlacks(blacks);
+        }));
+        results.push_back(measureCalls(base + "/mmap_1thread", "seconds_per_load", 1, repeats,
+                                       [&]() { Simulator::loadSeed(tmpFile, Simulator::BOUNDED, 1).stepCount(); }));
+        results.push_back(measureCalls(base + "/mmap_parallel", "seconds_per_load", 1, repeats,
+                                       [&]() { Simulator::loadSeed(tmpFile).stepCount(); }));
+    }
+    std::remove(tmpFile.c_str());
+
+    printResults(results, options);
+    return 0;
+}
@@ -4,84 +4,975 @@
  * @brief Programa principal que lee fichero de inicialización y lanza la simulación.
  *
  * Ejecutar:
- *   ./langton <fichero-inicializacion>
+ *   ./langton <fichero-inicializacion> (--steps N | --until-edge | --back N | --interactive) [--out fichero]
+ *             [--out-format text|bin|rle] [--snapshot-every K] [--quiet] [--view ANCHOxALTO] [--scale K] [--infinite] [--sync[=hilos]] [--highway] [--quadtree] [--macro] [--verify] [--stats]
+ *             [--telemetry fichero|-] [--telemetry-interval MS]
+ *             [--checkpoint fichero] [--checkpoint-every N] [--checkpoint-seconds T] [--resume]
+ *             [--trace fichero]
+ *             [--image fichero] [--frames base] [--frame-every K] [--frame-format png|pnm]
+ *             [--image-scale K] [--image-zoom Z] [--heatmap]
+ *             [--huge-pages off|thp|hugetlb] [--memory]
+ *
+ * Por defecto la simulación no es interactiva: ejecuta N pasos (--steps) o hasta que la hormiga
+ * alcance el borde (--until-edge), guarda el estado final en --out y solo escribe un resumen al
+ * terminar (nada con --quiet). --snapshot-every K guarda además el estado cada K pasos en
+ * "<out>.<paso>" ("snapshot.<paso>" si no hay --out). --out-format elige el formato de esos ficheros:
+ * text (el de entrada, por defecto), bin (instantánea binaria, ver Snapshot.h) o rle (binaria
+ * comprimida). --back N deshace además N pasos (0 = hasta el paso 0) ejecutando la regla al revés,
+ * sin historial, después de los que se ejecuten hacia delante; con una instantánea permite explorar
+ * hacia atrás sin repetir la simulación desde el principio. --interactive muestra el menú de siempre;
+ * en él --view ANCHOxALTO muestra solo una ventana centrada en la hormiga y --scale K un carácter
+ * por cada bloque de KxK celdas.
+ *
+ * Con --infinite la cinta no tiene bordes y crece según la hormiga la recorre;
+ * sizeX y sizeY solo indican el tamaño de la ventana que se muestra.
+ *
+ * El fichero de inicialización puede ser también una instantánea binaria guardada con
+ * --out-format bin o rle; en ese caso la cinta, la regla y las hormigas salen de ella.
  *
  * Formato del fichero:
  * Línea 1: sizeX sizeY
- * Línea 2: antX antY orient (orient: 0=Left,1=Right,2=Up,3=Down)
- * Línea 3..n: x y (coordenadas de celdas negras)
+ * Línea 2: antX antY orient [estado] (orient: 0=Left,1=Right,2=Up,3=Down; estado del turmite, 0 por defecto)
+ * Línea 3 (opcional): regla, p. ej. "RLR", "LLRR" o "turmite 2 2 1R1 1L0 1N0 0N0" (ver Rule.h).
+ *                     Si se omite se usa la hormiga de Langton ("LR"). Debe ir antes de las celdas.
+ * Líneas "ant x y orient" (opcionales): hormigas adicionales de la colonia.
+ * Línea 3..n: x y [color] (coordenadas de celdas no blancas; color 1 = negra por defecto)
+ *
+ * Con varias hormigas, --sync[=hilos] hace que en cada paso todas lean la cinta antes de
+ * escribir, repartiendo el trabajo entre hilos (uno por núcleo con 0 o sin valor, y como mucho
+ * cuatro por núcleo); por defecto se mueven una tras otra.
+ *
+ * Con --infinite, --highway detecta la autopista periódica y salta periodos completos;
+ * --quadtree usa el motor con quadtree y recorridos memorizados (una sola hormiga).
+ * --macro recorre la cinta con bordes por bloques de 4x4 con una tabla precalculada de cómo sale
+ * la hormiga de cada bloque (ver MacroStep.h; solo la regla de Langton y una sola hormiga). No
+ * es más rápido que el bucle normal: va igual sobre cintas vacías y unas 5 veces más lento sobre
+ * cintas aleatorias.
+ * --verify además repite la simulación paso a paso y comprueba que el resultado coincide
+ * (sin --quadtree implica --highway); con --macro comprueba también toda la tabla contra
+ * Ant::step. Si --back deja la simulación antes del punto de partida,
+ * la comprobación avanza una copia del resultado hasta él.
+ *
+ * --stats añade al resumen las estadísticas que Simulator mantiene paso a paso (celdas no
+ * blancas, giros, rectángulo recorrido y distancia al inicio); solo si se compiló con
+ * make STATS=1.
+ *
+ * La cinta con bordes guarda las celdas fila a fila; compilando con make LAYOUT=morton (y BMI2=1
+ * en procesadores con pdep/pext) las guarda por bloques de 8x8 en orden de Morton (ver
+ * TapeLayout.h). Los resultados y los ficheros son los mismos; solo cambia el acceso a memoria.
+ *
+ * Las cintas grandes se proyectan con mmap (ver TapeMemory.h). --huge-pages thp pide páginas
+ * grandes transparentes (madvise) y --huge-pages hugetlb páginas grandes reservadas en el sistema
+ * (MAP_HUGETLB, con thp si no quedan), que reducen los fallos de TLB en las cintas de varios GB.
+ * --memory añade al resumen los bytes proyectados, los bloques reutilizados y los fallos de página
+ * del proceso.
+ *
+ * --telemetry escribe, mientras se simula, una línea JSON por intervalo (1000 ms por defecto,
+ * --telemetry-interval) con los pasos, los pasos por segundo, la memoria de la cinta y del
+ * proceso y las baldosas de la cinta ilimitada (ver Telemetry.h), en un fichero o en la salida
+ * de errores con "-". La muestrea un hilo aparte, así que el bucle de simulación no se frena.
+ *
+ * --checkpoint guarda puntos de control (instantáneas binarias) en el fichero indicado cada N
+ * pasos (--checkpoint-every), cada T segundos (--checkpoint-seconds) y al terminar. Los escribe
+ * un hilo aparte a partir de una copia del estado (ver Checkpoint.h) y cada uno sustituye al
+ * anterior de forma atómica. Con --resume, si el fichero de --checkpoint existe, la simulación
+ * continúa desde él (cinta, hormigas, estado y número de pasos) en lugar de empezar desde el
+ * fichero de inicialización; --steps indica entonces el total de pasos contando los ya hechos.
+ * Con --verify, la comprobación parte de una copia en memoria del punto de control leído al
+ * empezar, ya que los de la propia ejecución lo sobrescriben.
+ *
+ * --trace registra la dirección de cada paso, a 2 bits por paso (ver StepTrace.h), y guarda el
+ * estado inicial en "<fichero>.start". Solo con una hormiga y sin --quadtree, --macro ni --highway con
+ * --infinite. Para reconstruir la cinta en cualquier paso del registro:
+ *   ./langton --replay <fichero> --at PASO [--at PASO ...] [--out fichero] [--out-format text|bin|rle]
+ *             [--keyframe-every N] [--keyframe-memory MB] [--quiet]
+ * que guarda cada paso pedido en "<out>.<paso>" ("replay.<paso>" si no hay --out). Se guarda en
+ * memoria un fotograma clave cada N pasos (1048576 por defecto) para no repetir el registro
+ * desde el principio en cada --at; entre todos ocupan como mucho MB megabytes (256 por defecto)
+ * además del estado inicial, y al llenarse se descartan los usados hace más tiempo.
+ *
+ * --image guarda la cinta final como imagen, PGM/PPM o PNG según la extensión (.pgm, .ppm, .pnm
+ * o .png), dibujada directamente desde la cinta (ver FrameRecorder.h). --frames graba además una
+ * secuencia "<base>.<paso>.png" (o .pgm/.ppm con --frame-format pnm) al empezar, cada K pasos
+ * (--frame-every) y al terminar; la codifican hilos aparte, así que la simulación solo se detiene
+ * para copiar la cinta. --image-scale K dibuja un píxel por cada bloque de KxK celdas (en gris
+ * según las celdas negras, o con el color más frecuente) y --image-zoom Z un cuadrado de ZxZ
+ * píxeles por celda. --heatmap colorea por el número de visitas a cada celda (solo con make
+ * STATS=1 y una cinta con bordes).
+ *
+ * Sin --interactive, Ctrl+C (SIGINT) o SIGTERM detienen la simulación al terminar el tramo de pasos
+ * en curso (ver Simulator::cancel) y se guarda igualmente lo hecho: --out, --image, el último
+ * fotograma y el punto de control, desde el que --resume puede continuar. El resumen lo indica con
+ * "Fin: interrumpida".
+ *
+ * Conjunto de simulaciones independientes repartidas entre todos los núcleos:
+ *   ./langton --ensemble <fichero-trabajos> [--threads N] [--out tabla.csv] [--no-highway]
+ *             [--huge-pages off|thp|hugetlb] [--memory] [--quiet]
+ * --threads N elige los hilos (0, por defecto, uno por núcleo; como mucho cuatro por núcleo).
+ * Cada línea del fichero de trabajos es "sizeX sizeY antX antY orient density seed maxSteps [regla]"
+ * (ver Ensemble.h). La tabla CSV con los pasos hasta el borde, las celdas no blancas al final y
+ * el inicio de la autopista se escribe en --out o, si no se indica, en la salida estándar.
  */
 
 #include "Simulator.h"
 #include "Ant.h"
+#include "Checkpoint.h"
+#include "Ensemble.h"
+#include "FrameRecorder.h"
+#include "MacroStep.h"
+#include "SeedFile.h"
+#include "Snapshot.h"
+#include "StepTrace.h"
+#include "TapeMemory.h"
+#include "Telemetry.h"
 
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdint>
 #include <fstream>
-#include <sstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
-#include <utility>
+
+namespace {
+
+// Bandera de cancelación del simulador en marcha (ver Simulator::cancelFlag)
+std::atomic<bool>* g_interrupt = nullptr;
 
 /**
-* @brief Función principal que inicia la simulación de la hormiga de Langton.
+* @brief Manejador de SIGINT y SIGTERM: pide al simulador que termine entre tramos de pasos.
+*        Solo guarda en una variable atómica sin cerrojos, que es lo que se puede hacer aquí.
 */
-int main(int argc, char* argv[])
+void onInterrupt(int)
 {
-    // Verificar que se ha proporcionado un fichero de inicialización
-    if (argc < 2) {
-        std::cerr << "Como ejecutar: " << argv[0] << " <fichero-inicializacion>\n";
+    if (g_interrupt) {
+        g_interrupt->store(true, std::memory_order_relaxed);
+    }
+}
+
+/**
+* @brief Lee el valor numérico de una opción de la línea de órdenes: solo cifras y sin pasar de
+*        'max' (los valores que no caben en 64 bits también se rechazan).
+* @param option opción, para el mensaje de error
+* @param text valor escrito
+* @param value número leído (no cambia si el valor no es válido)
+* @param max mayor valor admitido
+* @return false, tras escribir "Valor incorrecto para ...", si el valor no es válido
+*/
+bool parseNumber(const std::string& option, const std::string& text, std::uint64_t& value,
+                 std::uint64_t max = UINT64_MAX)
+{
+    std::uint64_t parsed = 0;
+    const char* end = text.data() + text.size();
+    const std::from_chars_result result = std::from_chars(text.data(), end, parsed);
+    if (text.empty() || result.ec != std::errc() || result.ptr != end || parsed > max) {
+        std::cerr << "Valor incorrecto para " << option << ": " << text << '\n';
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+/**
+* @brief Mayor número de hilos que se admite en las opciones: cuatro por núcleo de la máquina.
+*        Más hilos solo se estorban, y un valor enorme agotaría la memoria de las pilas.
+*/
+std::uint64_t maxThreads()
+{
+    return 4 * static_cast<std::uint64_t>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+/**
+* @brief Lee el valor de --huge-pages y elige las páginas de las cintas.
+* @return false si el valor no es válido
+*/
+bool setHugePages(const char* text)
+{
+    try {
+        TapeMemory::setHugePages(TapeMemory::parse(text));
+    } catch (std::invalid_argument const& e) {
+        std::cerr << e.what() << '\n';
+        return false;
+    }
+    return true;
+}
+
+/**
+* @brief Escribe en el resumen los bloques de TapeMemory y los fallos de página desde 'before'.
+*/
+void printMemory(const TapeMemory::Stats& before)
+{
+    const TapeMemory::Stats now = TapeMemory::stats();
+    std::cout << "Memoria de las cintas: " << now.mappedBytes << " bytes proyectados (" << now.maps << " bloques, "
+              << now.reuses << " reutilizados, " << now.cachedBytes << " bytes guardados), páginas grandes: "
+              << TapeMemory::name(TapeMemory::hugePages());
+    if (now.hugeFallbacks > 0) {
+        std::cout << " (" << now.hugeFallbacks << " bloques sin páginas reservadas)";
+    }
+    std::cout << "\nFallos de página: " << now.minorFaults - before.minorFaults << " menores, "
+              << now.majorFaults - before.majorFaults << " mayores\n";
+}
+
+/**
+* @brief Ejecuta el modo --ensemble: lee los trabajos, los reparte entre los hilos y escribe la tabla.
+* @return código de salida del programa
+*/
+int runEnsemble(int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cerr << "Como ejecutar: " << argv[0] << " --ensemble <fichero-trabajos> [--threads N] [--out tabla.csv]"
+                  << " [--no-highway] [--huge-pages off|thp|hugetlb] [--memory] [--quiet]\n";
         return 1;
     }
+    const TapeMemory::Stats memoryBefore = TapeMemory::stats();
+    unsigned threads = 0;
+    bool highway = true;
+    bool memory = false;
+    bool quiet = false;
+    std::string outFile;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            std::uint64_t value = 0;
+            if (!parseNumber(arg, argv[++i], value)) return 1;
+            if (value > maxThreads()) {
+                std::cerr << "--threads debe estar entre 0 (núcleos de la máquina) y " << maxThreads() << '\n';
+                return 1;
+            }
+            threads = static_cast<unsigned>(value);
+        } else if (arg == "--out" && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (arg == "--no-highway") {
+            highway = false;
+        } else if (arg == "--huge-pages" && i + 1 < argc) {
+            if (!setHugePages(argv[++i])) return 1;
+        } else if (arg == "--memory") {
+            memory = true;
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else {
+            std::cerr << "Opción desconocida o sin valor: " << arg << '\n';
+            return 1;
+        }
+    }
 
-    // Abrir el fichero de inicialización
-    std::string filename = argv[1];
-    std::ifstream ifs(filename);
-    // Verificar que el fichero se ha abierto correctamente
-    if (!ifs) {
-        std::cerr << "No se pudo abrir el fichero: " << filename << '\n';
+    try {
+        std::vector<EnsembleJob> jobs = Ensemble::readJobs(argv[2]);
+        Ensemble ensemble(threads);
+        ensemble.setHighwayTracking(highway);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<EnsembleResult> results = ensemble.run(jobs);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (outFile.empty()) {
+            Ensemble::writeTable(std::cout, jobs, results);
+        } else {
+            std::ofstream ofs(outFile);
+            Ensemble::writeTable(ofs, jobs, results);
+            if (!ofs) {
+                std::cerr << "Error guardando en " << outFile << '\n';
+                return 1;
+            }
+            if (!quiet) {
+                std::uint64_t steps = 0;
+                std::size_t failed = 0;
+                for (auto const& r : results) {
+                    steps += r.steps;
+                    failed += !r.error.empty();
+                }
+                std::cout << "Simulaciones: " << jobs.size() << " (" << failed << " con error) en "
+                          << ensemble.threads() << " hilos\n";
+                std::cout << "Tiempo: " << seconds << " s";
+                if (seconds > 0) {
+                    std::cout << " (" << static_cast<std::uint64_t>(steps / seconds) << " pasos/s)";
+                }
+                std::cout << "\nTabla guardada en " << outFile << '\n';
+                if (memory) {
+                    printMemory(memoryBefore);
+                }
+            }
+        }
+    } catch (SeedFormatError const& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    } catch (std::exception const& e) {
+        std::cerr << "Error en el simulador: " << e.what() << '\n';
         return 1;
     }
+    return 0;
+}
 
-    // Leer el tamaño del tablero
-    unsigned sizeX = 0, sizeY = 0;
-    if (!(ifs >> sizeX >> sizeY)) {
-        // Si no se pueden leer los tamaños, mostrar un error
-        std::cerr << "Formato incorrecto en la línea 1 (sizeX sizeY)\n";
+/**
+* @brief Ejecuta el modo --replay: reconstruye la cinta en los pasos pedidos a partir de un registro.
+* @return código de salida del programa
+*/
+int runReplay(int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cerr << "Como ejecutar: " << argv[0] << " --replay <registro> --at PASO [--at PASO ...] [--out fichero]"
+                  << " [--out-format text|bin|rle] [--keyframe-every N] [--keyframe-memory MB] [--quiet]\n";
+        return 1;
+    }
+    std::vector<std::uint64_t> targets;
+    std::uint64_t keyframeEvery = TraceReplay::kDefaultKeyframeInterval;
+    std::uint64_t keyframeMegabytes = TraceReplay::kDefaultKeyframeBytes >> 20;
+    bool quiet = false;
+    std::string outFile = "replay";
+    std::string outFormat = "text";
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--at" && i + 1 < argc) {
+            std::uint64_t step = 0;
+            if (!parseNumber(arg, argv[++i], step)) return 1;
+            targets.push_back(step);
+        } else if (arg == "--keyframe-every" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], keyframeEvery)) return 1;
+        } else if (arg == "--keyframe-memory" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], keyframeMegabytes, UINT64_MAX >> 20)) return 1;
+        } else if (arg == "--out" && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (arg == "--out-format" && i + 1 < argc) {
+            outFormat = argv[++i];
+            if (outFormat != "text" && outFormat != "bin" && outFormat != "rle") {
+                std::cerr << "Valor incorrecto para --out-format (text, bin o rle): " << outFormat << '\n';
+                return 1;
+            }
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else {
+            std::cerr << "Opción desconocida o sin valor: " << arg << '\n';
+            return 1;
+        }
+    }
+    if (targets.empty()) {
+        std::cerr << "Indica al menos un --at PASO\n";
         return 1;
     }
 
-    // Leer la posición inicial de la hormiga y su orientación
-    unsigned antX = 0, antY = 0;
-    int orientInt = 0;
-    // Verificar que se pueden leer los valores de la hormiga
-    if (!(ifs >> antX >> antY >> orientInt)) {
-        std::cerr << "Formato incorrecto en la línea 2 (antX antY orient)\n";
+    try {
+        const std::string traceFile = argv[2];
+        TraceReplay replay(traceFile + ".start", traceFile, keyframeEvery, keyframeMegabytes << 20);
+        if (!quiet) {
+            std::cout << "Registro: pasos " << replay.firstStep() << " - " << replay.lastStep() << '\n';
+        }
+        for (std::uint64_t step : targets) {
+            auto start = std::chrono::steady_clock::now();
+            Simulator sim = replay.seek(step);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            const std::string file = outFile + "." + std::to_string(step);
+            bool saved = outFormat == "text" ? sim.saveState(file) : sim.saveSnapshot(file, outFormat == "rle");
+            if (!saved) {
+                std::cerr << "Error guardando en " << file << '\n';
+                return 1;
+            }
+            if (!quiet) {
+                std::cout << "Paso " << step << " guardado en " << file << " (" << seconds << " s)\n";
+            }
+        }
+    } catch (std::exception const& e) {
+        std::cerr << "Error en el simulador: " << e.what() << '\n';
         return 1;
     }
-    // Verificar que la orientación es válida (0 a 3)
-    if (orientInt < 0 || orientInt > 3) {
-        std::cerr << "Orientación incorrecta (debe ser 0 al 3)\n";
+    return 0;
+}
+
+// Opciones de la simulación (ni --ensemble ni --replay), tal como se leen de la línea de órdenes
+struct RunOptions {
+    // Tipo de cinta, orden de actualización de la colonia y motores
+    Simulator::Mode mode = Simulator::BOUNDED;
+    Simulator::UpdateOrder order = Simulator::SEQUENTIAL;
+    unsigned threads = 0;
+    bool highway = false;
+    bool quadtree = false;
+    bool macro = false;
+    bool verify = false;
+    bool stats = false;
+    bool memory = false;
+    // Telemetría, puntos de control, registro de pasos e imágenes
+    std::string telemetryOut;
+    std::uint64_t telemetryInterval = 1000;
+    std::string checkpointFile;
+    std::uint64_t checkpointEvery = 0;
+    std::uint64_t checkpointSeconds = 0;
+    bool resume = false;
+    std::string traceFile;
+    std::string imageFile;
+    std::string framesBase;
+    std::uint64_t frameEvery = 0;
+    ImageWriter::Format frameFormat = ImageWriter::PNG;
+    FrameOptions frameOptions;
+    // Modo no interactivo
+    bool interactive = false;
+    bool untilEdge = false;
+    bool stepsGiven = false;
+    std::uint64_t steps = 0;
+    bool backGiven = false;
+    std::uint64_t back = 0;
+    std::uint64_t snapshotEvery = 0;
+    bool quiet = false;
+    std::string outFile;
+    std::string outFormat = "text";
+    // Ventana del modo interactivo
+    std::uint64_t viewX = 0;
+    std::uint64_t viewY = 0;
+    std::uint64_t scale = 1;
+};
+
+/**
+* @brief Lee las opciones que siguen al fichero de inicialización y comprueba que se pueden
+*        usar juntas.
+* @param options opciones leídas
+* @return false, tras escribir el motivo, si alguna no es válida
+*/
+bool parseOptions(int argc, char* argv[], RunOptions& options)
+{
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        // Valor numérico de la opción, en el argumento siguiente
+        auto number = [&](std::uint64_t& value, std::uint64_t max = UINT64_MAX) {
+            if (i + 1 >= argc) {
+                std::cerr << "Falta el valor de " << arg << '\n';
+                return false;
+            }
+            return parseNumber(arg, argv[++i], value, max);
+        };
+        // Valor de texto de la opción, en el argumento siguiente
+        auto text = [&](std::string& value) {
+            if (i + 1 >= argc) {
+                std::cerr << "Falta el valor de " << arg << '\n';
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+        if (arg == "--steps") {
+            if (!number(options.steps)) return false;
+            options.stepsGiven = true;
+        } else if (arg == "--until-edge") {
+            options.untilEdge = true;
+        } else if (arg == "--back") {
+            if (!number(options.back)) return false;
+            options.backGiven = true;
+        } else if (arg == "--snapshot-every") {
+            if (!number(options.snapshotEvery)) return false;
+        } else if (arg == "--out") {
+            if (!text(options.outFile)) return false;
+        } else if (arg == "--view") {
+            std::string value = (i + 1 < argc) ? argv[i + 1] : "";
+            std::size_t sep = value.find('x');
+            if (sep == std::string::npos) {
+                std::cerr << "Valor incorrecto para --view (ANCHOxALTO): " << value << '\n';
+                return false;
+            }
+            // Cada lado tiene que caber en el unsigned de Simulator::setViewport
+            if (!parseNumber("--view (ANCHOxALTO)", value.substr(0, sep), options.viewX, UINT_MAX) ||
+                !parseNumber("--view (ANCHOxALTO)", value.substr(sep + 1), options.viewY, UINT_MAX)) {
+                return false;
+            }
+            ++i;
+        } else if (arg == "--scale") {
+            if (!number(options.scale, UINT_MAX)) return false;
+            if (options.scale == 0) {
+                std::cerr << "--scale debe ser mayor que 0\n";
+                return false;
+            }
+        } else if (arg == "--out-format") {
+            options.outFormat = (i + 1 < argc) ? argv[++i] : "";
+            if (options.outFormat != "text" && options.outFormat != "bin" && options.outFormat != "rle") {
+                std::cerr << "Valor incorrecto para --out-format (text, bin o rle): " << options.outFormat << '\n';
+                return false;
+            }
+        } else if (arg == "--quiet") {
+            options.quiet = true;
+        } else if (arg == "--interactive") {
+            options.interactive = true;
+        } else if (arg == "--infinite") {
+            options.mode = Simulator::INFINITE;
+        } else if (arg == "--highway") {
+            options.highway = true;
+        } else if (arg == "--quadtree") {
+            options.quadtree = true;
+        } else if (arg == "--macro") {
+            options.macro = true;
+        } else if (arg == "--verify") {
+            options.verify = true;
+        } else if (arg == "--stats") {
+            if (!Simulator::kStatistics) {
+                std::cerr << "--stats necesita compilar con estadísticas (make clean && make STATS=1)\n";
+                return false;
+            }
+            options.stats = true;
+        } else if (arg == "--telemetry") {
+            if (!text(options.telemetryOut)) return false;
+        } else if (arg == "--telemetry-interval") {
+            if (!number(options.telemetryInterval)) return false;
+            if (options.telemetryInterval == 0) {
+                std::cerr << "--telemetry-interval debe ser mayor que 0\n";
+                return false;
+            }
+        } else if (arg == "--checkpoint") {
+            if (!text(options.checkpointFile)) return false;
+        } else if (arg == "--checkpoint-every") {
+            if (!number(options.checkpointEvery)) return false;
+        } else if (arg == "--checkpoint-seconds") {
+            if (!number(options.checkpointSeconds)) return false;
+        } else if (arg == "--resume") {
+            options.resume = true;
+        } else if (arg == "--trace") {
+            if (!text(options.traceFile)) return false;
+        } else if (arg == "--image") {
+            if (!text(options.imageFile)) return false;
+        } else if (arg == "--frames") {
+            if (!text(options.framesBase)) return false;
+        } else if (arg == "--frame-every") {
+            if (!number(options.frameEvery)) return false;
+        } else if (arg == "--frame-format") {
+            std::string value = (i + 1 < argc) ? argv[++i] : "";
+            if (value != "png" && value != "pnm") {
+                std::cerr << "Valor incorrecto para --frame-format (png o pnm): " << value << '\n';
+                return false;
+            }
+            options.frameFormat = value == "png" ? ImageWriter::PNG : ImageWriter::PNM;
+        } else if (arg == "--image-scale" || arg == "--image-zoom") {
+            std::uint64_t value;
+            if (!number(value)) return false;
+            if (value == 0 || value > 4096) {
+                std::cerr << arg << " debe estar entre 1 y 4096\n";
+                return false;
+            }
+            (arg == "--image-scale" ? options.frameOptions.cellsPerPixel : options.frameOptions.pixelsPerCell) =
+                static_cast<unsigned>(value);
+        } else if (arg == "--heatmap") {
+            if (!Simulator::kStatistics) {
+                std::cerr << "--heatmap necesita compilar con estadísticas (make clean && make STATS=1)\n";
+                return false;
+            }
+            options.frameOptions.heatmap = true;
+        } else if (arg == "--huge-pages") {
+            std::string value;
+            if (!text(value) || !setHugePages(value.c_str())) return false;
+        } else if (arg == "--memory") {
+            options.memory = true;
+        } else if (arg == "--sync") {
+            options.order = Simulator::SYNCHRONOUS;
+        } else if (arg.rfind("--sync=", 0) == 0) {
+            options.order = Simulator::SYNCHRONOUS;
+            std::uint64_t value = 0;
+            if (!parseNumber("--sync", arg.substr(7), value)) return false;
+            if (value > maxThreads()) {
+                std::cerr << "--sync=hilos debe estar entre 0 (núcleos de la máquina) y " << maxThreads() << '\n';
+                return false;
+            }
+            options.threads = static_cast<unsigned>(value);
+        } else {
+            std::cerr << "Opción desconocida: " << arg << '\n';
+            return false;
+        }
+    }
+
+    if (options.verify && !options.quadtree) {
+        options.highway = true;
+    }
+    if (!options.interactive) {
+        if (options.stepsGiven == options.untilEdge && !(options.backGiven && !options.stepsGiven)) {
+            std::cerr << "Indica --steps N, --until-edge o --back N (o --interactive para el menú)\n";
+            return false;
+        }
+        if (options.untilEdge && options.mode == Simulator::INFINITE) {
+            std::cerr << "--until-edge necesita una cinta con bordes\n";
+            return false;
+        }
+        if (options.stepsGiven && options.steps == 0) {
+            std::cerr << "--steps debe ser mayor que 0\n";
+            return false;
+        }
+    }
+    if (options.checkpointFile.empty() &&
+        (options.checkpointEvery != 0 || options.checkpointSeconds != 0 || options.resume)) {
+        std::cerr << "--checkpoint-every, --checkpoint-seconds y --resume necesitan --checkpoint\n";
+        return false;
+    }
+    if (options.interactive && !options.checkpointFile.empty() && !options.resume) {
+        std::cerr << "Los puntos de control solo se guardan en el modo no interactivo\n";
+        return false;
+    }
+    if (options.interactive && !options.traceFile.empty()) {
+        std::cerr << "El registro de pasos solo se guarda en el modo no interactivo\n";
+        return false;
+    }
+    if (options.framesBase.empty() != (options.frameEvery == 0)) {
+        std::cerr << "--frames y --frame-every K van juntos\n";
+        return false;
+    }
+    if (options.interactive && (!options.imageFile.empty() || !options.framesBase.empty())) {
+        std::cerr << "Las imágenes solo se guardan en el modo no interactivo\n";
+        return false;
+    }
+    if (!options.imageFile.empty()) {
+        try {
+            ImageWriter::formatOf(options.imageFile);
+        } catch (std::invalid_argument const& e) {
+            std::cerr << e.what() << '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+* @brief Aplica a 'sim' el orden de actualización, la autopista y el motor pedidos.
+* @param fast true para usar los motores y la autopista pedidos; false para el paso a paso
+*        con que se verifican
+*/
+void configureSimulator(Simulator& sim, const RunOptions& options, bool fast)
+{
+    sim.setUpdateOrder(options.order, options.threads);
+    sim.setHighwayAcceleration(fast && options.highway);
+    sim.setEngine(!fast ? Simulator::STEPPER
+                  : options.quadtree ? Simulator::QUADTREE
+                  : options.macro ? Simulator::MACRO
+                  : Simulator::STEPPER);
+}
+
+/**
+* @brief Crea un simulador desde el fichero de inicialización o la instantánea 'filename'.
+* @param fast true para usar los motores y la autopista pedidos; false para el paso a paso
+*        con que se verifican
+*/
+Simulator buildSimulator(const RunOptions& options, const std::string& filename, bool fast)
+{
+    // Una instantánea binaria ya contiene el estado completo; si no, el fichero de texto se
+    // proyecta en memoria y se lee en paralelo (ver SeedFile.h)
+    Simulator sim = Snapshot::isSnapshot(filename) ? Simulator::loadSnapshot(filename)
+                                                   : Simulator::loadSeed(filename, options.mode);
+    configureSimulator(sim, options, fast);
+    return sim;
+}
+
+/**
+* @brief Repite los pasos de 'sim' uno a uno desde 'filename' para verificar el salto de
+*        autopista, el quadtree o los macro-pasos (y antes, la tabla de macro-pasos entera).
+* @param initial estado de partida guardado al empezar, o nullptr para releer 'filename' (al
+*        reanudar, el fichero es el punto de control, que la propia ejecución sobrescribe)
+* @return true si el resultado coincide
+*/
+bool verifyRun(const RunOptions& options, const std::string& filename, const SnapshotImage* initial,
+               const Simulator& sim)
+{
+    if (options.macro && MacroStep::verify() != 0) {
+        return false;
+    }
+    Simulator reference = initial ? Simulator::fromSnapshot(*initial) : buildSimulator(options, filename, false);
+    if (initial) {
+        configureSimulator(reference, options, false);
+    }
+    reference.setQuiet(true);
+    // Una instantánea ya trae pasos hechos; solo se repiten los que faltan
+    if (sim.stepCount() > reference.stepCount()) {
+        reference.runFast(sim.stepCount() - reference.stepCount());
+    } else if (sim.stepCount() < reference.stepCount()) {
+        // Con --back se puede acabar antes del punto de partida: se avanza una copia del
+        // resultado hasta él y se compara allí
+        SnapshotImage image;
+        sim.captureSnapshot(image);
+        Simulator check = Simulator::fromSnapshot(image);
+        check.setQuiet(true);
+        check.runFast(reference.stepCount() - sim.stepCount());
+        return check.sameState(reference);
+    }
+    return sim.sameState(reference);
+}
+
+/**
+* @brief Modo no interactivo: el bucle de simulación con las instantáneas, los puntos de
+*        control, el registro y los fotogramas pedidos, lo que se guarda al final y el resumen.
+* @param sim simulador recién creado
+* @param filename fichero del que se creó (para --verify)
+* @param initial estado de partida para --verify, o nullptr para releer 'filename'
+* @param resumed true si se reanuda desde un punto de control
+* @param memoryBefore estadísticas de TapeMemory al empezar el programa (para --memory)
+* @return código de salida del programa
+*/
+int runBatch(Simulator& sim, const RunOptions& options, const std::string& filename, const SnapshotImage* initial,
+             bool resumed, const TapeMemory::Stats& memoryBefore)
+{
+    sim.setQuiet(true);
+    auto save = [&](const std::string& file) {
+        return options.outFormat == "text" ? sim.saveState(file) : sim.saveSnapshot(file, options.outFormat == "rle");
+    };
+    const std::string snapshotBase = options.outFile.empty() ? "snapshot" : options.outFile;
+    // Telemetría en otro hilo: el fichero se declara antes para que se cierre después
+    std::ofstream telemetryFile;
+    std::unique_ptr<Telemetry> telemetry;
+    if (!options.telemetryOut.empty()) {
+        std::ostream* out = &std::cerr;
+        if (options.telemetryOut != "-") {
+            telemetryFile.open(options.telemetryOut);
+            if (!telemetryFile) {
+                std::cerr << "Error abriendo " << options.telemetryOut << '\n';
+                return 1;
+            }
+            out = &telemetryFile;
+        }
+        telemetry.reset(new Telemetry(sim.telemetry(), *out, std::chrono::milliseconds(options.telemetryInterval)));
+    }
+    // Puntos de control en otro hilo
+    std::unique_ptr<Checkpointer> checkpoint;
+    if (!options.checkpointFile.empty()) {
+        checkpoint.reset(new Checkpointer(options.checkpointFile, false));
+    }
+    // Registro de pasos, con el estado inicial al lado para poder reconstruirlo
+    std::unique_ptr<TraceWriter> trace;
+    if (!options.traceFile.empty()) {
+        if (!sim.saveSnapshot(options.traceFile + ".start")) {
+            std::cerr << "Error guardando en " << options.traceFile << ".start\n";
+            return 1;
+        }
+        trace.reset(new TraceWriter(options.traceFile, sim.stepCount()));
+        sim.setStepTrace(trace.get());
+    }
+    // Fotogramas: el visitado se cuenta desde aquí para el mapa de calor
+    if (options.frameOptions.heatmap) {
+        sim.setVisitCounting(true);
+    }
+    std::unique_ptr<FrameRecorder> frames;
+    std::uint64_t lastFrame = 0;
+    if (!options.framesBase.empty()) {
+        frames.reset(new FrameRecorder(options.framesBase, options.frameFormat, options.frameOptions));
+        frames->record(sim);
+        lastFrame = sim.stepCount();
+    }
+    const std::uint64_t steps = options.steps;
+    const std::uint64_t snapshotEvery = options.snapshotEvery;
+    const std::uint64_t checkpointEvery = options.checkpointEvery;
+    const std::uint64_t checkpointSeconds = options.checkpointSeconds;
+    const std::uint64_t frameEvery = options.frameEvery;
+    // Tramo de pasos entre dos consultas del reloj con --checkpoint-seconds
+    const std::uint64_t timedChunk = std::uint64_t(1) << 24;
+    auto start = std::chrono::steady_clock::now();
+    auto lastCheckpoint = start;
+    // Al reanudar, los pasos se cuentan desde el inicio de la simulación
+    const std::uint64_t firstStep = resumed ? sim.stepCount() : 0;
+    std::uint64_t executed = firstStep;
+    // Ctrl+C o SIGTERM cortan la simulación y se guarda lo hecho
+    const std::shared_ptr<std::atomic<bool>> interrupt = sim.cancelFlag();
+    g_interrupt = interrupt.get();
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+    while (!sim.borderReached() && !sim.cancelled() && (options.untilEdge || executed < steps)) {
+        // Hasta el final o hasta la siguiente instantánea o punto de control
+        std::uint64_t chunk = options.untilEdge ? 0 : steps - executed;
+        if (snapshotEvery != 0) {
+            std::uint64_t toSnapshot = snapshotEvery - executed % snapshotEvery;
+            chunk = (chunk == 0) ? toSnapshot : std::min(chunk, toSnapshot);
+        }
+        if (checkpointEvery != 0) {
+            std::uint64_t toCheckpoint = checkpointEvery - executed % checkpointEvery;
+            chunk = (chunk == 0) ? toCheckpoint : std::min(chunk, toCheckpoint);
+        }
+        if (frameEvery != 0) {
+            std::uint64_t toFrame = frameEvery - executed % frameEvery;
+            chunk = (chunk == 0) ? toFrame : std::min(chunk, toFrame);
+        }
+        if (checkpointSeconds != 0) {
+            chunk = (chunk == 0) ? timedChunk : std::min(chunk, timedChunk);
+        }
+        executed += sim.runFast(chunk);
+        if (frames && executed % frameEvery == 0) {
+            frames->record(sim);
+            lastFrame = sim.stepCount();
+        }
+        if (snapshotEvery != 0 && !sim.borderReached() && executed % snapshotEvery == 0) {
+            std::string snapshot = snapshotBase + "." + std::to_string(executed);
+            if (!save(snapshot)) {
+                std::cerr << "Error guardando en " << snapshot << '\n';
+                return 1;
+            }
+        }
+        if (checkpoint && !sim.borderReached()) {
+            auto now = std::chrono::steady_clock::now();
+            if ((checkpointEvery != 0 && executed % checkpointEvery == 0) ||
+                (checkpointSeconds != 0 && now - lastCheckpoint >= std::chrono::seconds(checkpointSeconds))) {
+                checkpoint->save(sim);
+                lastCheckpoint = now;
+            }
+        }
+    }
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    g_interrupt = nullptr;
+    const bool interrupted = sim.cancelled();
+    // Pasos hacia atrás, después de los de hacia delante
+    std::uint64_t undone = 0;
+    if (options.backGiven && !interrupted) {
+        undone = sim.runBackwards(options.back);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (telemetry) {
+        sim.publishProgress();
+        telemetry->stop();
+    }
+    if (trace) {
+        sim.setStepTrace(nullptr);
+        if (!trace->close()) {
+            std::cerr << "Error guardando el registro de pasos en " << options.traceFile << '\n';
+            return 1;
+        }
+    }
+    if (frames) {
+        if (lastFrame != sim.stepCount()) {
+            frames->record(sim);
+        }
+        if (!frames->flush()) {
+            std::cerr << "Error guardando los fotogramas en " << options.framesBase << ".*\n";
+            return 1;
+        }
+    }
+    if (checkpoint) {
+        checkpoint->save(sim);
+        if (!checkpoint->flush()) {
+            std::cerr << "Error guardando el punto de control en " << options.checkpointFile << '\n';
+            return 1;
+        }
+    }
+
+    if (!options.outFile.empty() && !save(options.outFile)) {
+        std::cerr << "Error guardando en " << options.outFile << '\n';
+        return 1;
+    }
+    if (!options.imageFile.empty() && !sim.saveImage(options.imageFile, options.frameOptions)) {
+        std::cerr << "Error guardando la imagen en " << options.imageFile << '\n';
+        return 1;
+    }
+    bool verified = !options.verify || verifyRun(options, filename, initial, sim);
+    if (!options.quiet) {
+        std::cout << "Pasos ejecutados: " << executed;
+        if (resumed) {
+            std::cout << " (reanudada en el paso " << firstStep << ')';
+        }
+        std::cout << '\n';
+        if (options.backGiven) {
+            std::cout << "Pasos deshechos: " << undone << " (paso actual " << sim.stepCount() << ")\n";
+        }
+        std::cout << "Fin: " << (sim.borderReached() ? "borde alcanzado" : interrupted ? "interrumpida" : "pasos completados")
+                  << '\n';
+        std::cout << "Tiempo: " << seconds << " s";
+        if (seconds > 0) {
+            std::cout << " (" << static_cast<std::uint64_t>((executed - firstStep) / seconds) << " pasos/s)";
+        }
+        std::cout << '\n';
+        if (!options.outFile.empty()) {
+            std::cout << "Estado guardado en " << options.outFile << '\n';
+        }
+        if (checkpoint) {
+            std::cout << "Puntos de control guardados en " << options.checkpointFile << ": " << checkpoint->written() << '\n';
+        }
+        if (trace) {
+            std::cout << "Pasos registrados en " << options.traceFile << ": " << trace->steps() << '\n';
+        }
+        if (!options.imageFile.empty()) {
+            std::cout << "Imagen guardada en " << options.imageFile << '\n';
+        }
+        if (frames) {
+            std::cout << "Fotogramas guardados en " << options.framesBase << ".*: " << frames->written() << '\n';
+        }
+        if (options.verify) {
+            std::cout << "Verificación contra la simulación paso a paso: " << (verified ? "OK" : "FALLO") << '\n';
+        }
+        if (options.stats) {
+            Simulator::Statistics s = sim.statistics();
+            std::cout << "Celdas no blancas: " << s.blackCells << '\n';
+            std::cout << "Giros: " << s.turns[Rule::LEFT] << " izquierda, " << s.turns[Rule::RIGHT] << " derecha, "
+                      << s.turns[Rule::UTURN] << " media vuelta, " << s.turns[Rule::NONE] << " sin giro\n";
+            if (s.touched) {
+                std::cout << "Rectángulo recorrido: (" << s.minX << ", " << s.minY << ") - ("
+                          << s.maxX << ", " << s.maxY << ")\n";
+            }
+            std::cout << "Distancia al inicio: " << s.distance << " (" << s.dx << ", " << s.dy << ")\n";
+        }
+        if (options.memory) {
+            printMemory(memoryBefore);
+        }
+    }
+    return verified ? 0 : 1;
+}
+
+} // namespace
+
+/**
+* @brief Función principal que inicia la simulación de la hormiga de Langton.
+*/
+int main(int argc, char* argv[])
+{
+    if (argc >= 2 && std::string(argv[1]) == "--ensemble") {
+        return runEnsemble(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--replay") {
+        return runReplay(argc, argv);
+    }
+    // Verificar que se ha proporcionado un fichero de inicialización
+    if (argc < 2) {
+        std::cerr << "Como ejecutar: " << argv[0] << " <fichero-inicializacion> (--steps N | --until-edge | --back N | --interactive)"
+                  << " [--out fichero] [--out-format text|bin|rle] [--snapshot-every K] [--quiet] [--view ANCHOxALTO] [--scale K]"
+                  <<  " [--infinite] [--sync[=hilos]] [--highway] [--quadtree] [--macro] [--verify] [--stats]"
+                  << " [--telemetry fichero|-] [--telemetry-interval MS]"
+                  << " [--checkpoint fichero] [--checkpoint-every N] [--checkpoint-seconds T] [--resume]"
+                  << " [--trace fichero]"
+                  << " [--image fichero] [--frames base] [--frame-every K] [--frame-format png|pnm]"
+                  << " [--image-scale K] [--image-zoom Z] [--heatmap]"
+                  << " [--huge-pages off|thp|hugetlb] [--memory]\n";
+        return 1;
+    }
+    const TapeMemory::Stats memoryBefore = TapeMemory::stats();
+
+    RunOptions options;
+    if (!parseOptions(argc, argv, options)) {
         return 1;
     }
-    // Convertir la orientación a la enumeración correspondiente
-    Ant::Orientation orient = static_cast<Ant::Orientation>(orientInt);
 
-    // Leer las coordenadas de las celdas negras
-    std::vector<std::pair<unsigned, unsigned>> blacks;
-    unsigned bx, by;
-    while (ifs >> bx >> by) {
-        // Añadir la coordenada a la lista de celdas negras
-        blacks.emplace_back(bx, by);
+    // Con --resume se continúa desde el último punto de control, si lo hay
+    std::string filename = argv[1];
+    const bool resumed = options.resume && std::ifstream(options.checkpointFile).good();
+    if (resumed) {
+        filename = options.checkpointFile;
     }
 
     try {
-        // Crear el simulador con los parámetros leídos
-        Simulator sim(sizeX, sizeY, antX, antY, orient);
-        // Inicializar las celdas negras en el simulador
-        sim.initializeBlacks(blacks);
+        Simulator sim = buildSimulator(options, filename, true);
+        // Una instantánea puede traer la cinta ilimitada aunque no se pida --infinite
+        if (!options.interactive && options.untilEdge && sim.mode() == Simulator::INFINITE) {
+            std::cerr << "--until-edge necesita una cinta con bordes\n";
+            return 1;
+        }
+        // Al reanudar, la verificación parte del punto de control tal como estaba al empezar:
+        // los puntos de control de esta ejecución lo sobrescriben
+        std::unique_ptr<SnapshotImage> initial;
+        if (resumed && options.verify) {
+            initial.reset(new SnapshotImage());
+            sim.captureSnapshot(*initial);
+        }
+        if (!options.interactive) {
+            // Modo no interactivo: solo el bucle de simulación y, al final, un resumen
+            return runBatch(sim, options, filename, initial.get(), resumed, memoryBefore);
+        }
 
         // Ejecutar la simulación de forma interactiva
+        sim.setViewport(static_cast<unsigned>(options.viewX), static_cast<unsigned>(options.viewY),
+                        static_cast<unsigned>(options.scale));
         sim.runInteractive();
 
+        // Verificar el salto de autopista, el quadtree o los macro-pasos repitiendo los mismos pasos uno a uno
+        if (options.verify) {
+            std::cout << "Verificación contra la simulación paso a paso: "
+                      << (verifyRun(options, filename, initial.get(), sim) ? "OK" : "FALLO") << '\n';
+        }
+
         // Preguntar al usuario si desea guardar el estado de la simulación
         std::cout << "¿Quieres guardar el estado de la simulación en un fichero? (s/n): ";
         std::string respuesta;
@@ -99,6 +990,9 @@ int main(int argc, char* argv[])
                 std::cout << "Error guardando en " << out << '\n';
             }
         }
+    } catch (SeedFormatError const& e) { // Línea incorrecta en el fichero de inicialización
+        std::cerr << e.what() << '\n';
+        return 1;
     } catch (std::exception const& e) { // Cualquier excepción que ocurra durante la simulación
         std::cerr << "Error en el simulador: " << e.what() << '\n';
         return 1;